@@ -10,6 +10,14 @@ precision mediump float;
 #if ReceiveShadows
 uniform mat4 u_ShadowLightWVPT;
 uniform sampler2D u_ShadowTexture;
+
+// Cascaded shadows, u_ShadowCascadeCount is 0 if the shadow light isn't cascaded.
+uniform float u_ShadowCascadeCount;
+uniform mat4 u_ShadowCascadeWVPT[4];
+uniform vec4 u_ShadowCascadeTiles[4]; // Min and max texture coords of each cascade's tile in the atlas.
+uniform vec4 u_ShadowCascadeSplits; // Far view depth of each cascade.
+uniform vec3 u_ShadowCascadeViewPos;
+uniform vec3 u_ShadowCascadeViewDir;
 #endif //ReceiveShadows
 
 #ifdef VertexShader
@@ -49,12 +57,53 @@ void main()
 	vec3 WSNormal = texture2D( u_TextureNormal, UVCoord ).xyz;
     float depth = texture2D( u_TextureDepth, UVCoord ).x;
 
+    // Whether fragment is in shadow or not, 0.0 if it is, 1.0 if not.
+    float shadowPerc = 1.0;
+
 #if ReceiveShadows
     vec4 shadowPos = u_ShadowLightWVPT * vec4( WSPosition, 1 );
-#endif //ReceiveShadows
+    bool receivesShadow = true;
 
-    // Whether fragment is in shadow or not, returns 0.0 if it is, 1.0 if not.
-    float shadowPerc = CalculateShadowPercentage( shadowPos );
+    // Pick the nearest cascade covering this pixel's view depth, pixels past the last split aren't shadowed.
+    if( u_ShadowCascadeCount > 0.0 )
+    {
+        float viewDepth = dot( WSPosition - u_ShadowCascadeViewPos, u_ShadowCascadeViewDir );
+
+        vec4 tile = vec4( 0.0 );
+        if( viewDepth < u_ShadowCascadeSplits.x )
+        {
+            shadowPos = u_ShadowCascadeWVPT[0] * vec4( WSPosition, 1 );
+            tile = u_ShadowCascadeTiles[0];
+        }
+        else if( viewDepth < u_ShadowCascadeSplits.y )
+        {
+            shadowPos = u_ShadowCascadeWVPT[1] * vec4( WSPosition, 1 );
+            tile = u_ShadowCascadeTiles[1];
+        }
+        else if( viewDepth < u_ShadowCascadeSplits.z )
+        {
+            shadowPos = u_ShadowCascadeWVPT[2] * vec4( WSPosition, 1 );
+            tile = u_ShadowCascadeTiles[2];
+        }
+        else if( viewDepth < u_ShadowCascadeSplits.w )
+        {
+            shadowPos = u_ShadowCascadeWVPT[3] * vec4( WSPosition, 1 );
+            tile = u_ShadowCascadeTiles[3];
+        }
+        else
+        {
+            receivesShadow = false;
+        }
+
+        // Anything that projects outside its cascade's tile would sample a neighbouring cascade.
+        vec2 shadowCoord = shadowPos.xy / shadowPos.w;
+        if( any( lessThan( shadowCoord, tile.xy ) ) || any( greaterThan( shadowCoord, tile.zw ) ) )
+            receivesShadow = false;
+    }
+
+    if( receivesShadow )
+        shadowPerc = CalculateShadowPercentage( shadowPos );
+#endif //ReceiveShadows
 
     // Accumulate ambient, diffuse and specular color for all lights.
     vec3 finalAmbient = vec3( 0.05, 0.05, 0.05 );
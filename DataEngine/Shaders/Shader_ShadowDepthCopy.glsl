@@ -0,0 +1,35 @@
+#ifdef WIN32
+#define lowp
+#define mediump
+#else
+precision mediump float;
+#endif
+
+varying vec2 v_UVCoord;
+
+#ifdef VertexShader
+
+attribute vec4 a_Position;
+attribute vec2 a_UVCoord;
+
+void main()
+{
+    gl_Position = a_Position;
+    v_UVCoord = a_UVCoord;
+}
+
+#endif
+
+#ifdef FragmentShader
+
+uniform sampler2D u_TextureColor; // Depth texture of the cached static shadow casters.
+
+void main()
+{
+    float depth = texture2D( u_TextureColor, v_UVCoord ).r;
+
+    gl_FragColor = vec4( depth, depth, depth, 1 );
+    gl_FragDepth = depth;
+}
+
+#endif
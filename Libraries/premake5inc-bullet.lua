@@ -43,6 +43,11 @@ project "BulletCollision"
         optimize            "Full"
         vectorextensions    "SSE2"
 
+if PremakeConfig_UseBulletMT == true then
+    filter {}
+        defines             "BT_THREADSAFE=1"
+end
+
 -- String pooling is causing build errors in VS2019, don't feel like looking into it, so disabling.
 --    filter { "system:windows", "configurations:Release" }
 --        buildoptions        { "\\GF" } -- /GF -> Enable String Pooling 
@@ -85,6 +90,11 @@ project "BulletDynamics"
         optimize            "Full"
         vectorextensions    "SSE2"
 
+if PremakeConfig_UseBulletMT == true then
+    filter {}
+        defines             "BT_THREADSAFE=1"
+end
+
 -- String pooling is causing build errors in VS2019, don't feel like looking into it, so disabling.
 --    filter { "system:windows", "configurations:Release" }
 --        buildoptions        { "\\GF" } -- /GF -> Enable String Pooling 
@@ -127,6 +137,11 @@ project "LinearMath"
         optimize            "Full"
         vectorextensions    "SSE2"
 
+if PremakeConfig_UseBulletMT == true then
+    filter {}
+        defines             "BT_THREADSAFE=1"
+end
+
 -- String pooling is causing build errors in VS2019, don't feel like looking into it, so disabling.
 --    filter { "system:windows", "configurations:Release" }
 --        buildoptions        { "\\GF" } -- /GF -> Enable String Pooling 
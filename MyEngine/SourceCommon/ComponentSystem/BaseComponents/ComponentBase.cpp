@@ -10,8 +10,10 @@
 #include "MyEnginePCH.h"
 
 #include "ComponentBase.h"
+#include "ComponentVariableImportPlan.h"
 #include "ComponentSystem/Core/ComponentSystemManager.h"
 #include "ComponentSystem/Core/GameObject.h"
+#include "ComponentSystem/Core/SceneArena.h"
 #include "Core/EngineComponentTypeManager.h"
 #include "Core/EngineCore.h"
 
@@ -69,6 +71,9 @@ ComponentBase::ComponentBase(EngineCore* pEngineCore, ComponentSystemManager* pC
 , m_Type(-1)
 , m_ID(0)
 , m_EnabledState( EnabledState_Enabled )
+, m_TypeMask( 0 )
+, m_TypeMaskVersion( 0 )
+, m_ClassTypeID( ComponentTypeID_None )
 {
     ClassnameSanityCheck();
 
@@ -104,7 +109,7 @@ ComponentBase::~ComponentBase()
 
     // Let others know we were deleted.
     NotifyOthersThisWasDeleted();
-    MyAssert( m_pOnDeleteCallbacks.GetHead() == 0 );
+    MyAssert( m_OnDeleteObservers.GetCount() == 0 );
 
     // if it's in a list, remove it.
     if( this->Prev != 0 )
@@ -113,6 +118,24 @@ ComponentBase::~ComponentBase()
 //    ClearAllVariables_Base( GetComponentVariableList() );
 }
 
+void ComponentBase::operator delete(void* pMemory, size_t size)
+{
+    if( SceneArena::FreeFromAnyArena( pMemory, size ) == false )
+        ::operator delete( pMemory );
+}
+
+void ComponentBase::operator delete(void* pMemory, void* pPlace)
+{
+    // Only called if the constructor throws, the arena block belongs to whoever did the placement new.
+}
+
+#if MYFW_USE_MEMORY_TRACKER
+void ComponentBase::operator delete(void* pMemory, char* file, unsigned long line)
+{
+    ::operator delete( pMemory, file, line );
+}
+#endif
+
 void ComponentBase::Reset()
 {
 #if MYFW_USING_WX
@@ -332,6 +355,14 @@ const char* ComponentBase::GetTypeName()
     return m_pComponentSystemManager->GetComponentTypeManager()->GetTypeName( m_Type );
 }
 
+void ComponentBase::UpdateTypeMask()
+{
+    // Can't be done in the constructor, IsA() and GetClassname() aren't the most derived versions yet.
+    m_ClassTypeID = ComponentTypeIDRegistry::GetID( GetClassname() );
+    m_TypeMask = ComponentTypeIDRegistry::BuildMask( this );
+    m_TypeMaskVersion = ComponentTypeIDRegistry::GetVersion();
+}
+
 SceneInfo* ComponentBase::GetSceneInfo()
 {
     return m_pComponentSystemManager->GetSceneInfo( m_SceneIDLoadedFrom );
@@ -341,61 +372,34 @@ void ComponentBase::RegisterOnDeleteCallback(void* pObj, ComponentDeletedCallbac
 {
     MyAssert( pCallback != 0 );
 
-    // Make sure the same callback isn't being registered.
-    for( CPPListNode* pNode = m_pOnDeleteCallbacks.GetHead(); pNode; pNode = pNode->GetNext() )
-    {
-        ComponentDeletedCallbackStruct* pCallbackStruct = (ComponentDeletedCallbackStruct*)pNode;
-        if( pCallbackStruct->pObj == pObj && pCallbackStruct->pFunc == pCallback )
-            return;
-    }
-
-    // TODO: Pool callback structures.
-    ComponentDeletedCallbackStruct* pCallbackStruct = MyNew ComponentDeletedCallbackStruct;
-    pCallbackStruct->pObj = pObj;
-    pCallbackStruct->pFunc = pCallback;
-
-    m_pOnDeleteCallbacks.AddTail( pCallbackStruct );
+    // Registering the same callback twice is ignored.
+    m_OnDeleteObservers.Subscribe( pObj, (ObserverFunc*)pCallback );
 }
 
 void ComponentBase::UnregisterOnDeleteCallback(void* pObj, ComponentDeletedCallbackFunc* pCallback)
 {
-    for( CPPListNode* pNode = m_pOnDeleteCallbacks.GetHead(); pNode; pNode = pNode->GetNext() )
-    {
-        ComponentDeletedCallbackStruct* pCallbackStruct = (ComponentDeletedCallbackStruct*)pNode;
-        if( pCallbackStruct->pObj == pObj && pCallbackStruct->pFunc == pCallback )
-        {
-            pCallbackStruct->Remove();
-            delete pCallbackStruct;
-            return;
-        }
-    }
+    m_OnDeleteObservers.Unsubscribe( pObj, (ObserverFunc*)pCallback );
 }
 
 void ComponentBase::NotifyOthersThisWasDeleted()
 {
-    for( CPPListNode* pNode = m_pOnDeleteCallbacks.GetHead(); pNode; )
-    {
-        CPPListNode* pNextNode = pNode->GetNext();
-
-        ComponentDeletedCallbackStruct* pCallbackStruct = (ComponentDeletedCallbackStruct*)pNode;
-
-        // Remove the callback struct from the list before calling the function
-        //     since the callback function might try to unregister (and delete) the callback struct.
-        pCallbackStruct->Remove();
+    void* pObj;
+    ObserverFunc* pFunc;
 
+    // Each observer is unsubscribed before it's called,
+    //     since the callback function might try to unregister itself or others.
+    while( m_OnDeleteObservers.PopFirst( &pObj, &pFunc ) )
+    {
         // Call the onComponentDeleted callback function.
-        pCallbackStruct->pFunc( pCallbackStruct->pObj, this );
-
-        // Delete the struct.
-        delete pCallbackStruct;
-
-        pNode = pNextNode;
+        ((ComponentDeletedCallbackFunc*)pFunc)( pObj, this );
     }
 }
 
 // Static method.
 void ComponentBase::ClearAllVariables_Base(TCPPListHead<ComponentVariable*>* pComponentVariableList)
 {
+    ComponentVariableImportPlan::ReleasePlan( pComponentVariableList );
+
     while( CPPListNode* pNode = pComponentVariableList->GetHead() )
     {
         ComponentVariable* pVariable = (ComponentVariable*)pNode;
@@ -1850,270 +1854,268 @@ void ComponentBase::ExportVariablesToJSON(cJSON* jComponent, void* pObject, TCPP
     }
 }
 
-void ComponentBase::ImportVariablesFromJSON(cJSON* jComponent, void* pObject, TCPPListHead<ComponentVariable*>* pList, ComponentBase* pObjectAsComponent, SceneID sceneIDLoadedFrom, const char* singleLabelToImport)
+// Same rules as cJSONExt_Get*Array, but takes the array member directly. Arrays larger than the variable are ignored.
+template <class Type> static void GetArrayValuesFromJSON(cJSON* jArray, Type* pValues, int numElements)
 {
-    // TODO: Remove this once GetComponentVariableList() is pure virtual.
-    if( pList == 0 )
+    if( cJSON_GetArraySize( jArray ) > numElements )
         return;
 
+    int i = 0;
+    for( cJSON* jElement = jArray->child; jElement; jElement = jElement->next, i++ )
+        pValues[i] = (Type)jElement->valuedouble;
+}
+
+static void ImportVariableFromJSON(cJSON* jVariable, void* pObject, ComponentVariableImportPlan* pPlan, const ComponentVariableImportPlan::VariableEntry* pEntry, ComponentBase* pObjectAsComponent, SceneID sceneIDLoadedFrom)
+{
     ComponentSystemManager* pComponentSystemManager = g_pComponentSystemManager;
+    ComponentVariable* pVar = pEntry->m_pVar;
+    void* pVariable = (char*)pObject + pVar->m_Offset;
 
-    for( CPPListNode* pNode = pList->GetHead(); pNode; pNode = pNode->GetNext() )
+    switch( pVar->m_Type )
     {
-        ComponentVariable* pVar = (ComponentVariable*)pNode;
-        MyAssert( pVar );
-
-        if( pVar->m_SaveLoad == false )
-            continue;
+    case ComponentVariableType::Int:
+        *(int*)pVariable = jVariable->valueint;
+        break;
 
-        // If we are looking for a single label to import, check if this is it.
-        if( singleLabelToImport != 0 && strcmp( singleLabelToImport, pVar->m_Label ) != 0 )
-            continue;
+    case ComponentVariableType::Enum:
+        {
+            // Try to load the value as a string.
+            if( jVariable->valuestring != 0 )
+            {
+                pPlan->FindEnumValue( pEntry, jVariable->valuestring, (int*)pVariable );
+            }
+            else
+            {
+                // If a string wasn't found, then treat the value as an int.
+                *(int*)pVariable = jVariable->valueint;
+            }
+        }
+        break;
 
-        //if( pVar->m_Offset != -1 )
+    case ComponentVariableType::Flags:
         {
-            switch( pVar->m_Type )
+            // Load each array value as a string.
+            int arraysize = cJSON_GetArraySize( jVariable );
+            if( arraysize == 0 )
             {
-            case ComponentVariableType::Int:
-                cJSONExt_GetInt( jComponent, pVar->m_Label, (int*)((char*)pObject + pVar->m_Offset) );
-                break;
+                // TODO: Remove eventually.
+                // Support for old scene files that didn't store visibility flags in arrays.
+                // Just load valueint as a single flag.
+                *(unsigned int*)pVariable = 1<<(jVariable->valueint-1);
+            }
+            else
+            {
+                unsigned int flags = 0;
 
-            case ComponentVariableType::Enum:
+                for( cJSON* jFlag = jVariable->child; jFlag; jFlag = jFlag->next )
                 {
-                    cJSON* obj = cJSON_GetObjectItem( jComponent, pVar->m_Label );
-
-                    if( obj )
+                    if( jFlag->valuestring != 0 )
                     {
-                        // Try to load the value as a string.
-                        if( obj->valuestring != 0 )
+                        int flagIndex;
+                        bool found = pPlan->FindEnumValue( pEntry, jFlag->valuestring, &flagIndex );
+                        if( found )
+                            flags |= 1<<flagIndex;
+
+                        // If the flag string wasn't found, popup a warning.
+#if MYFW_USING_WX
+                        if( found == false )
                         {
-                            for( int i=0; i<pVar->m_NumEnumStrings; i++ )
+                            static bool messageboxshown = false;
+                            if( messageboxshown == false )
                             {
-                                if( strcmp( pVar->m_ppEnumStrings[i], obj->valuestring ) == 0 )
-                                {
-                                    *(int*)((char*)pObject + pVar->m_Offset) = i;
-                                    break;
-                                }
+                                messageboxshown = true;
+                                wxMessageBox( "Warning: At least one GameObject Flag string wasn't found,\nsaving the scene will discard old flags", "Warning" );
                             }
                         }
-                        else
-                        {
-                            // If a string wasn't found, then treat the value as an int.
-                            *(int*)((char*)pObject + pVar->m_Offset) = obj->valueint;
-                        }
+#endif //MYFW_USING_WX
                     }
                 }
-                break;
 
-            case ComponentVariableType::Flags:
-                {
-                    cJSON* jFlagsArray = cJSON_GetObjectItem( jComponent, pVar->m_Label );
+                *(unsigned int*)pVariable = flags;
+            }
+        }
+        break;
 
-                    // Load each array value as a string.
-                    if( jFlagsArray )
-                    {
-                        int arraysize = cJSON_GetArraySize( jFlagsArray );
-                        if( arraysize == 0 )
-                        {
-                            // TODO: Remove eventually.
-                            // Support for old scene files that didn't store visibility flags in arrays.
-                            // Just load valueint as a single flag.
-                            *(unsigned int*)((char*)pObject + pVar->m_Offset) = 1<<(jFlagsArray->valueint-1);
-                        }
-                        else
-                        {
-                            unsigned int flags = 0;
+    case ComponentVariableType::UnsignedInt:
+        *(unsigned int*)pVariable = (unsigned int)jVariable->valuedouble;
+        break;
 
-                            for( int i=0; i<arraysize; i++ )
-                            {
-                                cJSON* jFlag = cJSON_GetArrayItem( jFlagsArray, i );
+    //ComponentVariableType::Char,
+    //ComponentVariableType::UnsignedChar,
 
-                                if( jFlag->valuestring != 0 )
-                                {
-                                    bool found = false;
-                                    for( int i=0; i<pVar->m_NumEnumStrings; i++ )
-                                    {
-                                        if( strcmp( pVar->m_ppEnumStrings[i], jFlag->valuestring ) == 0 )
-                                        {
-                                            flags |= 1<<i;
-                                            found = true;
-                                            break;
-                                        }
-                                    }
-
-                                    // If the flag string wasn't found, popup a warning.
-#if MYFW_USING_WX
-                                    if( found == false )
-                                    {
-                                        static bool messageboxshown = false;
-                                        if( messageboxshown == false )
-                                        {
-                                            messageboxshown = true;
-                                            wxMessageBox( "Warning: At least one GameObject Flag string wasn't found,\nsaving the scene will discard old flags", "Warning" );
-                                        }
-                                    }
-#endif //MYFW_USING_WX
-                                }
-                            }
+    case ComponentVariableType::Bool:
+        *(bool*)pVariable = jVariable->valueint > 0 ? true : false;
+        break;
 
-                            *(unsigned int*)((char*)pObject + pVar->m_Offset) = flags;
-                        }
-                    }
-                }
-                break;
+    case ComponentVariableType::Float:
+        *(float*)pVariable = (float)jVariable->valuedouble;
+        break;
 
-            case ComponentVariableType::UnsignedInt:
-                cJSONExt_GetUnsignedInt( jComponent, pVar->m_Label, (unsigned int*)((char*)pObject + pVar->m_Offset) );
-                break;
+    //ComponentVariableType::Double,
+    //ComponentVariableType::ColorFloat,
 
-            //ComponentVariableType::Char,
-            //ComponentVariableType::UnsignedChar,
+    case ComponentVariableType::ColorByte:
+        GetArrayValuesFromJSON( jVariable, (unsigned char*)pVariable, 4 );
+        break;
 
-            case ComponentVariableType::Bool:
-                cJSONExt_GetBool( jComponent, pVar->m_Label, (bool*)((char*)pObject + pVar->m_Offset) );
-                break;
+    case ComponentVariableType::Vector2:
+        GetArrayValuesFromJSON( jVariable, (float*)pVariable, 2 );
+        break;
 
-            case ComponentVariableType::Float:
-                cJSONExt_GetFloat( jComponent, pVar->m_Label, (float*)((char*)pObject + pVar->m_Offset) );
-                break;
+    case ComponentVariableType::Vector3:
+        GetArrayValuesFromJSON( jVariable, (float*)pVariable, 3 );
+        break;
 
-            //ComponentVariableType::Double,
-            //ComponentVariableType::ColorFloat,
+    case ComponentVariableType::Vector2Int:
+        GetArrayValuesFromJSON( jVariable, (int*)pVariable, 2 );
+        break;
 
-            case ComponentVariableType::ColorByte:
-                cJSONExt_GetUnsignedCharArray( jComponent, pVar->m_Label, (unsigned char*)((char*)pObject + pVar->m_Offset), 4 );
-                break;
+    case ComponentVariableType::Vector3Int:
+        GetArrayValuesFromJSON( jVariable, (int*)pVariable, 3 );
+        break;
 
-            case ComponentVariableType::Vector2:
-                cJSONExt_GetFloatArray( jComponent, pVar->m_Label, (float*)((char*)pObject + pVar->m_Offset), 2 );
-                break;
+    case ComponentVariableType::CharArray:
+        if( jVariable->valuestring )
+        {
+            char* buffer = (char*)pVariable;
+            strncpy( buffer, jVariable->valuestring, pVar->m_TextLimit-1 );
+            buffer[pVar->m_TextLimit-1] = '\0';
+        }
+        break;
 
-            case ComponentVariableType::Vector3:
-                cJSONExt_GetFloatArray( jComponent, pVar->m_Label, (float*)((char*)pObject + pVar->m_Offset), 3 );
-                break;
+    case ComponentVariableType::String:
+        if( jVariable->valuestring )
+        {
+            std::string* str = (std::string*)pVariable;
+            *str = jVariable->valuestring;
+        }
+        break;
 
-            case ComponentVariableType::Vector2Int:
-                cJSONExt_GetIntArray( jComponent, pVar->m_Label, (int*)((char*)pObject + pVar->m_Offset), 2 );
-                break;
+    case ComponentVariableType::GameObjectPtr:
+        {
+            unsigned int parentid = (unsigned int)jVariable->valuedouble;
+            if( parentid != 0 )
+            {
+                GameObject* pParentGameObject = pComponentSystemManager->FindGameObjectByID( sceneIDLoadedFrom, parentid );
+                *(GameObject**)pVariable = pParentGameObject;
+            }
+        }
+        break;
 
-            case ComponentVariableType::Vector3Int:
-                cJSONExt_GetIntArray( jComponent, pVar->m_Label, (int*)((char*)pObject + pVar->m_Offset), 3 );
-                break;
+    case ComponentVariableType::ComponentPtr:
+        {
+            ComponentBase* pComponent = pComponentSystemManager->FindComponentByJSONRef( jVariable, sceneIDLoadedFrom );
+            *(ComponentBase**)pVariable = pComponent;
+        }
+        break;
 
-            case ComponentVariableType::CharArray:
-                cJSONExt_GetString( jComponent, pVar->m_Label, (char*)pObject + pVar->m_Offset, pVar->m_TextLimit );
-                break;
+    case ComponentVariableType::FilePtr:
+        {
+            // Find the file, load if needed.
+            FileManager* pFileManager = pComponentSystemManager->GetEngineCore()->GetManagers()->GetFileManager();
+            MyFileObject* pFile = pFileManager->FindFileByName( jVariable->valuestring );
+            if( pFile == nullptr )
+            {
+                MyFileInfo* pFileInfo = pComponentSystemManager->LoadDataFile( jVariable->valuestring, sceneIDLoadedFrom, nullptr, false );
+                pFile = pFileInfo->GetFile();
+            }
 
-            case ComponentVariableType::String:
-                {
-                    cJSON* obj = cJSON_GetObjectItem( jComponent, pVar->m_Label );
-                    if( obj )
-                    {
-                        std::string* str = (std::string*)((char*)pObject + pVar->m_Offset);
-                        *str = obj->valuestring;
-                    }
-                }
-                break;
+            // Assign the file to the component.
+            if( pFile != nullptr )
+            {
+                MyFileObject** ppFile = (MyFileObject**)pVariable;
+                pFile->AddRef();
+                SAFE_RELEASE( *ppFile );
+                *ppFile = pFile;
+            }
+        }
+        break;
 
-            case ComponentVariableType::GameObjectPtr:
-                {
-                    unsigned int parentid = 0;
-                    cJSONExt_GetUnsignedInt( jComponent, pVar->m_Label, &parentid );
-                    if( parentid != 0 )
-                    {
-                        GameObject* pParentGameObject = pComponentSystemManager->FindGameObjectByID( sceneIDLoadedFrom, parentid );
-                        *(GameObject**)((char*)pObject + pVar->m_Offset) = pParentGameObject;
-                    }
-                }
-                break;
+    case ComponentVariableType::MaterialPtr:
+    case ComponentVariableType::SoundCuePtr:
+        MyAssert( false );
+        break;
 
-            case ComponentVariableType::ComponentPtr:
-                {
-                    cJSON* jComponentRef = cJSON_GetObjectItem( jComponent, pVar->m_Label );
-                    if( jComponentRef )
-                    {
-                        ComponentBase* pComponent = pComponentSystemManager->FindComponentByJSONRef( jComponentRef, sceneIDLoadedFrom );
-                        *(ComponentBase**)((char*)pObject + pVar->m_Offset) = pComponent;
-                    }
-                }
-                break;
+    case ComponentVariableType::TexturePtr:
+        {
+            // Find the texture, load if needed.
+            TextureManager* pTextureManager = pComponentSystemManager->GetEngineCore()->GetManagers()->GetTextureManager();
+            TextureDefinition* pTexture = pTextureManager->FindTexture( jVariable->valuestring );
+            if( pTexture == nullptr )
+            {
+                MyFileInfo* pFileInfo = pComponentSystemManager->LoadDataFile( jVariable->valuestring, sceneIDLoadedFrom, nullptr, false );
+                pTexture = pFileInfo->GetTexture();
+            }
 
-            case ComponentVariableType::FilePtr:
-                {
-                    cJSON* jFileName = cJSON_GetObjectItem( jComponent, pVar->m_Label );
+            // Assign the texture to the component.
+            if( pTexture != nullptr )
+            {
+                TextureDefinition** ppTextureDef = (TextureDefinition**)pVariable;
+                pTexture->AddRef();
+                SAFE_RELEASE( *ppTextureDef );
+                *ppTextureDef = pTexture;
+            }
+        }
+        break;
 
-                    if( jFileName )
-                    {
-                        // Find the file, load if needed.
-                        FileManager* pFileManager = pComponentSystemManager->GetEngineCore()->GetManagers()->GetFileManager();
-                        MyFileObject* pFile = pFileManager->FindFileByName( jFileName->valuestring );
-                        if( pFile == nullptr )
-                        {
-                            MyFileInfo* pFileInfo = pComponentSystemManager->LoadDataFile( jFileName->valuestring, sceneIDLoadedFrom, nullptr, false );
-                            pFile = pFileInfo->GetFile();
-                        }
+    case ComponentVariableType::PointerIndirect:
+        MyAssert( pVar->m_pSetPointerDescCallBackFunc );
+        if( pVar->m_pSetPointerDescCallBackFunc )
+        {
+            (pObjectAsComponent->*pVar->m_pSetPointerDescCallBackFunc)( pVar, jVariable->valuestring );
+        }
+        break;
 
-                        // Assign the file to the component.
-                        if( pFile != nullptr )
-                        {
-                            MyFileObject** ppFile = (MyFileObject**)((char*)pObject + pVar->m_Offset);
-                            pFile->AddRef();
-                            SAFE_RELEASE( *ppFile );
-                            *ppFile = pFile;
-                        }
-                    }
-                }
-                break;
+    case ComponentVariableType::NumTypes:
+    default:
+        MyAssert( false );
+        break;
+    }
+}
 
-            case ComponentVariableType::MaterialPtr:
-            case ComponentVariableType::SoundCuePtr:
-                MyAssert( false );
-                break;
+void ComponentBase::ImportVariablesFromJSON(cJSON* jComponent, void* pObject, TCPPListHead<ComponentVariable*>* pList, ComponentBase* pObjectAsComponent, SceneID sceneIDLoadedFrom, const char* singleLabelToImport)
+{
+    // TODO: Remove this once GetComponentVariableList() is pure virtual.
+    if( pList == 0 )
+        return;
 
-            case ComponentVariableType::TexturePtr:
-                {
-                    cJSON* jTextureName = cJSON_GetObjectItem( jComponent, pVar->m_Label );
+    ComponentVariableImportPlan* pPlan = ComponentVariableImportPlan::GetPlan( pList );
+    unsigned int numVariables = pPlan->GetNumVariables();
 
-                    if( jTextureName )
-                    {
-                        // Find the texture, load if needed.
-                        TextureManager* pTextureManager = pComponentSystemManager->GetEngineCore()->GetManagers()->GetTextureManager();
-                        TextureDefinition* pTexture = pTextureManager->FindTexture( jTextureName->valuestring );
-                        if( pTexture == nullptr )
-                        {
-                            MyFileInfo* pFileInfo = pComponentSystemManager->LoadDataFile( jTextureName->valuestring, sceneIDLoadedFrom, nullptr, false );
-                            pTexture = pFileInfo->GetTexture();
-                        }
+    // If we are looking for a single label to import, only import variables with exactly that label.
+    if( singleLabelToImport != 0 )
+    {
+        for( unsigned int i=0; i<numVariables; i++ )
+        {
+            const ComponentVariableImportPlan::VariableEntry* pEntry = pPlan->GetVariable( i );
+            if( strcmp( singleLabelToImport, pEntry->m_pVar->m_Label ) != 0 )
+                continue;
 
-                        // Assign the texture to the component.
-                        if( pTexture != nullptr )
-                        {
-                            TextureDefinition** ppTextureDef = (TextureDefinition**)((char*)pObject + pVar->m_Offset);
-                            pTexture->AddRef();
-                            SAFE_RELEASE( *ppTextureDef );
-                            *ppTextureDef = pTexture;
-                        }
-                    }
-                }
-                break;
+            cJSON* jVariable = cJSON_GetObjectItem( jComponent, pEntry->m_pVar->m_Label );
+            if( jVariable )
+                ImportVariableFromJSON( jVariable, pObject, pPlan, pEntry, pObjectAsComponent, sceneIDLoadedFrom );
+        }
 
-            case ComponentVariableType::PointerIndirect:
-                MyAssert( pVar->m_pSetPointerDescCallBackFunc );
-                if( pVar->m_pSetPointerDescCallBackFunc )
-                {
-                    cJSON* obj = cJSON_GetObjectItem( jComponent, pVar->m_Label );
-                    if( obj )
-                        (pObjectAsComponent->*pVar->m_pSetPointerDescCallBackFunc)( pVar, obj->valuestring );
-                }
-                break;
+        return;
+    }
 
-            case ComponentVariableType::NumTypes:
-            default:
-                MyAssert( false );
-                break;
-            }
-        }
+    if( numVariables == 0 )
+        return;
+
+    // Walk the JSON members once to find each variable's member, then import them in list order,
+    //     since some variables rely on ones registered before them being set.
+    MyStackAllocator::MyStackPointer stackpointer;
+    cJSON** ppMembers = (cJSON**)g_pEngineCore->GetSingleFrameMemoryStack()->AllocateBlock( sizeof(cJSON*)*numVariables, &stackpointer );
+
+    pPlan->FindJSONMembers( jComponent, ppMembers );
+
+    for( unsigned int i=0; i<numVariables; i++ )
+    {
+        if( ppMembers[i] )
+            ImportVariableFromJSON( ppMembers[i], pObject, pPlan, pPlan->GetVariable( i ), pObjectAsComponent, sceneIDLoadedFrom );
     }
+
+    g_pEngineCore->GetSingleFrameMemoryStack()->RewindStack( stackpointer );
 }
 
 #if MYFW_USING_WX
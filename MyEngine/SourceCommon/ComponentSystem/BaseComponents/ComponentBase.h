@@ -12,6 +12,8 @@
 
 #include "ComponentVariable.h"
 #include "ComponentVariableValue.h"
+#include "ComponentSystem/Core/ComponentTypeIDs.h"
+#include "ComponentSystem/Core/ObserverList.h"
 
 class CommandStack;
 class ComponentBase;
@@ -34,11 +36,6 @@ enum BaseComponentTypes
 class ComponentVariable;
 
 typedef void ComponentDeletedCallbackFunc(void* pObjectPtr, ComponentBase* pComponent);
-struct ComponentDeletedCallbackStruct : CPPListNode
-{
-    void* pObj;
-    ComponentDeletedCallbackFunc* pFunc;
-};
 
 class ComponentBase : public ComponentVariableCallbackInterface
 {
@@ -64,12 +61,18 @@ protected:
     int m_Type;
     GameObject* m_pGameObject;
 
-    CPPListHead m_pOnDeleteCallbacks;
+    // Built on first use from IsA(), rebuilt if more classnames were registered since.
+    ComponentTypeMask m_TypeMask;
+    unsigned int m_TypeMaskVersion;
+    int m_ClassTypeID;
+
+    ObserverList m_OnDeleteObservers;
 
     bool m_CallbacksRegistered;
 
 protected:
     void NotifyOthersThisWasDeleted();
+    void UpdateTypeMask();
 
     virtual void RegisterCallbacks() {}
     virtual void UnregisterCallbacks() {}
@@ -79,6 +82,15 @@ public:
     virtual ~ComponentBase();
     SetClassnameBase( "BaseComponent" ); // Only first 8 character count.
 
+    // Components can be allocated from a scene's arena, this returns the memory to wherever it came from.
+    static void operator delete(void* pMemory, size_t size);
+
+    // Declaring the above hides the global placement deletes, these match the placement news used to create components.
+    static void operator delete(void* pMemory, void* pPlace);
+#if MYFW_USE_MEMORY_TRACKER
+    static void operator delete(void* pMemory, char* file, unsigned long line);
+#endif
+
 #if MYFW_USING_LUA
     static void LuaRegister(lua_State* luastate);
 #endif //MYFW_USING_LUA
@@ -90,6 +102,8 @@ public:
 
     virtual void Reset();
     virtual void CopyFromSameType_Dangerous(ComponentBase* pObject) { *this = (ComponentBase&)*pObject; }
+    // Used when spawning from a prefab's prototype components, which shouldn't be referenced by the copy.
+    virtual void CopyFromPrototype_Dangerous(ComponentBase* pObject) { CopyFromSameType_Dangerous( pObject ); }
     ComponentBase& operator=(const ComponentBase& other);
 
 public:
@@ -105,6 +119,11 @@ public:
     BaseComponentTypes GetBaseType() { return m_BaseType; }
     int GetType() { return m_Type; }
     const char* GetTypeName();
+
+    // Integer versions of IsA(), see ComponentTypeIDs.h.
+    ComponentTypeMask GetTypeMask() { if( m_TypeMaskVersion != ComponentTypeIDRegistry::GetVersion() ) UpdateTypeMask(); return m_TypeMask; }
+    int GetClassTypeID() { if( m_TypeMaskVersion != ComponentTypeIDRegistry::GetVersion() ) UpdateTypeMask(); return m_ClassTypeID; }
+    bool IsType(int typeID) { return (GetTypeMask() & ComponentTypeIDRegistry::GetBit( typeID )) != 0; }
     GameObject* GetGameObject() { return m_pGameObject; }
     bool IsEnabled() { return m_EnabledState == EnabledState_Enabled; }
     EnabledState GetEnabledState() { return m_EnabledState; }
@@ -15,6 +15,7 @@
 #include "ComponentSystem/BaseComponents/ComponentTransform.h"
 #include "ComponentSystem/Core/EngineFileManager.h"
 #include "ComponentSystem/Core/GameObject.h"
+#include "ComponentSystem/Core/RenderTargetPool.h"
 #include "ComponentSystem/FrameworkComponents/ComponentCameraShadow.h"
 #include "ComponentSystem/FrameworkComponents/ComponentPostEffect.h"
 #include "Core/EngineCore.h"
@@ -30,6 +31,8 @@
 bool ComponentCamera::m_PanelWatchBlockVisible = true;
 #endif
 
+ComponentCamera::DeferredLightStats ComponentCamera::m_DeferredLightStats = { 0, 0, 0, 0 };
+
 // 32 layers strings since ComponentBase::ExportVariablesToJSON -> case ComponentVariableType::Flags is looking for 32
 const char* g_pVisibilityLayerStrings[32] = //g_NumberOfVisibilityLayers] =
 {
@@ -81,12 +84,13 @@ ComponentCamera::ComponentCamera(EngineCore* pEngineCore, ComponentSystemManager
 
     m_pComponentTransform = 0;
     m_DeferredGBufferVisible = false;
+    m_pDeferredShadowCamera = 0;
 }
 
 ComponentCamera::~ComponentCamera()
 {
-    SAFE_RELEASE( m_pPostEffectFBOs[0] );
-    SAFE_RELEASE( m_pPostEffectFBOs[1] );
+    // Post effect targets are only borrowed from the RenderTargetPool while drawing.
+    MyAssert( m_pPostEffectFBOs[0] == 0 && m_pPostEffectFBOs[1] == 0 );
 
     MYFW_COMPONENT_VARIABLE_LIST_DESTRUCTOR(); //_VARIABLE_LIST
 
@@ -125,6 +129,11 @@ void ComponentCamera::RegisterVariables(TCPPListHead<ComponentVariable*>* pList,
 
     pVar = AddVar( pList, "Deferred", ComponentVariableType::Bool, MyOffsetOf( pThis, &pThis->m_Deferred ), true, true, 0, (CVarFunc_ValueChanged)&ComponentCamera::OnValueChanged, 0, 0 );
 
+    pVar = AddVar( pList, "DeferredLightMinSize", ComponentVariableType::Float, MyOffsetOf( pThis, &pThis->m_DeferredLightMinScreenSize ), true, true, "Min Light Size", (CVarFunc_ValueChanged)&ComponentCamera::OnValueChanged, 0, 0 );
+#if MYFW_USING_WX
+    pVar->SetEditorLimits( 0, 1 );
+#endif
+
     pVar = AddVar( pList, "Ortho", ComponentVariableType::Bool, MyOffsetOf( pThis, &pThis->m_Orthographic ), true, true, 0, (CVarFunc_ValueChanged)&ComponentCamera::OnValueChanged, 0, 0 );
 
     pVar = AddVar( pList, "DesiredWidth", ComponentVariableType::Float, MyOffsetOf( pThis, &pThis->m_DesiredWidth ), true, true, 0, (CVarFunc_ValueChanged)&ComponentCamera::OnValueChanged, 0, 0 );
@@ -266,6 +275,7 @@ void ComponentCamera::Reset()
 
     // Deferred lighting variables.
     m_Deferred = false;
+    m_DeferredLightMinScreenSize = 0.01f;
     m_pGBuffer = 0;
 
     m_pDeferredShaderFile_AmbientDirectional = 0;
@@ -315,6 +325,7 @@ ComponentCamera& ComponentCamera::operator=(const ComponentCamera& other)
 
     this->m_Orthographic = other.m_Orthographic;
     this->m_Deferred = other.m_Deferred;
+    this->m_DeferredLightMinScreenSize = other.m_DeferredLightMinScreenSize;
 
     this->m_ClearColorBuffer = other.m_ClearColorBuffer;
     this->m_ClearDepthBuffer = other.m_ClearDepthBuffer;
@@ -474,9 +485,10 @@ ComponentPostEffect* ComponentCamera::GetNextPostEffect(ComponentPostEffect* pLa
 
     while( pComponent != 0 )
     {
-        pPostEffect = pComponent->IsA( "PostEffectComponent" ) ? (ComponentPostEffect*)pComponent : 0;
+        pPostEffect = pComponent->IsType( ComponentTypeID_PostEffect ) ? (ComponentPostEffect*)pComponent : 0;
         
-        if( pPostEffect && pPostEffect->m_pMaterial != 0 && pPostEffect->IsEnabled() )
+        // Skip disabled effects and effects without a shader, so they don't cost a pass or a render target.
+        if( pPostEffect && pPostEffect->m_pMaterial != 0 && pPostEffect->m_pMaterial->GetShader() != 0 && pPostEffect->IsEnabled() )
             return pPostEffect; // if we found a valid initialized post effect, return it.
         else
             pComponent = m_pGameObject->GetNextComponentOfBaseType( pComponent );
@@ -515,25 +527,15 @@ void ComponentCamera::OnDrawFrame()
     // Find the first actual ComponentPostEffect.
     ComponentPostEffect* pPostEffect = GetNextPostEffect( 0 );
 
+    // Post effect targets come from a shared pool, so they're only allocated when the viewport size changes.
+    RenderTargetPool* pRenderTargetPool = m_pComponentSystemManager->m_pRenderTargetPool;
+
     // First pass: Render the main scene... into a post effect FBO if a ComponentPostEffect was found.
     {
         if( pPostEffect )
         {
-            TextureManager* pTextureManager = m_pEngineCore->GetManagers()->GetTextureManager();
-
             // If a post effect was found, render to an FBO.
-            if( m_pPostEffectFBOs[0] == 0 )
-            {
-                m_pPostEffectFBOs[0] = pTextureManager->CreateFBO( m_Viewport.GetWidth(), m_Viewport.GetHeight(), MyRE::MinFilter_Nearest, MyRE::MagFilter_Nearest, FBODefinition::FBOColorFormat_RGBA_UByte, 32, false );
-#if MYFW_EDITOR
-                m_pPostEffectFBOs[0]->MemoryPanel_Hide();
-#endif
-            }
-            else
-            {
-                pTextureManager->ReSetupFBO( m_pPostEffectFBOs[0], m_Viewport.GetWidth(), m_Viewport.GetHeight(), MyRE::MinFilter_Nearest, MyRE::MagFilter_Nearest, FBODefinition::FBOColorFormat_RGBA_UByte, 32, false );
-            }
-
+            m_pPostEffectFBOs[0] = pRenderTargetPool->Acquire( m_Viewport.GetWidth(), m_Viewport.GetHeight(), FBODefinition::FBOColorFormat_RGBA_UByte, 32 );
             m_pPostEffectFBOs[0]->Bind( false );
 
             MyViewport viewport( 0, 0, m_Viewport.GetWidth(), m_Viewport.GetHeight() );
@@ -556,20 +558,10 @@ void ComponentCamera::OnDrawFrame()
 
         if( pNextPostEffect )
         {
-            TextureManager* pTextureManager = m_pEngineCore->GetManagers()->GetTextureManager();
-
             // If there is a next effect, render into the next unused FBO.
+            // The second target is only needed for chains of 2 or more effects.
             if( m_pPostEffectFBOs[!fboindex] == 0 )
-            {
-                m_pPostEffectFBOs[!fboindex] = pTextureManager->CreateFBO( m_Viewport.GetWidth(), m_Viewport.GetHeight(), MyRE::MinFilter_Nearest, MyRE::MagFilter_Nearest, FBODefinition::FBOColorFormat_RGBA_UByte, 32, false );
-#if MYFW_EDITOR
-                m_pPostEffectFBOs[!fboindex]->MemoryPanel_Hide();
-#endif
-            }
-            else
-            {
-                pTextureManager->ReSetupFBO( m_pPostEffectFBOs[!fboindex], m_Viewport.GetWidth(), m_Viewport.GetHeight(), MyRE::MinFilter_Nearest, MyRE::MagFilter_Nearest, FBODefinition::FBOColorFormat_RGBA_UByte, 32, false );
-            }
+                m_pPostEffectFBOs[!fboindex] = pRenderTargetPool->Acquire( m_Viewport.GetWidth(), m_Viewport.GetHeight(), FBODefinition::FBOColorFormat_RGBA_UByte, 32 );
             m_pPostEffectFBOs[!fboindex]->Bind( false );
 
             MyViewport viewport( 0, 0, m_Viewport.GetWidth(), m_Viewport.GetHeight() );
@@ -594,6 +586,16 @@ void ComponentCamera::OnDrawFrame()
         pPostEffect = pNextPostEffect;
     }
 
+    // Return the targets to the pool, other cameras with the same viewport size will reuse them.
+    for( int i=0; i<2; i++ )
+    {
+        if( m_pPostEffectFBOs[i] )
+        {
+            pRenderTargetPool->Release( m_pPostEffectFBOs[i] );
+            m_pPostEffectFBOs[i] = 0;
+        }
+    }
+
     // Restore the FBO to what was set when we entered this method.
     if( startingFBO != g_GLStats.m_CurrentFramebuffer )
     {
@@ -775,6 +777,7 @@ void ComponentCamera::DrawScene()
         // Find nearest shadow casting light. TODO: handle this better.
         MyMatrix* pShadowVP = 0;
         TextureDefinition* pShadowTex = 0;
+        ComponentCameraShadow* pShadowCam = 0;
         if( g_ActiveShaderPass == ShaderPass_Main )
         {
             GameObject* pObject = g_pComponentSystemManager->FindGameObjectByName( "Shadow Light" );
@@ -783,7 +786,7 @@ void ComponentCamera::DrawScene()
                 ComponentBase* pComponent = pObject->GetFirstComponentOfBaseType( BaseComponentType_Camera );
                 if( pComponent )
                 {
-                    ComponentCameraShadow* pShadowCam = pComponent->IsA( "CameraShadowComponent" ) ? (ComponentCameraShadow*)pComponent : 0;
+                    pShadowCam = pComponent->IsType( ComponentTypeID_CameraShadow ) ? (ComponentCameraShadow*)pComponent : 0;
                     if( pShadowCam )
                     {
                         pShadowVP = pShadowCam->GetViewProjMatrix();
@@ -817,44 +820,85 @@ void ComponentCamera::DrawScene()
 
                 Vector3 worldPosition = m_pComponentTransform->GetWorldPosition();
 
+                m_pDeferredShadowCamera = pShadowCam;
+
                 if( pLight )
                     m_pDeferredQuadMesh->Draw( 0, 0, 0, &worldPosition, 0, &pLight, 1, pShadowVP, pShadowTex, 0, 0 );
                 else
                     m_pDeferredQuadMesh->Draw( 0, 0, 0, &worldPosition, 0, 0, 0, pShadowVP, pShadowTex, 0, 0 );
+
+                m_pDeferredShadowCamera = 0;
             }
 
-            // Disable depth write and depth test for point light spheres.
+            // Disable depth write for point light spheres, depth test is set per light below.
             g_pRenderer->SetDepthWriteEnabled( false );
-            g_pRenderer->SetDepthTestEnabled( false );
 
-            // Draw all the point lights in the scene, using a sphere for each.
+            // Draw the visible point lights in the scene, using a sphere for each.
             {
-                // Swap culling to draw backs of spheres for the rest of the lights.
-                g_pRenderer->SetCullMode( MyRE::CullMode_Front );
+                Vector3 worldPosition = m_pComponentTransform->GetWorldPosition();
+
+                // The near plane can clip a sphere's front faces before the camera is inside it, so pad the test.
+                float nearZ = m_Orthographic ? m_OrthoNearZ : m_PerspectiveNearZ;
 
+                // Cull lights against the frustum and by projected size, then sort the rest.
+                m_DeferredPointLights.clear();
                 for( CPPListNode* pNode = pLightManager->GetLightList()->GetHead(); pNode; pNode = pNode->GetNext() )
                 {
                     MyLight* pLight = static_cast<MyLight*>( pNode );
 
-                    if( pLight->m_LightType == LightType_Point )
+                    if( pLight->m_LightType != LightType_Point )
+                        continue;
+
+                    if( IsDeferredPointLightVisible( pLight, pMatProj, pMatView ) == false )
+                        continue;
+
+                    float radius = pLight->m_Attenuation.x;
+
+                    DeferredPointLight light;
+                    light.m_pLight = pLight;
+                    light.m_DistanceSquared = (pLight->m_Position - worldPosition).LengthSquared();
+                    light.m_CameraIsInside = light.m_DistanceSquared <= (radius + nearZ) * (radius + nearZ);
+                    m_DeferredPointLights.push_back( light );
+                }
+
+                std::sort( m_DeferredPointLights.begin(), m_DeferredPointLights.end() );
+
+                bool drawingFromInside = false;
+
+                // Draw front faces with depth testing for lights the camera is outside of, so lights behind walls are rejected.
+                g_pRenderer->SetDepthTestEnabled( true );
+                g_pRenderer->SetCullMode( MyRE::CullMode_Back );
+
+                for( unsigned int i=0; i<m_DeferredPointLights.size(); i++ )
+                {
+                    MyLight* pLight = m_DeferredPointLights[i].m_pLight;
+
+                    if( m_DeferredPointLights[i].m_CameraIsInside )
+                    {
+                        // Swap culling to draw backs of spheres with no depth test for the lights the camera is inside of.
+                        if( drawingFromInside == false )
+                        {
+                            drawingFromInside = true;
+                            g_pRenderer->SetDepthTestEnabled( false );
+                            g_pRenderer->SetCullMode( MyRE::CullMode_Front );
+                        }
+
+                        m_DeferredLightStats.m_LightsDrawnFromInside++;
+                    }
+                    else
                     {
-                        // Scale sphere.
-                        float radius = pLight->m_Attenuation.x;
-                        MyMatrix matWorld;
-                        matWorld.CreateSRT( radius, 0, pLight->m_Position );
-
-                        MyMatrix* pMatViewProj;
-                        if( m_Orthographic )
-                            pMatViewProj = &m_Camera2D.m_matViewProj;
-                        else
-                            pMatViewProj = &m_Camera3D.m_matViewProj;
-
-                        // Render a sphere to combine the 3 textures from the G-Buffer.
-                        // Point light shader should set blending to additive.
-                        // Textures are set below in SetupCustomUniformsCallback().
-                        Vector3 worldPosition = m_pComponentTransform->GetWorldPosition();
-                        m_pDeferredSphereMesh->Draw( pMatProj, pMatView, &matWorld, &worldPosition, 0, &pLight, 1, 0, 0, 0, 0 );
+                        m_DeferredLightStats.m_LightsDrawnFromOutside++;
                     }
+
+                    // Scale sphere.
+                    float radius = pLight->m_Attenuation.x;
+                    MyMatrix matWorld;
+                    matWorld.CreateSRT( radius, 0, pLight->m_Position );
+
+                    // Render a sphere to combine the 3 textures from the G-Buffer.
+                    // Point light shader should set blending to additive.
+                    // Textures are set below in SetupCustomUniformsCallback().
+                    m_pDeferredSphereMesh->Draw( pMatProj, pMatView, &matWorld, &worldPosition, 0, &pLight, 1, 0, 0, 0, 0 );
                 }
             }
 
@@ -887,10 +931,75 @@ void ComponentCamera::DrawScene()
     }
 }
 
+bool ComponentCamera::IsDeferredPointLightVisible(MyLight* pLight, MyMatrix* pMatProj, MyMatrix* pMatView)
+{
+    float radius = pLight->m_Attenuation.x;
+    Vector3 pos = pLight->m_Position;
+
+    // Test the light's bounding box against the frustum, same clip space test as ComponentMesh::DrawCallback.
+    MyMatrix matViewProj = *pMatProj * *pMatView;
+
+    Vector4 clippos[8];
+    for( int i=0; i<8; i++ )
+    {
+        clippos[i] = matViewProj * Vector4( pos.x + (i & 1 ? radius : -radius),
+                                            pos.y + (i & 2 ? radius : -radius),
+                                            pos.z + (i & 4 ? radius : -radius), 1 );
+    }
+
+    for( int component=0; component<3; component++ ) // Loop through x/y/z.
+    {
+        bool insideMin = false;
+        bool insideMax = false;
+        for( int i=0; i<8; i++ )
+        {
+            if( clippos[i][component] >= -clippos[i].w )
+                insideMin = true;
+            if( clippos[i][component] <= clippos[i].w )
+                insideMax = true;
+        }
+
+        // All points are outside of one plane.
+        if( insideMin == false || insideMax == false )
+        {
+            m_DeferredLightStats.m_LightsCulledByFrustum++;
+            return false;
+        }
+    }
+
+    // Skip lights that cover too little of the screen, unless the camera is inside them.
+    if( m_DeferredLightMinScreenSize > 0 )
+    {
+        Vector4 viewPos = *pMatView * Vector4( pos.x, pos.y, pos.z, 1 );
+        float distanceSquared = viewPos.x*viewPos.x + viewPos.y*viewPos.y + viewPos.z*viewPos.z;
+        if( distanceSquared > radius * radius )
+        {
+            // Project the center and a point one radius above it in view space, the difference is the size on screen.
+            Vector4 clipCenter = *pMatProj * viewPos;
+            Vector4 clipTop = *pMatProj * Vector4( viewPos.x, viewPos.y + radius, viewPos.z, 1 );
+
+            if( clipCenter.w > 0 && clipTop.w > 0 )
+            {
+                float screenSize = fabsf( clipTop.y / clipTop.w - clipCenter.y / clipCenter.w ); // Radius in NDC is a diameter as a fraction of the screen.
+                if( screenSize < m_DeferredLightMinScreenSize )
+                {
+                    m_DeferredLightStats.m_LightsCulledBySize++;
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
 void ComponentCamera::SetupCustomUniformsCallback(Shader_Base* pShader) // StaticSetupCustomUniformsCallback
 {
     // TODO: Not this...
     pShader->ProgramDeferredRenderingUniforms( m_pGBuffer, m_PerspectiveNearZ, m_PerspectiveFarZ, m_pGameObject->GetTransform()->GetWorldTransform(), ColorFloat( 0, 0, 0.2f, 1 ) );
+
+    // Cascaded shadows, the ambient/directional shader picks a cascade per pixel based on view depth.
+    ComponentCameraShadow::ProgramCascadeUniforms( pShader, m_pDeferredShadowCamera );
 }
 
 bool ComponentCamera::IsVisible()
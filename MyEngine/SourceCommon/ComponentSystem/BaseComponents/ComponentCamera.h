@@ -17,6 +17,7 @@
 #include "Camera/Camera3D.h"
 #include "ComponentSystem/Core/ComponentSystemManager.h"
 
+class ComponentCameraShadow;
 class ComponentPostEffect;
 class ComponentTransform;
 
@@ -40,9 +41,37 @@ public:
 
     // For deferred.
     bool m_Deferred;
+    float m_DeferredLightMinScreenSize; // Point lights covering less than this fraction of the screen height aren't drawn.
+
+    // Point light counts for all deferred cameras, reset by the Timing window.
+    struct DeferredLightStats
+    {
+        unsigned int m_LightsCulledByFrustum;
+        unsigned int m_LightsCulledBySize;
+        unsigned int m_LightsDrawnFromOutside;
+        unsigned int m_LightsDrawnFromInside;
+    };
+    static DeferredLightStats m_DeferredLightStats;
+
 private:
+    struct DeferredPointLight
+    {
+        MyLight* m_pLight;
+        float m_DistanceSquared;
+        bool m_CameraIsInside;
+
+        // Draw lights the camera is outside of first, then inside, front to back within each group.
+        bool operator<(const DeferredPointLight& other) const
+        {
+            if( m_CameraIsInside != other.m_CameraIsInside ) return m_CameraIsInside == false;
+            return m_DistanceSquared < other.m_DistanceSquared;
+        }
+    };
+    std::vector<DeferredPointLight> m_DeferredPointLights; // Rebuilt each frame.
+
     bool m_DeferredGBufferVisible;
     FBODefinition* m_pGBuffer;
+    ComponentCameraShadow* m_pDeferredShadowCamera; // Only set while drawing the ambient/directional quad, for cascade uniforms.
 
     MyFileObject* m_pDeferredShaderFile_AmbientDirectional;
     MyFileObject* m_pDeferredShaderFile_PointLight;
@@ -75,7 +104,7 @@ public:
     Camera2D m_Camera2D;
     Camera3D m_Camera3D;
 
-    FBODefinition* m_pPostEffectFBOs[2];
+    FBODefinition* m_pPostEffectFBOs[2]; // Borrowed from the RenderTargetPool during OnDrawFrame.
 
 #if MYFW_EDITOR
     unsigned int m_FullClearsRequired;
@@ -112,6 +141,8 @@ public:
 protected:
     void DrawScene();
 
+    bool IsDeferredPointLightVisible(MyLight* pLight, MyMatrix* pMatProj, MyMatrix* pMatView);
+
     // Mesh draw callback
     static void StaticSetupCustomUniformsCallback(void* pObjectPtr, Shader_Base* pShader) { ((ComponentCamera*)pObjectPtr)->SetupCustomUniformsCallback( pShader ); }
     void SetupCustomUniformsCallback(Shader_Base* pShader);
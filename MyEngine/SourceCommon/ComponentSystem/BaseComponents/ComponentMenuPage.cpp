@@ -968,7 +968,7 @@ void ComponentMenuPage::FindLuaScriptComponentPointer()
     // if we don't have a luascript, find the first one attached to this gameobject
     if( m_pComponentLuaScript == 0 )
     {
-        m_pComponentLuaScript = (ComponentLuaScript*)m_pGameObject->GetFirstComponentOfType( "LuaScriptComponent" );
+        m_pComponentLuaScript = (ComponentLuaScript*)m_pGameObject->GetFirstComponentOfTypeID( ComponentTypeID_LuaScript );
     }
 }
 
@@ -1873,7 +1873,7 @@ bool ComponentMenuPage::IsInputEnabled()
 
 bool ComponentMenuPage::IsOnTop()
 {
-    if( g_pComponentSystemManager->m_pComponentCallbackList_OnButtons.GetHead() == &m_CallbackStruct_OnButtons )
+    if( g_pComponentSystemManager->m_ComponentCallbackList_OnButtons.GetFront() == &m_CallbackStruct_OnButtons )
         return true;
 
     return false;
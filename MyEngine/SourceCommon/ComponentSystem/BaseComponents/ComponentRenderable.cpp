@@ -48,6 +48,10 @@ void ComponentRenderable::RegisterVariables(TCPPListHead<ComponentVariable*>* pL
                  g_NumberOfVisibilityLayers, g_pVisibilityLayerStrings,
                  (CVarFunc_ValueChanged)&ComponentRenderable::OnValueChanged,
                  0, 0 ); //, ComponentRenderable::StaticOnDrop, 0 );
+
+    AddVar( pList, "Static", ComponentVariableType::Bool, MyOffsetOf( pThis, &pThis->m_Static ), true, true, 0,
+            (CVarFunc_ValueChanged)&ComponentRenderable::OnValueChanged,
+            0, 0 );
 }
 
 void ComponentRenderable::Reset()
@@ -61,6 +65,7 @@ void ComponentRenderable::Reset()
 
     m_Visible = true;
     m_LayersThisExistsOn = Layer_MainScene;
+    m_Static = false;
 
 #if MYFW_USING_WX
     m_pPanelWatchBlockVisible = &m_PanelWatchBlockVisible;
@@ -93,6 +98,7 @@ ComponentRenderable& ComponentRenderable::operator=(const ComponentRenderable& o
 
     this->m_Visible = other.m_Visible;
     this->m_LayersThisExistsOn = other.m_LayersThisExistsOn;
+    this->m_Static = other.m_Static;
 
     return *this;
 }
@@ -23,6 +23,7 @@ protected:
 protected:
     bool m_Visible;
     unsigned int m_LayersThisExistsOn;
+    bool m_Static; // Static renderables are cached in shadow maps until one of them changes.
 
 public:
     ComponentTransform* m_pComponentTransform;
@@ -57,6 +58,15 @@ public:
     virtual void SetVisible(bool visible) { m_Visible = visible; }
     virtual bool IsVisible();
 
+    bool IsStatic() { return m_Static; }
+    virtual bool IsStaticShadowCaster() { return m_Static; } // False for renderables that don't report their changes.
+
+protected:
+    // Call when anything that affects a static renderable's shadow changes.
+    void OnStaticRenderableChanged() { if( m_Static && m_pComponentSystemManager ) m_pComponentSystemManager->OnStaticRenderableChanged(); }
+
+public:
+
     virtual void AddToRenderGraph() = 0;
     virtual void RemoveFromRenderGraph() = 0;
     virtual void PushChangesToRenderGraphObjects() = 0;
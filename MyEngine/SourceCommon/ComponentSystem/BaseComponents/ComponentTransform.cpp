@@ -16,6 +16,8 @@
 // Component Variable List
 MYFW_COMPONENT_IMPLEMENT_VARIABLE_LIST( ComponentTransform );
 
+ComponentTransform::Stats ComponentTransform::m_Stats;
+
 ComponentTransform::ComponentTransform(EngineCore* pEngineCore, ComponentSystemManager* pComponentSystemManager)
 : ComponentBase( pEngineCore, pComponentSystemManager )
 {
@@ -26,11 +28,22 @@ ComponentTransform::ComponentTransform(EngineCore* pEngineCore, ComponentSystemM
     m_BaseType = BaseComponentType_Data;
 
     m_pParentTransform = nullptr;
+
+    m_QueuedNotificationIndex = -1;
+    m_QueuedNotificationChangedByUserInEditor = false;
+
+    m_WorldTransformVersion = 0;
+    m_ParentWorldTransformVersion = 0;
+    m_WorldTransformInverseIsDirty = true;
 }
 
 ComponentTransform::~ComponentTransform()
 {
     MYFW_COMPONENT_VARIABLE_LIST_DESTRUCTOR();
+
+    // Don't let the ComponentSystemManager notify for a deleted transform.
+    if( m_QueuedNotificationIndex != -1 )
+        m_pComponentSystemManager->CancelTransformChangedNotification( m_QueuedNotificationIndex );
 }
 
 void ComponentTransform::SystemStartup()
@@ -90,6 +103,10 @@ void ComponentTransform::Reset()
     m_LocalPosition.Set( 0,0,0 );
     m_LocalRotation.Set( 0,0,0 );
     m_LocalScale.Set( 1,1,1 );
+
+    m_WorldTransformVersion++;
+    m_ParentWorldTransformVersion = 0;
+    m_WorldTransformInverseIsDirty = true;
 }
 
 #if MYFW_USING_LUA
@@ -224,45 +241,39 @@ void* ComponentTransform::OnValueChanged(ComponentVariable* pVar, bool changedBy
             }
             else
             {
-                // Calculate new local transform matrix, decompose it into local SRT.
-                MyMatrix matworld;
-                matworld.CreateSRT( m_WorldScale, m_WorldRotation, m_WorldPosition );
-
-                MyMatrix matparentworld = *m_pParentTransform->GetWorldTransform();
-                matparentworld.Inverse();
-                MyMatrix matlocal = matparentworld * matworld;
-                
-                SetLocalTransform( &matlocal );
-                UpdateLocalSRT();
+                // This edit is newer than any pending local change, don't let that change override it.
+                m_LocalTransformIsDirty = false;
             }
 
+            // The local transform will be recalculated from the world values and our parent's cached inverse.
             m_WorldTransformIsDirty = true;
-            UpdateTransform();
 
-            for( CPPListNode* pNode = m_TransformChangedCallbackList.GetHead(); pNode != nullptr; pNode = pNode->GetNext() )
-            {
-                TransformChangedCallbackStruct* pCallbackStruct = (TransformChangedCallbackStruct*)pNode;
-
-                pCallbackStruct->pFunc( pCallbackStruct->pObj, m_WorldPosition, m_WorldRotation, m_WorldScale, true );
-            }
+            QueueTransformChangedNotification( true );
         }
         else if( pVar->m_Offset == MyOffsetOf( this, &m_LocalPosition ) ||
                  pVar->m_Offset == MyOffsetOf( this, &m_LocalRotation ) ||
                  pVar->m_Offset == MyOffsetOf( this, &m_LocalScale ) )
         {
+            // This edit is newer than any pending world change, the world values will be rebuilt from local.
             m_LocalTransformIsDirty = true;
+            m_WorldTransformIsDirty = false;
 
-            for( CPPListNode* pNode = m_TransformChangedCallbackList.GetHead(); pNode != nullptr; pNode = pNode->GetNext() )
-            {
-                TransformChangedCallbackStruct* pCallbackStruct = (TransformChangedCallbackStruct*)pNode;
-
-                pCallbackStruct->pFunc( pCallbackStruct->pObj, m_WorldPosition, m_WorldRotation, m_WorldScale, true );
-            }
+            QueueTransformChangedNotification( true );
         }
     }
 
     return oldPointer;
 }
+
+#if MYFW_USING_IMGUI
+void ComponentTransform::AddAllVariablesToWatchPanel(CommandStack* pCommandStack)
+{
+    // The watch panel reads the SRT values directly, make sure they're not waiting on a lazy update.
+    UpdateTransform();
+
+    ComponentBase::AddAllVariablesToWatchPanel( pCommandStack );
+}
+#endif //MYFW_USING_IMGUI
 #endif //MYFW_EDITOR
 
 cJSON* ComponentTransform::ExportAsJSONObject(bool savesceneid, bool saveid)
@@ -289,7 +300,6 @@ void ComponentTransform::ImportFromJSONObject(cJSON* jsonobj, SceneID sceneid)
             if( pParentGameObject )
             {
                 m_pGameObject->SetParentGameObject( pParentGameObject );
-                m_WorldTransformIsDirty = true;
             }
             m_LocalTransformIsDirty = true;
         }
@@ -298,17 +308,14 @@ void ComponentTransform::ImportFromJSONObject(cJSON* jsonobj, SceneID sceneid)
     // Load all the registered variables.
     ComponentBase::ImportFromJSONObject( jsonobj, sceneid );
 
-    // Local scale/rotation/position should be loaded, update the transform.
+    // Local scale/rotation/position should be loaded, rebuild the world values from them.
+    //     Root transforms don't lazily update their world SRT, so this can't wait until the transform is next used.
     m_LocalTransformIsDirty = true;
+    m_WorldTransformIsDirty = false;
     UpdateTransform();
 
     // Inform all children/other objects that our transform changed.
-    for( CPPListNode* pNode = m_TransformChangedCallbackList.GetHead(); pNode != nullptr; pNode = pNode->GetNext() )
-    {
-        TransformChangedCallbackStruct* pCallbackStruct = (TransformChangedCallbackStruct*)pNode;
-
-        pCallbackStruct->pFunc( pCallbackStruct->pObj, m_WorldPosition, m_WorldRotation, m_WorldScale, true );
-    }
+    QueueTransformChangedNotification( true );
 }
 
 cJSON* ComponentTransform::ExportLocalTransformAsJSONObject()
@@ -327,19 +334,36 @@ cJSON* ComponentTransform::ExportLocalTransformAsJSONObject()
 
 void ComponentTransform::ImportLocalTransformFromJSONObject(cJSON* jsonobj)
 {
-    cJSONExt_GetFloatArray( jsonobj, "Pos", &this->m_LocalPosition.x, 3 );
-    cJSONExt_GetFloatArray( jsonobj, "Rot", &this->m_LocalRotation.x, 3 );
-    cJSONExt_GetFloatArray( jsonobj, "Scale", &this->m_LocalScale.x, 3 );
+    Vector3 pos = m_LocalPosition;
+    Vector3 rot = m_LocalRotation;
+    Vector3 scale = m_LocalScale;
 
-    m_LocalTransformIsDirty = true;
-    UpdateTransform();
+    cJSONExt_GetFloatArray( jsonobj, "Pos", &pos.x, 3 );
+    cJSONExt_GetFloatArray( jsonobj, "Rot", &rot.x, 3 );
+    cJSONExt_GetFloatArray( jsonobj, "Scale", &scale.x, 3 );
 
-    for( CPPListNode* pNode = m_TransformChangedCallbackList.GetHead(); pNode != nullptr; pNode = pNode->GetNext() )
-    {
-        TransformChangedCallbackStruct* pCallbackStruct = (TransformChangedCallbackStruct*)pNode;
+    SetLocalPositionRotationScale( pos, rot, scale );
+}
+
+void ComponentTransform::SetLocalPositionRotationScale(Vector3 pos, Vector3 rot, Vector3 scale)
+{
+    // Bring the local values up to date if the world values were set directly.
+    if( m_pParentTransform && m_WorldTransformIsDirty )
+        UpdateTransform();
 
-        pCallbackStruct->pFunc( pCallbackStruct->pObj, m_WorldPosition, m_WorldRotation, m_WorldScale, true );
+    m_LocalPosition = pos;
+    m_LocalRotation = rot;
+    m_LocalScale = scale;
+    m_LocalTransformIsDirty = true;
+    if( m_pParentTransform == nullptr )
+    {
+        m_WorldPosition = m_LocalPosition;
+        m_WorldRotation = m_LocalRotation;
+        m_WorldScale = m_LocalScale;
+        m_WorldTransformIsDirty = true;
     }
+
+    QueueTransformChangedNotification( true );
 }
 
 ComponentTransform& ComponentTransform::operator=(const ComponentTransform& other)
@@ -362,82 +386,37 @@ ComponentTransform& ComponentTransform::operator=(const ComponentTransform& othe
     this->m_LocalRotation = other.m_LocalRotation;
     this->m_LocalScale = other.m_LocalScale;
 
+    // Our parent might not be the same as the other transform's, so rebuild from the local values.
+    this->m_LocalTransformIsDirty = true;
+    this->m_WorldTransformVersion++;
+    this->m_WorldTransformInverseIsDirty = true;
+
     return *this;
 }
 
 #if MYFW_EDITOR
 void ComponentTransform::SetPositionByEditor(Vector3 pos)
 {
-    m_LocalPosition = pos;
-    m_LocalTransform.CreateSRT( m_LocalScale, m_LocalRotation, m_LocalPosition );
-
-    if( m_pParentTransform == nullptr )
-    {
-        m_WorldPosition = pos;
-        m_WorldTransform.CreateSRT( m_WorldScale, m_WorldRotation, m_WorldPosition );
-    }
-    else
-    {
-        m_LocalTransformIsDirty = true;
-    }
-
-    for( CPPListNode* pNode = m_TransformChangedCallbackList.GetHead(); pNode != nullptr; pNode = pNode->GetNext() )
-    {
-        TransformChangedCallbackStruct* pCallbackStruct = (TransformChangedCallbackStruct*)pNode;
-
-        pCallbackStruct->pFunc( pCallbackStruct->pObj, m_WorldPosition, m_WorldRotation, m_WorldScale, true );
-    }
+    SetLocalPosition( pos );
 }
 
 void ComponentTransform::SetScaleByEditor(Vector3 scale)
 {
-    m_LocalScale = scale;
-    m_LocalTransform.CreateSRT( m_LocalScale, m_LocalRotation, m_LocalPosition );
-
-    if( m_pParentTransform == nullptr )
-    {
-        m_WorldScale = scale;
-        m_WorldTransform.CreateSRT( m_WorldScale, m_WorldRotation, m_WorldPosition );
-    }
-    else
-    {
-        m_LocalTransformIsDirty = true;
-    }
-
-    for( CPPListNode* pNode = m_TransformChangedCallbackList.GetHead(); pNode != nullptr; pNode = pNode->GetNext() )
-    {
-        TransformChangedCallbackStruct* pCallbackStruct = (TransformChangedCallbackStruct*)pNode;
-
-        pCallbackStruct->pFunc( pCallbackStruct->pObj, m_WorldPosition, m_WorldRotation, m_WorldScale, true );
-    }
+    SetLocalScale( scale );
 }
 
 void ComponentTransform::SetRotationByEditor(Vector3 eulerAngles)
 {
-    m_LocalRotation = eulerAngles;
-    m_LocalTransform.CreateSRT( m_LocalScale, m_LocalRotation, m_LocalPosition );
-
-    if( m_pParentTransform == nullptr )
-    {
-        m_WorldRotation = eulerAngles;
-        m_WorldTransform.CreateSRT( m_WorldScale, m_WorldRotation, m_WorldPosition );
-    }
-    else
-    {
-        m_LocalTransformIsDirty = true;
-    }
-
-    for( CPPListNode* pNode = m_TransformChangedCallbackList.GetHead(); pNode != nullptr; pNode = pNode->GetNext() )
-    {
-        TransformChangedCallbackStruct* pCallbackStruct = (TransformChangedCallbackStruct*)pNode;
-
-        pCallbackStruct->pFunc( pCallbackStruct->pObj, m_WorldPosition, m_WorldRotation, m_WorldScale, true );
-    }
+    SetLocalRotation( eulerAngles );
 }
 #endif //MYFW_EDITOR
 
 void ComponentTransform::SetWorldPosition(Vector3 pos)
 {
+    // Bring the other world values up to date before replacing one of them, root transforms are always up to date.
+    if( m_pParentTransform && m_WorldTransformIsDirty == false )
+        UpdateTransform();
+
     m_WorldPosition = pos;
     m_WorldTransformIsDirty = true;
     if( m_pParentTransform == nullptr )
@@ -446,16 +425,15 @@ void ComponentTransform::SetWorldPosition(Vector3 pos)
         m_LocalTransformIsDirty = true;
     }
 
-    for( CPPListNode* pNode = m_TransformChangedCallbackList.GetHead(); pNode != nullptr; pNode = pNode->GetNext() )
-    {
-        TransformChangedCallbackStruct* pCallbackStruct = (TransformChangedCallbackStruct*)pNode;
-
-        pCallbackStruct->pFunc( pCallbackStruct->pObj, m_WorldPosition, m_WorldRotation, m_WorldScale, true );
-    }
+    QueueTransformChangedNotification( true );
 }
 
 void ComponentTransform::SetWorldRotation(Vector3 rot)
 {
+    // Bring the other world values up to date before replacing one of them, root transforms are always up to date.
+    if( m_pParentTransform && m_WorldTransformIsDirty == false )
+        UpdateTransform();
+
     m_WorldRotation = rot;
     m_WorldTransformIsDirty = true;
     if( m_pParentTransform == nullptr )
@@ -464,16 +442,15 @@ void ComponentTransform::SetWorldRotation(Vector3 rot)
         m_LocalTransformIsDirty = true;
     }
 
-    for( CPPListNode* pNode = m_TransformChangedCallbackList.GetHead(); pNode != nullptr; pNode = pNode->GetNext() )
-    {
-        TransformChangedCallbackStruct* pCallbackStruct = (TransformChangedCallbackStruct*)pNode;
-
-        pCallbackStruct->pFunc( pCallbackStruct->pObj, m_WorldPosition, m_WorldRotation, m_WorldScale, true );
-    }
+    QueueTransformChangedNotification( true );
 }
 
 void ComponentTransform::SetWorldScale(Vector3 scale)
 {
+    // Bring the other world values up to date before replacing one of them, root transforms are always up to date.
+    if( m_pParentTransform && m_WorldTransformIsDirty == false )
+        UpdateTransform();
+
     m_WorldScale = scale;
     m_WorldTransformIsDirty = true;
     if( m_pParentTransform == nullptr )
@@ -481,6 +458,8 @@ void ComponentTransform::SetWorldScale(Vector3 scale)
         m_LocalScale = m_WorldScale;
         m_LocalTransformIsDirty = true;
     }
+
+    QueueTransformChangedNotification( true );
 }
 
 // Exposed to Lua, change elsewhere if function signature changes.
@@ -488,6 +467,8 @@ void ComponentTransform::SetLocalTransform(MyMatrix* mat)
 {
     m_LocalTransform = *mat;
     UpdateLocalSRT();
+    m_LocalTransformIsDirty = false;
+    m_WorldTransformIsDirty = false;
 
     if( m_pParentTransform )
     {
@@ -496,17 +477,24 @@ void ComponentTransform::SetLocalTransform(MyMatrix* mat)
     }
     else
     {
-        m_WorldTransformIsDirty = false;
         m_WorldTransform = m_LocalTransform;
         m_WorldPosition = m_LocalPosition;
         m_WorldRotation = m_LocalRotation;
         m_WorldScale = m_LocalScale;
     }
+
+    OnWorldTransformChanged();
+
+    QueueTransformChangedNotification( false );
 }
 
 // Exposed to Lua, change elsewhere if function signature changes.
 void ComponentTransform::SetLocalPosition(Vector3 pos)
 {
+    // Bring the local values up to date if the world values were set directly.
+    if( m_pParentTransform && m_WorldTransformIsDirty )
+        UpdateTransform();
+
     if( m_LocalPosition == pos )
         return;
 
@@ -518,19 +506,16 @@ void ComponentTransform::SetLocalPosition(Vector3 pos)
         m_WorldTransformIsDirty = true;
     }
 
-    UpdateTransform();
-
-    for( CPPListNode* pNode = m_TransformChangedCallbackList.GetHead(); pNode != nullptr; pNode = pNode->GetNext() )
-    {
-        TransformChangedCallbackStruct* pCallbackStruct = (TransformChangedCallbackStruct*)pNode;
-
-        pCallbackStruct->pFunc( pCallbackStruct->pObj, m_WorldPosition, m_WorldRotation, m_WorldScale, true );
-    }
+    QueueTransformChangedNotification( true );
 }
 
 // Exposed to Lua, change elsewhere if function signature changes.
 void ComponentTransform::SetLocalRotation(Vector3 rot)
 {
+    // Bring the local values up to date if the world values were set directly.
+    if( m_pParentTransform && m_WorldTransformIsDirty )
+        UpdateTransform();
+
     m_LocalRotation = rot;
     m_LocalTransformIsDirty = true;
     if( m_pParentTransform == nullptr )
@@ -539,11 +524,15 @@ void ComponentTransform::SetLocalRotation(Vector3 rot)
         m_WorldTransformIsDirty = true;
     }
 
-    UpdateTransform();
+    QueueTransformChangedNotification( true );
 }
 
 void ComponentTransform::SetLocalScale(Vector3 scale)
 {
+    // Bring the local values up to date if the world values were set directly.
+    if( m_pParentTransform && m_WorldTransformIsDirty )
+        UpdateTransform();
+
     m_LocalScale = scale;
     m_LocalTransformIsDirty = true;
     if( m_pParentTransform == nullptr )
@@ -552,7 +541,7 @@ void ComponentTransform::SetLocalScale(Vector3 scale)
         m_WorldTransformIsDirty = true;
     }
 
-    UpdateTransform();
+    QueueTransformChangedNotification( true );
 }
 
 // Exposed to Lua, change elsewhere if function signature changes.
@@ -564,22 +553,19 @@ void ComponentTransform::SetWorldTransform(const MyMatrix* mat)
 
     if( m_pParentTransform )
     {
-        m_pParentTransform->UpdateTransform();
-        m_LocalTransform = m_pParentTransform->m_WorldTransform.GetInverse() * m_WorldTransform;
-        UpdateLocalSRT();
+        m_LocalTransform = *m_pParentTransform->GetWorldTransformInverse() * m_WorldTransform;
     }
     else
     {
         m_LocalTransform = m_WorldTransform;
-        UpdateLocalSRT();
     }
+    UpdateLocalSRT();
 
-    for( CPPListNode* pNode = m_TransformChangedCallbackList.GetHead(); pNode != nullptr; pNode = pNode->GetNext() )
-    {
-        TransformChangedCallbackStruct* pCallbackStruct = (TransformChangedCallbackStruct*)pNode;
+    m_LocalTransformIsDirty = false;
+    m_WorldTransformIsDirty = false;
+    OnWorldTransformChanged();
 
-        pCallbackStruct->pFunc( pCallbackStruct->pObj, m_WorldPosition, m_WorldRotation, m_WorldScale, false );
-    }
+    QueueTransformChangedNotification( false );
 }
 
 // Exposed to Lua, change elsewhere if function signature changes.
@@ -596,24 +582,42 @@ MyMatrix* ComponentTransform::GetWorldTransform(bool markDirty)
     return &m_WorldTransform;
 }
 
+MyMatrix* ComponentTransform::GetWorldTransformInverse()
+{
+    UpdateTransform();
+
+    if( m_WorldTransformInverseIsDirty )
+    {
+        m_WorldTransformInverseIsDirty = false;
+        m_WorldTransformInverse = m_WorldTransform.GetInverse();
+    }
+
+    return &m_WorldTransformInverse;
+}
+
 Vector3 ComponentTransform::GetWorldPosition()
 {
     //return m_WorldTransform.GetTranslation();
+    UpdateTransform();
     return m_WorldPosition;
 }
 Vector3 ComponentTransform::GetWorldScale()
 {
     //return m_WorldTransform.GetScale();
+    UpdateTransform();
     return m_WorldScale;
 }
 Vector3 ComponentTransform::GetWorldRotation()
 {
     //return m_WorldTransform.GetEulerAngles();
+    UpdateTransform();
     return m_WorldRotation;
 }
 
 MyMatrix ComponentTransform::GetWorldRotPosMatrix()
 {
+    UpdateTransform();
+
     MyMatrix world;
     world.CreateSRT( Vector3(1,1,1), m_WorldRotation, m_WorldPosition );
 
@@ -635,22 +639,31 @@ MyMatrix* ComponentTransform::GetLocalTransform(bool markDirty)
 Vector3 ComponentTransform::GetLocalPosition()
 {
     //return m_LocalTransform.GetTranslation();
+    if( m_pParentTransform && m_WorldTransformIsDirty )
+        UpdateTransform();
     return m_LocalPosition;
 }
 Vector3 ComponentTransform::GetLocalScale()
 {
     //return m_LocalTransform.GetScale();
+    if( m_pParentTransform && m_WorldTransformIsDirty )
+        UpdateTransform();
     return m_LocalScale;
 }
 // Exposed to Lua, change elsewhere if function signature changes.
 Vector3 ComponentTransform::GetLocalRotation()
 {
     //return m_LocalTransform.GetEulerAngles();
+    if( m_pParentTransform && m_WorldTransformIsDirty )
+        UpdateTransform();
     return m_LocalRotation;
 }
 
 MyMatrix ComponentTransform::GetLocalRotPosMatrix()
 {
+    if( m_pParentTransform && m_WorldTransformIsDirty )
+        UpdateTransform();
+
     MyMatrix local;
     local.CreateSRT( Vector3(1,1,1), m_LocalRotation, m_LocalPosition );
 
@@ -681,7 +694,7 @@ void ComponentTransform::Rotate(MyMatrix* pRotMatrix, Vector3 pivot)
 void ComponentTransform::LookAt(Vector3 pos)
 {
     MyMatrix temp;
-    temp.CreateLookAtWorld( m_WorldPosition, Vector3(0,1,0), pos );
+    temp.CreateLookAtWorld( GetWorldPosition(), Vector3(0,1,0), pos );
 
     Vector3 rot = temp.GetEulerAngles() * 180.0f/PI;
 
@@ -695,13 +708,16 @@ void ComponentTransform::SetParentTransform(ComponentTransform* pNewParentTransf
     if( m_pParentTransform == pNewParentTransform )
         return;
 
+    // Make sure our world values are current before swapping parents.
+    UpdateTransform();
+
     MyMatrix wantedWorldSpaceTransform;
 
     // If we had an old parent:
     if( m_pParentTransform != nullptr )
     {
         // Stop sending old parent position changed messages.
-        m_pParentTransform->m_pGameObject->GetTransform()->UnregisterTransformChangedCallbacks( this );
+        m_pParentTransform->m_pGameObject->GetTransform()->UnregisterTransformChangedCallback( this, StaticOnParentTransformChanged );
 
         // Maintain our world space position by setting local transform to match world.
         wantedWorldSpaceTransform = m_WorldTransform;
@@ -725,6 +741,7 @@ void ComponentTransform::SetParentTransform(ComponentTransform* pNewParentTransf
         m_WorldScale = m_LocalScale;
 
         m_pParentTransform = nullptr;
+        OnWorldTransformChanged();
     }
     else
     {
@@ -761,23 +778,34 @@ void ComponentTransform::UpdateTransform()
 {
     if( m_pParentTransform )
     {
-        if( m_WorldTransformIsDirty )
-        {
-            //MyAssert( m_LocalTransformIsDirty == false );
-
-            m_WorldTransformIsDirty = false;
-            m_WorldTransform.CreateSRT( m_WorldScale, m_WorldRotation, m_WorldPosition );
-        }
+        // Bring our parent up to date first, if its world transform changed since ours was built, rebuild ours.
+        m_pParentTransform->UpdateTransform();
 
         if( m_LocalTransformIsDirty )
         {
-            //MyAssert( m_WorldTransformIsDirty == false );
-
             m_LocalTransformIsDirty = false;
+            m_WorldTransformIsDirty = false;
             m_LocalTransform.CreateSRT( m_LocalScale, m_LocalRotation, m_LocalPosition );
 
-            m_WorldTransform = *m_pParentTransform->GetWorldTransform() * m_LocalTransform;
+            m_WorldTransform = m_pParentTransform->m_WorldTransform * m_LocalTransform;
+            UpdateWorldSRT();
+            OnWorldTransformChanged();
+        }
+        else if( m_WorldTransformIsDirty )
+        {
+            // World values were set directly, find the local transform using our parent's cached inverse.
+            m_WorldTransformIsDirty = false;
+            m_WorldTransform.CreateSRT( m_WorldScale, m_WorldRotation, m_WorldPosition );
+
+            m_LocalTransform = *m_pParentTransform->GetWorldTransformInverse() * m_WorldTransform;
+            UpdateLocalSRT();
+            OnWorldTransformChanged();
+        }
+        else if( m_ParentWorldTransformVersion != m_pParentTransform->m_WorldTransformVersion )
+        {
+            m_WorldTransform = m_pParentTransform->m_WorldTransform * m_LocalTransform;
             UpdateWorldSRT();
+            OnWorldTransformChanged();
         }
     }
     else
@@ -792,10 +820,22 @@ void ComponentTransform::UpdateTransform()
             m_WorldPosition = m_LocalPosition;
             m_WorldRotation = m_LocalRotation;
             m_WorldScale = m_LocalScale;
+            OnWorldTransformChanged();
         }
     }
 }
 
+void ComponentTransform::OnWorldTransformChanged()
+{
+    m_WorldTransformVersion++;
+    m_WorldTransformInverseIsDirty = true;
+
+    if( m_pParentTransform )
+        m_ParentWorldTransformVersion = m_pParentTransform->m_WorldTransformVersion;
+
+    m_Stats.m_WorldTransformsRecalculated++;
+}
+
 //MyMatrix* ComponentTransform::GetMatrix()
 //{
 //    return &m_Transform;
@@ -805,48 +845,60 @@ void ComponentTransform::RegisterTransformChangedCallback(void* pObj, TransformC
 {
     MyAssert( pCallback != nullptr );
 
-    TransformChangedCallbackStruct* pCallbackStruct = m_pComponentSystemManager->GetTransformChangedCallbackPool()->GetObjectFromPool();
+    m_TransformChangedObservers.Subscribe( pObj, (ObserverFunc*)pCallback );
+}
+
+void ComponentTransform::UnregisterTransformChangedCallback(void* pObj, TransformChangedCallbackFunc* pCallback)
+{
+    m_TransformChangedObservers.Unsubscribe( pObj, (ObserverFunc*)pCallback );
+}
+
+void ComponentTransform::QueueTransformChangedNotification(bool changedByUserInEditor)
+{
+    // Nobody to tell.
+    if( m_TransformChangedObservers.GetCount() == 0 )
+        return;
 
-    //LOGInfo( "TransformPool", "Grabbed an object (%d) - %s\n", m_pComponentTransform_TransformChangedCallbackPool.GetNumUsed(), ((ComponentBase*)pObj)->m_pGameObject->GetName() );
+    m_QueuedNotificationChangedByUserInEditor |= changedByUserInEditor;
 
-    if( pCallbackStruct != nullptr )
+    if( m_QueuedNotificationIndex == -1 )
     {
-        pCallbackStruct->pObj = pObj;
-        pCallbackStruct->pFunc = pCallback;
-
-        m_TransformChangedCallbackList.AddTail( pCallbackStruct );
+        m_QueuedNotificationIndex = m_pComponentSystemManager->QueueTransformChangedNotification( this );
+        m_Stats.m_NotificationsQueued++;
     }
 }
 
-void ComponentTransform::UnregisterTransformChangedCallbacks(void* pObj)
+void ComponentTransform::SendQueuedTransformChangedNotification()
 {
-    for( CPPListNode* pNode = m_TransformChangedCallbackList.GetHead(); pNode != nullptr; )
-    {
-        CPPListNode* pNextNode = pNode->GetNext();
-
-        TransformChangedCallbackStruct* pCallbackStruct = (TransformChangedCallbackStruct*)pNode;
+    bool changedByUserInEditor = m_QueuedNotificationChangedByUserInEditor;
 
-        if( pCallbackStruct->pObj == pObj )
-        {
-            pCallbackStruct->Remove();
-            m_pComponentSystemManager->GetTransformChangedCallbackPool()->ReturnObjectToPool( pCallbackStruct );
+    // Clear first, observers moving this transform again will queue another notification.
+    m_QueuedNotificationIndex = -1;
+    m_QueuedNotificationChangedByUserInEditor = false;
 
-            //LOGInfo( "TransformPool", "Returned an object (%d) %s\n", m_pComponentTransform_TransformChangedCallbackPool.GetNumUsed(), ((ComponentBase*)pObj)->m_pGameObject->GetName() );
-        }
+    UpdateTransform();
+    NotifyTransformChangedObservers( changedByUserInEditor );
 
-        pNode = pNextNode;
-    }
+    m_Stats.m_NotificationsSent++;
 }
 
-void ComponentTransform::OnParentTransformChanged(const Vector3& newPos, const Vector3& newRot, const Vector3& newScale, bool changedByUserInEditor)
+void ComponentTransform::NotifyTransformChangedObservers(bool changedByUserInEditor)
 {
-    m_LocalTransformIsDirty = true;
-    UpdateTransform();
-
-    for( CPPListNode* pNode = m_TransformChangedCallbackList.GetHead(); pNode != nullptr; pNode = pNode->GetNext() )
+    for( unsigned int slot = m_TransformChangedObservers.GetFirstSlot(); slot != ObserverPool::INVALID_SLOT; )
     {
-        TransformChangedCallbackStruct* pCallbackStruct = (TransformChangedCallbackStruct*)pNode;
+        // Grab the next slot first, the callback might unregister itself.
+        unsigned int nextSlot = m_TransformChangedObservers.GetNextSlot( slot );
 
-        pCallbackStruct->pFunc( pCallbackStruct->pObj, m_WorldPosition, m_WorldRotation, m_WorldScale, changedByUserInEditor );
+        ObserverPool::Slot& observer = m_TransformChangedObservers.GetSlot( slot );
+        ((TransformChangedCallbackFunc*)observer.m_pFunc)( observer.m_pObj, m_WorldPosition, m_WorldRotation, m_WorldScale, changedByUserInEditor );
+
+        slot = nextSlot;
     }
 }
+
+void ComponentTransform::OnParentTransformChanged(const Vector3& newPos, const Vector3& newRot, const Vector3& newScale, bool changedByUserInEditor)
+{
+    // Our world transform will be rebuilt when it's next read since our parent's version changed,
+    //     just pass the notification on to our own observers.
+    QueueTransformChangedNotification( changedByUserInEditor );
+}
@@ -15,12 +15,24 @@
 
 class ComponentTransform : public ComponentBase
 {
+public:
+    struct Stats
+    {
+        unsigned int m_WorldTransformsRecalculated;
+        unsigned int m_NotificationsQueued;
+        unsigned int m_NotificationsSent;
+    };
+
 private:
     // Component Variable List
     MYFW_COMPONENT_DECLARE_VARIABLE_LIST( ComponentTransform );
 
 protected:
-    CPPListHead m_TransformChangedCallbackList;
+    static Stats m_Stats;
+
+    ObserverList m_TransformChangedObservers;
+    int m_QueuedNotificationIndex; // Index in the ComponentSystemManager's queue, -1 if no notification is pending.
+    bool m_QueuedNotificationChangedByUserInEditor;
 
     ComponentTransform* m_pParentTransform; // This is redundant for slightly faster access to transform; The parent GameObject is stored in GameObject.
 
@@ -29,6 +41,11 @@ protected:
     Vector3 m_WorldPosition;
     Vector3 m_WorldRotation; // In degrees.
     Vector3 m_WorldScale;
+    unsigned int m_WorldTransformVersion; // Bumped each time m_WorldTransform changes, children compare against it.
+    unsigned int m_ParentWorldTransformVersion; // Version of the parent's world transform ours was built from.
+
+    MyMatrix m_WorldTransformInverse; // Cached for children setting their world transform.
+    bool m_WorldTransformInverseIsDirty;
 
     MyMatrix m_LocalTransform;
     bool m_LocalTransformIsDirty;
@@ -36,6 +53,11 @@ protected:
     Vector3 m_LocalRotation; // In degrees.
     Vector3 m_LocalScale;
 
+protected:
+    void OnWorldTransformChanged();
+    void QueueTransformChangedNotification(bool changedByUserInEditor);
+    void NotifyTransformChangedObservers(bool changedByUserInEditor);
+
 public:
     ComponentTransform(EngineCore* pEngineCore, ComponentSystemManager* pComponentSystemManager);
     virtual ~ComponentTransform();
@@ -75,12 +97,13 @@ public:
     void SetWorldTransformIsDirty() { m_WorldTransformIsDirty = true; }
     void SetWorldTransform(const MyMatrix* mat);
     MyMatrix* GetWorldTransform(bool markDirty = false);
+    MyMatrix* GetWorldTransformInverse();
     Vector3 GetWorldPosition();
     Vector3 GetWorldRotation();
     Vector3 GetWorldScale();
     MyMatrix GetWorldRotPosMatrix();
 
-    // Recalculate the matrix each time we set any of the 3 properties. // Not efficient.
+    // Setters only mark the transform dirty, the matrices are recalculated on the next read.
     void SetWorldPosition(Vector3 pos);
     void SetWorldRotation(Vector3 rot);
     void SetWorldScale(Vector3 scale);
@@ -96,10 +119,11 @@ public:
     void Rotate(MyMatrix* pRotMatrix, Vector3 pivot);
     void LookAt(Vector3 pos);
 
-    // Recalculate the matrix each time we set any of the 3 properties. // Not efficient.
+    // Setters only mark the transform dirty, the matrices are recalculated on the next read.
     void SetLocalPosition(Vector3 pos);
     void SetLocalRotation(Vector3 rot);
     void SetLocalScale(Vector3 scale);
+    void SetLocalPositionRotationScale(Vector3 pos, Vector3 rot, Vector3 scale); // Sets all 3 with a single update.
 
     void UpdateLocalSRT();
     void UpdateWorldSRT();
@@ -107,7 +131,11 @@ public:
 
     // Callbacks.
     void RegisterTransformChangedCallback(void* pObj, TransformChangedCallbackFunc* pCallback);
-    void UnregisterTransformChangedCallbacks(void* pObj);
+    void UnregisterTransformChangedCallback(void* pObj, TransformChangedCallbackFunc* pCallback);
+
+    // Called by the ComponentSystemManager, changes are coalesced into one notification per flush.
+    void SendQueuedTransformChangedNotification();
+    static Stats& GetStats() { return m_Stats; }
 
     // Parent transform changed.
     static void StaticOnParentTransformChanged(void* pObjectPtr, const Vector3& newPos, const Vector3& newRot, const Vector3& newScale, bool changedByUserInEditor) { ((ComponentTransform*)pObjectPtr)->OnParentTransformChanged( newPos, newRot, newScale, changedByUserInEditor ); }
@@ -129,6 +157,10 @@ public:
     virtual void FillPropertiesWindow(bool clear, bool addcomponentvariables = false, bool ignoreblockvisibleflag = false);
 
 #endif
+#if MYFW_USING_IMGUI
+    virtual void AddAllVariablesToWatchPanel(CommandStack* pCommandStack) override;
+#endif
+
     // Component variable callbacks.
     void* OnDropTransform(ComponentVariable* pVar, bool changedByInterface, int x, int y);
 
@@ -0,0 +1,180 @@
+//
+// Copyright (c) 2020 Jimmy Lord http://www.flatheadgames.com
+//
+// This software is provided 'as-is', without any express or implied warranty.  In no event will the authors be held liable for any damages arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include "MyEnginePCH.h"
+
+#include "ComponentVariableImportPlan.h"
+
+std::map<TCPPListHead<ComponentVariable*>*, ComponentVariableImportPlan*> ComponentVariableImportPlan::m_Plans;
+
+// cJSON_GetObjectItem ignores case when matching member names, labels are hashed and compared the same way.
+static uint32 HashLabel(const char* label)
+{
+    // FNV-1a.
+    uint32 hash = 2166136261u;
+    for( int i=0; label[i] != '\0'; i++ )
+    {
+        hash ^= (unsigned char)tolower( (unsigned char)label[i] );
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+static bool LabelsMatch(const char* label1, const char* label2)
+{
+    for( ; *label1 != '\0'; label1++, label2++ )
+    {
+        if( tolower( (unsigned char)*label1 ) != tolower( (unsigned char)*label2 ) )
+            return false;
+    }
+
+    return *label2 == '\0';
+}
+
+ComponentVariableImportPlan::ComponentVariableImportPlan(TCPPListHead<ComponentVariable*>* pList)
+{
+    m_NumVariablesInList = GetNumVariablesInList( pList );
+
+    for( CPPListNode* pNode = pList->GetHead(); pNode; pNode = pNode->GetNext() )
+    {
+        ComponentVariable* pVar = (ComponentVariable*)pNode;
+
+        if( pVar->m_SaveLoad == false )
+            continue;
+
+        LabelEntry label;
+        label.m_LabelHash = HashLabel( pVar->m_Label );
+        label.m_VariableIndex = (unsigned int)m_Variables.size();
+        m_Labels.push_back( label );
+
+        VariableEntry entry;
+        entry.m_pVar = pVar;
+        entry.m_FirstEnumEntry = (unsigned int)m_EnumEntries.size();
+        entry.m_NumEnumEntries = 0;
+
+        if( pVar->m_Type == ComponentVariableType::Enum || pVar->m_Type == ComponentVariableType::Flags )
+        {
+            for( int i=0; i<pVar->m_NumEnumStrings; i++ )
+            {
+                EnumEntry enumEntry;
+                enumEntry.m_Hash = HashString( pVar->m_ppEnumStrings[i] );
+                enumEntry.m_Value = i;
+                m_EnumEntries.push_back( enumEntry );
+            }
+
+            entry.m_NumEnumEntries = pVar->m_NumEnumStrings;
+
+            // Stable sort so duplicate strings resolve to the lowest value, same as the old linear search.
+            std::stable_sort( m_EnumEntries.begin() + entry.m_FirstEnumEntry, m_EnumEntries.end(),
+                [](const EnumEntry& a, const EnumEntry& b) { return a.m_Hash < b.m_Hash; } );
+        }
+
+        m_Variables.push_back( entry );
+    }
+
+    std::stable_sort( m_Labels.begin(), m_Labels.end(),
+        [](const LabelEntry& a, const LabelEntry& b) { return a.m_LabelHash < b.m_LabelHash; } );
+}
+
+ComponentVariableImportPlan* ComponentVariableImportPlan::GetPlan(TCPPListHead<ComponentVariable*>* pList)
+{
+    ComponentVariableImportPlan*& pPlan = m_Plans[pList];
+
+    // Variables lists are registered once per class, but rebuild if the list grew since the plan was made.
+    if( pPlan && pPlan->m_NumVariablesInList != GetNumVariablesInList( pList ) )
+    {
+        delete pPlan;
+        pPlan = nullptr;
+    }
+
+    if( pPlan == nullptr )
+        pPlan = MyNew ComponentVariableImportPlan( pList );
+
+    return pPlan;
+}
+
+void ComponentVariableImportPlan::ReleasePlan(TCPPListHead<ComponentVariable*>* pList)
+{
+    std::map<TCPPListHead<ComponentVariable*>*, ComponentVariableImportPlan*>::iterator it = m_Plans.find( pList );
+    if( it == m_Plans.end() )
+        return;
+
+    delete it->second;
+    m_Plans.erase( it );
+}
+
+uint32 ComponentVariableImportPlan::HashString(const char* str)
+{
+    // FNV-1a.
+    uint32 hash = 2166136261u;
+    for( int i=0; str[i] != '\0'; i++ )
+    {
+        hash ^= (unsigned char)str[i];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+int ComponentVariableImportPlan::GetNumVariablesInList(TCPPListHead<ComponentVariable*>* pList)
+{
+    // Variables are indexed in the order they're added, so the tail's index gives the count.
+    ComponentVariable* pTail = (ComponentVariable*)pList->GetTail();
+    if( pTail == nullptr )
+        return 0;
+
+    return pTail->m_Index + 1;
+}
+
+void ComponentVariableImportPlan::FindJSONMembers(cJSON* jObject, cJSON** ppMembers) const
+{
+    for( unsigned int i=0; i<m_Variables.size(); i++ )
+        ppMembers[i] = nullptr;
+
+    for( cJSON* jMember = jObject->child; jMember; jMember = jMember->next )
+    {
+        if( jMember->string == nullptr )
+            continue;
+
+        uint32 hash = HashLabel( jMember->string );
+
+        std::vector<LabelEntry>::const_iterator it = std::lower_bound( m_Labels.begin(), m_Labels.end(), hash,
+            [](const LabelEntry& entry, uint32 hash) { return entry.m_LabelHash < hash; } );
+
+        // Every variable with this label gets the member, unless an earlier member with the same name already matched.
+        for( ; it != m_Labels.end() && it->m_LabelHash == hash; it++ )
+        {
+            if( ppMembers[it->m_VariableIndex] == nullptr && LabelsMatch( m_Variables[it->m_VariableIndex].m_pVar->m_Label, jMember->string ) )
+                ppMembers[it->m_VariableIndex] = jMember;
+        }
+    }
+}
+
+bool ComponentVariableImportPlan::FindEnumValue(const VariableEntry* pEntry, const char* str, int* pValue) const
+{
+    uint32 hash = HashString( str );
+
+    std::vector<EnumEntry>::const_iterator first = m_EnumEntries.begin() + pEntry->m_FirstEnumEntry;
+    std::vector<EnumEntry>::const_iterator last = first + pEntry->m_NumEnumEntries;
+
+    std::vector<EnumEntry>::const_iterator it = std::lower_bound( first, last, hash,
+        [](const EnumEntry& entry, uint32 hash) { return entry.m_Hash < hash; } );
+
+    for( ; it != last && it->m_Hash == hash; it++ )
+    {
+        if( strcmp( pEntry->m_pVar->m_ppEnumStrings[it->m_Value], str ) == 0 )
+        {
+            *pValue = it->m_Value;
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,72 @@
+//
+// Copyright (c) 2020 Jimmy Lord http://www.flatheadgames.com
+//
+// This software is provided 'as-is', without any express or implied warranty.  In no event will the authors be held liable for any damages arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#ifndef __ComponentVariableImportPlan_H__
+#define __ComponentVariableImportPlan_H__
+
+#include "ComponentVariable.h"
+
+// Precomputed lookup tables used by ComponentBase::ImportVariablesFromJSON.
+// One plan is built per ComponentVariable list (i.e. per component class) the first time it's imported,
+//     JSON members are then matched to variables by hashed label and enum/flag strings are resolved by hash,
+//     so an import is a single pass over the JSON object's children followed by a pass over the variables.
+// Not thread safe, the plans are shared by all components and must only be used on the main thread.
+class ComponentVariableImportPlan
+{
+public:
+    struct EnumEntry
+    {
+        uint32 m_Hash;
+        int m_Value;
+    };
+
+    struct VariableEntry
+    {
+        ComponentVariable* m_pVar;
+        unsigned int m_FirstEnumEntry; // Index into m_EnumEntries, enum strings for this variable are sorted by hash.
+        unsigned int m_NumEnumEntries;
+    };
+
+    struct LabelEntry
+    {
+        uint32 m_LabelHash;
+        unsigned int m_VariableIndex;
+    };
+
+protected:
+    static std::map<TCPPListHead<ComponentVariable*>*, ComponentVariableImportPlan*> m_Plans;
+
+    std::vector<VariableEntry> m_Variables; // In list order, only contains variables with m_SaveLoad set.
+    std::vector<LabelEntry> m_Labels; // Sorted by label hash, ties stay in list order.
+    std::vector<EnumEntry> m_EnumEntries;
+    int m_NumVariablesInList; // Used to detect variables being added to the list after the plan was built.
+
+protected:
+    ComponentVariableImportPlan(TCPPListHead<ComponentVariable*>* pList);
+
+public:
+    // Returns the plan for this list, building it if needed.
+    static ComponentVariableImportPlan* GetPlan(TCPPListHead<ComponentVariable*>* pList);
+    // Called when a list is cleared, the variables the plan points to are about to be deleted.
+    static void ReleasePlan(TCPPListHead<ComponentVariable*>* pList);
+
+    static uint32 HashString(const char* str);
+    static int GetNumVariablesInList(TCPPListHead<ComponentVariable*>* pList);
+
+    unsigned int GetNumVariables() const { return (unsigned int)m_Variables.size(); }
+    const VariableEntry* GetVariable(unsigned int index) const { return &m_Variables[index]; }
+
+    // Fills ppMembers, one per variable, with the first JSON member whose name matches the variable's label the way
+    //     cJSON_GetObjectItem does, so imports see the same member they would by looking each label up.
+    void FindJSONMembers(cJSON* jObject, cJSON** ppMembers) const;
+
+    bool FindEnumValue(const VariableEntry* pEntry, const char* str, int* pValue) const;
+};
+
+#endif //__ComponentVariableImportPlan_H__
@@ -0,0 +1,157 @@
+//
+// Copyright (c) 2020 Jimmy Lord http://www.flatheadgames.com
+//
+// This software is provided 'as-is', without any express or implied warranty.  In no event will the authors be held liable for any damages arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include "MyEnginePCH.h"
+
+#include "ComponentCallbackList.h"
+
+ComponentCallbackList::ComponentCallbackList()
+{
+    m_NumEmptySlots = 0;
+    m_DispatchDepth = 0;
+    m_KeepOrder = false;
+}
+
+ComponentCallbackList::~ComponentCallbackList()
+{
+    // If a component didn't unregister its callbacks, assert.
+    MyAssert( GetCount() == 0 );
+}
+
+void ComponentCallbackList::Add(ComponentCallbackStructBase* pCallback)
+{
+    MyAssert( pCallback->m_Index == -1 );
+
+    pCallback->m_Index = (int)m_Callbacks.size();
+    m_Callbacks.push_back( pCallback );
+}
+
+void ComponentCallbackList::Remove(ComponentCallbackStructBase* pCallback)
+{
+    if( pCallback->m_Index == -1 )
+        return;
+
+    unsigned int index = (unsigned int)pCallback->m_Index;
+    MyAssert( index < m_Callbacks.size() && m_Callbacks[index] == pCallback );
+
+    pCallback->m_Index = -1;
+
+    // The callback struct might be deleted along with its component, so forget about any pending moves.
+    for( unsigned int i=0; i<m_PendingMovesToFront.size(); i++ )
+    {
+        if( m_PendingMovesToFront[i] == pCallback )
+        {
+            m_PendingMovesToFront.erase( m_PendingMovesToFront.begin() + i );
+            i--;
+        }
+    }
+
+    if( m_KeepOrder || m_DispatchDepth > 0 )
+    {
+        m_Callbacks[index] = nullptr;
+        m_NumEmptySlots++;
+        return;
+    }
+
+    // There are no holes outside of a dispatch for unordered lists, so the last entry is always valid.
+    ComponentCallbackStructBase* pLast = m_Callbacks.back();
+    m_Callbacks[index] = pLast;
+    pLast->m_Index = (int)index;
+    m_Callbacks.pop_back();
+}
+
+void ComponentCallbackList::MoveToFront(ComponentCallbackStructBase* pCallback)
+{
+    if( pCallback->m_Index == -1 )
+        return;
+
+    // Shifting entries would break the loop dispatching this list, so wait until it's done.
+    if( m_DispatchDepth > 0 )
+    {
+        m_PendingMovesToFront.push_back( pCallback );
+        return;
+    }
+
+    ApplyMoveToFront( pCallback );
+}
+
+void ComponentCallbackList::ApplyMoveToFront(ComponentCallbackStructBase* pCallback)
+{
+    Compact();
+
+    unsigned int index = (unsigned int)pCallback->m_Index;
+    for( unsigned int i=index; i>0; i-- )
+    {
+        m_Callbacks[i] = m_Callbacks[i-1];
+        m_Callbacks[i]->m_Index = (int)i;
+    }
+
+    m_Callbacks[0] = pCallback;
+    pCallback->m_Index = 0;
+}
+
+ComponentCallbackStructBase* ComponentCallbackList::GetFront()
+{
+    // Pending moves are applied in order, so the last one requested will end up in front.
+    if( m_PendingMovesToFront.size() > 0 )
+        return m_PendingMovesToFront.back();
+
+    for( unsigned int i=0; i<m_Callbacks.size(); i++ )
+    {
+        if( m_Callbacks[i] != nullptr )
+            return m_Callbacks[i];
+    }
+
+    return nullptr;
+}
+
+void ComponentCallbackList::BeginDispatch()
+{
+    if( m_DispatchDepth == 0 )
+        Compact();
+
+    m_DispatchDepth++;
+}
+
+void ComponentCallbackList::EndDispatch()
+{
+    MyAssert( m_DispatchDepth > 0 );
+
+    m_DispatchDepth--;
+    if( m_DispatchDepth > 0 )
+        return;
+
+    Compact();
+
+    for( unsigned int i=0; i<m_PendingMovesToFront.size(); i++ )
+    {
+        ApplyMoveToFront( m_PendingMovesToFront[i] );
+    }
+    m_PendingMovesToFront.clear();
+}
+
+void ComponentCallbackList::Compact()
+{
+    if( m_NumEmptySlots == 0 )
+        return;
+
+    unsigned int count = 0;
+    for( unsigned int i=0; i<m_Callbacks.size(); i++ )
+    {
+        if( m_Callbacks[i] == nullptr )
+            continue;
+
+        m_Callbacks[count] = m_Callbacks[i];
+        m_Callbacks[count]->m_Index = (int)count;
+        count++;
+    }
+
+    m_Callbacks.resize( count );
+    m_NumEmptySlots = 0;
+}
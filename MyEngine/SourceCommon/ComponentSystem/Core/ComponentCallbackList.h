@@ -0,0 +1,71 @@
+//
+// Copyright (c) 2020 Jimmy Lord http://www.flatheadgames.com
+//
+// This software is provided 'as-is', without any express or implied warranty.  In no event will the authors be held liable for any damages arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#ifndef __ComponentCallbackList_H__
+#define __ComponentCallbackList_H__
+
+class ComponentBase;
+
+// Base for the ComponentCallbackStruct_* types declared in ComponentSystemManager.h.
+struct ComponentCallbackStructBase
+{
+    ComponentBase* pObj;
+    int m_Index; // Slot in the ComponentCallbackList this is registered with, -1 if not registered.
+
+    ComponentCallbackStructBase()
+    {
+        pObj = nullptr;
+        m_Index = -1;
+    }
+
+    bool IsRegistered() { return m_Index != -1; }
+};
+
+// Dense array of callbacks, components are only in it while they're enabled.
+// Removing is O(1), the last entry is swapped into the hole.
+// Lists that keep their order (draw order, input priority) and lists being dispatched leave a nullptr instead,
+//     the holes are closed up before the next dispatch.
+class ComponentCallbackList
+{
+protected:
+    std::vector<ComponentCallbackStructBase*> m_Callbacks;
+    std::vector<ComponentCallbackStructBase*> m_PendingMovesToFront; // Moves requested while dispatching.
+    unsigned int m_NumEmptySlots;
+    unsigned int m_DispatchDepth;
+    bool m_KeepOrder;
+
+protected:
+    void Compact();
+    void ApplyMoveToFront(ComponentCallbackStructBase* pCallback);
+
+public:
+    ComponentCallbackList();
+    ~ComponentCallbackList();
+
+    void SetKeepOrder(bool keepOrder) { m_KeepOrder = keepOrder; }
+
+    void Add(ComponentCallbackStructBase* pCallback);
+    void Remove(ComponentCallbackStructBase* pCallback);
+    void MoveToFront(ComponentCallbackStructBase* pCallback);
+
+    // Wrap loops over the list in these, entries can be nullptr while dispatching.
+    void BeginDispatch();
+    void EndDispatch();
+
+    unsigned int GetArraySize() { return (unsigned int)m_Callbacks.size(); }
+    ComponentCallbackStructBase* GetCallback(unsigned int index) { return m_Callbacks[index]; }
+
+    // First callback in the list, including moves to the front that are waiting for a dispatch to end.
+    ComponentCallbackStructBase* GetFront();
+
+    // Number of registered callbacks.
+    unsigned int GetCount() { return (unsigned int)m_Callbacks.size() - m_NumEmptySlots; }
+};
+
+#endif //__ComponentCallbackList_H__
@@ -10,9 +10,19 @@
 #include "MyEnginePCH.h"
 
 #include "ComponentSystemManager.h"
+#include "ComponentCallbackList.h"
 #include "PrefabManager.h"
+#include "PrefabInstantiationTemplate.h"
+#include "LightRegistry.h"
+#include "ParticleSystemManager.h"
+#include "SpriteBatcher.h"
+#include "RenderGraph_BVH.h"
+#include "RenderTargetPool.h"
+#include "SceneArena.h"
+#include "SceneLoader.h"
 #include "ComponentSystem/BaseComponents/ComponentCamera.h"
 #include "ComponentSystem/BaseComponents/ComponentInputHandler.h"
+#include "ComponentSystem/BaseComponents/ComponentRenderable.h"
 #include "ComponentSystem/BaseComponents/ComponentTransform.h"
 #include "ComponentSystem/Core/ComponentTypeManager.h"
 #include "ComponentSystem/Core/EngineFileManager.h"
@@ -56,12 +66,18 @@ ComponentSystemManager::ComponentSystemManager(ComponentTypeManager* pTypeManage
     m_pGameObjectTemplateManager = MyNew GameObjectTemplateManager();
 #endif
 
-    // Create a pool of transform changed callback objects.
-    if( m_pComponentTransform_TransformChangedCallbackPool.IsInitialized() == false )
-        m_pComponentTransform_TransformChangedCallbackPool.AllocateObjects( CALLBACK_POOL_SIZE );
+    // Draw order and input priority depend on the order of these lists.
+    m_ComponentCallbackList_Draw.SetKeepOrder( true );
+    m_ComponentCallbackList_OnTouch.SetKeepOrder( true );
+    m_ComponentCallbackList_OnButtons.SetKeepOrder( true );
+    m_ComponentCallbackList_OnKeys.SetKeepOrder( true );
 
     // Initialize managers.
     m_pPrefabManager = MyNew PrefabManager( m_pEngineCore );
+    m_pLightRegistry = MyNew LightRegistry( m_pEngineCore );
+    m_pParticleSystemManager = MyNew ParticleSystemManager();
+    m_pSpriteBatcher = MyNew SpriteBatcher( m_pEngineCore );
+    m_pRenderTargetPool = MyNew RenderTargetPool( m_pEngineCore );
 
     EventManager* pEventManager = m_pEngineCore->GetManagers()->GetEventManager();
     pEventManager->RegisterForEvents( "GameObjectEnable", this, &ComponentSystemManager::StaticOnEvent );
@@ -85,9 +101,16 @@ ComponentSystemManager::ComponentSystemManager(ComponentTypeManager* pTypeManage
 
     m_TimeScale = 1;
 
+    m_StaticRenderablesVersion = 0;
+
+    // The flat and octree graphs don't support the object filter used to split static and dynamic shadow casters.
     //m_pRenderGraph = MyNew RenderGraph_Flat();
-    int depth = 3;
-    m_pRenderGraph = MyNew RenderGraph_Octree( m_pEngineCore, depth, -32, -32, -32, 32, 32, 32 );
+    //int depth = 3;
+    //m_pRenderGraph = MyNew RenderGraph_Octree( m_pEngineCore, depth, -32, -32, -32, 32, 32, 32 );
+    m_pRenderGraph = MyNew RenderGraph_BVH( m_pEngineCore );
+    m_UseSceneArenas = true;
+    m_ParseScenesInParallel = true;
+    m_pSceneLoadIDMap = nullptr;
 
     for( int i=0; i<MAX_SCENES_LOADED_INCLUDING_UNMANAGED; i++ )
     {
@@ -136,16 +159,20 @@ ComponentSystemManager::~ComponentSystemManager()
     
     SAFE_DELETE( m_pRenderGraph );
 
+    // All emitters and sprites were destroyed with their scenes above, so they've all unregistered.
+    SAFE_DELETE( m_pParticleSystemManager );
+    SAFE_DELETE( m_pSpriteBatcher );
+    SAFE_DELETE( m_pLightRegistry );
+    SAFE_DELETE( m_pRenderTargetPool );
+
     // If a component didn't unregister its callbacks, assert.
-    MyAssert( m_pComponentCallbackList_Tick.GetHead() == nullptr );
-    MyAssert( m_pComponentCallbackList_OnSurfaceChanged.GetHead() == nullptr );
-    MyAssert( m_pComponentCallbackList_Draw.GetHead() == nullptr );
-    MyAssert( m_pComponentCallbackList_OnTouch.GetHead() == nullptr );
-    MyAssert( m_pComponentCallbackList_OnButtons.GetHead() == nullptr );
-    MyAssert( m_pComponentCallbackList_OnKeys.GetHead() == nullptr );
-    MyAssert( m_pComponentCallbackList_OnFileRenamed.GetHead() == nullptr );
-    
-    m_pComponentTransform_TransformChangedCallbackPool.FreeObjects();
+    MyAssert( m_ComponentCallbackList_Tick.GetCount() == 0 );
+    MyAssert( m_ComponentCallbackList_OnSurfaceChanged.GetCount() == 0 );
+    MyAssert( m_ComponentCallbackList_Draw.GetCount() == 0 );
+    MyAssert( m_ComponentCallbackList_OnTouch.GetCount() == 0 );
+    MyAssert( m_ComponentCallbackList_OnButtons.GetCount() == 0 );
+    MyAssert( m_ComponentCallbackList_OnKeys.GetCount() == 0 );
+    MyAssert( m_ComponentCallbackList_OnFileRenamed.GetCount() == 0 );
 
     g_pComponentSystemManager = nullptr;
 }
@@ -154,39 +181,22 @@ ComponentSystemManager::~ComponentSystemManager()
 #define MYFW_COMPONENTSYSTEMMANAGER_IMPLEMENT_CALLBACK_REGISTER_FUNCTIONS(CallbackType) \
     void ComponentSystemManager::RegisterComponentCallback_##CallbackType(ComponentCallbackStruct_##CallbackType* pCallbackStruct) \
     { \
-        MyAssert( pCallbackStruct->pFunc != nullptr && pCallbackStruct->pObj != nullptr && pCallbackStruct->Prev == nullptr && pCallbackStruct->Next == nullptr ); \
-        m_pComponentCallbackList_##CallbackType.AddTail( pCallbackStruct ); \
+        MyAssert( pCallbackStruct->pFunc != nullptr && pCallbackStruct->pObj != nullptr && pCallbackStruct->IsRegistered() == false ); \
+        m_ComponentCallbackList_##CallbackType.Add( pCallbackStruct ); \
     } \
     void ComponentSystemManager::UnregisterComponentCallback_##CallbackType(ComponentCallbackStruct_##CallbackType* pCallbackStruct) \
     { \
-        if( pCallbackStruct->Prev ) \
-        { \
-            pCallbackStruct->Remove(); \
-            pCallbackStruct->Next = nullptr; \
-            pCallbackStruct->Prev = nullptr; \
-        } \
+        m_ComponentCallbackList_##CallbackType.Remove( pCallbackStruct ); \
     }
 
 MYFW_COMPONENTSYSTEMMANAGER_IMPLEMENT_CALLBACK_REGISTER_FUNCTIONS( Tick );
 MYFW_COMPONENTSYSTEMMANAGER_IMPLEMENT_CALLBACK_REGISTER_FUNCTIONS( OnSurfaceChanged );
-//MYFW_COMPONENTSYSTEMMANAGER_IMPLEMENT_CALLBACK_REGISTER_FUNCTIONS( Draw ); // declared manually below
+MYFW_COMPONENTSYSTEMMANAGER_IMPLEMENT_CALLBACK_REGISTER_FUNCTIONS( Draw );
 MYFW_COMPONENTSYSTEMMANAGER_IMPLEMENT_CALLBACK_REGISTER_FUNCTIONS( OnTouch );
 MYFW_COMPONENTSYSTEMMANAGER_IMPLEMENT_CALLBACK_REGISTER_FUNCTIONS( OnButtons );
 MYFW_COMPONENTSYSTEMMANAGER_IMPLEMENT_CALLBACK_REGISTER_FUNCTIONS( OnKeys );
 MYFW_COMPONENTSYSTEMMANAGER_IMPLEMENT_CALLBACK_REGISTER_FUNCTIONS( OnFileRenamed );
 
-void ComponentSystemManager::RegisterComponentCallback_Draw(ComponentCallbackStruct_Draw* pCallbackStruct)
-{
-    MyAssert( pCallbackStruct->pFunc != nullptr && pCallbackStruct->pObj != nullptr );
-    m_pComponentCallbackList_Draw.AddTail( pCallbackStruct );
-}
-
-void ComponentSystemManager::UnregisterComponentCallback_Draw(ComponentCallbackStruct_Draw* pCallbackStruct)
-{
-    if( pCallbackStruct->Prev )
-        pCallbackStruct->Remove();
-}
-
 #if MYFW_USING_LUA
 void ComponentSystemManager::LuaRegister(lua_State* luastate)
 {
@@ -996,15 +1006,16 @@ void ComponentSystemManager::FreeAllDataFiles(SceneID sceneIDToClear)
 
 void ComponentSystemManager::LoadSceneFromJSON(const char* sceneName, const char* jsonString, SceneID sceneID)
 {
-    cJSON* jRoot = cJSON_Parse( jsonString );
+    double startTime = MyTime_GetSystemTime();
+
+    bool getSceneIDFromEachObject = (sceneID == SCENEID_TempPlayStop);
 
-    if( jRoot == nullptr )
+    // Split the scene into one block per object and parse the blocks on the job threads.
+    SceneLoader loader( m_pComponentTypeManager );
+    if( loader.Parse( jsonString, sceneID, getSceneIDFromEachObject, m_ParseScenesInParallel ) == false )
         return;
 
-    cJSON* jFileArray = cJSON_GetObjectItem( jRoot, "Files" );
-    cJSON* jGameobjectArray = cJSON_GetObjectItem( jRoot, "GameObjects" );
-    cJSON* jTransformArray = cJSON_GetObjectItem( jRoot, "Transforms" );
-    cJSON* jComponentArray = cJSON_GetObjectItem( jRoot, "Components" );
+    double createStartTime = MyTime_GetSystemTime();
 
 #if MYFW_EDITOR
     if( sceneID != SCENEID_TempPlayStop )
@@ -1015,15 +1026,16 @@ void ComponentSystemManager::LoadSceneFromJSON(const char* sceneName, const char
     // Create the Box2D world.
     MyAssert( sceneID >= SCENEID_MainScene && sceneID < MAX_SCENES_LOADED_INCLUDING_UNMANAGED );
     MyAssert( m_pSceneInfoMap[sceneID].m_pBox2DWorld == nullptr );
-    m_pSceneInfoMap[sceneID].m_pBox2DWorld = MyNew Box2DWorld( nullptr, nullptr, nullptr, new EngineBox2DContactListener );
+    m_pSceneInfoMap[sceneID].m_pBox2DContactListener = new EngineBox2DContactListener;
+    m_pSceneInfoMap[sceneID].m_pBox2DWorld = MyNew Box2DWorld( nullptr, nullptr, nullptr, m_pSceneInfoMap[sceneID].m_pBox2DContactListener );
 #endif //MYFW_EDITOR
 
     // Request all files used by scene.
-    if( jFileArray && sceneID != SCENEID_TempPlayStop )
+    if( sceneID != SCENEID_TempPlayStop )
     {
-        for( int i=0; i<cJSON_GetArraySize( jFileArray ); i++ )
+        for( unsigned int i=0; i<loader.GetNumBlocks( SceneLoader::BlockArray_Files ); i++ )
         {
-            cJSON* jFile = cJSON_GetArrayItem( jFileArray, i );
+            cJSON* jFile = loader.GetBlock( SceneLoader::BlockArray_Files, i )->m_jObject;
 
             if( jFile->valuestring != nullptr )
             {
@@ -1062,218 +1074,194 @@ void ComponentSystemManager::LoadSceneFromJSON(const char* sceneName, const char
         }
     }
 
-    bool getSceneIDFromEachObject = (sceneID == SCENEID_TempPlayStop);
+    // Find objects by ID through a hash map while loading, FindGameObjectByID() and FindComponentByID() also use it.
+    SceneLoadIDMap idMap;
+    for( unsigned int i=0; i<MAX_SCENES_CREATED; i++ )
+    {
+        if( m_pSceneInfoMap[i].m_GameObjects.GetHead() )
+            idMap.AddGameObjectList( (SceneID)i, m_pSceneInfoMap[i].m_GameObjects.GetHead() );
+    }
+    m_pSceneLoadIDMap = &idMap;
 
     // Create/init all the game objects.
-    if( jGameobjectArray )
+    for( unsigned int i=0; i<loader.GetNumBlocks( SceneLoader::BlockArray_GameObjects ); i++ )
     {
-        for( int i=0; i<cJSON_GetArraySize( jGameobjectArray ); i++ )
-        {
-            cJSON* jGameObject = cJSON_GetArrayItem( jGameobjectArray, i );
-
-            if( getSceneIDFromEachObject )
-                cJSONExt_GetUnsignedInt( jGameObject, "SceneID", (unsigned int*)&sceneID );
+        SceneLoaderBlock* pBlock = loader.GetBlock( SceneLoader::BlockArray_GameObjects, i );
+        MyAssert( pBlock->m_IsValid );
+        if( pBlock->m_IsValid == false )
+            continue;
 
-            unsigned int id = -1;
-            cJSONExt_GetUnsignedInt( jGameObject, "ID", &id );
-            MyAssert( id != -1 );
+        SceneID objectSceneID = pBlock->m_SceneID;
 
-            // LEGACY: Support for old scene files with folders in them, now stored as "SubType".
-            bool isFolder = false;
-            cJSONExt_GetBool( jGameObject, "IsFolder", &isFolder );
+        // Find an existing game object with the same id or create a new one.
+        GameObject* pGameObject = idMap.FindGameObject( objectSceneID, pBlock->m_ID );
+        if( pGameObject )
+        {
+            MyAssert( pGameObject->GetSceneID() == objectSceneID );
+        }
 
-            bool hasTransform = true;
-            cJSON* jSubtype = cJSON_GetObjectItem( jGameObject, "SubType" );
-            if( jSubtype )
-            {
-                if( strcmp( jSubtype->valuestring, "Folder" ) == 0 )
-                {
-                    isFolder = true;
-                    hasTransform = false;
-                }
-                else if( strcmp( jSubtype->valuestring, "Logic" ) == 0 )
-                {
-                    hasTransform = false;
-                }
-            }
+        if( pGameObject == nullptr )
+        {
+            pGameObject = CreateGameObject( true, objectSceneID, pBlock->m_IsFolder, pBlock->m_HasTransform );
+        }
 
-            // Find an existing game object with the same id or create a new one.
-            GameObject* pGameObject = FindGameObjectByID( sceneID, id );
-            if( pGameObject )
-            {
-                MyAssert( pGameObject->GetSceneID() == sceneID );
-            }
+        pGameObject->ImportFromJSONObject( pBlock->m_jObject, objectSceneID );
+        MyAssert( pGameObject->m_pEngineCore == GetEngineCore() );
 
-            if( pGameObject == nullptr )
-            {
-                pGameObject = CreateGameObject( true, sceneID, isFolder, hasTransform );
-            }
+        idMap.AddGameObject( objectSceneID, pBlock->m_ID, pGameObject );
 
-            pGameObject->ImportFromJSONObject( jGameObject, sceneID );
-            MyAssert( pGameObject->m_pEngineCore == GetEngineCore() );
-        
-            unsigned int gameObjectID = pGameObject->GetID();
-            if( gameObjectID > m_pSceneInfoMap[sceneID].m_NextGameObjectID )
-                m_pSceneInfoMap[sceneID].m_NextGameObjectID = gameObjectID + 1;
-        }
+        unsigned int gameObjectID = pGameObject->GetID();
+        if( gameObjectID > m_pSceneInfoMap[objectSceneID].m_NextGameObjectID )
+            m_pSceneInfoMap[objectSceneID].m_NextGameObjectID = gameObjectID + 1;
     }
 
     // Setup all the game object transforms.
-    if( jTransformArray )
+    for( unsigned int i=0; i<loader.GetNumBlocks( SceneLoader::BlockArray_Transforms ); i++ )
     {
-        for( int i=0; i<cJSON_GetArraySize( jTransformArray ); i++ )
-        {
-            cJSON* jTransform = cJSON_GetArrayItem( jTransformArray, i );
-        
-            if( getSceneIDFromEachObject )
-            {
-                cJSONExt_GetUnsignedInt( jTransform, "SceneID", (unsigned int*)&sceneID );
-            }
+        SceneLoaderBlock* pBlock = loader.GetBlock( SceneLoader::BlockArray_Transforms, i );
+        MyAssert( pBlock->m_IsValid );
+        if( pBlock->m_IsValid == false )
+            continue;
 
-            unsigned int gameObjectID = 0;
-            cJSONExt_GetUnsignedInt( jTransform, "GOID", &gameObjectID );
-            MyAssert( gameObjectID > 0 );
+        SceneID objectSceneID = pBlock->m_SceneID;
+        unsigned int gameObjectID = pBlock->m_GameObjectID;
 
-            GameObject* pGameObject = FindGameObjectByID( sceneID, gameObjectID );
-            MyAssert( pGameObject );
+        GameObject* pGameObject = idMap.FindGameObject( objectSceneID, gameObjectID );
+        MyAssert( pGameObject );
 
-            if( pGameObject )
-            {
-                pGameObject->SetID( gameObjectID );
+        if( pGameObject )
+        {
+            pGameObject->SetID( gameObjectID );
 
-                if( pGameObject->GetTransform() )
-                {
-                    pGameObject->GetTransform()->ImportFromJSONObject( jTransform, sceneID );
-                }
-                else
+            if( pGameObject->GetTransform() )
+            {
+                pGameObject->GetTransform()->ImportFromJSONObject( pBlock->m_jObject, objectSceneID );
+            }
+            else
+            {
+                unsigned int parentGOID = 0;
+                cJSONExt_GetUnsignedInt( pBlock->m_jObject, "ParentGOID", &parentGOID );
+            
+                if( parentGOID > 0 )
                 {
-                    unsigned int parentGOID = 0;
-                    cJSONExt_GetUnsignedInt( jTransform, "ParentGOID", &parentGOID );
-                
-                    if( parentGOID > 0 )
-                    {
-                        GameObject* pParentGameObject = FindGameObjectByID( sceneID, parentGOID );
-                        MyAssert( pParentGameObject );
+                    GameObject* pParentGameObject = idMap.FindGameObject( objectSceneID, parentGOID );
+                    MyAssert( pParentGameObject );
 
-                        pGameObject->SetParentGameObject( pParentGameObject );
-                        if( pGameObject->GetTransform() )
-                        {
-                            pGameObject->GetTransform()->SetWorldTransformIsDirty();
-                        }
+                    pGameObject->SetParentGameObject( pParentGameObject );
+                    if( pGameObject->GetTransform() )
+                    {
+                        pGameObject->GetTransform()->SetWorldTransformIsDirty();
                     }
                 }
+            }
 
-                if( gameObjectID >= m_pSceneInfoMap[sceneID].m_NextGameObjectID )
-                {
-                    m_pSceneInfoMap[sceneID].m_NextGameObjectID = gameObjectID + 1;
-                }
+            if( gameObjectID >= m_pSceneInfoMap[objectSceneID].m_NextGameObjectID )
+            {
+                m_pSceneInfoMap[objectSceneID].m_NextGameObjectID = gameObjectID + 1;
             }
         }
     }
 
     // Load inheritance info (i.e. Parent GameObjects) for objects that inherit from others.
-    if( jGameobjectArray )
+    for( unsigned int i=0; i<loader.GetNumBlocks( SceneLoader::BlockArray_GameObjects ); i++ )
     {
-        for( int i=0; i<cJSON_GetArraySize( jGameobjectArray ); i++ )
-        {
-            cJSON* jGameObject = cJSON_GetArrayItem( jGameobjectArray, i );
-
-            if( getSceneIDFromEachObject )
-                cJSONExt_GetUnsignedInt( jGameObject, "SceneID", (unsigned int*)&sceneID );
-
-            unsigned int id = -1;
-            cJSONExt_GetUnsignedInt( jGameObject, "ID", &id );
-            MyAssert( id != -1 );
+        SceneLoaderBlock* pBlock = loader.GetBlock( SceneLoader::BlockArray_GameObjects, i );
+        if( pBlock->m_IsValid == false )
+            continue;
 
-            // Find the existing game object with the same id.
-            GameObject* pGameObject = FindGameObjectByID( sceneID, id );
-            MyAssert( pGameObject );
+        // Find the existing game object with the same id.
+        GameObject* pGameObject = idMap.FindGameObject( pBlock->m_SceneID, pBlock->m_ID );
+        MyAssert( pGameObject );
 
-            pGameObject->ImportInheritanceInfoFromJSONObject( jGameObject );
-        }
+        pGameObject->ImportInheritanceInfoFromJSONObject( pBlock->m_jObject );
     }
 
-    if( jComponentArray )
+    // Add all existing components to the map, this is done after the GameObjects are imported
+    //     since linking to prefabs can add components with IDs the scene file refers to.
+    for( unsigned int i=0; i<BaseComponentType_NumTypes; i++ )
     {
-        // Create all the components, not loading component properties.
-        for( int i=0; i<cJSON_GetArraySize( jComponentArray ); i++ )
+        for( CPPListNode* pNode = m_Components[i].GetHead(); pNode; pNode = pNode->GetNext() )
         {
-            cJSON* jComponent = cJSON_GetArrayItem( jComponentArray, i );
-        
-            if( getSceneIDFromEachObject )
-            {
-                cJSONExt_GetUnsignedInt( jComponent, "SceneID", (unsigned int*)&sceneID );
-            }
+            ComponentBase* pComponent = (ComponentBase*)pNode;
+            if( idMap.FindComponent( pComponent->GetSceneID(), pComponent->GetID() ) == nullptr )
+                idMap.AddComponent( pComponent->GetSceneID(), pComponent->GetID(), pComponent );
+        }
+    }
 
-            unsigned int gameObjectID = 0;
-            cJSONExt_GetUnsignedInt( jComponent, "GOID", &gameObjectID );
-            MyAssert( gameObjectID > 0 );
-            GameObject* pGameObject = FindGameObjectByID( sceneID, gameObjectID );
-            MyAssert( pGameObject );
+    // Create all the components, not loading component properties.
+    unsigned int numComponentBlocks = loader.GetNumBlocks( SceneLoader::BlockArray_Components );
+    std::vector<ComponentBase*> components( numComponentBlocks, nullptr );
 
-            CreateComponentFromJSONObject( pGameObject, jComponent );
-        }
+    for( unsigned int i=0; i<numComponentBlocks; i++ )
+    {
+        SceneLoaderBlock* pBlock = loader.GetBlock( SceneLoader::BlockArray_Components, i );
+        MyAssert( pBlock->m_IsValid );
+        if( pBlock->m_IsValid == false )
+            continue;
 
-        // Load all the components properties after all components are created.
-        for( int i=0; i<cJSON_GetArraySize( jComponentArray ); i++ )
-        {
-            cJSON* jComponent = cJSON_GetArrayItem( jComponentArray, i );
-        
-            if( getSceneIDFromEachObject )
-            {
-                cJSONExt_GetUnsignedInt( jComponent, "SceneID", (unsigned int*)&sceneID );
-            }
+        GameObject* pGameObject = idMap.FindGameObject( pBlock->m_SceneID, pBlock->m_GameObjectID );
+        MyAssert( pGameObject );
 
-            unsigned int componentID;
-            cJSONExt_GetUnsignedInt( jComponent, "ID", &componentID );
+        if( pBlock->m_ComponentType == -1 )
+        {
+            cJSON* jType = cJSON_GetObjectItem( pBlock->m_jObject, "Type" );
+            LOGError( LOGTag, "Unknown component in scene file: %s\n", jType ? jType->valuestring : "(no type)" );
+            MyAssert( false );
+            continue;
+        }
 
-            ComponentBase* pComponent = FindComponentByID( componentID, sceneID );
-            MyAssert( pComponent );
+        components[i] = CreateComponentWithID( pGameObject, pBlock->m_ComponentType, pBlock->m_ID );
+    }
 
-            if( pComponent )
-            {
-                MyAssert( pComponent->GetComponentSystemManager() == this );
-                if( pComponent->GetGameObject()->IsEnabled() == false )
-                {
-                    pComponent->OnGameObjectDisabled();
-                }
+    double importStartTime = MyTime_GetSystemTime();
 
-                pComponent->ImportFromJSONObject( jComponent, sceneID );
-            }
-        }
+    // Load all the components properties after all components are created.
+    for( unsigned int i=0; i<numComponentBlocks; i++ )
+    {
+        SceneLoaderBlock* pBlock = loader.GetBlock( SceneLoader::BlockArray_Components, i );
+        ComponentBase* pComponent = components[i];
+        MyAssert( pComponent );
 
-        // Second pass on loading component properties for components that rely on other components being initialized.
-        for( int i=0; i<cJSON_GetArraySize( jComponentArray ); i++ )
+        if( pComponent )
         {
-            cJSON* jComponent = cJSON_GetArrayItem( jComponentArray, i );
-        
-            if( getSceneIDFromEachObject )
+            MyAssert( pComponent->GetComponentSystemManager() == this );
+            if( pComponent->GetGameObject()->IsEnabled() == false )
             {
-                cJSONExt_GetUnsignedInt( jComponent, "SceneID", (unsigned int*)&sceneID );
+                pComponent->OnGameObjectDisabled();
             }
 
-            unsigned int componentID;
-            cJSONExt_GetUnsignedInt( jComponent, "ID", &componentID );
+            pComponent->ImportFromJSONObject( pBlock->m_jObject, pBlock->m_SceneID );
+        }
+    }
 
-            ComponentBase* pComponent = FindComponentByID( componentID, sceneID );
-            MyAssert( pComponent );
+    // Second pass on loading component properties for components that rely on other components being initialized.
+    for( unsigned int i=0; i<numComponentBlocks; i++ )
+    {
+        ComponentBase* pComponent = components[i];
 
-            if( pComponent )
-            {
-                pComponent->FinishImportingFromJSONObject( jComponent );
-            }
+        if( pComponent )
+        {
+            pComponent->FinishImportingFromJSONObject( loader.GetBlock( SceneLoader::BlockArray_Components, i )->m_jObject );
         }
     }
 
-    cJSON_Delete( jRoot );
+    m_pSceneLoadIDMap = nullptr;
 
     SyncAllRigidBodiesToObjectTransforms();
+
+    double endTime = MyTime_GetSystemTime();
+
+    SceneLoader::Stats& stats = SceneLoader::GetStats();
+    stats.m_CreateTime = (float)((importStartTime - createStartTime) * 1000);
+    stats.m_ImportTime = (float)((endTime - importStartTime) * 1000);
+    stats.m_TotalTime = (float)((endTime - startTime) * 1000);
+
+    LOGInfo( LOGTag, "Scene loaded in %0.2f ms (Split: %0.2f  Parse: %0.2f on %u jobs  Create: %0.2f  Import: %0.2f)\n",
+        stats.m_TotalTime, stats.m_SplitTime, stats.m_ParseTime, stats.m_JobsUsed, stats.m_CreateTime, stats.m_ImportTime );
 }
 
 ComponentBase* ComponentSystemManager::CreateComponentFromJSONObject(GameObject* pGameObject, cJSON* jComponent)
 {
-    SceneID sceneID = pGameObject->GetSceneID();
-
     cJSON* jType = cJSON_GetObjectItem( jComponent, "Type" );
     MyAssert( jType );
     int type = -1;
@@ -1288,48 +1276,62 @@ ComponentBase* ComponentSystemManager::CreateComponentFromJSONObject(GameObject*
         }
         else
         {
-            ComponentBase* pComponent = nullptr;
-
             // If the JSON block has a component id, check if that component already exists.
             unsigned int id = 0;
-            {
-                cJSONExt_GetUnsignedInt( jComponent, "ID", &id );
+            cJSONExt_GetUnsignedInt( jComponent, "ID", &id );
 
-                if( id != 0 )
-                {
-                    pComponent = FindComponentByID( id, sceneID );
-                    if( pComponent )
-                    {
-                        MyAssert( pComponent->GetSceneID() == sceneID );
+            return CreateComponentWithID( pGameObject, type, id );
+        }
+    }
 
-                        if( id >= m_pSceneInfoMap[sceneID].m_NextComponentID )
-                            m_pSceneInfoMap[sceneID].m_NextComponentID = id + 1;
+    return nullptr;
+}
 
-                        MyAssert( pGameObject->m_pEngineCore == GetEngineCore() );
-                        MyAssert( pComponent->GetComponentSystemManager() == this );
+// Returns the existing component if one with this id is already in the GameObject's scene.
+ComponentBase* ComponentSystemManager::CreateComponentWithID(GameObject* pGameObject, int type, unsigned int id)
+{
+    SceneID sceneID = pGameObject->GetSceneID();
 
-                        return pComponent;
-                    }
-                }
-            }
+    ComponentBase* pComponent = nullptr;
 
-            // Create a new component of this type on the game object.
-            MyAssert( g_pComponentSystemManager == this );
-            pComponent = pGameObject->AddNewComponent( type, sceneID, g_pComponentSystemManager );
+    if( id != 0 )
+    {
+        // While a scene is loading the map has every component, so a miss doesn't need to walk the lists.
+        if( m_pSceneLoadIDMap )
+            pComponent = m_pSceneLoadIDMap->FindComponent( sceneID, id );
+        else
+            pComponent = FindComponentByID( id, sceneID );
 
-            // If this component had an id set in the scene file, then use it.
-            if( id != 0 )
-            {
-                pComponent->SetID( id );
-                if( id >= m_pSceneInfoMap[sceneID].m_NextComponentID )
-                    m_pSceneInfoMap[sceneID].m_NextComponentID = id + 1;
-            }
+        if( pComponent )
+        {
+            MyAssert( pComponent->GetSceneID() == sceneID );
+
+            if( id >= m_pSceneInfoMap[sceneID].m_NextComponentID )
+                m_pSceneInfoMap[sceneID].m_NextComponentID = id + 1;
+
+            MyAssert( pGameObject->m_pEngineCore == GetEngineCore() );
+            MyAssert( pComponent->GetComponentSystemManager() == this );
 
             return pComponent;
         }
     }
 
-    return nullptr;
+    // Create a new component of this type on the game object.
+    MyAssert( g_pComponentSystemManager == this );
+    pComponent = pGameObject->AddNewComponent( type, sceneID, g_pComponentSystemManager );
+
+    // If this component had an id set in the scene file, then use it.
+    if( id != 0 )
+    {
+        pComponent->SetID( id );
+        if( id >= m_pSceneInfoMap[sceneID].m_NextComponentID )
+            m_pSceneInfoMap[sceneID].m_NextComponentID = id + 1;
+
+        if( m_pSceneLoadIDMap )
+            m_pSceneLoadIDMap->AddComponent( sceneID, id, pComponent );
+    }
+
+    return pComponent;
 }
 
 void ComponentSystemManager::FinishLoading(bool lockWhileLoading, SceneID sceneID, bool playWhenFinishedLoading)
@@ -1476,6 +1478,12 @@ void ComponentSystemManager::UnloadScene(SceneID sceneIDToClear, bool clearUnman
         MyAssert( m_pSceneInfoMap[sceneIDToClear].m_InUse == true );
         m_pSceneInfoMap[sceneIDToClear].Reset();
     }
+
+    // The unmanaged scene is never reset, but its arena can still be released, new objects will get a fresh one.
+    if( sceneIDToClear == SCENEID_AllScenes || sceneIDToClear == SCENEID_Unmanaged )
+    {
+        m_pSceneInfoMap[SCENEID_Unmanaged].ReleaseArena();
+    }
 }
 
 bool ComponentSystemManager::IsSceneLoaded(const char* fullPath)
@@ -1525,7 +1533,14 @@ GameObject* ComponentSystemManager::EditorLua_CreateGameObject(const char* name,
 
 GameObject* ComponentSystemManager::CreateGameObject(bool manageObject, SceneID sceneID, bool isFolder, bool hasTransform, PrefabReference* pPrefabRef)
 {
-    GameObject* pGameObject = MyNew GameObject( m_pEngineCore, manageObject, sceneID, isFolder, hasTransform, pPrefabRef );
+    GameObject* pGameObject = nullptr;
+
+    SceneArena* pArena = GetArenaForScene( sceneID );
+    void* pMemory = pArena ? pArena->Allocate( sizeof(GameObject) ) : nullptr;
+    if( pMemory )
+        pGameObject = new(pMemory) GameObject( m_pEngineCore, manageObject, sceneID, isFolder, hasTransform, pPrefabRef );
+    else
+        pGameObject = MyNew GameObject( m_pEngineCore, manageObject, sceneID, isFolder, hasTransform, pPrefabRef );
     
     {
         unsigned int id = GetNextGameObjectIDAndIncrement( sceneID );
@@ -1546,8 +1561,39 @@ GameObject* ComponentSystemManager::CreateGameObject(bool manageObject, SceneID
     return pGameObject;
 }
 
+ComponentBase* ComponentSystemManager::CreateComponent(int type, SceneID sceneID)
+{
+    // The type manager allocates from this arena while it's set.
+    m_pComponentTypeManager->SetAllocationArena( GetArenaForScene( sceneID ) );
+    ComponentBase* pComponent = m_pComponentTypeManager->CreateComponent( type );
+    m_pComponentTypeManager->SetAllocationArena( nullptr );
+
+    return pComponent;
+}
+
+SceneArena* ComponentSystemManager::GetArenaForScene(SceneID sceneID)
+{
+    if( m_UseSceneArenas == false )
+        return nullptr;
+
+    SceneInfo* pSceneInfo = GetSceneInfo( sceneID );
+    if( pSceneInfo->m_pArena == nullptr )
+        pSceneInfo->m_pArena = MyNew SceneArena();
+
+    return pSceneInfo->m_pArena;
+}
+
 GameObject* ComponentSystemManager::CreateGameObjectFromPrefab(PrefabObject* pPrefab, bool manageObject, SceneID sceneID)
 {
+    // At runtime, copy from the prefab's compiled template instead of importing the JSON for every instance.
+    // The editor and the master prefab GameObjects still go through the JSON so inheritance gets set up.
+    if( sceneID != SCENEID_Unmanaged && g_pEngineCore->IsInEditorMode() == false )
+    {
+        PrefabInstantiationTemplate* pTemplate = pPrefab->GetInstantiationTemplate();
+        if( pTemplate->IsValid() )
+            return pTemplate->Instantiate( manageObject, sceneID );
+    }
+
     return CreateGameObjectFromPrefab( pPrefab, pPrefab->GetJSONObject(), 0, manageObject, sceneID );
 }
 
@@ -1793,11 +1839,17 @@ void ComponentSystemManager::DeleteGameObject(GameObject* pObject, bool deleteCo
         {
             ComponentBase* pComponent = pObject->m_Components.RemoveIndex( 0 );
 
+            if( m_pSceneLoadIDMap )
+                m_pSceneLoadIDMap->RemoveComponent( pComponent );
+
             pComponent->SetEnabled( false );
             delete pComponent;
         }
     }
 
+    if( m_pSceneLoadIDMap )
+        m_pSceneLoadIDMap->RemoveGameObject( pObject );
+
     SAFE_DELETE( pObject );
 }
 
@@ -1964,6 +2016,13 @@ GameObject* ComponentSystemManager::GetFirstGameObjectFromScene(SceneID sceneID)
 
 GameObject* ComponentSystemManager::FindGameObjectByID(SceneID sceneID, unsigned int goid)
 {
+    if( m_pSceneLoadIDMap )
+    {
+        GameObject* pGameObject = m_pSceneLoadIDMap->FindGameObject( sceneID, goid );
+        if( pGameObject )
+            return pGameObject;
+    }
+
     SceneInfo* pSceneInfo = GetSceneInfo( sceneID );
     if( pSceneInfo == nullptr )
         return nullptr;
@@ -2222,6 +2281,9 @@ ComponentBase* ComponentSystemManager::AddComponent(ComponentBase* pComponent)
 
 void ComponentSystemManager::DeleteComponent(ComponentBase* pComponent)
 {
+    if( m_pSceneLoadIDMap )
+        m_pSceneLoadIDMap->RemoveComponent( pComponent );
+
     if( pComponent->GetGameObject() )
     {
         pComponent->GetGameObject()->RemoveComponent( pComponent );
@@ -2233,6 +2295,13 @@ void ComponentSystemManager::DeleteComponent(ComponentBase* pComponent)
 
 ComponentBase* ComponentSystemManager::FindComponentByID(unsigned int id, SceneID sceneID)
 {
+    if( m_pSceneLoadIDMap )
+    {
+        ComponentBase* pComponent = m_pSceneLoadIDMap->FindComponent( sceneID, id );
+        if( pComponent )
+            return pComponent;
+    }
+
     for( unsigned int i=0; i<BaseComponentType_NumTypes; i++ )
     {
         for( CPPListNode* pNode = m_Components[i].GetHead(); pNode;  )
@@ -2307,15 +2376,24 @@ void ComponentSystemManager::Tick(float deltaTime)
     }
 
     // Update all components that registered a tick callback... might unregister themselves while in their callback
-    for( CPPListNode* pNode = m_pComponentCallbackList_Tick.GetHead(); pNode != nullptr; pNode = pNextNode )
+    m_ComponentCallbackList_Tick.BeginDispatch();
+    for( unsigned int i=0; i<m_ComponentCallbackList_Tick.GetArraySize(); i++ )
     {
-        pNextNode = pNode->GetNext();
+        ComponentCallbackStruct_Tick* pCallbackStruct = (ComponentCallbackStruct_Tick*)m_ComponentCallbackList_Tick.GetCallback( i );
+        if( pCallbackStruct == nullptr )
+            continue;
 
-        ComponentCallbackStruct_Tick* pCallbackStruct = (ComponentCallbackStruct_Tick*)pNode;
         MyAssert( pCallbackStruct->pFunc != nullptr );
 
         (pCallbackStruct->pObj->*pCallbackStruct->pFunc)( deltaTime );
     }
+    m_ComponentCallbackList_Tick.EndDispatch();
+
+    // Let observers know about any transforms moved by physics or the components above.
+    SendQueuedTransformChangedNotifications();
+
+    // Update all particle emitters, spread across the job threads.
+    m_pParticleSystemManager->Tick( deltaTime );
 
     // Update all cameras after game objects are updated.
     for( CPPListNode* pNode = m_Components[BaseComponentType_Camera].GetHead(); pNode != nullptr; pNode = pNode->GetNext() )
@@ -2329,6 +2407,35 @@ void ComponentSystemManager::Tick(float deltaTime)
     }
 }
 
+int ComponentSystemManager::QueueTransformChangedNotification(ComponentTransform* pTransform)
+{
+    m_TransformChangedNotificationQueue.push_back( pTransform );
+
+    return (int)m_TransformChangedNotificationQueue.size() - 1;
+}
+
+void ComponentSystemManager::CancelTransformChangedNotification(int index)
+{
+    MyAssert( index >= 0 && index < (int)m_TransformChangedNotificationQueue.size() );
+
+    m_TransformChangedNotificationQueue[index] = nullptr;
+}
+
+void ComponentSystemManager::SendQueuedTransformChangedNotifications()
+{
+    // Observers can queue more notifications (i.e. children of a moved parent), those are added to the end and sent in this same loop.
+    for( unsigned int i=0; i<m_TransformChangedNotificationQueue.size(); i++ )
+    {
+        ComponentTransform* pTransform = m_TransformChangedNotificationQueue[i];
+        if( pTransform == nullptr )
+            continue;
+
+        pTransform->SendQueuedTransformChangedNotification();
+    }
+
+    m_TransformChangedNotificationQueue.clear();
+}
+
 void ComponentSystemManager::OnSurfaceChanged(uint32 x, uint32 y, uint32 width, uint32 height, unsigned int desiredAspectWidth, unsigned int desiredaspectHeight)
 {
     for( CPPListNode* pNode = m_Components[BaseComponentType_Camera].GetHead(); pNode != nullptr; pNode = pNode->GetNext() )
@@ -2354,16 +2461,23 @@ void ComponentSystemManager::OnSurfaceChanged(uint32 x, uint32 y, uint32 width,
     //}
 
     // Notify all components that registered a callback of a change to the surfaces/aspect ratio.
-    for( CPPListNode* pNode = m_pComponentCallbackList_OnSurfaceChanged.HeadNode.Next; pNode->Next; pNode = pNode->Next )
+    m_ComponentCallbackList_OnSurfaceChanged.BeginDispatch();
+    for( unsigned int i=0; i<m_ComponentCallbackList_OnSurfaceChanged.GetArraySize(); i++ )
     {
-        ComponentCallbackStruct_OnSurfaceChanged* pCallbackStruct = (ComponentCallbackStruct_OnSurfaceChanged*)pNode;
+        ComponentCallbackStruct_OnSurfaceChanged* pCallbackStruct = (ComponentCallbackStruct_OnSurfaceChanged*)m_ComponentCallbackList_OnSurfaceChanged.GetCallback( i );
+        if( pCallbackStruct == nullptr )
+            continue;
 
         (pCallbackStruct->pObj->*pCallbackStruct->pFunc)( x, y, width, height, desiredAspectWidth, desiredaspectHeight );
     }
+    m_ComponentCallbackList_OnSurfaceChanged.EndDispatch();
 }
 
 void ComponentSystemManager::OnDrawFrame()
 {
+    // Cameras (i.e. shadow cameras) can draw before DrawFrame is called, catch anything moved since the tick.
+    SendQueuedTransformChangedNotifications();
+
     for( CPPListNode* pNode = m_Components[BaseComponentType_Camera].GetHead(); pNode != nullptr; pNode = pNode->GetNext() )
     {
         ComponentCamera* pCamera = (ComponentCamera*)pNode;
@@ -2373,10 +2487,19 @@ void ComponentSystemManager::OnDrawFrame()
             pCamera->OnDrawFrame();
         }
     }
+
+    // Free any post effect targets that haven't been used in a while.
+    m_pRenderTargetPool->EndFrame();
 }
 
 void ComponentSystemManager::DrawFrame(ComponentCamera* pCamera, MyMatrix* pMatProj, MyMatrix* pMatView, ShaderGroup* pShaderOverride, bool drawOpaques, bool drawTransparents, EmissiveDrawOptions emissiveDrawOption, bool drawOverlays)
 {
+    // Catch anything moved since the tick, i.e. by cameras or the editor.
+    SendQueuedTransformChangedNotifications();
+
+    // Rebin the lights if any were added, removed or moved since the last draw.
+    m_pLightRegistry->Update();
+
     // Draw all objects in the scene graph.
     {
         Vector3 campos = pCamera->m_pComponentTransform->GetLocalPosition();
@@ -2385,6 +2508,8 @@ void ComponentSystemManager::DrawFrame(ComponentCamera* pCamera, MyMatrix* pMatP
         // Find nearest shadow casting light. TODO: handle this better.
         MyMatrix* pShadowVP = nullptr;
         TextureDefinition* pShadowTex = nullptr;
+        ShadowReceiverMatrixFunc* pShadowReceiverFunc = nullptr;
+        void* pShadowReceiverUserData = nullptr;
         if( g_ActiveShaderPass == ShaderPass_Main )
         {
             GameObject* pObject = g_pComponentSystemManager->FindGameObjectByName( "Shadow Light" );
@@ -2393,7 +2518,7 @@ void ComponentSystemManager::DrawFrame(ComponentCamera* pCamera, MyMatrix* pMatP
                 ComponentBase* pComponent = pObject->GetFirstComponentOfBaseType( BaseComponentType_Camera );
                 if( pComponent )
                 {
-                    ComponentCameraShadow* pShadowCam = pComponent->IsA( "CameraShadowComponent" ) ? (ComponentCameraShadow*)pComponent : nullptr;
+                    ComponentCameraShadow* pShadowCam = pComponent->IsType( ComponentTypeID_CameraShadow ) ? (ComponentCameraShadow*)pComponent : nullptr;
                     if( pShadowCam )
                     {
                         pShadowVP = pShadowCam->GetViewProjMatrix();
@@ -2402,11 +2527,21 @@ void ComponentSystemManager::DrawFrame(ComponentCamera* pCamera, MyMatrix* pMatP
 #else
                         pShadowTex = pShadowCam->GetFBO()->GetColorTexture( 0 );
 #endif
+
+                        // No one cascade covers every receiver, so pick one for each object's or batch's bounds.
+                        if( pShadowCam->GetCascades() )
+                        {
+                            pShadowReceiverFunc = ComponentCameraShadow::StaticGetReceiverViewProjMatrix;
+                            pShadowReceiverUserData = pShadowCam;
+                        }
                     }
                 }
             }
         }
 
+        m_pRenderGraph->SetShadowReceiverFunc( pShadowReceiverFunc, pShadowReceiverUserData );
+        m_pSpriteBatcher->SetShadowReceiverFunc( pShadowReceiverFunc, pShadowReceiverUserData );
+
         //RenderGraphFlags baseFlags = (RenderGraphFlags)0;
         //if( drawEmissives )
         //    baseFlags = (RenderGraphFlags)(baseFlags | RenderGraphFlag_Emissive);
@@ -2416,13 +2551,20 @@ void ComponentSystemManager::DrawFrame(ComponentCamera* pCamera, MyMatrix* pMatP
             //RenderGraphFlags flags = (RenderGraphFlags)(baseFlags | RenderGraphFlag_Opaque);
             //baseFlags = (RenderGraphFlags)(baseFlags | ~RenderGraphFlag_Emissive);
             m_pRenderGraph->Draw( true, emissiveDrawOption, pCamera->m_LayersToRender, &campos, &camrot, pMatProj, pMatView, pShadowVP, pShadowTex, pShaderOverride, nullptr );
+
+            DrawBatchedSprites( pCamera, pMatProj, pMatView, pShadowVP, pShadowTex, pShaderOverride, true, emissiveDrawOption );
         }
 
         if( drawTransparents )
         {
             //RenderGraphFlags flags = (RenderGraphFlags)(baseFlags | RenderGraphFlag_Transparent);
             m_pRenderGraph->Draw( false, emissiveDrawOption, pCamera->m_LayersToRender, &campos, &camrot, pMatProj, pMatView, pShadowVP, pShadowTex, pShaderOverride, nullptr );
+
+            DrawBatchedSprites( pCamera, pMatProj, pMatView, pShadowVP, pShadowTex, pShaderOverride, false, emissiveDrawOption );
         }
+
+        m_pRenderGraph->SetShadowReceiverFunc( nullptr, nullptr );
+        m_pSpriteBatcher->SetShadowReceiverFunc( nullptr, nullptr );
     }
     
     if( drawOverlays )
@@ -2431,14 +2573,31 @@ void ComponentSystemManager::DrawFrame(ComponentCamera* pCamera, MyMatrix* pMatP
     }
 }
 
+void ComponentSystemManager::DrawBatchedSprites(ComponentCamera* pCamera, MyMatrix* pMatProj, MyMatrix* pMatView, MyMatrix* pShadowVP, TextureDefinition* pShadowTex, ShaderGroup* pShaderOverride, bool drawOpaques, EmissiveDrawOptions emissiveDrawOption)
+{
+    // Batched sprites are never emissive.
+    if( emissiveDrawOption == EmissiveDrawOption_OnlyEmissives )
+        return;
+
+    // Passes with a shader override draw them one at a time.
+    if( pShaderOverride )
+        m_pSpriteBatcher->DrawIndividually( pCamera, pMatProj, pMatView, pShaderOverride, nullptr, drawOpaques, !drawOpaques );
+    else
+        m_pSpriteBatcher->Draw( pCamera, pMatProj, pMatView, pShadowVP, pShadowTex, drawOpaques );
+}
+
 void ComponentSystemManager::DrawOverlays(ComponentCamera* pCamera, MyMatrix* pMatProj, MyMatrix* pMatView, ShaderGroup* pShaderOverride)
 {
     // Draw all components that registered a callback, used mostly for debug info (camera/light icons, collision info).
     // Also used for menu pages.
     {
-        for( CPPListNode* pNode = m_pComponentCallbackList_Draw.HeadNode.Next; pNode->Next; pNode = pNode->Next )
+        m_ComponentCallbackList_Draw.BeginDispatch();
+        for( unsigned int i=0; i<m_ComponentCallbackList_Draw.GetArraySize(); i++ )
         {
-            ComponentCallbackStruct_Draw* pCallbackStruct = (ComponentCallbackStruct_Draw*)pNode;
+            ComponentCallbackStruct_Draw* pCallbackStruct = (ComponentCallbackStruct_Draw*)m_ComponentCallbackList_Draw.GetCallback( i );
+            if( pCallbackStruct == nullptr )
+                continue;
+
             ComponentBase* pComponent = (ComponentBase*)pCallbackStruct->pObj;
 
             if( pComponent->ExistsOnLayer( pCamera->m_LayersToRender ) )
@@ -2449,28 +2608,79 @@ void ComponentSystemManager::DrawOverlays(ComponentCamera* pCamera, MyMatrix* pM
                 }
             }
         }
+        m_ComponentCallbackList_Draw.EndDispatch();
     }
 }
 
+// Render graph objects belong to renderables, split shadow casters on their static flag.
+static bool IsStaticShadowCaster(RenderGraphObject* pObject)
+{
+    ComponentBase* pComponent = (ComponentBase*)pObject->m_pUserData;
+    MyAssert( pComponent->GetBaseType() == BaseComponentType_Renderable );
+
+    return static_cast<ComponentRenderable*>( pComponent )->IsStaticShadowCaster();
+}
+
+static bool IsDynamicShadowCaster(RenderGraphObject* pObject)
+{
+    return IsStaticShadowCaster( pObject ) == false;
+}
+
+void ComponentSystemManager::DrawShadowCasters(ComponentCamera* pCamera, MyMatrix* pMatProj, MyMatrix* pMatView, bool drawStatic, bool drawDynamic, unsigned int* pNumDrawn, unsigned int* pNumCulled)
+{
+    if( drawStatic == false && drawDynamic == false )
+        return;
+
+    // Shadow casters can be drawn outside of DrawFrame, make sure they're drawn where they currently are.
+    SendQueuedTransformChangedNotifications();
+
+    Vector3 campos = pCamera->m_pComponentTransform->GetLocalPosition();
+    Vector3 camrot = pCamera->m_pComponentTransform->GetLocalRotation();
+
+    RenderGraph_BVH::ObjectFilterFunc* pFilterFunc = nullptr;
+    if( drawStatic == false )
+        pFilterFunc = IsDynamicShadowCaster;
+    else if( drawDynamic == false )
+        pFilterFunc = IsStaticShadowCaster;
+
+    RenderGraph_BVH::CullStats statsBefore = RenderGraph_BVH::m_CullStats;
+
+    // Same opaque pass DrawFrame draws, the render graph culls against the light's frustum.
+    m_pRenderGraph->SetObjectFilter( pFilterFunc );
+    m_pRenderGraph->Draw( true, EmissiveDrawOption_EitherEmissiveOrNot, pCamera->m_LayersToRender, &campos, &camrot, pMatProj, pMatView, nullptr, nullptr, nullptr, nullptr );
+    m_pRenderGraph->SetObjectFilter( nullptr );
+
+    // Batched sprites aren't in the render graph and are never cached with the static casters.
+    if( drawDynamic )
+        m_pSpriteBatcher->Draw( pCamera, pMatProj, pMatView, nullptr, nullptr, true );
+
+    *pNumDrawn += RenderGraph_BVH::m_CullStats.m_ObjectsDrawn - statsBefore.m_ObjectsDrawn;
+    *pNumCulled += RenderGraph_BVH::m_CullStats.m_NodesCulled - statsBefore.m_NodesCulled;
+}
+
 void ComponentSystemManager::OnFileRenamed(const char* fullPathBefore, const char* fullPathAfter)
 {
     // Call all components that registered a callback.
-    for( CPPListNode* pNode = m_pComponentCallbackList_OnFileRenamed.HeadNode.Next; pNode->Next; pNode = pNode->Next )
+    m_ComponentCallbackList_OnFileRenamed.BeginDispatch();
+    for( unsigned int i=0; i<m_ComponentCallbackList_OnFileRenamed.GetArraySize(); i++ )
     {
-        ComponentCallbackStruct_OnFileRenamed* pCallbackStruct = (ComponentCallbackStruct_OnFileRenamed*)pNode;
+        ComponentCallbackStruct_OnFileRenamed* pCallbackStruct = (ComponentCallbackStruct_OnFileRenamed*)m_ComponentCallbackList_OnFileRenamed.GetCallback( i );
+        if( pCallbackStruct == nullptr )
+            continue;
 
         (pCallbackStruct->pObj->*pCallbackStruct->pFunc)( fullPathBefore, fullPathAfter );
     }
+    m_ComponentCallbackList_OnFileRenamed.EndDispatch();
 }
 
-void ComponentSystemManager::MoveInputHandlersToFront(CPPListNode* pOnTouch, CPPListNode* pOnButtons, CPPListNode* pOnKeys)
+void ComponentSystemManager::MoveInputHandlersToFront(ComponentCallbackStruct_OnTouch* pOnTouch, ComponentCallbackStruct_OnButtons* pOnButtons, ComponentCallbackStruct_OnKeys* pOnKeys)
 {
     if( pOnTouch )
-        m_pComponentCallbackList_OnTouch.MoveHead( pOnTouch );
+        m_ComponentCallbackList_OnTouch.MoveToFront( pOnTouch );
     if( pOnButtons )
-        m_pComponentCallbackList_OnButtons.MoveHead( pOnButtons );
+        m_ComponentCallbackList_OnButtons.MoveToFront( pOnButtons );
     if( pOnKeys )
-        m_pComponentCallbackList_OnKeys.MoveHead( pOnKeys );
+        m_ComponentCallbackList_OnKeys.MoveToFront( pOnKeys );
 }
 
 void ProgramSceneIDs(ComponentBase* pComponent, ShaderGroup* pShaderOverride)
@@ -2521,12 +2731,17 @@ void ComponentSystemManager::DrawMousePickerFrame(ComponentCamera* pCamera, MyMa
 
             m_pRenderGraph->Draw( true, EmissiveDrawOption_EitherEmissiveOrNot, pCamera->m_LayersToRender, &campos, &camrot, pMatProj, pMatView, nullptr, nullptr, pShaderOverride, ProgramSceneIDs );
             m_pRenderGraph->Draw( false, EmissiveDrawOption_EitherEmissiveOrNot, pCamera->m_LayersToRender, &campos, &camrot, pMatProj, pMatView, nullptr, nullptr, pShaderOverride, ProgramSceneIDs );
+
+            m_pSpriteBatcher->DrawIndividually( pCamera, pMatProj, pMatView, pShaderOverride, ProgramSceneIDs, true, true );
         }
 
         // Draw all components that registered a callback.
-        for( CPPListNode* pNode = m_pComponentCallbackList_Draw.HeadNode.Next; pNode->Next; pNode = pNode->Next )
+        m_ComponentCallbackList_Draw.BeginDispatch();
+        for( unsigned int i=0; i<m_ComponentCallbackList_Draw.GetArraySize(); i++ )
         {
-            ComponentCallbackStruct_Draw* pCallbackStruct = (ComponentCallbackStruct_Draw*)pNode;
+            ComponentCallbackStruct_Draw* pCallbackStruct = (ComponentCallbackStruct_Draw*)m_ComponentCallbackList_Draw.GetCallback( i );
+            if( pCallbackStruct == nullptr )
+                continue;
 
             ComponentBase* pComponent = (ComponentBase*)pCallbackStruct->pObj;
 
@@ -2553,6 +2768,7 @@ void ComponentSystemManager::DrawMousePickerFrame(ComponentCamera* pCamera, MyMa
                 }
             }
         }
+        m_ComponentCallbackList_Draw.EndDispatch();
 
         pShader->DeactivateShader( nullptr, false );
     }
@@ -2617,9 +2833,11 @@ void ComponentSystemManager::CreateNewScene(const char* sceneName, SceneID scene
     // Create the box2d world, pass in a material for the debug renderer.
     ComponentCamera* pCamera = g_pEngineCore->GetEditorState()->GetEditorCamera();
 #if MYFW_USING_BOX2D
-    m_pSceneInfoMap[sceneID].m_pBox2DWorld = MyNew Box2DWorld( g_pEngineCore->GetMaterial_Box2DDebugDraw(), &pCamera->m_Camera3D.m_matProj, &pCamera->m_Camera3D.m_matView, new EngineBox2DContactListener );
+    m_pSceneInfoMap[sceneID].m_pBox2DContactListener = new EngineBox2DContactListener;
+    m_pSceneInfoMap[sceneID].m_pBox2DWorld = MyNew Box2DWorld( g_pEngineCore->GetMaterial_Box2DDebugDraw(), &pCamera->m_Camera3D.m_matProj, &pCamera->m_Camera3D.m_matView, m_pSceneInfoMap[sceneID].m_pBox2DContactListener );
 #else
     m_pSceneInfoMap[sceneID].m_pBox2DWorld = nullptr;
+    m_pSceneInfoMap[sceneID].m_pBox2DContactListener = nullptr;
 #endif
 }
 
@@ -3013,13 +3231,20 @@ bool ComponentSystemManager::OnEvent(MyEvent* pEvent)
 bool ComponentSystemManager::OnTouch(int action, int id, float x, float y, float pressure, float size)
 {
     // Send touch events to all components that registered a callback.
-    for( CPPListNode* pNode = m_pComponentCallbackList_OnTouch.HeadNode.Next; pNode->Next; pNode = pNode->Next )
+    bool handled = false;
+    m_ComponentCallbackList_OnTouch.BeginDispatch();
+    for( unsigned int i=0; i<m_ComponentCallbackList_OnTouch.GetArraySize() && handled == false; i++ )
     {
-        ComponentCallbackStruct_OnTouch* pCallbackStruct = (ComponentCallbackStruct_OnTouch*)pNode;
+        ComponentCallbackStruct_OnTouch* pCallbackStruct = (ComponentCallbackStruct_OnTouch*)m_ComponentCallbackList_OnTouch.GetCallback( i );
+        if( pCallbackStruct == nullptr )
+            continue;
 
-        if( (pCallbackStruct->pObj->*pCallbackStruct->pFunc)( action, id, x, y, pressure, size ) )
-            return true;
+        handled = (pCallbackStruct->pObj->*pCallbackStruct->pFunc)( action, id, x, y, pressure, size );
     }
+    m_ComponentCallbackList_OnTouch.EndDispatch();
+
+    if( handled )
+        return true;
 
     // Then regular scene input handlers.
     for( CPPListNode* pNode = m_Components[BaseComponentType_InputHandler].GetHead(); pNode != nullptr; pNode = pNode->GetNext() )
@@ -3051,13 +3276,20 @@ bool ComponentSystemManager::OnTouch(int action, int id, float x, float y, float
 bool ComponentSystemManager::OnButtons(GameCoreButtonActions action, GameCoreButtonIDs id)
 {
     // Send button events to all components that registered a callback.
-    for( CPPListNode* pNode = m_pComponentCallbackList_OnButtons.HeadNode.Next; pNode->Next; pNode = pNode->Next )
+    bool handled = false;
+    m_ComponentCallbackList_OnButtons.BeginDispatch();
+    for( unsigned int i=0; i<m_ComponentCallbackList_OnButtons.GetArraySize() && handled == false; i++ )
     {
-        ComponentCallbackStruct_OnButtons* pCallbackStruct = (ComponentCallbackStruct_OnButtons*)pNode;
+        ComponentCallbackStruct_OnButtons* pCallbackStruct = (ComponentCallbackStruct_OnButtons*)m_ComponentCallbackList_OnButtons.GetCallback( i );
+        if( pCallbackStruct == nullptr )
+            continue;
 
-        if( (pCallbackStruct->pObj->*pCallbackStruct->pFunc)( action, id ) )
-            return true;
+        handled = (pCallbackStruct->pObj->*pCallbackStruct->pFunc)( action, id );
     }
+    m_ComponentCallbackList_OnButtons.EndDispatch();
+
+    if( handled )
+        return true;
 
     // Then regular scene input handlers.
     for( CPPListNode* pNode = m_Components[BaseComponentType_InputHandler].GetHead(); pNode != nullptr; pNode = pNode->GetNext() )
@@ -3096,13 +3328,20 @@ bool ComponentSystemManager::OnKeys(GameCoreButtonActions action, int keyCode, i
     pEventManager->SendEventNow( pEvent );
 
     // Send keyboard events to all components that registered a callback.
-    for( CPPListNode* pNode = m_pComponentCallbackList_OnKeys.HeadNode.Next; pNode->Next; pNode = pNode->Next )
+    bool handled = false;
+    m_ComponentCallbackList_OnKeys.BeginDispatch();
+    for( unsigned int i=0; i<m_ComponentCallbackList_OnKeys.GetArraySize() && handled == false; i++ )
     {
-        ComponentCallbackStruct_OnKeys* pCallbackStruct = (ComponentCallbackStruct_OnKeys*)pNode;
+        ComponentCallbackStruct_OnKeys* pCallbackStruct = (ComponentCallbackStruct_OnKeys*)m_ComponentCallbackList_OnKeys.GetCallback( i );
+        if( pCallbackStruct == nullptr )
+            continue;
 
-        if( (pCallbackStruct->pObj->*pCallbackStruct->pFunc)( action, keyCode, unicodeChar ) )
-            return true;
+        handled = (pCallbackStruct->pObj->*pCallbackStruct->pFunc)( action, keyCode, unicodeChar );
     }
+    m_ComponentCallbackList_OnKeys.EndDispatch();
+
+    if( handled )
+        return true;
 
     // Then regular scene input handlers.
     for( CPPListNode* pNode = m_Components[BaseComponentType_InputHandler].GetHead(); pNode != nullptr; pNode = pNode->GetNext() )
@@ -3136,6 +3375,8 @@ void ComponentSystemManager::DrawSingleObject(MyMatrix* pMatProj, MyMatrix* pMat
 {
     MyAssert( pObject != nullptr );
 
+    m_pLightRegistry->Update();
+
     for( unsigned int i=0; i<pObject->GetComponentCount(); i++ )
     {
         ComponentRenderable* pComponent = dynamic_cast<ComponentRenderable*>( pObject->GetComponentByIndex( i ) );
@@ -3160,6 +3401,8 @@ void ComponentSystemManager::DrawSingleComponent(MyMatrix* pMatProj, MyMatrix* p
     MyAssert( pComponent != nullptr );
     MyAssert( numMaterialOverrides <= 4 );
 
+    m_pLightRegistry->Update();
+
     if( pComponent )
     {
         pComponent->Draw( pMatProj, pMatView );
@@ -11,17 +11,26 @@
 #define __ComponentSystemManager_H__
 
 #include "SceneHandler.h"
+#include "ComponentCallbackList.h"
 #include "ComponentSystem/BaseComponents/ComponentBase.h"
+#include "RenderGraph_BVH.h"
 
 class ComponentRenderable;
 class ComponentSystemManager;
+class ComponentTransform;
 class ComponentTypeManager;
 class PrefabManager;
+class LightRegistry;
+class ParticleSystemManager;
+class SpriteBatcher;
+class RenderTargetPool;
 class PrefabFile;
 class PrefabObject;
 class PrefabReference;
 class GameObjectTemplateManager;
 class SceneHandler;
+class SceneArena;
+class SceneLoadIDMap;
 class GameObject;
 class ComponentBase;
 class ComponentCamera;
@@ -53,20 +62,18 @@ struct FileUpdatedCallbackStruct
 
 // Define structures to hold callback funcs and objects.
 #define MYFW_COMPONENTSYSTEMMANAGER_DEFINE_CALLBACK_STRUCT(CallbackType) \
-    struct ComponentCallbackStruct_##CallbackType : public CPPListNode \
+    struct ComponentCallbackStruct_##CallbackType : public ComponentCallbackStructBase \
     { \
-        ComponentBase* pObj; \
         ComponentCallbackFunc_##CallbackType pFunc; \
         ComponentCallbackStruct_##CallbackType() \
         { \
-            pObj = nullptr; \
             pFunc = nullptr; \
         } \
     };
 
 // Callback registration function macros.
 #define MYFW_COMPONENTSYSTEMMANAGER_DECLARE_CALLBACK_REGISTER_FUNCTIONS(CallbackType) \
-    CPPListHead m_pComponentCallbackList_##CallbackType; \
+    ComponentCallbackList m_ComponentCallbackList_##CallbackType; \
     void RegisterComponentCallback_##CallbackType(ComponentCallbackStruct_##CallbackType* pCallbackStruct); \
     void UnregisterComponentCallback_##CallbackType(ComponentCallbackStruct_##CallbackType* pCallbackStruct);
 
@@ -84,7 +91,7 @@ struct FileUpdatedCallbackStruct
     g_pComponentSystemManager->UnregisterComponentCallback_##CallbackType( &m_CallbackStruct_##CallbackType );
 
 #define MYFW_ASSERT_COMPONENT_CALLBACK_IS_NOT_REGISTERED(CallbackType) \
-    MyAssert( m_CallbackStruct_##CallbackType.Prev == nullptr );
+    MyAssert( m_CallbackStruct_##CallbackType.IsRegistered() == false );
 
 // Declare callback objects/functions - used by components.
 #define MYFW_DECLARE_COMPONENT_CALLBACK_TICK() \
@@ -134,11 +141,6 @@ MYFW_COMPONENTSYSTEMMANAGER_DEFINE_CALLBACK_STRUCT( OnKeys );
 MYFW_COMPONENTSYSTEMMANAGER_DEFINE_CALLBACK_STRUCT( OnFileRenamed );
 
 typedef void TransformChangedCallbackFunc(void* pObjectPtr, const Vector3& newPos, const Vector3& newRot, const Vector3& newScale, bool changedByUserInEditor);
-struct TransformChangedCallbackStruct : public CPPListNode
-{
-    void* pObj;
-    TransformChangedCallbackFunc* pFunc;
-};
 
 class ComponentSystemManager
 {
@@ -159,11 +161,14 @@ protected:
 
     float m_TimeScale;
 
-    RenderGraph_Base* m_pRenderGraph;
+    RenderGraph_BVH* m_pRenderGraph; // Shadow casters rely on its object filter.
+    unsigned int m_StaticRenderablesVersion; // Bumped when a static renderable changes, used to invalidate cached shadow maps.
+    bool m_UseSceneArenas; // Allocate GameObjects and components from per-scene arenas instead of the heap.
+    bool m_ParseScenesInParallel; // Parse scene files on the job threads.
+    SceneLoadIDMap* m_pSceneLoadIDMap; // Only set while LoadSceneFromJSON() is running.
 
-    // Pool for transform changed callbacks.
-    static const int CALLBACK_POOL_SIZE = 1000;
-    MySimplePool<TransformChangedCallbackStruct> m_pComponentTransform_TransformChangedCallbackPool;
+    // Transforms that changed since the last flush, each one notifies its observers once. Entries are nullptr if the transform was deleted.
+    std::vector<ComponentTransform*> m_TransformChangedNotificationQueue;
 
 #if MYFW_EDITOR
     std::vector<FileUpdatedCallbackStruct> m_pFileUpdatedCallbackList;
@@ -180,12 +185,16 @@ public:
     // Getters.
     EngineCore* GetEngineCore() { return m_pEngineCore; }
     float GetTimeScale() { return m_TimeScale; }
-    RenderGraph_Base* GetRenderGraph() { return m_pRenderGraph; }
+    RenderGraph_BVH* GetRenderGraph() { return m_pRenderGraph; }
+    unsigned int GetStaticRenderablesVersion() { return m_StaticRenderablesVersion; }
+    bool AreSceneArenasEnabled() { return m_UseSceneArenas; }
+    bool IsSceneParsingParallel() { return m_ParseScenesInParallel; }
     ComponentTypeManager* GetComponentTypeManager() { return m_pComponentTypeManager; }
-    MySimplePool<TransformChangedCallbackStruct>* GetTransformChangedCallbackPool() { return &m_pComponentTransform_TransformChangedCallbackPool; }
 
     // Setters.
     void SetTimeScale(float scale) { m_TimeScale = scale; } // Exposed to Lua, change elsewhere if function signature changes.
+    void SetSceneArenasEnabled(bool enabled) { m_UseSceneArenas = enabled; } // Only affects objects created afterwards.
+    void SetSceneParsingParallel(bool inParallel) { m_ParseScenesInParallel = inParallel; }
 
     void MoveAllFilesNeededForLoadingScreenToStartOfFileList(GameObject* first);
     void AddListOfFilesUsedToJSONObject(SceneID sceneID, cJSON* jFileArray);
@@ -219,6 +228,7 @@ public:
 
     void LoadSceneFromJSON(const char* sceneName, const char* jsonString, SceneID sceneID);
     ComponentBase* CreateComponentFromJSONObject(GameObject* pGameObject, cJSON* jComponent);
+    ComponentBase* CreateComponentWithID(GameObject* pGameObject, int type, unsigned int id);
     void FinishLoading(bool lockWhileLoading, SceneID sceneID, bool playWhenFinishedLoading);
 
     void SyncAllRigidBodiesToObjectTransforms();
@@ -231,6 +241,8 @@ public:
 
     GameObject* EditorLua_CreateGameObject(const char* name, uint32 sceneID, bool isFolder, bool hasTransform);
     GameObject* CreateGameObject(bool manageObject = true, SceneID sceneID = SCENEID_Unmanaged, bool isFolder = false, bool hasTransform = true, PrefabReference* pPrefabRef = nullptr);
+    ComponentBase* CreateComponent(int type, SceneID sceneID);
+    SceneArena* GetArenaForScene(SceneID sceneID); // Returns nullptr if scene arenas are disabled.
     GameObject* CreateGameObjectFromPrefab(PrefabObject* pPrefab, bool manageObject, SceneID sceneID);
     GameObject* CreateGameObjectFromPrefab(PrefabObject* pPrefab, cJSON* jPrefab, uint32 prefabChildID, bool manageObject, SceneID sceneID);
 #if MYFW_EDITOR
@@ -274,7 +286,15 @@ public:
     void OnSurfaceChanged(uint32 x, uint32 y, uint32 width, uint32 height, unsigned int desiredAspectWidth, unsigned int desiredaspectHeight);
     void OnDrawFrame();
     void DrawFrame(ComponentCamera* pCamera, MyMatrix* pMatProj, MyMatrix* pMatView, ShaderGroup* pShaderOverride, bool drawOpaques, bool drawTransparents, EmissiveDrawOptions emissiveDrawOption, bool drawOverlays);
+    void DrawBatchedSprites(ComponentCamera* pCamera, MyMatrix* pMatProj, MyMatrix* pMatView, MyMatrix* pShadowVP, TextureDefinition* pShadowTex, ShaderGroup* pShaderOverride, bool drawOpaques, EmissiveDrawOptions emissiveDrawOption);
     void DrawOverlays(ComponentCamera* pCamera, MyMatrix* pMatProj, MyMatrix* pMatView, ShaderGroup* pShaderOverride);
+    void DrawShadowCasters(ComponentCamera* pCamera, MyMatrix* pMatProj, MyMatrix* pMatView, bool drawStatic, bool drawDynamic, unsigned int* pNumDrawn, unsigned int* pNumCulled);
+    void OnStaticRenderableChanged() { m_StaticRenderablesVersion++; }
+
+    // Transform changed notifications, sent after components tick and before each camera draws.
+    int QueueTransformChangedNotification(ComponentTransform* pTransform);
+    void CancelTransformChangedNotification(int index);
+    void SendQueuedTransformChangedNotifications();
     void OnFileRenamed(const char* fullPathBefore, const char* fullPathAfter);
 
     void OnLoad(SceneID sceneID);
@@ -297,7 +317,7 @@ public:
     MYFW_COMPONENTSYSTEMMANAGER_DECLARE_CALLBACK_REGISTER_FUNCTIONS( OnKeys );
     MYFW_COMPONENTSYSTEMMANAGER_DECLARE_CALLBACK_REGISTER_FUNCTIONS( OnFileRenamed );
 
-    void MoveInputHandlersToFront(CPPListNode* pOnTouch, CPPListNode* pOnButtons, CPPListNode* pOnKeys);
+    void MoveInputHandlersToFront(ComponentCallbackStruct_OnTouch* pOnTouch, ComponentCallbackStruct_OnButtons* pOnButtons, ComponentCallbackStruct_OnKeys* pOnKeys);
 
     // Other utility functions.
     void DrawMousePickerFrame(ComponentCamera* pCamera, MyMatrix* pMatProj, MyMatrix* pMatView, ShaderGroup* pShaderOverride);
@@ -322,6 +342,10 @@ public:
     MaterialDefinition* ParseLog_Material(const char* line);
 #endif //MYFW_EDITOR
     PrefabManager* m_pPrefabManager;
+    LightRegistry* m_pLightRegistry;
+    ParticleSystemManager* m_pParticleSystemManager;
+    SpriteBatcher* m_pSpriteBatcher;
+    RenderTargetPool* m_pRenderTargetPool;
     SceneInfo m_pSceneInfoMap[MAX_SCENES_CREATED];
 
     // RenderGraph Functions.
@@ -0,0 +1,142 @@
+//
+// Copyright (c) 2020 Jimmy Lord http://www.flatheadgames.com
+//
+// This software is provided 'as-is', without any express or implied warranty.  In no event will the authors be held liable for any damages arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include "MyEnginePCH.h"
+
+#include "ComponentTypeIDs.h"
+#include "ComponentSystem/BaseComponents/ComponentBase.h"
+
+// Must be in same order as enum ComponentTypeIDs.
+static const char* g_EngineComponentClassnames[ComponentTypeID_NumEngineTypes] = // ADDING_NEW_ComponentType
+{
+    "BaseComponent",                    // ComponentTypeID_Base,
+    "DataComponent",                    // ComponentTypeID_Data,
+    "UpdateableComponent",              // ComponentTypeID_Updateable,
+    "InputHandlerComponent",            // ComponentTypeID_InputHandler,
+    "RenderableComponent",              // ComponentTypeID_Renderable,
+    "GameObjectPropertiesComponent",    // ComponentTypeID_GameObjectProperties,
+    "TransformComponent",               // ComponentTypeID_Transform,
+    "CameraComponent",                  // ComponentTypeID_Camera,
+    "SpriteComponent",                  // ComponentTypeID_Sprite,
+    "MeshComponent",                    // ComponentTypeID_Mesh,
+    "MeshOBJComponent",                 // ComponentTypeID_MeshOBJ,
+    "MeshPrimitiveComponent",           // ComponentTypeID_MeshPrimitive,
+    "HeightmapComponent",               // ComponentTypeID_Heightmap,
+    "TilemapComponent",                 // ComponentTypeID_Tilemap,
+    "VoxelMeshComponent",               // ComponentTypeID_VoxelMesh,
+    "VoxelWorldComponent",              // ComponentTypeID_VoxelWorld,
+    "LightComponent",                   // ComponentTypeID_Light,
+    "CameraShadowComponent",            // ComponentTypeID_CameraShadow,
+    "PostEffectComponent",              // ComponentTypeID_PostEffect,
+    "3DCollisionObjectComponent",       // ComponentTypeID_3DCollisionObject,
+    "3DJoint-Point2PointComponent",     // ComponentTypeID_3DJointPoint2Point,
+    "3DJoint-HingeComponent",           // ComponentTypeID_3DJointHinge,
+    "3DJoint-SliderComponent",          // ComponentTypeID_3DJointSlider,
+    "2DCollisionObjectComponent",       // ComponentTypeID_2DCollisionObject,
+    "2DJoint-RevoluteComponent",        // ComponentTypeID_2DJointRevolute,
+    "2DJoint-PrismaticComponent",       // ComponentTypeID_2DJointPrismatic,
+    "2DJoint-WeldComponent",            // ComponentTypeID_2DJointWeld,
+    "LuaScriptComponent",               // ComponentTypeID_LuaScript,
+    "MonoScriptComponent",              // ComponentTypeID_MonoScript,
+    "ParticleEmitterComponent",         // ComponentTypeID_ParticleEmitter,
+    "AnimPlayerComponent",              // ComponentTypeID_AnimationPlayer,
+    "Anim2DComponent",                  // ComponentTypeID_AnimationPlayer2D,
+    "AudioPlayerComponent",             // ComponentTypeID_AudioPlayer,
+    "ObjectPoolComponent",              // ComponentTypeID_ObjectPool,
+    "MenuPageComponent",                // ComponentTypeID_MenuPage,
+};
+
+uint64 ComponentTypeIDRegistry::m_Keys[ComponentTypeID_Max];
+char ComponentTypeIDRegistry::m_Names[ComponentTypeID_Max][MAX_CLASSNAME_LENGTH];
+unsigned int ComponentTypeIDRegistry::m_NumIDs = 0;
+unsigned int ComponentTypeIDRegistry::m_Version = 1;
+
+uint64 ComponentTypeIDRegistry::GetKey(const char* classname)
+{
+    // FNV-1a.
+    uint64 key = 14695981039346656037ULL;
+    for( int i=0; classname[i] != '\0'; i++ )
+    {
+        key ^= (unsigned char)classname[i];
+        key *= 1099511628211ULL;
+    }
+
+    return key;
+}
+
+int ComponentTypeIDRegistry::AddID(const char* classname, uint64 key)
+{
+    if( m_NumIDs >= ComponentTypeID_Max )
+        return ComponentTypeID_None;
+
+    MyAssert( strlen( classname ) < MAX_CLASSNAME_LENGTH );
+
+    int typeID = m_NumIDs;
+    m_Keys[typeID] = key;
+    strncpy( m_Names[typeID], classname, MAX_CLASSNAME_LENGTH-1 );
+    m_Names[typeID][MAX_CLASSNAME_LENGTH-1] = '\0';
+
+    m_NumIDs++;
+    m_Version++;
+
+    return typeID;
+}
+
+unsigned int ComponentTypeIDRegistry::GetNumIDs()
+{
+    // Engine classnames are added on first use, so their IDs match the enum.
+    if( m_NumIDs == 0 )
+    {
+        for( int i=0; i<ComponentTypeID_NumEngineTypes; i++ )
+        {
+            AddID( g_EngineComponentClassnames[i], GetKey( g_EngineComponentClassnames[i] ) );
+        }
+    }
+
+    return m_NumIDs;
+}
+
+int ComponentTypeIDRegistry::GetID(const char* classname)
+{
+    int typeID = FindID( classname );
+    if( typeID != ComponentTypeID_None )
+        return typeID;
+
+    return AddID( classname, GetKey( classname ) );
+}
+
+int ComponentTypeIDRegistry::FindID(const char* classname)
+{
+    MyAssert( classname != nullptr );
+
+    uint64 key = GetKey( classname );
+
+    unsigned int numIDs = GetNumIDs();
+    for( unsigned int i=0; i<numIDs; i++ )
+    {
+        if( m_Keys[i] == key && strcmp( m_Names[i], classname ) == 0 )
+            return i;
+    }
+
+    return ComponentTypeID_None;
+}
+
+ComponentTypeMask ComponentTypeIDRegistry::BuildMask(ComponentBase* pComponent)
+{
+    ComponentTypeMask mask = 0;
+
+    unsigned int numIDs = GetNumIDs();
+    for( unsigned int i=0; i<numIDs; i++ )
+    {
+        if( pComponent->IsA( m_Names[i] ) )
+            mask |= GetBit( i );
+    }
+
+    return mask;
+}
@@ -0,0 +1,94 @@
+//
+// Copyright (c) 2020 Jimmy Lord http://www.flatheadgames.com
+//
+// This software is provided 'as-is', without any express or implied warranty.  In no event will the authors be held liable for any damages arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#ifndef __ComponentTypeIDs_H__
+#define __ComponentTypeIDs_H__
+
+class ComponentBase;
+
+typedef uint64 ComponentTypeMask;
+
+// Small integer IDs for component classnames, used to find components without comparing strings.
+// Engine classes have fixed IDs, other classnames (game components or names only used in lookups) get the next free ID when first seen.
+// A component's mask has a bit set for every registered classname it IsA(), so parent classes are included.
+enum ComponentTypeIDs // ADDING_NEW_ComponentType
+{
+    ComponentTypeID_Base,
+    ComponentTypeID_Data,
+    ComponentTypeID_Updateable,
+    ComponentTypeID_InputHandler,
+    ComponentTypeID_Renderable,
+    ComponentTypeID_GameObjectProperties,
+    ComponentTypeID_Transform,
+    ComponentTypeID_Camera,
+    ComponentTypeID_Sprite,
+    ComponentTypeID_Mesh,
+    ComponentTypeID_MeshOBJ,
+    ComponentTypeID_MeshPrimitive,
+    ComponentTypeID_Heightmap,
+    ComponentTypeID_Tilemap,
+    ComponentTypeID_VoxelMesh,
+    ComponentTypeID_VoxelWorld,
+    ComponentTypeID_Light,
+    ComponentTypeID_CameraShadow,
+    ComponentTypeID_PostEffect,
+    ComponentTypeID_3DCollisionObject,
+    ComponentTypeID_3DJointPoint2Point,
+    ComponentTypeID_3DJointHinge,
+    ComponentTypeID_3DJointSlider,
+    ComponentTypeID_2DCollisionObject,
+    ComponentTypeID_2DJointRevolute,
+    ComponentTypeID_2DJointPrismatic,
+    ComponentTypeID_2DJointWeld,
+    ComponentTypeID_LuaScript,
+    ComponentTypeID_MonoScript,
+    ComponentTypeID_ParticleEmitter,
+    ComponentTypeID_AnimationPlayer,
+    ComponentTypeID_AnimationPlayer2D,
+    ComponentTypeID_AudioPlayer,
+    ComponentTypeID_ObjectPool,
+    ComponentTypeID_MenuPage,
+    ComponentTypeID_NumEngineTypes,
+
+    ComponentTypeID_Max = 64, // One bit per ID in a ComponentTypeMask.
+    ComponentTypeID_None = -1,
+};
+
+class ComponentTypeIDRegistry
+{
+protected:
+    static const int MAX_CLASSNAME_LENGTH = 64;
+
+    static uint64 m_Keys[ComponentTypeID_Max]; // Hash of the classname, checked before comparing the strings.
+    static char m_Names[ComponentTypeID_Max][MAX_CLASSNAME_LENGTH];
+    static unsigned int m_NumIDs;
+    static unsigned int m_Version; // Bumped each time an ID is added, cached masks built with an older version are rebuilt.
+
+protected:
+    static uint64 GetKey(const char* classname);
+    static int AddID(const char* classname, uint64 key);
+
+public:
+    // Returns the ID for the classname, adding one if it's new, returns ComponentTypeID_None if all IDs are used.
+    static int GetID(const char* classname);
+
+    // Returns the ID for the classname or ComponentTypeID_None if it was never added, doesn't add one.
+    static int FindID(const char* classname);
+
+    // Returns a mask with a bit set for each ID the component IsA().
+    static ComponentTypeMask BuildMask(ComponentBase* pComponent);
+
+    static const char* GetName(int typeID) { return m_Names[typeID]; }
+    static unsigned int GetNumIDs();
+    static unsigned int GetVersion() { return m_Version; }
+
+    static ComponentTypeMask GetBit(int typeID) { return (ComponentTypeMask)1 << typeID; }
+};
+
+#endif //__ComponentTypeIDs_H__
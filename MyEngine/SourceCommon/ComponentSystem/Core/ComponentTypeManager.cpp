@@ -15,6 +15,7 @@
 ComponentTypeManager::ComponentTypeManager()
 {
     m_pComponentSystemManager = nullptr;
+    m_pAllocationArena = nullptr;
 }
 
 ComponentTypeManager::~ComponentTypeManager()
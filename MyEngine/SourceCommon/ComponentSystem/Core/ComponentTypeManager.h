@@ -10,9 +10,12 @@
 #ifndef __ComponentTypeManager_H__
 #define __ComponentTypeManager_H__
 
+#include "SceneArena.h"
+
 class ComponentBase;
 class ComponentSystemManager;
 class ComponentTypeManager;
+class EngineCore;
 
 struct ComponentTypeInfo
 {
@@ -24,12 +27,24 @@ class ComponentTypeManager
 {
 protected:
     ComponentSystemManager* m_pComponentSystemManager;
+    SceneArena* m_pAllocationArena; // Set by ComponentSystemManager::CreateComponent() while creating components for a scene.
+
+    // Creates a component in m_pAllocationArena if set, otherwise on the heap.
+    template <class Type> Type* NewComponent(EngineCore* pEngineCore)
+    {
+        void* pMemory = m_pAllocationArena ? m_pAllocationArena->Allocate( sizeof(Type) ) : nullptr;
+        if( pMemory )
+            return new(pMemory) Type( pEngineCore, m_pComponentSystemManager );
+
+        return MyNew Type( pEngineCore, m_pComponentSystemManager );
+    }
 
 public:
     ComponentTypeManager();
     virtual ~ComponentTypeManager();
 
     void SetComponentSystemManager(ComponentSystemManager* pComponentSystemManager);
+    void SetAllocationArena(SceneArena* pArena) { m_pAllocationArena = pArena; }
 
     virtual ComponentBase* CreateComponent(int type) = 0;
     virtual unsigned int GetNumberOfComponentTypes() = 0;
@@ -14,6 +14,7 @@
 #include "ComponentSystem/BaseComponents/ComponentTransform.h"
 #include "ComponentSystem/Core/ComponentSystemManager.h"
 #include "ComponentSystem/Core/GameObject.h"
+#include "ComponentSystem/Core/SceneArena.h"
 #include "ComponentSystem/EngineComponents/ComponentLuaScript.h"
 #include "ComponentSystem/EngineComponents/ComponentObjectPool.h"
 #include "Core/EngineComponentTypeManager.h"
@@ -53,7 +54,9 @@ GameObject::GameObject(EngineCore* pEngineCore, bool managed, SceneID sceneID, b
     m_ID = 0;
     m_PhysicsSceneID = sceneID;
     m_Name = nullptr;
+    m_OwnsName = false;
     m_pOriginatingPool = nullptr;
+    m_PoolSlotIndex = 0;
     
     m_Managed = false;
     if( managed )
@@ -65,7 +68,7 @@ GameObject::GameObject(EngineCore* pEngineCore, bool managed, SceneID sceneID, b
     }
     else
     {
-        m_pComponentTransform = MyNew ComponentTransform( pEngineCore, pEngineCore->GetComponentSystemManager() );
+        m_pComponentTransform = (ComponentTransform*)pEngineCore->GetComponentSystemManager()->CreateComponent( ComponentType_Transform, sceneID );
         m_pComponentTransform->SetType( ComponentType_Transform );
         m_pComponentTransform->SetSceneID( sceneID );
         m_pComponentTransform->SetGameObject( this );
@@ -73,13 +76,16 @@ GameObject::GameObject(EngineCore* pEngineCore, bool managed, SceneID sceneID, b
     }
 
     m_Components.AllocateObjects( MAX_COMPONENTS ); // Hard coded nonsense for now, max of 8 components on a game object.
+
+    m_ComponentTypeMask = 0;
+    m_ComponentTypeTableVersion = 0;
 }
 
 GameObject::~GameObject()
 {
     NotifyOthersThisWasDeleted();
 
-    MyAssert( m_pOnDeleteCallbacks.GetHead() == nullptr );
+    MyAssert( m_OnDeleteObservers.GetCount() == 0 );
 
     // If we still have a parent gameobject, then we're likely still registered in its OnDeleted callback list.
     // Unregister ourselves to stop the parent's gameobject from reporting its deletion.
@@ -97,6 +103,10 @@ GameObject::~GameObject()
         while( m_Components.Count() )
         {
             ComponentBase* pComponent = m_Components.RemoveIndex( 0 );
+
+            // Components or their indices changed, disabling can look up other components.
+            m_ComponentTypeTableVersion = 0;
+
             pComponent->SetEnabled( false );
             delete pComponent;
         }
@@ -113,7 +123,8 @@ GameObject::~GameObject()
 
     m_Properties.SetEnabled( false );
 
-    SAFE_DELETE_ARRAY( m_Name );
+    if( m_OwnsName )
+        SAFE_DELETE_ARRAY( m_Name );
 
     // Delete all children.
     while( m_ChildList.GetHead() )
@@ -122,6 +133,24 @@ GameObject::~GameObject()
     }
 }
 
+void GameObject::operator delete(void* pMemory, size_t size)
+{
+    if( SceneArena::FreeFromAnyArena( pMemory, size ) == false )
+        ::operator delete( pMemory );
+}
+
+void GameObject::operator delete(void* pMemory, void* pPlace)
+{
+    // Only called if the constructor throws, the arena block belongs to whoever did the placement new.
+}
+
+#if MYFW_USE_MEMORY_TRACKER
+void GameObject::operator delete(void* pMemory, char* file, unsigned long line)
+{
+    ::operator delete( pMemory, file, line );
+}
+#endif
+
 void GameObject::SetGameObjectThisInheritsFrom(GameObject* pObj)
 {
     // TODO: Fix prefab when this gets called.
@@ -619,20 +648,34 @@ void GameObject::SetName(const char* name)
         if( strcmp( m_Name, name ) == 0 ) // Name hasn't changed.
             return;
 
-        delete[] m_Name;
+        if( m_OwnsName )
+            delete[] m_Name;
     }
     
     size_t len = strlen( name );
     
     m_Name = MyNew char[len+1];
     strcpy_s( m_Name, len+1, name );
+    m_OwnsName = true;
+}
+
+void GameObject::SetSharedName(const char* name)
+{
+    MyAssert( name );
+
+    if( m_OwnsName )
+        SAFE_DELETE_ARRAY( m_Name );
+
+    m_Name = (char*)name;
+    m_OwnsName = false;
 }
 
-void GameObject::SetOriginatingPool(ComponentObjectPool* pPool)
+void GameObject::SetOriginatingPool(ComponentObjectPool* pPool, unsigned int slotIndex)
 {
     MyAssert( m_pOriginatingPool == nullptr );
 
     m_pOriginatingPool = pPool;
+    m_PoolSlotIndex = slotIndex;
 }
 
 void GameObject::SetParentGameObject(GameObject* pNewParentGameObject)
@@ -815,7 +858,7 @@ ComponentBase* GameObject::AddNewComponent(int componentType, SceneID sceneID, C
     if( m_Components.Count() >= m_Components.Length() )
         return nullptr;
 
-    ComponentBase* pComponent = pComponentSystemManager->GetComponentTypeManager()->CreateComponent( componentType );
+    ComponentBase* pComponent = pComponentSystemManager->CreateComponent( componentType, sceneID );
     //pComponent->SetComponentSystemManager( pComponentSystemManager );
 
     if( componentType == ComponentType_Transform )
@@ -892,6 +935,9 @@ ComponentBase* GameObject::AddExistingComponent(ComponentBase* pComponent, bool
             g_pComponentSystemManager->AddComponent( pComponent );
     }
 
+    // Components or their indices changed.
+    m_ComponentTypeTableVersion = 0;
+
     //// Register this components callbacks.
     //pComponent->RegisterCallbacks();
 
@@ -965,6 +1011,9 @@ ComponentBase* GameObject::RemoveComponent(ComponentBase* pComponent)
 
     if( found )
     {
+        // Components or their indices changed.
+        m_ComponentTypeTableVersion = 0;
+
         // Disable and unregister all this components callbacks.
         pComponent->SetEnabled( false );
 
@@ -1100,9 +1149,80 @@ ComponentBase* GameObject::GetNextComponentOfBaseType(ComponentBase* pLastCompon
     return nullptr; // Component not found.
 }
 
+void GameObject::UpdateComponentTypeTable()
+{
+    m_ComponentTypeMask = 0;
+
+    for( unsigned int i=0; i<GetComponentCountIncludingCore(); i++ )
+    {
+        ComponentTypeMask newTypes = GetComponentByIndexIncludingCore( i )->GetTypeMask() & ~m_ComponentTypeMask;
+
+        // Store this component's index for each type an earlier component didn't already have.
+        for( int typeID=0; newTypes != 0; typeID++ )
+        {
+            if( newTypes & ComponentTypeIDRegistry::GetBit( typeID ) )
+            {
+                m_FirstComponentIndexOfType[typeID] = (unsigned char)i;
+                newTypes &= ~ComponentTypeIDRegistry::GetBit( typeID );
+            }
+        }
+
+        m_ComponentTypeMask |= GetComponentByIndexIncludingCore( i )->GetTypeMask();
+    }
+
+    m_ComponentTypeTableVersion = ComponentTypeIDRegistry::GetVersion();
+}
+
+bool GameObject::HasComponentOfTypeID(int typeID)
+{
+    if( m_ComponentTypeTableVersion != ComponentTypeIDRegistry::GetVersion() )
+        UpdateComponentTypeTable();
+
+    return (m_ComponentTypeMask & ComponentTypeIDRegistry::GetBit( typeID )) != 0;
+}
+
+ComponentBase* GameObject::GetFirstComponentOfTypeID(int typeID)
+{
+    MyAssert( typeID >= 0 && typeID < ComponentTypeID_Max );
+
+    if( HasComponentOfTypeID( typeID ) == false )
+        return nullptr; // Component not found.
+
+    return GetComponentByIndexIncludingCore( m_FirstComponentIndexOfType[typeID] );
+}
+
+ComponentBase* GameObject::GetNextComponentOfTypeID(ComponentBase* pLastComponent, int typeID)
+{
+    MyAssert( pLastComponent != nullptr );
+    MyAssert( typeID >= 0 && typeID < ComponentTypeID_Max );
+
+    if( HasComponentOfTypeID( typeID ) == false )
+        return nullptr; // Component not found.
+
+    // Start searching after the first component of this type, since pLastComponent can't be before it.
+    bool foundLast = false;
+    for( unsigned int i=m_FirstComponentIndexOfType[typeID]; i<GetComponentCountIncludingCore(); i++ )
+    {
+        ComponentBase* pComponent = GetComponentByIndexIncludingCore( i );
+
+        if( pLastComponent == pComponent )
+            foundLast = true;
+        else if( foundLast && pComponent->IsType( typeID ) )
+            return pComponent;
+    }
+
+    return nullptr; // Component not found.
+}
+
 // Exposed to Lua, change elsewhere if function signature changes.
 ComponentBase* GameObject::GetFirstComponentOfType(const char* type)
 {
+    // Don't add IDs for names no component registered, like typos from Lua, each would bump the version and rebuild every table.
+    int typeID = ComponentTypeIDRegistry::FindID( type );
+    if( typeID != ComponentTypeID_None )
+        return GetFirstComponentOfTypeID( typeID );
+
+    // Unregistered names or all type IDs are in use, fall back to comparing classnames.
     for( unsigned int i=0; i<GetComponentCountIncludingCore(); i++ )
     {
         ComponentBase* pComponent = GetComponentByIndexIncludingCore( i );
@@ -1117,6 +1237,11 @@ ComponentBase* GameObject::GetNextComponentOfType(ComponentBase* pLastComponent)
 {
     MyAssert( pLastComponent != nullptr );
 
+    int typeID = pLastComponent->GetClassTypeID();
+    if( typeID != ComponentTypeID_None )
+        return GetNextComponentOfTypeID( pLastComponent, typeID );
+
+    // All type IDs are in use, fall back to comparing classnames.
     bool foundLast = false;
     for( unsigned int i=0; i<GetComponentCountIncludingCore(); i++ )
     {
@@ -1135,58 +1260,26 @@ void GameObject::RegisterOnDeleteCallback(void* pObj, GameObjectDeletedCallbackF
 {
     MyAssert( pCallback != nullptr );
 
-//#if _DEBUG
-    // Make sure the same callback isn't being registered.
-    for( CPPListNode* pNode = m_pOnDeleteCallbacks.GetHead(); pNode; pNode = pNode->GetNext() )
-    {
-        GameObjectDeletedCallbackStruct* pCallbackStruct = (GameObjectDeletedCallbackStruct*)pNode;
-        //MyAssert( pCallbackStruct->pObj != pObj && pCallbackStruct->pFunc != pCallback );
-        if( pCallbackStruct->pObj == pObj && pCallbackStruct->pFunc == pCallback )
-            return;
-    }
-//#endif
-
-    // TODO: Pool callback structures.
-    GameObjectDeletedCallbackStruct* pCallbackStruct = MyNew GameObjectDeletedCallbackStruct;
-    pCallbackStruct->pObj = pObj;
-    pCallbackStruct->pFunc = pCallback;
-
-    m_pOnDeleteCallbacks.AddTail( pCallbackStruct );
+    // Registering the same callback twice is ignored.
+    m_OnDeleteObservers.Subscribe( pObj, (ObserverFunc*)pCallback );
 }
 
 void GameObject::UnregisterOnDeleteCallback(void* pObj, GameObjectDeletedCallbackFunc* pCallback)
 {
-    for( CPPListNode* pNode = m_pOnDeleteCallbacks.GetHead(); pNode; pNode = pNode->GetNext() )
-    {
-        GameObjectDeletedCallbackStruct* pCallbackStruct = (GameObjectDeletedCallbackStruct*)pNode;
-        if( pCallbackStruct->pObj == pObj && pCallbackStruct->pFunc == pCallback )
-        {
-            pCallbackStruct->Remove();
-            delete pCallbackStruct;
-            return;
-        }
-    }
+    m_OnDeleteObservers.Unsubscribe( pObj, (ObserverFunc*)pCallback );
 }
 
 void GameObject::NotifyOthersThisWasDeleted()
 {
-    for( CPPListNode* pNode = m_pOnDeleteCallbacks.GetHead(); pNode; )
-    {
-        CPPListNode* pNextNode = pNode->GetNext();
-
-        GameObjectDeletedCallbackStruct* pCallbackStruct = (GameObjectDeletedCallbackStruct*)pNode;
-
-        // Remove the callback struct from the list before calling the function
-        //     since the callback function might try to unregister (and delete) the callback struct.
-        pCallbackStruct->Remove();
+    void* pObj;
+    ObserverFunc* pFunc;
 
+    // Each observer is unsubscribed before it's called,
+    //     since the callback function might try to unregister itself or others.
+    while( m_OnDeleteObservers.PopFirst( &pObj, &pFunc ) )
+    {
         // Call the onGameObjectDeleted callback function.
-        pCallbackStruct->pFunc( pCallbackStruct->pObj, this );
-
-        // Delete the struct.
-        delete pCallbackStruct;
-
-        pNode = pNextNode;
+        ((GameObjectDeletedCallbackFunc*)pFunc)( pObj, this );
     }
 }
 
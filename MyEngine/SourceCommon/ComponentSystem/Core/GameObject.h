@@ -11,6 +11,7 @@
 #define __GameObject_H__
 
 #include "PrefabManager.h"
+#include "ObserverList.h"
 #include "ComponentSystem/BaseComponents/ComponentGameObjectProperties.h"
 
 class Component2DCollisionObject;
@@ -30,11 +31,6 @@ class PrefabObject;
 class PrefabReference;
 
 typedef void GameObjectDeletedCallbackFunc(void* pObjectPtr, GameObject* pGameObject);
-struct GameObjectDeletedCallbackStruct : CPPListNode
-{
-    void* pObj;
-    GameObjectDeletedCallbackFunc* pFunc;
-};
 
 class GameObject : public TCPPListNode<GameObject*>
 {
@@ -61,23 +57,40 @@ protected:
     SceneID m_SceneID;
     unsigned int m_ID;
     SceneID m_PhysicsSceneID; // Can't be SCENEID_Unmanaged (runtime scene) if a collision component exists.
-    char* m_Name; // This a copy of the string passed in.
+    char* m_Name; // This a copy of the string passed in, unless set with SetSharedName().
+    bool m_OwnsName;
     ComponentObjectPool* m_pOriginatingPool; // If this isn't nullptr, this object came from a pool and should be returned to it.
+    unsigned int m_PoolSlotIndex; // Index of this object in its originating pool.
     bool m_Managed;
 
-    CPPListHead m_pOnDeleteCallbacks;
+    ObserverList m_OnDeleteObservers;
 
     ComponentTransform* m_pComponentTransform;
     MyList<ComponentBase*> m_Components; // ComponentSystemManager is responsible for deleting these components.
 
+    // Lookup table for GetFirstComponentOfTypeID(), rebuilt when components are added/removed or more type IDs are registered.
+    ComponentTypeMask m_ComponentTypeMask; // Every type bit of every component, including core components.
+    unsigned char m_FirstComponentIndexOfType[ComponentTypeID_Max]; // Index for GetComponentByIndexIncludingCore(), only valid if the type's bit is set.
+    unsigned int m_ComponentTypeTableVersion; // ComponentTypeIDRegistry version the table was built with, 0 if components changed.
+
 protected:
     void NotifyOthersThisWasDeleted();
+    void UpdateComponentTypeTable();
 
 public:
     GameObject(EngineCore* pEngineCore, bool managed, SceneID sceneID, bool isFolder, bool hasTransform, PrefabReference* pPrefabRef);
     virtual ~GameObject();
     SetClassnameBase( "GameObject" ); // Only first 8 character count.
 
+    // GameObjects can be allocated from a scene's arena, this returns the memory to wherever it came from.
+    static void operator delete(void* pMemory, size_t size);
+
+    // Declaring the above hides the global placement deletes, these match the placement news used to create GameObjects.
+    static void operator delete(void* pMemory, void* pPlace);
+#if MYFW_USE_MEMORY_TRACKER
+    static void operator delete(void* pMemory, char* file, unsigned long line);
+#endif
+
     PrefabReference* GetPrefabRef() { return &m_PrefabRef; }
     bool IsPrefabInstance() { return m_PrefabRef.GetPrefab() != 0; }
 
@@ -113,7 +126,8 @@ public:
     void SetSceneID(SceneID sceneID, bool assignNewGOID = true);
     void SetID(unsigned int id);
     void SetName(const char* name);
-    void SetOriginatingPool(ComponentObjectPool* pPool);
+    void SetSharedName(const char* name); // Doesn't copy the string, it must outlive this object or be replaced first.
+    void SetOriginatingPool(ComponentObjectPool* pPool, unsigned int slotIndex);
 
     void SetParentGameObject(GameObject* pNewParentGameObject);
     bool IsParentedTo(GameObject* pPotentialParent, bool onlyCheckDirectParent);
@@ -148,24 +162,29 @@ public:
     ComponentBase* GetFirstComponentOfBaseType(BaseComponentTypes baseType);
     ComponentBase* GetNextComponentOfBaseType(ComponentBase* pLastComponent);
 
+    // String versions are wrappers around the type ID versions.
     ComponentBase* GetFirstComponentOfType(const char* type);
     ComponentBase* GetNextComponentOfType(ComponentBase* pLastComponent);
 
+    bool HasComponentOfTypeID(int typeID);
+    ComponentBase* GetFirstComponentOfTypeID(int typeID);
+    ComponentBase* GetNextComponentOfTypeID(ComponentBase* pLastComponent, int typeID);
+
     // Exposed to Lua, change elsewhere if function signature changes.
     ComponentTransform* GetTransform() { return m_pComponentTransform; }
 
     // TODO: Find a way to find an arbitrary component type that would be accessible from lua script.
     // Exposed to Lua, change elsewhere if function signature changes.
-    ComponentSprite* GetSprite()                        { return (ComponentSprite*)GetFirstComponentOfType( "SpriteComponent" ); }
-    ComponentVoxelWorld* GetVoxelWorld()                { return (ComponentVoxelWorld*)GetFirstComponentOfType( "VoxelWorldComponent" ); }
-    Component3DCollisionObject* Get3DCollisionObject()  { return (Component3DCollisionObject*)GetFirstComponentOfType( "3DCollisionObjectComponent" ); }
-    Component2DCollisionObject* Get2DCollisionObject()  { return (Component2DCollisionObject*)GetFirstComponentOfType( "2DCollisionObjectComponent" ); }
-    ComponentLuaScript* GetLuaScript()                  { return (ComponentLuaScript*)GetFirstComponentOfType( "LuaScriptComponent" ); }
-    ComponentParticleEmitter* GetParticleEmitter()      { return (ComponentParticleEmitter*)GetFirstComponentOfType( "ParticleEmitterComponent" ); }
-    ComponentAnimationPlayer* GetAnimationPlayer()      { return (ComponentAnimationPlayer*)GetFirstComponentOfType( "AnimPlayerComponent" ); }
-    ComponentAnimationPlayer2D* Get2DAnimationPlayer()  { return (ComponentAnimationPlayer2D*)GetFirstComponentOfType( "Anim2DComponent" ); }
-    ComponentAudioPlayer* GetAudioPlayer()              { return (ComponentAudioPlayer*)GetFirstComponentOfType( "AudioPlayerComponent" ); }
-    ComponentObjectPool* GetObjectPool()                { return (ComponentObjectPool*)GetFirstComponentOfType( "ObjectPoolComponent" ); }
+    ComponentSprite* GetSprite()                        { return (ComponentSprite*)GetFirstComponentOfTypeID( ComponentTypeID_Sprite ); }
+    ComponentVoxelWorld* GetVoxelWorld()                { return (ComponentVoxelWorld*)GetFirstComponentOfTypeID( ComponentTypeID_VoxelWorld ); }
+    Component3DCollisionObject* Get3DCollisionObject()  { return (Component3DCollisionObject*)GetFirstComponentOfTypeID( ComponentTypeID_3DCollisionObject ); }
+    Component2DCollisionObject* Get2DCollisionObject()  { return (Component2DCollisionObject*)GetFirstComponentOfTypeID( ComponentTypeID_2DCollisionObject ); }
+    ComponentLuaScript* GetLuaScript()                  { return (ComponentLuaScript*)GetFirstComponentOfTypeID( ComponentTypeID_LuaScript ); }
+    ComponentParticleEmitter* GetParticleEmitter()      { return (ComponentParticleEmitter*)GetFirstComponentOfTypeID( ComponentTypeID_ParticleEmitter ); }
+    ComponentAnimationPlayer* GetAnimationPlayer()      { return (ComponentAnimationPlayer*)GetFirstComponentOfTypeID( ComponentTypeID_AnimationPlayer ); }
+    ComponentAnimationPlayer2D* Get2DAnimationPlayer()  { return (ComponentAnimationPlayer2D*)GetFirstComponentOfTypeID( ComponentTypeID_AnimationPlayer2D ); }
+    ComponentAudioPlayer* GetAudioPlayer()              { return (ComponentAudioPlayer*)GetFirstComponentOfTypeID( ComponentTypeID_AudioPlayer ); }
+    ComponentObjectPool* GetObjectPool()                { return (ComponentObjectPool*)GetFirstComponentOfTypeID( ComponentTypeID_ObjectPool ); }
 
     MaterialDefinition* GetMaterial();
     void SetMaterial(MaterialDefinition* pMaterial);
@@ -173,6 +192,8 @@ public:
     void SetScriptFile(MyFileObject* pFile);
 
     void ReturnToPool();
+    ComponentObjectPool* GetOriginatingPool() { return m_pOriginatingPool; }
+    unsigned int GetPoolSlotIndex() { return m_PoolSlotIndex; }
 
     // Callbacks
     void RegisterOnDeleteCallback(void* pObj, GameObjectDeletedCallbackFunc* pCallback);
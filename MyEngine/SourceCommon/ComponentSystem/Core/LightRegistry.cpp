@@ -0,0 +1,327 @@
+//
+// Copyright (c) 2020 Jimmy Lord http://www.flatheadgames.com
+//
+// This software is provided 'as-is', without any express or implied warranty.  In no event will the authors be held liable for any damages arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include "MyEnginePCH.h"
+
+#include "LightRegistry.h"
+#include "Core/EngineCore.h"
+
+LightRegistry::LightRegistry(EngineCore* pEngineCore)
+{
+    m_pEngineCore = pEngineCore;
+
+    m_CellSize = 10.0f;
+
+    m_QueryStamp = 0;
+    m_Generation = 0;
+    m_LightsVersion = 1;
+    m_BuiltLightsVersion = 0;
+
+    m_NumDirtyRegionsThisRebuild = 0;
+    m_LastGlobalChangeGeneration = 0;
+}
+
+LightRegistry::~LightRegistry()
+{
+}
+
+void LightRegistry::GetCellCoords(const Vector3& position, int* pX, int* pY, int* pZ)
+{
+    *pX = (int)floorf( position.x / m_CellSize );
+    *pY = (int)floorf( position.y / m_CellSize );
+    *pZ = (int)floorf( position.z / m_CellSize );
+}
+
+uint64 LightRegistry::GetCellKey(int x, int y, int z)
+{
+    // 21 bits per axis, wraps around far from the origin which only costs some extra candidates.
+    return ((uint64)(x & 0x1FFFFF) << 42) | ((uint64)(y & 0x1FFFFF) << 21) | (uint64)(z & 0x1FFFFF);
+}
+
+void LightRegistry::Rebuild()
+{
+    LightManager* pLightManager = m_pEngineCore->GetManagers()->GetLightManager();
+
+    // Keep the old lights around to compare against.
+    m_Lights.swap( m_PreviousLights );
+    m_Lights.clear();
+    m_CellEntries.clear();
+    m_UnboundedLights.clear();
+
+    for( CPPListNode* pNode = pLightManager->GetLightList()->GetHead(); pNode; pNode = pNode->GetNext() )
+    {
+        MyLight* pLight = static_cast<MyLight*>( pNode );
+
+        if( pLight->m_LightType == LightType_Directional )
+            continue;
+
+        LightInfo info;
+        info.m_pLight = pLight;
+        info.m_Type = pLight->m_LightType;
+        info.m_Position = pLight->m_Position;
+        info.m_Range = pLight->m_Attenuation.x;
+
+        unsigned int lightIndex = (unsigned int)m_Lights.size();
+        m_Lights.push_back( info );
+
+        if( info.m_Range <= 0 )
+        {
+            m_UnboundedLights.push_back( lightIndex );
+            continue;
+        }
+
+        // Add the light to every cell its range touches.
+        int minX, minY, minZ;
+        int maxX, maxY, maxZ;
+        GetCellCoords( info.m_Position - Vector3( info.m_Range ), &minX, &minY, &minZ );
+        GetCellCoords( info.m_Position + Vector3( info.m_Range ), &maxX, &maxY, &maxZ );
+
+        int numCells = (maxX - minX + 1) * (maxY - minY + 1) * (maxZ - minZ + 1);
+        if( numCells > MAX_CELLS_PER_QUERY )
+        {
+            m_UnboundedLights.push_back( lightIndex );
+            continue;
+        }
+
+        for( int z=minZ; z<=maxZ; z++ )
+        {
+            for( int y=minY; y<=maxY; y++ )
+            {
+                for( int x=minX; x<=maxX; x++ )
+                {
+                    CellEntry entry;
+                    entry.m_CellKey = GetCellKey( x, y, z );
+                    entry.m_LightIndex = lightIndex;
+                    m_CellEntries.push_back( entry );
+                }
+            }
+        }
+    }
+
+    std::sort( m_CellEntries.begin(), m_CellEntries.end() );
+
+    m_LightQueryStamps.clear();
+    m_LightQueryStamps.resize( m_Lights.size(), 0 );
+    m_QueryStamp = 0;
+
+    m_Generation++;
+    m_BuiltLightsVersion = m_LightsVersion;
+
+    FindChangedRegions();
+}
+
+void LightRegistry::FindChangedRegions()
+{
+    m_NumDirtyRegionsThisRebuild = 0;
+
+    // Drop regions too old for anyone to ask about.
+    unsigned int numExpired = 0;
+    while( numExpired < m_DirtyRegions.size() && m_Generation - m_DirtyRegions[numExpired].m_Generation >= MAX_DIRTY_GENERATIONS )
+        numExpired++;
+    m_DirtyRegions.erase( m_DirtyRegions.begin(), m_DirtyRegions.begin() + numExpired );
+
+    std::sort( m_PreviousLights.begin(), m_PreviousLights.end(), LightInfo::CompareLightPointers );
+    m_PreviousLightFound.assign( m_PreviousLights.size(), false );
+
+    // Lights that were added, moved, or changed type or range dirty both the area they used to reach and the area they reach now.
+    for( unsigned int i=0; i<m_Lights.size(); i++ )
+    {
+        LightInfo& info = m_Lights[i];
+
+        std::vector<LightInfo>::iterator it = std::lower_bound( m_PreviousLights.begin(), m_PreviousLights.end(), info, LightInfo::CompareLightPointers );
+        if( it == m_PreviousLights.end() || it->m_pLight != info.m_pLight )
+        {
+            AddDirtyRegion( info );
+            continue;
+        }
+
+        m_PreviousLightFound[it - m_PreviousLights.begin()] = true;
+
+        if( it->m_Type == info.m_Type && it->m_Range == info.m_Range &&
+            it->m_Position.x == info.m_Position.x && it->m_Position.y == info.m_Position.y && it->m_Position.z == info.m_Position.z )
+        {
+            continue;
+        }
+
+        AddDirtyRegion( *it );
+        AddDirtyRegion( info );
+    }
+
+    // Lights that were removed.
+    for( unsigned int i=0; i<m_PreviousLights.size(); i++ )
+    {
+        if( m_PreviousLightFound[i] == false )
+            AddDirtyRegion( m_PreviousLights[i] );
+    }
+}
+
+void LightRegistry::AddDirtyRegion(const LightInfo& info)
+{
+    if( info.m_Range <= 0 || m_NumDirtyRegionsThisRebuild >= MAX_DIRTY_REGIONS_PER_REBUILD )
+    {
+        m_LastGlobalChangeGeneration = m_Generation;
+        return;
+    }
+
+    DirtyRegion region;
+    region.m_Generation = m_Generation;
+    region.m_BoundsMin = info.m_Position - Vector3( info.m_Range );
+    region.m_BoundsMax = info.m_Position + Vector3( info.m_Range );
+    m_DirtyRegions.push_back( region );
+
+    m_NumDirtyRegionsThisRebuild++;
+}
+
+bool LightRegistry::HaveLightsChangedInBounds(unsigned int sinceGeneration, const Vector3& boundsMin, const Vector3& boundsMax)
+{
+    if( sinceGeneration == m_Generation )
+        return false;
+
+    // Too old to tell, or something changed that reaches every box.
+    if( m_Generation - sinceGeneration > MAX_DIRTY_GENERATIONS || m_LastGlobalChangeGeneration > sinceGeneration )
+        return true;
+
+    // Only the newest regions matter, walk back until they're older than the caller's results.
+    for( int i=(int)m_DirtyRegions.size()-1; i>=0; i-- )
+    {
+        DirtyRegion& region = m_DirtyRegions[i];
+        if( region.m_Generation <= sinceGeneration )
+            break;
+
+        if( region.m_BoundsMin.x <= boundsMax.x && region.m_BoundsMax.x >= boundsMin.x &&
+            region.m_BoundsMin.y <= boundsMax.y && region.m_BoundsMax.y >= boundsMin.y &&
+            region.m_BoundsMin.z <= boundsMax.z && region.m_BoundsMax.z >= boundsMin.z )
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void LightRegistry::Update()
+{
+    if( m_BuiltLightsVersion != m_LightsVersion )
+    {
+        Rebuild();
+    }
+}
+
+void LightRegistry::AddCandidate(unsigned int lightIndex, LightTypes lightType, const Vector3& boundsMin, const Vector3& boundsMax)
+{
+    if( m_LightQueryStamps[lightIndex] == m_QueryStamp )
+        return;
+
+    m_LightQueryStamps[lightIndex] = m_QueryStamp;
+
+    LightInfo& info = m_Lights[lightIndex];
+    if( info.m_Type != lightType )
+        return;
+
+    // Skip lights whose range doesn't reach the box.
+    if( info.m_Range > 0 )
+    {
+        Vector3 closest = info.m_Position;
+        if( closest.x < boundsMin.x ) closest.x = boundsMin.x; else if( closest.x > boundsMax.x ) closest.x = boundsMax.x;
+        if( closest.y < boundsMin.y ) closest.y = boundsMin.y; else if( closest.y > boundsMax.y ) closest.y = boundsMax.y;
+        if( closest.z < boundsMin.z ) closest.z = boundsMin.z; else if( closest.z > boundsMax.z ) closest.z = boundsMax.z;
+
+        if( (closest - info.m_Position).LengthSquared() > info.m_Range * info.m_Range )
+            return;
+    }
+
+    m_Candidates.push_back( lightIndex );
+}
+
+int LightRegistry::FindNearestLights(LightTypes lightType, int maxLights, const Vector3& boundsMin, const Vector3& boundsMax, MyLight** ppLightArray)
+{
+    MyAssert( maxLights > 0 );
+
+    // Start a new query, reset the stamps if the counter wraps.
+    m_QueryStamp++;
+    if( m_QueryStamp == 0 )
+    {
+        for( unsigned int i=0; i<m_LightQueryStamps.size(); i++ )
+            m_LightQueryStamps[i] = 0;
+        m_QueryStamp = 1;
+    }
+
+    m_Candidates.clear();
+
+    for( unsigned int i=0; i<m_UnboundedLights.size(); i++ )
+    {
+        AddCandidate( m_UnboundedLights[i], lightType, boundsMin, boundsMax );
+    }
+
+    int minX, minY, minZ;
+    int maxX, maxY, maxZ;
+    GetCellCoords( boundsMin, &minX, &minY, &minZ );
+    GetCellCoords( boundsMax, &maxX, &maxY, &maxZ );
+
+    int numCells = (maxX - minX + 1) * (maxY - minY + 1) * (maxZ - minZ + 1);
+    if( numCells > MAX_CELLS_PER_QUERY )
+    {
+        // Box covers a large part of the grid, test every light instead.
+        for( unsigned int i=0; i<m_Lights.size(); i++ )
+        {
+            AddCandidate( i, lightType, boundsMin, boundsMax );
+        }
+    }
+    else if( m_CellEntries.size() > 0 )
+    {
+        for( int z=minZ; z<=maxZ; z++ )
+        {
+            for( int y=minY; y<=maxY; y++ )
+            {
+                for( int x=minX; x<=maxX; x++ )
+                {
+                    CellEntry key;
+                    key.m_CellKey = GetCellKey( x, y, z );
+                    key.m_LightIndex = 0;
+
+                    std::vector<CellEntry>::iterator it = std::lower_bound( m_CellEntries.begin(), m_CellEntries.end(), key );
+                    for( ; it != m_CellEntries.end() && it->m_CellKey == key.m_CellKey; it++ )
+                    {
+                        AddCandidate( it->m_LightIndex, lightType, boundsMin, boundsMax );
+                    }
+                }
+            }
+        }
+    }
+
+    // Keep the nearest lights to the center of the box with an insertion sort, maxLights is small.
+    Vector3 center = (boundsMin + boundsMax) * 0.5f;
+
+    int numLights = 0;
+    float distances[MAX_LIGHTS_PER_QUERY];
+    if( maxLights > MAX_LIGHTS_PER_QUERY )
+        maxLights = MAX_LIGHTS_PER_QUERY;
+
+    for( unsigned int i=0; i<m_Candidates.size(); i++ )
+    {
+        LightInfo& info = m_Lights[m_Candidates[i]];
+        float distance = (info.m_Position - center).LengthSquared();
+
+        if( numLights == maxLights && distance >= distances[numLights-1] )
+            continue;
+
+        int slot = numLights < maxLights ? numLights++ : numLights-1;
+        while( slot > 0 && distances[slot-1] > distance )
+        {
+            distances[slot] = distances[slot-1];
+            ppLightArray[slot] = ppLightArray[slot-1];
+            slot--;
+        }
+
+        distances[slot] = distance;
+        ppLightArray[slot] = info.m_pLight;
+    }
+
+    return numLights;
+}
@@ -0,0 +1,112 @@
+//
+// Copyright (c) 2020 Jimmy Lord http://www.flatheadgames.com
+//
+// This software is provided 'as-is', without any express or implied warranty.  In no event will the authors be held liable for any damages arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#ifndef __LightRegistry_H__
+#define __LightRegistry_H__
+
+// Bins point and spot lights into a uniform grid based on their range, so meshes can find nearby lights
+//     without sorting every light in the scene.
+// The grid is only rebuilt when a light is added, removed, moved or changes range,
+//     whatever changes a light needs to call OnLightChanged().
+// Each rebuild also records the regions the changed lights covered before and after,
+//     so callers caching query results only need to query again if their bounds overlap one.
+class LightRegistry
+{
+public:
+    static const int MAX_CELLS_PER_QUERY = 64; // Larger queries just test every light.
+    static const int MAX_LIGHTS_PER_QUERY = 8;
+    static const unsigned int MAX_DIRTY_GENERATIONS = 8; // Caches older than this many rebuilds always query again.
+    static const unsigned int MAX_DIRTY_REGIONS_PER_REBUILD = 256; // Past this, a rebuild counts as changing everything.
+
+protected:
+    struct LightInfo
+    {
+        MyLight* m_pLight;
+        LightTypes m_Type;
+        Vector3 m_Position;
+        float m_Range; // 0 or less means the light has no range, so it's added to every query.
+
+        static bool CompareLightPointers(const LightInfo& a, const LightInfo& b) { return a.m_pLight < b.m_pLight; }
+    };
+
+    struct DirtyRegion
+    {
+        unsigned int m_Generation;
+        Vector3 m_BoundsMin;
+        Vector3 m_BoundsMax;
+    };
+
+    struct CellEntry
+    {
+        uint64 m_CellKey;
+        unsigned int m_LightIndex;
+
+        bool operator<(const CellEntry& other) const
+        {
+            if( m_CellKey != other.m_CellKey ) return m_CellKey < other.m_CellKey;
+            return m_LightIndex < other.m_LightIndex;
+        }
+    };
+
+    EngineCore* m_pEngineCore;
+
+    float m_CellSize;
+
+    std::vector<LightInfo> m_Lights;
+    std::vector<LightInfo> m_PreviousLights; // Lights from the last rebuild, sorted by pointer while finding what changed.
+    std::vector<bool> m_PreviousLightFound;
+    std::vector<CellEntry> m_CellEntries; // Sorted by cell, lookups are a binary search.
+    std::vector<unsigned int> m_UnboundedLights;
+
+    std::vector<unsigned int> m_Candidates; // Kept between queries to avoid allocating.
+    std::vector<unsigned int> m_LightQueryStamps; // Used to skip lights found in more than one cell.
+    unsigned int m_QueryStamp;
+
+    unsigned int m_Generation; // Incremented each time the grid is rebuilt.
+    unsigned int m_LightsVersion; // Bumped by OnLightChanged.
+    unsigned int m_BuiltLightsVersion; // Version the grid was last built from.
+
+    std::vector<DirtyRegion> m_DirtyRegions; // Oldest first, trimmed to the last MAX_DIRTY_GENERATIONS rebuilds.
+    unsigned int m_NumDirtyRegionsThisRebuild;
+    unsigned int m_LastGlobalChangeGeneration; // Last rebuild that changed a light without a range or too many lights at once.
+
+protected:
+    void GetCellCoords(const Vector3& position, int* pX, int* pY, int* pZ);
+    uint64 GetCellKey(int x, int y, int z);
+
+    void Rebuild();
+    void FindChangedRegions();
+    void AddDirtyRegion(const LightInfo& info);
+
+    void AddCandidate(unsigned int lightIndex, LightTypes lightType, const Vector3& boundsMin, const Vector3& boundsMax);
+
+public:
+    LightRegistry(EngineCore* pEngineCore);
+    ~LightRegistry();
+
+    // Call before drawing, rebuilds the grid if any lights changed since the last call.
+    void Update();
+
+    // Call when a light is created, destroyed, enabled, disabled, moved or changes type or range.
+    void OnLightChanged() { m_LightsVersion++; }
+
+    // Finds up to maxLights lights of the given type that reach the box, nearest to the center of the box first.
+    int FindNearestLights(LightTypes lightType, int maxLights, const Vector3& boundsMin, const Vector3& boundsMax, MyLight** ppLightArray);
+
+    void SetCellSize(float size) { m_CellSize = size > 0 ? size : 1; m_LightsVersion++; }
+
+    // Results of FindNearestLights are valid for as long as this doesn't change.
+    unsigned int GetGeneration() { return m_Generation; }
+
+    // Results of FindNearestLights from sinceGeneration are still valid for this box if this returns false.
+    bool HaveLightsChangedInBounds(unsigned int sinceGeneration, const Vector3& boundsMin, const Vector3& boundsMax);
+    unsigned int GetNumberOfLights() { return (unsigned int)m_Lights.size(); }
+};
+
+#endif //__LightRegistry_H__
@@ -0,0 +1,257 @@
+//
+// Copyright (c) 2020 Jimmy Lord http://www.flatheadgames.com
+//
+// This software is provided 'as-is', without any express or implied warranty.  In no event will the authors be held liable for any damages arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include "MyEnginePCH.h"
+
+#include "ObserverList.h"
+
+ObserverPool ObserverPool::m_Instance;
+
+ObserverPool::ObserverPool()
+{
+    m_FirstFreeSlot = INVALID_SLOT;
+    m_NumSlotsInUse = 0;
+}
+
+ObserverPool::~ObserverPool()
+{
+    for( unsigned int i=0; i<m_Chunks.size(); i++ )
+    {
+        delete[] m_Chunks[i];
+    }
+}
+
+unsigned int ObserverPool::AllocateSlot()
+{
+    // Add a new chunk of slots if none are free.
+    if( m_FirstFreeSlot == INVALID_SLOT )
+    {
+        unsigned int firstIndex = (unsigned int)m_Chunks.size() * SLOTS_PER_CHUNK;
+
+        Slot* pChunk = new Slot[SLOTS_PER_CHUNK];
+        m_Chunks.push_back( pChunk );
+
+        // Link the new slots in order, so they're handed out in order.
+        for( unsigned int i=0; i<SLOTS_PER_CHUNK; i++ )
+        {
+            pChunk[i].m_pList = nullptr;
+            pChunk[i].m_Next = (i == SLOTS_PER_CHUNK-1) ? INVALID_SLOT : firstIndex + i + 1;
+        }
+
+        m_FirstFreeSlot = firstIndex;
+
+        // Grow the lookup table to keep it at most half full, then add back the slots in use.
+        unsigned int tableSize = 1;
+        while( tableSize < GetNumSlotsAllocated() * 2 )
+            tableSize *= 2;
+
+        m_LookupTable.assign( tableSize, (unsigned int)INVALID_SLOT );
+        for( unsigned int i=0; i<firstIndex; i++ )
+        {
+            if( GetSlot( i ).m_pList != nullptr )
+                AddToLookupTable( i );
+        }
+    }
+
+    unsigned int slotIndex = m_FirstFreeSlot;
+    m_FirstFreeSlot = GetSlot( slotIndex ).m_Next;
+    m_NumSlotsInUse++;
+
+    return slotIndex;
+}
+
+void ObserverPool::FreeSlot(unsigned int slotIndex)
+{
+    Slot& slot = GetSlot( slotIndex );
+
+    slot.m_pList = nullptr;
+    slot.m_Next = m_FirstFreeSlot;
+    m_FirstFreeSlot = slotIndex;
+
+    m_NumSlotsInUse--;
+}
+
+unsigned int ObserverPool::GetLookupIndex(ObserverList* pList, void* pObj, ObserverFunc* pFunc)
+{
+    size_t hash = (size_t)pList;
+    hash = hash * 31 + (size_t)pObj;
+    hash = hash * 31 + (size_t)pFunc;
+
+    // Pointers are aligned, mix the high bits into the low ones before masking.
+    hash ^= hash >> 16;
+    hash *= 0x45d9f3b;
+    hash ^= hash >> 16;
+
+    return (unsigned int)hash & (unsigned int)(m_LookupTable.size() - 1);
+}
+
+unsigned int ObserverPool::FindSlot(ObserverList* pList, void* pObj, ObserverFunc* pFunc)
+{
+    if( m_LookupTable.size() == 0 )
+        return INVALID_SLOT;
+
+    unsigned int mask = (unsigned int)m_LookupTable.size() - 1;
+    for( unsigned int i = GetLookupIndex( pList, pObj, pFunc ); m_LookupTable[i] != INVALID_SLOT; i = (i + 1) & mask )
+    {
+        Slot& slot = GetSlot( m_LookupTable[i] );
+        if( slot.m_pList == pList && slot.m_pObj == pObj && slot.m_pFunc == pFunc )
+            return m_LookupTable[i];
+    }
+
+    return INVALID_SLOT;
+}
+
+void ObserverPool::AddToLookupTable(unsigned int slotIndex)
+{
+    Slot& slot = GetSlot( slotIndex );
+
+    unsigned int mask = (unsigned int)m_LookupTable.size() - 1;
+    unsigned int i = GetLookupIndex( slot.m_pList, slot.m_pObj, slot.m_pFunc );
+    while( m_LookupTable[i] != INVALID_SLOT )
+        i = (i + 1) & mask;
+
+    m_LookupTable[i] = slotIndex;
+}
+
+void ObserverPool::RemoveFromLookupTable(unsigned int slotIndex)
+{
+    Slot& slot = GetSlot( slotIndex );
+
+    unsigned int mask = (unsigned int)m_LookupTable.size() - 1;
+    unsigned int i = GetLookupIndex( slot.m_pList, slot.m_pObj, slot.m_pFunc );
+    while( m_LookupTable[i] != slotIndex )
+    {
+        MyAssert( m_LookupTable[i] != INVALID_SLOT );
+        i = (i + 1) & mask;
+    }
+
+    m_LookupTable[i] = INVALID_SLOT;
+
+    // Shift back any following entries that can no longer be reached past the gap.
+    for( unsigned int j = (i + 1) & mask; m_LookupTable[j] != INVALID_SLOT; j = (j + 1) & mask )
+    {
+        Slot& other = GetSlot( m_LookupTable[j] );
+        unsigned int home = GetLookupIndex( other.m_pList, other.m_pObj, other.m_pFunc );
+
+        // Entries whose home is cyclically in (i, j] are still reachable.
+        bool reachable = (i <= j) ? (home > i && home <= j) : (home > i || home <= j);
+        if( reachable )
+            continue;
+
+        m_LookupTable[i] = m_LookupTable[j];
+        m_LookupTable[j] = INVALID_SLOT;
+        i = j;
+    }
+}
+
+ObserverList::ObserverList()
+{
+    m_FirstSlot = ObserverPool::INVALID_SLOT;
+    m_LastSlot = ObserverPool::INVALID_SLOT;
+    m_Count = 0;
+}
+
+ObserverList::ObserverList(const ObserverList& other)
+{
+    m_FirstSlot = ObserverPool::INVALID_SLOT;
+    m_LastSlot = ObserverPool::INVALID_SLOT;
+    m_Count = 0;
+}
+
+ObserverList::~ObserverList()
+{
+    UnsubscribeAll();
+}
+
+bool ObserverList::Subscribe(void* pObj, ObserverFunc* pFunc)
+{
+    MyAssert( pFunc != nullptr );
+
+    ObserverPool* pPool = ObserverPool::Get();
+
+    // Don't subscribe the same callback twice.
+    if( pPool->FindSlot( this, pObj, pFunc ) != ObserverPool::INVALID_SLOT )
+        return false;
+
+    unsigned int slotIndex = pPool->AllocateSlot();
+    ObserverPool::Slot& slot = pPool->GetSlot( slotIndex );
+
+    slot.m_pList = this;
+    slot.m_pObj = pObj;
+    slot.m_pFunc = pFunc;
+    slot.m_Prev = m_LastSlot;
+    slot.m_Next = ObserverPool::INVALID_SLOT;
+
+    if( m_LastSlot != ObserverPool::INVALID_SLOT )
+        pPool->GetSlot( m_LastSlot ).m_Next = slotIndex;
+    else
+        m_FirstSlot = slotIndex;
+    m_LastSlot = slotIndex;
+    m_Count++;
+
+    pPool->AddToLookupTable( slotIndex );
+
+    return true;
+}
+
+bool ObserverList::Unsubscribe(void* pObj, ObserverFunc* pFunc)
+{
+    ObserverPool* pPool = ObserverPool::Get();
+
+    unsigned int slotIndex = pPool->FindSlot( this, pObj, pFunc );
+    if( slotIndex == ObserverPool::INVALID_SLOT )
+        return false;
+
+    RemoveSlot( slotIndex );
+    return true;
+}
+
+void ObserverList::UnsubscribeAll()
+{
+    while( m_FirstSlot != ObserverPool::INVALID_SLOT )
+    {
+        RemoveSlot( m_FirstSlot );
+    }
+}
+
+bool ObserverList::PopFirst(void** ppObj, ObserverFunc** ppFunc)
+{
+    if( m_FirstSlot == ObserverPool::INVALID_SLOT )
+        return false;
+
+    ObserverPool::Slot& slot = ObserverPool::Get()->GetSlot( m_FirstSlot );
+    *ppObj = slot.m_pObj;
+    *ppFunc = slot.m_pFunc;
+
+    RemoveSlot( m_FirstSlot );
+    return true;
+}
+
+void ObserverList::RemoveSlot(unsigned int slotIndex)
+{
+    ObserverPool* pPool = ObserverPool::Get();
+    ObserverPool::Slot& slot = pPool->GetSlot( slotIndex );
+
+    MyAssert( slot.m_pList == this );
+
+    if( slot.m_Prev != ObserverPool::INVALID_SLOT )
+        pPool->GetSlot( slot.m_Prev ).m_Next = slot.m_Next;
+    else
+        m_FirstSlot = slot.m_Next;
+
+    if( slot.m_Next != ObserverPool::INVALID_SLOT )
+        pPool->GetSlot( slot.m_Next ).m_Prev = slot.m_Prev;
+    else
+        m_LastSlot = slot.m_Prev;
+
+    m_Count--;
+
+    pPool->RemoveFromLookupTable( slotIndex );
+    pPool->FreeSlot( slotIndex );
+}
@@ -0,0 +1,107 @@
+//
+// Copyright (c) 2020 Jimmy Lord http://www.flatheadgames.com
+//
+// This software is provided 'as-is', without any express or implied warranty.  In no event will the authors be held liable for any damages arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#ifndef __ObserverList_H__
+#define __ObserverList_H__
+
+class ObserverList;
+
+// Callbacks are stored as this type, the subject casts them back to the real type when notifying.
+typedef void ObserverFunc();
+
+// Engine-wide storage for the subscriptions of every ObserverList.
+// Slots are allocated in fixed size chunks, so they never move and there's no limit on the number of subscriptions.
+// Slots are found by list/object/function through an open addressed table that's only resized when a chunk is added,
+//     so subscribing and unsubscribing don't allocate.
+class ObserverPool
+{
+    friend class ObserverList;
+
+public:
+    static const unsigned int SLOTS_PER_CHUNK = 1024;
+    static const unsigned int INVALID_SLOT = 0xFFFFFFFF;
+
+    struct Slot
+    {
+        ObserverList* m_pList; // nullptr if the slot is free.
+        void* m_pObj;
+        ObserverFunc* m_pFunc;
+        unsigned int m_Prev;
+        unsigned int m_Next; // Links free slots together when the slot isn't in use.
+    };
+
+protected:
+    static ObserverPool m_Instance;
+
+    std::vector<Slot*> m_Chunks;
+    unsigned int m_FirstFreeSlot;
+    unsigned int m_NumSlotsInUse;
+
+    // Slot indices with linear probing, a power of 2 at least twice the number of slots.
+    std::vector<unsigned int> m_LookupTable;
+
+protected:
+    ObserverPool();
+    ~ObserverPool();
+
+    unsigned int AllocateSlot();
+    void FreeSlot(unsigned int slotIndex);
+
+    unsigned int GetLookupIndex(ObserverList* pList, void* pObj, ObserverFunc* pFunc);
+    unsigned int FindSlot(ObserverList* pList, void* pObj, ObserverFunc* pFunc);
+    void AddToLookupTable(unsigned int slotIndex);
+    void RemoveFromLookupTable(unsigned int slotIndex);
+
+public:
+    static ObserverPool* Get() { return &m_Instance; }
+
+    Slot& GetSlot(unsigned int slotIndex) { return m_Chunks[slotIndex / SLOTS_PER_CHUNK][slotIndex % SLOTS_PER_CHUNK]; }
+
+    unsigned int GetNumSlotsInUse() { return m_NumSlotsInUse; }
+    unsigned int GetNumSlotsAllocated() { return (unsigned int)m_Chunks.size() * SLOTS_PER_CHUNK; }
+};
+
+// List of callbacks to notify when something happens to the object that owns the list.
+// Subscribing and unsubscribing by object/function pair are O(1).
+class ObserverList
+{
+protected:
+    unsigned int m_FirstSlot;
+    unsigned int m_LastSlot;
+    unsigned int m_Count;
+
+protected:
+    void RemoveSlot(unsigned int slotIndex);
+
+public:
+    ObserverList();
+    ~ObserverList();
+
+    // Observers belong to the list they subscribed to, copying an owner (i.e. CopyFromSameType_Dangerous) won't copy them.
+    ObserverList(const ObserverList& other);
+    ObserverList& operator=(const ObserverList& /*other*/) { return *this; }
+
+    // Returns false if this object/function pair is already subscribed.
+    bool Subscribe(void* pObj, ObserverFunc* pFunc);
+    bool Unsubscribe(void* pObj, ObserverFunc* pFunc);
+    void UnsubscribeAll();
+
+    // Unsubscribes the first observer and returns it, for notifying and clearing the list in one pass.
+    bool PopFirst(void** ppObj, ObserverFunc** ppFunc);
+
+    unsigned int GetCount() { return m_Count; }
+
+    // Iterate with: for( slot = GetFirstSlot(); slot != ObserverPool::INVALID_SLOT; slot = next ),
+    //     grab the next slot before notifying in case the observer unsubscribes itself.
+    unsigned int GetFirstSlot() { return m_FirstSlot; }
+    unsigned int GetNextSlot(unsigned int slotIndex) { return ObserverPool::Get()->GetSlot( slotIndex ).m_Next; }
+    ObserverPool::Slot& GetSlot(unsigned int slotIndex) { return ObserverPool::Get()->GetSlot( slotIndex ); }
+};
+
+#endif //__ObserverList_H__
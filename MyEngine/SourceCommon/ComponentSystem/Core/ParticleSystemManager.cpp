@@ -0,0 +1,333 @@
+//
+// Copyright (c) 2020 Jimmy Lord http://www.flatheadgames.com
+//
+// This software is provided 'as-is', without any express or implied warranty.  In no event will the authors be held liable for any damages arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+
+#include "MyEnginePCH.h"
+
+#include "ParticleSystemManager.h"
+#include "ComponentSystem/BaseComponents/ComponentCamera.h"
+#include "ComponentSystem/BaseComponents/ComponentTransform.h"
+#include "ComponentSystem/Core/ComponentSystemManager.h"
+#include "ComponentSystem/FrameworkComponents/ComponentParticleEmitter.h"
+#include "Core/EngineCore.h"
+
+//====================================================================================================
+// ParticleEmitterUpdateJob
+//====================================================================================================
+
+class ParticleEmitterUpdateJob : public MyJob
+{
+protected:
+    ComponentParticleEmitter** m_ppEmitters;
+    unsigned int m_NumEmitters;
+    MyMatrix* m_pMatCameraRotation;
+
+public:
+    unsigned int m_ParticlesSimulated;
+
+public:
+    ParticleEmitterUpdateJob()
+    {
+        m_ppEmitters = nullptr;
+        m_NumEmitters = 0;
+        m_pMatCameraRotation = nullptr;
+        m_ParticlesSimulated = 0;
+    }
+
+    // Call before adding the job to the job manager.
+    void PrepareToUpdate(ComponentParticleEmitter** ppEmitters, unsigned int numEmitters, MyMatrix* pMatCameraRotation)
+    {
+        m_IsStarted = false;
+        m_IsFinished = false;
+
+        m_ppEmitters = ppEmitters;
+        m_NumEmitters = numEmitters;
+        m_pMatCameraRotation = pMatCameraRotation;
+        m_ParticlesSimulated = 0;
+    }
+
+    virtual void DoWork()
+    {
+        for( unsigned int i=0; i<m_NumEmitters; i++ )
+        {
+            ComponentParticleEmitter* pEmitter = m_ppEmitters[i];
+
+            // m_TimeSinceLastUpdate is cleared on the main thread after spawning, which uses the same time.
+            m_ParticlesSimulated += pEmitter->m_Particles.GetCount();
+            pEmitter->UpdateParticles( pEmitter->m_TimeSinceLastUpdate, m_pMatCameraRotation );
+        }
+    }
+};
+
+//====================================================================================================
+// ParticleSystemManager
+//====================================================================================================
+
+ParticleSystemManager::ParticleSystemManager()
+{
+    for( int i=0; i<MAX_JOBS+1; i++ )
+    {
+        m_pJobs[i] = MyNew ParticleEmitterUpdateJob;
+    }
+
+    m_UpdateInParallel = true;
+    m_ThrottleDistance = 50.0f;
+    m_MaxThrottleInterval = 4;
+    m_CullOffscreenEmitters = true;
+    m_MaxCatchUpTime = 0.5f;
+    m_ParticleBudget = 0;
+
+    m_FrameCount = 0;
+
+    memset( &m_Stats, 0, sizeof(Stats) );
+}
+
+ParticleSystemManager::~ParticleSystemManager()
+{
+    // Emitters are unregistered when they're disabled, so there shouldn't be any left.
+    // If there are, make sure they won't try to unregister from this manager once it's gone.
+    MyAssert( m_Emitters.size() == 0 );
+    for( unsigned int i=0; i<m_Emitters.size(); i++ )
+    {
+        m_Emitters[i]->m_ParticleSystemManagerIndex = -1;
+    }
+
+    // Jobs are always waited on in Tick(), so none of these will be queued.
+    for( int i=0; i<MAX_JOBS+1; i++ )
+    {
+        SAFE_DELETE( m_pJobs[i] );
+    }
+}
+
+void ParticleSystemManager::RegisterEmitter(ComponentParticleEmitter* pEmitter)
+{
+    MyAssert( pEmitter->m_ParticleSystemManagerIndex == -1 );
+
+    pEmitter->m_ParticleSystemManagerIndex = (int)m_Emitters.size();
+    pEmitter->m_TimeSinceLastUpdate = 0;
+    m_Emitters.push_back( pEmitter );
+}
+
+void ParticleSystemManager::UnregisterEmitter(ComponentParticleEmitter* pEmitter)
+{
+    int index = pEmitter->m_ParticleSystemManagerIndex;
+    if( index == -1 )
+        return;
+
+    MyAssert( m_Emitters[index] == pEmitter );
+
+    // Swap the last emitter into this slot.
+    ComponentParticleEmitter* pLastEmitter = m_Emitters.back();
+    m_Emitters[index] = pLastEmitter;
+    pLastEmitter->m_ParticleSystemManagerIndex = index;
+    m_Emitters.pop_back();
+
+    pEmitter->m_ParticleSystemManagerIndex = -1;
+}
+
+// Same clip space test as ComponentMesh::DrawCallback, using the emitter's particle bounds.
+bool ParticleSystemManager::IsEmitterOnScreen(ComponentParticleEmitter* pEmitter, MyMatrix* pMatViewProj)
+{
+    Vector3 min;
+    Vector3 max;
+    pEmitter->GetBounds( &min, &max );
+
+    Vector4 clippos[8];
+    clippos[0] = *pMatViewProj * Vector4( min.x, min.y, min.z, 1 );
+    clippos[1] = *pMatViewProj * Vector4( min.x, min.y, max.z, 1 );
+    clippos[2] = *pMatViewProj * Vector4( min.x, max.y, min.z, 1 );
+    clippos[3] = *pMatViewProj * Vector4( min.x, max.y, max.z, 1 );
+    clippos[4] = *pMatViewProj * Vector4( max.x, min.y, min.z, 1 );
+    clippos[5] = *pMatViewProj * Vector4( max.x, min.y, max.z, 1 );
+    clippos[6] = *pMatViewProj * Vector4( max.x, max.y, min.z, 1 );
+    clippos[7] = *pMatViewProj * Vector4( max.x, max.y, max.z, 1 );
+
+    for( int component=0; component<3; component++ ) // Loop through x/y/z.
+    {
+        bool insideMin = false;
+        bool insideMax = false;
+        for( int i=0; i<8; i++ )
+        {
+            if( clippos[i][component] >= -clippos[i].w )
+                insideMin = true;
+            if( clippos[i][component] <= clippos[i].w )
+                insideMax = true;
+        }
+
+        // All points are outside of one plane.
+        if( insideMin == false || insideMax == false )
+            return false;
+    }
+
+    return true;
+}
+
+void ParticleSystemManager::Tick(float deltaTime)
+{
+    memset( &m_Stats, 0, sizeof(Stats) );
+
+    if( m_Emitters.size() == 0 )
+        return;
+
+    double startTime = MyTime_GetSystemTime();
+
+    m_FrameCount++;
+
+    // Get the camera info once for all emitters, use the editor camera if in editor mode.
+    // Cameras tick after this, so build the view matrix from the camera's current transform rather than
+    //     using last frame's m_matViewProj, otherwise emitters pop at the screen edges while the camera moves.
+    Vector3 campos( 0, 0, 0 );
+    Vector3 camrot( 0, 0, 0 );
+    MyMatrix matViewProj;
+    MyMatrix* pMatViewProj = nullptr;
+    ComponentCamera* pCamera = g_pComponentSystemManager->GetFirstCamera( true );
+    if( pCamera )
+    {
+        campos = pCamera->m_pComponentTransform->GetWorldPosition();
+        camrot = pCamera->m_pComponentTransform->GetLocalRotation();
+        if( pCamera->m_Orthographic == false )
+        {
+            MyMatrix matView = *pCamera->m_pComponentTransform->GetWorldTransform();
+            matView.Inverse();
+            matViewProj = pCamera->m_Camera3D.m_matProj * matView;
+            pMatViewProj = &matViewProj;
+        }
+    }
+
+    MyMatrix matCameraRotation;
+    matCameraRotation.CreateSRT( Vector3(1), camrot, Vector3(0) );
+
+    // Decide which emitters get updated this frame.
+    m_Candidates.clear();
+    for( unsigned int i=0; i<m_Emitters.size(); i++ )
+    {
+        ComponentParticleEmitter* pEmitter = m_Emitters[i];
+
+        // Cap the time owed, so an emitter that was off screen for a while doesn't age all its particles out in one update.
+        float emitterDeltaTime = pEmitter->GetEmitterDeltaTime( deltaTime );
+        pEmitter->m_TimeSinceLastUpdate += emitterDeltaTime;
+        if( pEmitter->m_TimeSinceLastUpdate > m_MaxCatchUpTime )
+            pEmitter->m_TimeSinceLastUpdate = m_MaxCatchUpTime;
+
+        unsigned int particleCount = pEmitter->m_Particles.GetCount();
+
+        // Hidden and off screen emitters don't simulate, the owed time is caught up once they're back in view.
+        if( m_CullOffscreenEmitters )
+        {
+            if( pEmitter->IsVisible() == false || (pMatViewProj && IsEmitterOnScreen( pEmitter, pMatViewProj ) == false) )
+            {
+                m_Stats.m_EmittersCulled++;
+                m_Stats.m_ParticlesCulled += particleCount;
+                continue;
+            }
+        }
+
+        // Distant emitters update every few frames, staggered so they don't all land on the same frame.
+        float distance = 0;
+        if( pCamera )
+            distance = sqrtf( (pEmitter->m_pComponentTransform->GetWorldPosition() - campos).LengthSquared() );
+
+        if( pCamera && m_ThrottleDistance > 0 )
+        {
+            unsigned int interval = 1 + (unsigned int)(distance / m_ThrottleDistance);
+            if( interval > m_MaxThrottleInterval )
+                interval = m_MaxThrottleInterval;
+
+            if( interval > 1 && (m_FrameCount + i) % interval != 0 )
+            {
+                m_Stats.m_EmittersThrottled++;
+                m_Stats.m_ParticlesSkipped += particleCount;
+                continue;
+            }
+        }
+
+        // Emitters that are owed more time go first, closer ones go first for the same time owed.
+        EmitterPriority candidate;
+        candidate.m_pEmitter = pEmitter;
+        candidate.m_Priority = pEmitter->m_TimeSinceLastUpdate;
+        if( m_ThrottleDistance > 0 )
+            candidate.m_Priority /= 1 + distance / m_ThrottleDistance;
+        m_Candidates.push_back( candidate );
+    }
+
+    // If there's a budget, update emitters in priority order until it's used up, always update at least one.
+    // Emitters left out keep their owed time and will get a higher priority next frame.
+    unsigned int numCandidates = (unsigned int)m_Candidates.size();
+    if( m_ParticleBudget > 0 )
+        std::sort( m_Candidates.begin(), m_Candidates.end() );
+
+    m_EmittersToUpdate.clear();
+    unsigned int particlesInBudget = 0;
+    for( unsigned int i=0; i<numCandidates; i++ )
+    {
+        ComponentParticleEmitter* pEmitter = m_Candidates[i].m_pEmitter;
+        unsigned int particleCount = pEmitter->m_Particles.GetCount();
+
+        if( m_ParticleBudget > 0 && i > 0 && particlesInBudget + particleCount > m_ParticleBudget )
+        {
+            m_Stats.m_EmittersOverBudget++;
+            m_Stats.m_ParticlesSkipped += particleCount;
+            continue;
+        }
+
+        particlesInBudget += particleCount;
+        m_EmittersToUpdate.push_back( pEmitter );
+    }
+
+    m_Stats.m_EmittersUpdated = (unsigned int)m_EmittersToUpdate.size();
+
+    // Split the emitters into even chunks, queue all but the first and update the first chunk here.
+    unsigned int numEmitters = (unsigned int)m_EmittersToUpdate.size();
+    if( numEmitters > 0 )
+    {
+        unsigned int numChunks = 1;
+        if( m_UpdateInParallel && g_pEngineCore->GetManagers()->GetJobManager() != nullptr )
+        {
+            numChunks = numEmitters < (unsigned int)MAX_JOBS+1 ? numEmitters : MAX_JOBS+1;
+        }
+
+        unsigned int chunkSize = (numEmitters + numChunks - 1) / numChunks;
+
+        unsigned int numQueued = 0;
+        for( unsigned int i=1; i<numChunks; i++ )
+        {
+            unsigned int first = i * chunkSize;
+            if( first >= numEmitters )
+                break;
+
+            unsigned int count = numEmitters - first < chunkSize ? numEmitters - first : chunkSize;
+
+            m_pJobs[i]->PrepareToUpdate( &m_EmittersToUpdate[first], count, &matCameraRotation );
+            g_pEngineCore->GetManagers()->GetJobManager()->AddJob( m_pJobs[i] );
+            numQueued++;
+        }
+
+        m_pJobs[0]->PrepareToUpdate( &m_EmittersToUpdate[0], numEmitters < chunkSize ? numEmitters : chunkSize, &matCameraRotation );
+        m_pJobs[0]->DoWork();
+        m_Stats.m_ParticlesSimulated += m_pJobs[0]->m_ParticlesSimulated;
+
+        for( unsigned int i=1; i<=numQueued; i++ )
+        {
+            g_pEngineCore->GetManagers()->GetJobManager()->WaitForJobToComplete( m_pJobs[i] );
+            m_Stats.m_ParticlesSimulated += m_pJobs[i]->m_ParticlesSimulated;
+        }
+    }
+
+    // Spawning reads the emitter transforms, so keep it on this thread.
+    // Only emitters that were simulated spawn, using the same accumulated time, so culled or throttled
+    //     emitters don't fill their stores with particles that won't age until they're updated again.
+    for( unsigned int i=0; i<numEmitters; i++ )
+    {
+        ComponentParticleEmitter* pEmitter = m_EmittersToUpdate[i];
+        pEmitter->UpdateSpawning( pEmitter->m_TimeSinceLastUpdate );
+        pEmitter->m_TimeSinceLastUpdate = 0;
+    }
+
+    m_Stats.m_UpdateTime = (float)((MyTime_GetSystemTime() - startTime) * 1000);
+}
@@ -0,0 +1,88 @@
+//
+// Copyright (c) 2020 Jimmy Lord http://www.flatheadgames.com
+//
+// This software is provided 'as-is', without any express or implied warranty.  In no event will the authors be held liable for any damages arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+
+#ifndef __ParticleSystemManager_H__
+#define __ParticleSystemManager_H__
+
+class ComponentParticleEmitter;
+class ParticleEmitterUpdateJob;
+
+// Updates all registered particle emitters once per frame, spread across the job threads.
+//     Each emitter writes only into its own particle store and renderer, so emitters can be updated in any order.
+//     Spawning needs the emitter's transform, so it's done on the main thread after the jobs are done.
+//     If a particle budget is set, the emitters owed the most time, weighted by distance, are updated first
+//     and the rest wait for a later frame.
+class ParticleSystemManager
+{
+    static const int MAX_JOBS = 4; // The main thread also takes a share of emitters.
+
+public:
+    struct Stats
+    {
+        unsigned int m_EmittersUpdated;
+        unsigned int m_EmittersThrottled;
+        unsigned int m_EmittersOverBudget;
+        unsigned int m_EmittersCulled;
+        unsigned int m_ParticlesSimulated;
+        unsigned int m_ParticlesSkipped; // Throttled or over budget, will catch up on a later frame.
+        unsigned int m_ParticlesCulled; // Off screen or hidden.
+        float m_UpdateTime; // In ms.
+    };
+
+protected:
+    struct EmitterPriority
+    {
+        ComponentParticleEmitter* m_pEmitter;
+        float m_Priority; // Higher is updated first when over budget.
+
+        bool operator<(const EmitterPriority& other) const { return m_Priority > other.m_Priority; }
+    };
+
+    std::vector<ComponentParticleEmitter*> m_Emitters;
+    std::vector<ComponentParticleEmitter*> m_EmittersToUpdate; // Rebuilt each frame.
+    std::vector<EmitterPriority> m_Candidates; // Rebuilt each frame, emitters that passed culling and throttling.
+
+    ParticleEmitterUpdateJob* m_pJobs[MAX_JOBS+1];
+
+    bool m_UpdateInParallel;
+    float m_ThrottleDistance; // Emitters further than this from the camera update less often.
+    unsigned int m_MaxThrottleInterval; // In frames.
+    bool m_CullOffscreenEmitters;
+    float m_MaxCatchUpTime; // Most time an emitter can be owed while culled or throttled, in seconds.
+    unsigned int m_ParticleBudget; // Most particles simulated per frame, 0 for no limit.
+
+    unsigned int m_FrameCount;
+
+    Stats m_Stats;
+
+protected:
+    bool IsEmitterOnScreen(ComponentParticleEmitter* pEmitter, MyMatrix* pMatViewProj);
+
+public:
+    ParticleSystemManager();
+    ~ParticleSystemManager();
+
+    void RegisterEmitter(ComponentParticleEmitter* pEmitter);
+    void UnregisterEmitter(ComponentParticleEmitter* pEmitter);
+
+    void Tick(float deltaTime);
+
+    void SetUpdateInParallel(bool inParallel) { m_UpdateInParallel = inParallel; }
+    void SetThrottleDistance(float distance) { m_ThrottleDistance = distance; }
+    void SetMaxThrottleInterval(unsigned int frames) { m_MaxThrottleInterval = frames > 0 ? frames : 1; }
+    void SetCullOffscreenEmitters(bool cull) { m_CullOffscreenEmitters = cull; }
+    void SetMaxCatchUpTime(float seconds) { m_MaxCatchUpTime = seconds; }
+    void SetParticleBudget(unsigned int particlesPerFrame) { m_ParticleBudget = particlesPerFrame; }
+
+    unsigned int GetNumberOfEmitters() { return (unsigned int)m_Emitters.size(); }
+    const Stats& GetStats() { return m_Stats; }
+};
+
+#endif //__ParticleSystemManager_H__
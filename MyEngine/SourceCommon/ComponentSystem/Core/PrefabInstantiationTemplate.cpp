@@ -0,0 +1,186 @@
+//
+// Copyright (c) 2020 Jimmy Lord http://www.flatheadgames.com
+//
+// This software is provided 'as-is', without any express or implied warranty.  In no event will the authors be held liable for any damages arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include "MyEnginePCH.h"
+
+#include "PrefabInstantiationTemplate.h"
+#include "ComponentSystem/BaseComponents/ComponentTransform.h"
+#include "ComponentSystem/Core/ComponentSystemManager.h"
+#include "ComponentSystem/Core/GameObject.h"
+#include "ComponentSystem/Core/PrefabManager.h"
+
+PrefabInstantiationTemplate::Stats PrefabInstantiationTemplate::m_Stats;
+
+PrefabInstantiationTemplate::PrefabInstantiationTemplate(PrefabObject* pPrefab)
+{
+    m_pPrefab = pPrefab;
+    m_pPrototypeGameObject = nullptr;
+    m_OwnsPrototypeGameObject = false;
+
+#if MYFW_EDITOR
+    // The editor's master GameObjects are kept in sync with the prefab, so use them as the prototypes.
+    m_pPrototypeGameObject = pPrefab->m_pGameObject;
+#else
+    // Outside the editor, import the prefab once into a disabled GameObject and copy from that.
+    if( pPrefab->GetJSONObject() != nullptr )
+    {
+        m_pPrototypeGameObject = g_pComponentSystemManager->CreateGameObjectFromPrefab( pPrefab, false, SCENEID_Unmanaged );
+        m_pPrototypeGameObject->SetEnabled( false, true );
+        m_OwnsPrototypeGameObject = true;
+    }
+#endif //MYFW_EDITOR
+
+    if( m_pPrototypeGameObject == nullptr )
+        return;
+
+    // If the prototypes don't match the JSON (i.e. a component type failed to create), leave the template
+    //     invalid and let the prefab spawn through the JSON.
+    if( AddObject( m_pPrototypeGameObject, pPrefab->GetJSONObject(), -1 ) == false )
+    {
+        m_Objects.clear();
+        m_Components.clear();
+        return;
+    }
+
+    m_Stats.m_TemplatesCompiled++;
+}
+
+PrefabInstantiationTemplate::~PrefabInstantiationTemplate()
+{
+    if( m_OwnsPrototypeGameObject )
+        delete m_pPrototypeGameObject;
+}
+
+bool PrefabInstantiationTemplate::AddObject(GameObject* pPrototype, cJSON* jObject, int parentIndex)
+{
+    cJSON* jComponentArray = cJSON_GetObjectItem( jObject, "Components" );
+    int numJSONComponents = jComponentArray ? cJSON_GetArraySize( jComponentArray ) : 0;
+    if( numJSONComponents != (int)pPrototype->GetComponentCount() )
+        return false;
+
+    ObjectEntry object;
+    object.m_ParentIndex = parentIndex;
+    object.m_ChildID = pPrototype->GetPrefabRef()->GetChildID();
+    object.m_NameOffset = (unsigned int)m_Names.size();
+    object.m_IsFolder = pPrototype->IsFolder();
+    object.m_HasTransform = pPrototype->GetTransform() != nullptr;
+    object.m_LocalPosition = Vector3( 0, 0, 0 );
+    object.m_LocalRotation = Vector3( 0, 0, 0 );
+    object.m_LocalScale = Vector3( 1, 1, 1 );
+    object.m_FirstComponent = (unsigned int)m_Components.size();
+    object.m_NumComponents = pPrototype->GetComponentCount();
+
+    if( object.m_HasTransform )
+    {
+        object.m_LocalPosition = pPrototype->GetTransform()->GetLocalPosition();
+        object.m_LocalRotation = pPrototype->GetTransform()->GetLocalRotation();
+        object.m_LocalScale = pPrototype->GetTransform()->GetLocalScale();
+    }
+
+    const char* name = pPrototype->GetName();
+    m_Names.insert( m_Names.end(), name, name + strlen( name ) + 1 );
+
+    for( unsigned int i=0; i<object.m_NumComponents; i++ )
+    {
+        ComponentBase* pComponent = pPrototype->GetComponentByIndex( i );
+
+        ComponentEntry component;
+        component.m_Type = pComponent->GetType();
+        component.m_Enabled = pComponent->GetEnabledState() != ComponentBase::EnabledState_Disabled_ManuallyDisabled;
+        component.m_pPrototype = pComponent;
+        component.m_jComponent = cJSON_GetArrayItem( jComponentArray, i );
+
+        m_Components.push_back( component );
+    }
+
+    int objectIndex = (int)m_Objects.size();
+    m_Objects.push_back( object );
+
+    // Children were created in the same order as the JSON array.
+    cJSON* jChildrenArray = cJSON_GetObjectItem( jObject, "Children" );
+    int numJSONChildren = jChildrenArray ? cJSON_GetArraySize( jChildrenArray ) : 0;
+
+    int childIndex = 0;
+    for( GameObject* pChild = pPrototype->GetFirstChild(); pChild != nullptr; pChild = pChild->GetNext() )
+    {
+        if( childIndex >= numJSONChildren )
+            return false;
+
+        cJSON* jChild = cJSON_GetArrayItem( jChildrenArray, childIndex++ );
+
+        uint32 childID = 0;
+        cJSONExt_GetUnsignedInt( jChild, "ChildID", &childID );
+        if( childID != pChild->GetPrefabRef()->GetChildID() )
+            return false;
+
+        if( AddObject( pChild, jChild, objectIndex ) == false )
+            return false;
+    }
+
+    return childIndex == numJSONChildren;
+}
+
+GameObject* PrefabInstantiationTemplate::Instantiate(bool manageObject, SceneID sceneID)
+{
+    MyAssert( IsValid() );
+
+    double startTime = MyTime_GetSystemTime();
+
+    ComponentSystemManager* pComponentSystemManager = g_pComponentSystemManager;
+
+    // Take the scratch list while spawning, so a spawn from a component's OnLoad (i.e. from Lua) can't overwrite it.
+    std::vector<GameObject*> instantiatedObjects;
+    instantiatedObjects.swap( m_InstantiatedObjects );
+    instantiatedObjects.resize( m_Objects.size() );
+
+    for( unsigned int i=0; i<m_Objects.size(); i++ )
+    {
+        const ObjectEntry& object = m_Objects[i];
+
+        PrefabReference prefabRef( m_pPrefab, object.m_ChildID, true );
+        // Only the root follows manageObject, children are always managed like on the JSON path.
+        bool manageGameObject = object.m_ParentIndex == -1 ? manageObject : true;
+        GameObject* pGameObject = pComponentSystemManager->CreateGameObject( manageGameObject, sceneID, object.m_IsFolder, object.m_HasTransform, &prefabRef );
+        pGameObject->SetName( &m_Names[object.m_NameOffset] );
+
+        // Create the components and copy the values from the prototypes.
+        for( unsigned int c=object.m_FirstComponent; c<object.m_FirstComponent + object.m_NumComponents; c++ )
+        {
+            const ComponentEntry& component = m_Components[c];
+
+            ComponentBase* pComponent = pGameObject->AddNewComponent( component.m_Type, pGameObject->GetSceneID(), pComponentSystemManager );
+            pComponent->CopyFromPrototype_Dangerous( component.m_pPrototype );
+            if( component.m_Enabled == false )
+                pComponent->SetEnabled( false );
+            pComponent->FinishImportingFromJSONObject( component.m_jComponent );
+            pComponent->OnLoad();
+        }
+
+        // Parents are always created before their children.
+        if( object.m_ParentIndex != -1 )
+        {
+            pGameObject->SetParentGameObject( instantiatedObjects[object.m_ParentIndex] );
+            if( pGameObject->GetTransform() )
+                pGameObject->GetTransform()->SetLocalPositionRotationScale( object.m_LocalPosition, object.m_LocalRotation, object.m_LocalScale );
+        }
+
+        instantiatedObjects[i] = pGameObject;
+    }
+
+    m_Stats.m_Spawns++;
+    m_Stats.m_GameObjectsCreated += (unsigned int)m_Objects.size();
+    m_Stats.m_SpawnTime += (float)((MyTime_GetSystemTime() - startTime) * 1000);
+
+    GameObject* pRootObject = instantiatedObjects[0];
+
+    // Hand the storage back for the next spawn.
+    m_InstantiatedObjects.swap( instantiatedObjects );
+
+    return pRootObject;
+}
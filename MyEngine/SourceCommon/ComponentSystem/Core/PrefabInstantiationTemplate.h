@@ -0,0 +1,84 @@
+//
+// Copyright (c) 2020 Jimmy Lord http://www.flatheadgames.com
+//
+// This software is provided 'as-is', without any express or implied warranty.  In no event will the authors be held liable for any damages arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#ifndef __PrefabInstantiationTemplate_H__
+#define __PrefabInstantiationTemplate_H__
+
+class ComponentBase;
+class GameObject;
+class PrefabObject;
+
+// Flattened version of a prefab, built once so instances don't go through the JSON import path.
+// Holds the object hierarchy as a table (parents always come before their children), the component types
+//     resolved up front and a prototype component for each one that new instances copy their values from.
+// Prototypes are the editor's master prefab GameObjects if they exist, otherwise a disabled copy of the
+//     prefab owned by the template.
+// Each component also keeps its JSON from the prefab, for components that resolve references or build
+//     data in FinishImportingFromJSONObject.
+class PrefabInstantiationTemplate
+{
+public:
+    struct Stats
+    {
+        unsigned int m_Spawns;
+        unsigned int m_GameObjectsCreated;
+        unsigned int m_TemplatesCompiled;
+        float m_SpawnTime; // In milliseconds.
+    };
+
+protected:
+    struct ObjectEntry
+    {
+        int m_ParentIndex; // -1 for the root object.
+        uint32 m_ChildID;
+        unsigned int m_NameOffset; // Into m_Names.
+        bool m_IsFolder;
+        bool m_HasTransform;
+        Vector3 m_LocalPosition;
+        Vector3 m_LocalRotation;
+        Vector3 m_LocalScale;
+        unsigned int m_FirstComponent; // Into m_Components.
+        unsigned int m_NumComponents;
+    };
+
+    struct ComponentEntry
+    {
+        int m_Type;
+        bool m_Enabled;
+        ComponentBase* m_pPrototype;
+        cJSON* m_jComponent; // Owned by the prefab, the template is deleted whenever the JSON changes.
+    };
+
+    static Stats m_Stats;
+
+    PrefabObject* m_pPrefab;
+    GameObject* m_pPrototypeGameObject;
+    bool m_OwnsPrototypeGameObject;
+
+    std::vector<ObjectEntry> m_Objects;
+    std::vector<ComponentEntry> m_Components;
+    std::vector<char> m_Names;
+
+    std::vector<GameObject*> m_InstantiatedObjects; // Scratch list, reused between instances, taken by Instantiate while it runs.
+
+protected:
+    bool AddObject(GameObject* pPrototype, cJSON* jObject, int parentIndex);
+
+public:
+    PrefabInstantiationTemplate(PrefabObject* pPrefab);
+    ~PrefabInstantiationTemplate();
+
+    bool IsValid() { return m_Objects.size() > 0; }
+
+    GameObject* Instantiate(bool manageObject, SceneID sceneID);
+
+    static Stats& GetStats() { return m_Stats; }
+};
+
+#endif //__PrefabInstantiationTemplate_H__
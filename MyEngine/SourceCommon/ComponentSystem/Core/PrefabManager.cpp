@@ -10,6 +10,7 @@
 #include "MyEnginePCH.h"
 
 #include "PrefabManager.h"
+#include "PrefabInstantiationTemplate.h"
 #include "ComponentSystem/Core/ComponentSystemManager.h"
 #include "ComponentSystem/Core/GameObject.h"
 #include "Core/EngineCore.h"
@@ -102,6 +103,8 @@ PrefabObject::PrefabObject()
 
     m_PrefabID = 0;
 
+    m_pInstantiationTemplate = nullptr;
+
 #if MYFW_EDITOR
     m_NextChildPrefabID = 1;
 
@@ -111,6 +114,9 @@ PrefabObject::PrefabObject()
 
 PrefabObject::~PrefabObject()
 {
+    // Delete the template first, it may reference the master GameObjects.
+    InvalidateInstantiationTemplate();
+
 #if MYFW_EDITOR
     if( m_jPrefab )
     {
@@ -139,6 +145,8 @@ void PrefabObject::SetName(const char* name)
 
 void PrefabObject::SetPrefabJSONObject(cJSON* jPrefab, bool createmastergameobjects)
 {
+    InvalidateInstantiationTemplate();
+
     if( m_jPrefab )
     {
         cJSON_Delete( m_jPrefab );
@@ -195,6 +203,19 @@ uint32 PrefabObject::GetNextChildPrefabIDAndIncrement()
     return m_NextChildPrefabID - 1;
 }
 
+PrefabInstantiationTemplate* PrefabObject::GetInstantiationTemplate()
+{
+    if( m_pInstantiationTemplate == nullptr )
+        m_pInstantiationTemplate = MyNew PrefabInstantiationTemplate( this );
+
+    return m_pInstantiationTemplate;
+}
+
+void PrefabObject::InvalidateInstantiationTemplate()
+{
+    SAFE_DELETE( m_pInstantiationTemplate );
+}
+
 #if MYFW_EDITOR
 GameObject* PrefabObject::GetGameObject(uint32 childid)
 {
@@ -762,6 +783,18 @@ void PrefabManager::UnloadAllPrefabFiles()
     }
 }
 
+void PrefabManager::InvalidateAllInstantiationTemplates()
+{
+    for( unsigned int i=0; i<m_pPrefabFiles.size(); i++ )
+    {
+        for( CPPListNode* pNode = m_pPrefabFiles[i]->m_Prefabs.GetHead(); pNode; pNode = pNode->GetNext() )
+        {
+            PrefabObject* pPrefab = (PrefabObject*)pNode;
+            pPrefab->InvalidateInstantiationTemplate();
+        }
+    }
+}
+
 #if MYFW_EDITOR
 void PrefabManager::LoadFileNow(const char* prefabfilename)
 {
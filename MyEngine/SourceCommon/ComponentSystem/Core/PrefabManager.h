@@ -14,6 +14,7 @@ class GameObject;
 class PrefabObject;
 class PrefabFile;
 class PrefabManager;
+class PrefabInstantiationTemplate;
 
 #if MYFW_USING_WX
 class PrefabObjectWxEventHandler : public wxEvtHandler
@@ -79,6 +80,7 @@ class PrefabObject : public CPPListNode
 {
     friend class PrefabFile;
     friend class PrefabManager;
+    friend class PrefabInstantiationTemplate;
 
 public:
     static const int MAX_PREFAB_NAME_LENGTH = 30;
@@ -91,6 +93,8 @@ protected:
     uint32 m_PrefabID;
     uint32 m_NextChildPrefabID;
 
+    PrefabInstantiationTemplate* m_pInstantiationTemplate; // Built on first use, deleted whenever the JSON changes.
+
 public:
     PrefabObject();
     ~PrefabObject();
@@ -107,6 +111,9 @@ public:
 
     uint32 GetNextChildPrefabIDAndIncrement();
 
+    PrefabInstantiationTemplate* GetInstantiationTemplate();
+    void InvalidateInstantiationTemplate();
+
 #if MYFW_EDITOR
 protected:
     GameObject* m_pGameObject; // Each prefab is instantiated in editor so inheritance code can compare values.
@@ -219,6 +226,7 @@ public:
     PrefabFile* RequestFile(const char* prefabfilename);
 
     void UnloadAllPrefabFiles();
+    void InvalidateAllInstantiationTemplates();
 
 #if MYFW_EDITOR
     PrefabObject* CreatePrefabInFile(unsigned int fileindex, const char* prefabname, GameObject* pGameObject);
@@ -0,0 +1,745 @@
+//
+// Copyright (c) 2020 Jimmy Lord http://www.flatheadgames.com
+//
+// This software is provided 'as-is', without any express or implied warranty.  In no event will the authors be held liable for any damages arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include "MyEnginePCH.h"
+
+#include "RenderGraph_BVH.h"
+
+RenderGraph_BVH::CullStats RenderGraph_BVH::m_CullStats;
+
+const float RenderGraph_BVH::FAT_BOUNDS_MARGIN = 0.1f;
+const float RenderGraph_BVH::FAT_BOUNDS_MINIMUM_MARGIN = 0.1f;
+
+static float SurfaceArea(const Vector3& min, const Vector3& max)
+{
+    float x = max.x - min.x;
+    float y = max.y - min.y;
+    float z = max.z - min.z;
+
+    return 2.0f * (x*y + y*z + z*x);
+}
+
+static void CombineBounds(const Vector3& minA, const Vector3& maxA, const Vector3& minB, const Vector3& maxB, Vector3* pMin, Vector3* pMax)
+{
+    pMin->Set( minA.x < minB.x ? minA.x : minB.x, minA.y < minB.y ? minA.y : minB.y, minA.z < minB.z ? minA.z : minB.z );
+    pMax->Set( maxA.x > maxB.x ? maxA.x : maxB.x, maxA.y > maxB.y ? maxA.y : maxB.y, maxA.z > maxB.z ? maxA.z : maxB.z );
+}
+
+RenderGraph_BVH::RenderGraph_BVH(EngineCore* pEngineCore)
+{
+    m_pEngineCore = pEngineCore;
+
+    m_RootIndex = -1;
+    m_FreeListIndex = -1;
+
+    m_pObjectFilterFunc = nullptr;
+
+    m_pShadowReceiverFunc = nullptr;
+    m_pShadowReceiverUserData = nullptr;
+
+    memset( &m_LastBenchmarkResults, 0, sizeof(BenchmarkResults) );
+
+    memset( &m_CullStats, 0, sizeof(CullStats) );
+}
+
+RenderGraph_BVH::~RenderGraph_BVH()
+{
+    // All objects should have been removed by their components.
+    MyAssert( m_RootIndex == -1 );
+    MyAssert( m_UnboundedObjects.size() == 0 );
+
+    for( unsigned int i=0; i<m_Nodes.size(); i++ )
+    {
+        if( m_Nodes[i].m_Height == 0 )
+            delete m_Nodes[i].m_pObject;
+    }
+
+    for( unsigned int i=0; i<m_UnboundedObjects.size(); i++ )
+    {
+        delete m_UnboundedObjects[i];
+    }
+}
+
+int RenderGraph_BVH::AllocateNode()
+{
+    int index;
+
+    if( m_FreeListIndex != -1 )
+    {
+        index = m_FreeListIndex;
+        m_FreeListIndex = m_Nodes[index].m_Parent;
+    }
+    else
+    {
+        index = (int)m_Nodes.size();
+        m_Nodes.push_back( Node() );
+    }
+
+    Node& node = m_Nodes[index];
+    node.m_Min.Set( 0, 0, 0 );
+    node.m_Max.Set( 0, 0, 0 );
+    node.m_Parent = -1;
+    node.m_Child[0] = -1;
+    node.m_Child[1] = -1;
+    node.m_Height = 0;
+    node.m_pObject = nullptr;
+
+    return index;
+}
+
+void RenderGraph_BVH::FreeNode(int index)
+{
+    m_Nodes[index].m_Parent = m_FreeListIndex;
+    m_Nodes[index].m_Height = -1;
+    m_Nodes[index].m_pObject = nullptr;
+    m_FreeListIndex = index;
+}
+
+void RenderGraph_BVH::InsertLeaf(int leafIndex)
+{
+    if( m_RootIndex == -1 )
+    {
+        m_RootIndex = leafIndex;
+        m_Nodes[leafIndex].m_Parent = -1;
+        return;
+    }
+
+    Vector3 leafMin = m_Nodes[leafIndex].m_Min;
+    Vector3 leafMax = m_Nodes[leafIndex].m_Max;
+
+    // Walk down the tree to find the cheapest sibling for the new leaf, using surface area as the cost.
+    int index = m_RootIndex;
+    while( m_Nodes[index].IsLeaf() == false )
+    {
+        const Node& node = m_Nodes[index];
+
+        Vector3 combinedMin, combinedMax;
+        CombineBounds( node.m_Min, node.m_Max, leafMin, leafMax, &combinedMin, &combinedMax );
+
+        float area = SurfaceArea( node.m_Min, node.m_Max );
+        float combinedArea = SurfaceArea( combinedMin, combinedMax );
+
+        // Cost of pairing the leaf with this node, and the cost added to this node if the leaf goes further down.
+        float cost = 2.0f * combinedArea;
+        float inheritanceCost = 2.0f * (combinedArea - area);
+
+        float childCost[2];
+        for( int i=0; i<2; i++ )
+        {
+            const Node& child = m_Nodes[node.m_Child[i]];
+
+            Vector3 min, max;
+            CombineBounds( child.m_Min, child.m_Max, leafMin, leafMax, &min, &max );
+
+            if( child.IsLeaf() )
+                childCost[i] = SurfaceArea( min, max ) + inheritanceCost;
+            else
+                childCost[i] = SurfaceArea( min, max ) - SurfaceArea( child.m_Min, child.m_Max ) + inheritanceCost;
+        }
+
+        if( cost < childCost[0] && cost < childCost[1] )
+            break;
+
+        index = childCost[0] < childCost[1] ? node.m_Child[0] : node.m_Child[1];
+    }
+
+    int siblingIndex = index;
+
+    // Create a new parent for the sibling and the leaf, AllocateNode can grow m_Nodes so don't hold references across it.
+    int newParentIndex = AllocateNode();
+    int oldParentIndex = m_Nodes[siblingIndex].m_Parent;
+
+    Node& newParent = m_Nodes[newParentIndex];
+    CombineBounds( m_Nodes[siblingIndex].m_Min, m_Nodes[siblingIndex].m_Max, leafMin, leafMax, &newParent.m_Min, &newParent.m_Max );
+    newParent.m_Parent = oldParentIndex;
+    newParent.m_Child[0] = siblingIndex;
+    newParent.m_Child[1] = leafIndex;
+    newParent.m_Height = m_Nodes[siblingIndex].m_Height + 1;
+
+    m_Nodes[siblingIndex].m_Parent = newParentIndex;
+    m_Nodes[leafIndex].m_Parent = newParentIndex;
+
+    if( oldParentIndex != -1 )
+    {
+        Node& oldParent = m_Nodes[oldParentIndex];
+        if( oldParent.m_Child[0] == siblingIndex )
+            oldParent.m_Child[0] = newParentIndex;
+        else
+            oldParent.m_Child[1] = newParentIndex;
+    }
+    else
+    {
+        m_RootIndex = newParentIndex;
+    }
+
+    RefitAncestors( m_Nodes[leafIndex].m_Parent );
+}
+
+void RenderGraph_BVH::RemoveLeaf(int leafIndex)
+{
+    if( leafIndex == m_RootIndex )
+    {
+        m_RootIndex = -1;
+        return;
+    }
+
+    int parentIndex = m_Nodes[leafIndex].m_Parent;
+    int grandParentIndex = m_Nodes[parentIndex].m_Parent;
+    int siblingIndex = m_Nodes[parentIndex].m_Child[0] == leafIndex ? m_Nodes[parentIndex].m_Child[1] : m_Nodes[parentIndex].m_Child[0];
+
+    // Replace the parent with the sibling.
+    if( grandParentIndex != -1 )
+    {
+        Node& grandParent = m_Nodes[grandParentIndex];
+        if( grandParent.m_Child[0] == parentIndex )
+            grandParent.m_Child[0] = siblingIndex;
+        else
+            grandParent.m_Child[1] = siblingIndex;
+
+        m_Nodes[siblingIndex].m_Parent = grandParentIndex;
+        FreeNode( parentIndex );
+
+        RefitAncestors( grandParentIndex );
+    }
+    else
+    {
+        m_RootIndex = siblingIndex;
+        m_Nodes[siblingIndex].m_Parent = -1;
+        FreeNode( parentIndex );
+    }
+
+    m_Nodes[leafIndex].m_Parent = -1;
+}
+
+// Rotates the taller child of node A up if A's children differ in height by more than 1, returns the new root of the subtree.
+int RenderGraph_BVH::Balance(int indexA)
+{
+    Node* pA = &m_Nodes[indexA];
+    if( pA->IsLeaf() || pA->m_Height < 2 )
+        return indexA;
+
+    int indexB = pA->m_Child[0];
+    int indexC = pA->m_Child[1];
+    Node* pB = &m_Nodes[indexB];
+    Node* pC = &m_Nodes[indexC];
+
+    int balance = pC->m_Height - pB->m_Height;
+
+    if( balance > 1 )
+    {
+        // Rotate C up.
+        int indexF = pC->m_Child[0];
+        int indexG = pC->m_Child[1];
+        Node* pF = &m_Nodes[indexF];
+        Node* pG = &m_Nodes[indexG];
+
+        // Swap A and C.
+        pC->m_Child[0] = indexA;
+        pC->m_Parent = pA->m_Parent;
+        pA->m_Parent = indexC;
+
+        if( pC->m_Parent != -1 )
+        {
+            Node& parent = m_Nodes[pC->m_Parent];
+            if( parent.m_Child[0] == indexA )
+                parent.m_Child[0] = indexC;
+            else
+                parent.m_Child[1] = indexC;
+        }
+        else
+        {
+            m_RootIndex = indexC;
+        }
+
+        // Keep the taller of C's children under C, move the other under A.
+        Node* pKeep = pF->m_Height > pG->m_Height ? pF : pG;
+        Node* pMove = pF->m_Height > pG->m_Height ? pG : pF;
+        int indexKeep = pF->m_Height > pG->m_Height ? indexF : indexG;
+        int indexMove = pF->m_Height > pG->m_Height ? indexG : indexF;
+
+        pC->m_Child[1] = indexKeep;
+        pA->m_Child[1] = indexMove;
+        pMove->m_Parent = indexA;
+
+        CombineBounds( pB->m_Min, pB->m_Max, pMove->m_Min, pMove->m_Max, &pA->m_Min, &pA->m_Max );
+        CombineBounds( pA->m_Min, pA->m_Max, pKeep->m_Min, pKeep->m_Max, &pC->m_Min, &pC->m_Max );
+
+        pA->m_Height = 1 + (pB->m_Height > pMove->m_Height ? pB->m_Height : pMove->m_Height);
+        pC->m_Height = 1 + (pA->m_Height > pKeep->m_Height ? pA->m_Height : pKeep->m_Height);
+
+        return indexC;
+    }
+
+    if( balance < -1 )
+    {
+        // Rotate B up.
+        int indexD = pB->m_Child[0];
+        int indexE = pB->m_Child[1];
+        Node* pD = &m_Nodes[indexD];
+        Node* pE = &m_Nodes[indexE];
+
+        // Swap A and B.
+        pB->m_Child[0] = indexA;
+        pB->m_Parent = pA->m_Parent;
+        pA->m_Parent = indexB;
+
+        if( pB->m_Parent != -1 )
+        {
+            Node& parent = m_Nodes[pB->m_Parent];
+            if( parent.m_Child[0] == indexA )
+                parent.m_Child[0] = indexB;
+            else
+                parent.m_Child[1] = indexB;
+        }
+        else
+        {
+            m_RootIndex = indexB;
+        }
+
+        // Keep the taller of B's children under B, move the other under A.
+        Node* pKeep = pD->m_Height > pE->m_Height ? pD : pE;
+        Node* pMove = pD->m_Height > pE->m_Height ? pE : pD;
+        int indexKeep = pD->m_Height > pE->m_Height ? indexD : indexE;
+        int indexMove = pD->m_Height > pE->m_Height ? indexE : indexD;
+
+        pB->m_Child[1] = indexKeep;
+        pA->m_Child[0] = indexMove;
+        pMove->m_Parent = indexA;
+
+        CombineBounds( pC->m_Min, pC->m_Max, pMove->m_Min, pMove->m_Max, &pA->m_Min, &pA->m_Max );
+        CombineBounds( pA->m_Min, pA->m_Max, pKeep->m_Min, pKeep->m_Max, &pB->m_Min, &pB->m_Max );
+
+        pA->m_Height = 1 + (pC->m_Height > pMove->m_Height ? pC->m_Height : pMove->m_Height);
+        pB->m_Height = 1 + (pA->m_Height > pKeep->m_Height ? pA->m_Height : pKeep->m_Height);
+
+        return indexB;
+    }
+
+    return indexA;
+}
+
+void RenderGraph_BVH::RefitAncestors(int index)
+{
+    while( index != -1 )
+    {
+        index = Balance( index );
+
+        Node& node = m_Nodes[index];
+        const Node& child0 = m_Nodes[node.m_Child[0]];
+        const Node& child1 = m_Nodes[node.m_Child[1]];
+
+        CombineBounds( child0.m_Min, child0.m_Max, child1.m_Min, child1.m_Max, &node.m_Min, &node.m_Max );
+        node.m_Height = 1 + (child0.m_Height > child1.m_Height ? child0.m_Height : child1.m_Height);
+
+        index = node.m_Parent;
+    }
+}
+
+bool RenderGraph_BVH::GetObjectBounds(RenderGraphObject_BVH* pObject, Vector3* pMin, Vector3* pMax)
+{
+    if( pObject->m_pMesh == nullptr || pObject->m_pTransform == nullptr )
+        return false;
+
+    MyAABounds* pBounds = pObject->m_pMesh->GetBounds();
+    if( pBounds == nullptr )
+        return false;
+
+    Vector3 center = pBounds->GetCenter();
+    Vector3 half = pBounds->GetHalfSize();
+    MyMatrix* pMat = pObject->m_pTransform;
+
+    // Transform the center, then find the world space half size from the absolute values of the rotation/scale part of the matrix.
+    Vector3 worldCenter( pMat->m11*center.x + pMat->m21*center.y + pMat->m31*center.z + pMat->m41,
+                         pMat->m12*center.x + pMat->m22*center.y + pMat->m32*center.z + pMat->m42,
+                         pMat->m13*center.x + pMat->m23*center.y + pMat->m33*center.z + pMat->m43 );
+    Vector3 worldHalf( fabsf(pMat->m11)*half.x + fabsf(pMat->m21)*half.y + fabsf(pMat->m31)*half.z,
+                       fabsf(pMat->m12)*half.x + fabsf(pMat->m22)*half.y + fabsf(pMat->m32)*half.z,
+                       fabsf(pMat->m13)*half.x + fabsf(pMat->m23)*half.y + fabsf(pMat->m33)*half.z );
+
+    pMin->Set( worldCenter.x - worldHalf.x, worldCenter.y - worldHalf.y, worldCenter.z - worldHalf.z );
+    pMax->Set( worldCenter.x + worldHalf.x, worldCenter.y + worldHalf.y, worldCenter.z + worldHalf.z );
+
+    return true;
+}
+
+void RenderGraph_BVH::AddObjectToTree(RenderGraphObject_BVH* pObject)
+{
+    Vector3 min, max;
+    if( GetObjectBounds( pObject, &min, &max ) == false )
+    {
+        pObject->m_LeafIndex = -1;
+        pObject->m_UnboundedIndex = (int)m_UnboundedObjects.size();
+        m_UnboundedObjects.push_back( pObject );
+        return;
+    }
+
+    // Fatten the bounds, so small moves don't require a reinsert.
+    Vector3 margin( (max.x - min.x) * FAT_BOUNDS_MARGIN + FAT_BOUNDS_MINIMUM_MARGIN,
+                    (max.y - min.y) * FAT_BOUNDS_MARGIN + FAT_BOUNDS_MINIMUM_MARGIN,
+                    (max.z - min.z) * FAT_BOUNDS_MARGIN + FAT_BOUNDS_MINIMUM_MARGIN );
+
+    int leafIndex = AllocateNode();
+    Node& leaf = m_Nodes[leafIndex];
+    leaf.m_Min.Set( min.x - margin.x, min.y - margin.y, min.z - margin.z );
+    leaf.m_Max.Set( max.x + margin.x, max.y + margin.y, max.z + margin.z );
+    leaf.m_pObject = pObject;
+
+    pObject->m_LeafIndex = leafIndex;
+    pObject->m_UnboundedIndex = -1;
+
+    InsertLeaf( leafIndex );
+}
+
+void RenderGraph_BVH::RemoveObjectFromTree(RenderGraphObject_BVH* pObject)
+{
+    if( pObject->m_LeafIndex != -1 )
+    {
+        RemoveLeaf( pObject->m_LeafIndex );
+        FreeNode( pObject->m_LeafIndex );
+        pObject->m_LeafIndex = -1;
+    }
+    else
+    {
+        // Order doesn't matter, so swap with the last unbounded object.
+        int index = pObject->m_UnboundedIndex;
+        MyAssert( index != -1 && m_UnboundedObjects[index] == pObject );
+
+        m_UnboundedObjects[index] = m_UnboundedObjects.back();
+        m_UnboundedObjects[index]->m_UnboundedIndex = index;
+        m_UnboundedObjects.pop_back();
+
+        pObject->m_UnboundedIndex = -1;
+    }
+}
+
+bool RenderGraph_BVH::IsObjectInPass(RenderGraphObject* pObject, bool drawOpaques, EmissiveDrawOptions emissiveDrawOption, unsigned int layersToRender)
+{
+    if( pObject->m_Visible == false )
+        return false;
+
+    if( (pObject->m_Layers & layersToRender) == 0 )
+        return false;
+
+    if( drawOpaques && (pObject->m_Flags & RenderGraphFlag_Opaque) == 0 )
+        return false;
+
+    if( drawOpaques == false && (pObject->m_Flags & RenderGraphFlag_Transparent) == 0 )
+        return false;
+
+    if( emissiveDrawOption == EmissiveDrawOption_NoEmissives && (pObject->m_Flags & RenderGraphFlag_Emissive) )
+        return false;
+
+    if( emissiveDrawOption == EmissiveDrawOption_OnlyEmissives && (pObject->m_Flags & RenderGraphFlag_Emissive) == 0 )
+        return false;
+
+    if( m_pObjectFilterFunc && m_pObjectFilterFunc( pObject ) == false )
+        return false;
+
+    return true;
+}
+
+void RenderGraph_BVH::ExtractFrustumPlanes(MyMatrix* pMatViewProj, FrustumPlane* pPlanes)
+{
+    // Planes are in order: left, right, bottom, top, near, far.
+    // Each is row 4 of the matrix plus or minus row 1, 2 or 3, they aren't normalized since only the sign of the distances is used.
+    MyMatrix* m = pMatViewProj;
+
+    Vector4 row[4] =
+    {
+        Vector4( m->m11, m->m21, m->m31, m->m41 ),
+        Vector4( m->m12, m->m22, m->m32, m->m42 ),
+        Vector4( m->m13, m->m23, m->m33, m->m43 ),
+        Vector4( m->m14, m->m24, m->m34, m->m44 ),
+    };
+
+    for( int i=0; i<3; i++ )
+    {
+        for( int side=0; side<2; side++ )
+        {
+            float sign = side == 0 ? 1.0f : -1.0f;
+
+            FrustumPlane& plane = pPlanes[i*2 + side];
+            plane.m_Normal.Set( row[3].x + sign*row[i].x, row[3].y + sign*row[i].y, row[3].z + sign*row[i].z );
+            plane.m_Distance = row[3].w + sign*row[i].w;
+        }
+    }
+}
+
+RenderGraphObject* RenderGraph_BVH::AddObject(MyMatrix* pTransform, MyMesh* pMesh, MySubmesh* pSubmesh, MaterialDefinition* pMaterial, MyRE::PrimitiveTypes primitiveType, int pointSize, unsigned int layers, void* pUserData)
+{
+    RenderGraphObject_BVH* pObject = MyNew RenderGraphObject_BVH;
+
+    pObject->SetFlags( (RenderGraphFlags)0 );
+    pObject->m_pTransform = pTransform;
+    pObject->m_pMesh = pMesh;
+    pObject->m_pSubmesh = pSubmesh;
+    pObject->m_pMaterial = nullptr;
+    pObject->SetMaterial( pMaterial, true );
+    pObject->m_GLPrimitiveType = primitiveType;
+    pObject->m_PointSize = pointSize;
+    pObject->m_Layers = layers;
+    pObject->m_Visible = true;
+    pObject->m_pUserData = pUserData;
+
+    AddObjectToTree( pObject );
+
+    return pObject;
+}
+
+void RenderGraph_BVH::RemoveObject(RenderGraphObject* pObject)
+{
+    RenderGraphObject_BVH* pBVHObject = (RenderGraphObject_BVH*)pObject;
+
+    RemoveObjectFromTree( pBVHObject );
+
+    delete pBVHObject;
+}
+
+void RenderGraph_BVH::ObjectMoved(RenderGraphObject* pObject)
+{
+    RenderGraphObject_BVH* pBVHObject = (RenderGraphObject_BVH*)pObject;
+
+    if( pBVHObject->m_LeafIndex != -1 )
+    {
+        Vector3 min, max;
+        if( GetObjectBounds( pBVHObject, &min, &max ) )
+        {
+            // If the object is still inside its fat bounds, the tree doesn't need to change.
+            const Node& leaf = m_Nodes[pBVHObject->m_LeafIndex];
+            if( min.x >= leaf.m_Min.x && min.y >= leaf.m_Min.y && min.z >= leaf.m_Min.z &&
+                max.x <= leaf.m_Max.x && max.y <= leaf.m_Max.y && max.z <= leaf.m_Max.z )
+            {
+                return;
+            }
+        }
+    }
+    else if( pBVHObject->m_pMesh == nullptr )
+    {
+        // Unbounded objects stay unbounded.
+        return;
+    }
+
+    // Reinsert the object, this also moves it in or out of the unbounded list if its mesh bounds changed.
+    RemoveObjectFromTree( pBVHObject );
+    AddObjectToTree( pBVHObject );
+
+    m_CullStats.m_Reinserts++;
+}
+
+unsigned int RenderGraph_BVH::Cull(MyMatrix* pMatViewProj, std::vector<RenderGraphObject*>* pObjects)
+{
+    pObjects->clear();
+
+    if( m_RootIndex == -1 )
+        return 0;
+
+    FrustumPlane planes[6];
+    ExtractFrustumPlanes( pMatViewProj, planes );
+
+    const int allPlanes = 0x3F;
+
+    m_CullStack.clear();
+    m_CullStack.push_back( m_RootIndex );
+    m_CullStack.push_back( allPlanes );
+
+    while( m_CullStack.size() > 0 )
+    {
+        int planeMask = m_CullStack.back();
+        m_CullStack.pop_back();
+        int index = m_CullStack.back();
+        m_CullStack.pop_back();
+
+        const Node& node = m_Nodes[index];
+
+        // Once a node is fully inside all planes, its whole subtree is visible and isn't tested.
+        if( planeMask != 0 )
+        {
+            m_CullStats.m_NodesTested++;
+
+            Vector3 center( (node.m_Min.x + node.m_Max.x) * 0.5f, (node.m_Min.y + node.m_Max.y) * 0.5f, (node.m_Min.z + node.m_Max.z) * 0.5f );
+            Vector3 half( (node.m_Max.x - node.m_Min.x) * 0.5f, (node.m_Max.y - node.m_Min.y) * 0.5f, (node.m_Max.z - node.m_Min.z) * 0.5f );
+
+            bool outside = false;
+            for( int i=0; i<6; i++ )
+            {
+                if( (planeMask & (1 << i)) == 0 )
+                    continue;
+
+                const FrustumPlane& plane = planes[i];
+                float distance = plane.m_Normal.x*center.x + plane.m_Normal.y*center.y + plane.m_Normal.z*center.z + plane.m_Distance;
+                float radius = fabsf(plane.m_Normal.x)*half.x + fabsf(plane.m_Normal.y)*half.y + fabsf(plane.m_Normal.z)*half.z;
+
+                if( distance < -radius )
+                {
+                    outside = true;
+                    break;
+                }
+
+                // Fully inside this plane, so children don't need to test it.
+                if( distance > radius )
+                    planeMask &= ~(1 << i);
+            }
+
+            if( outside )
+            {
+                m_CullStats.m_NodesCulled++;
+                continue;
+            }
+
+            if( planeMask == 0 )
+                m_CullStats.m_NodesFullyInside++;
+        }
+
+        if( node.IsLeaf() )
+        {
+            pObjects->push_back( node.m_pObject );
+        }
+        else
+        {
+            m_CullStack.push_back( node.m_Child[0] );
+            m_CullStack.push_back( planeMask );
+            m_CullStack.push_back( node.m_Child[1] );
+            m_CullStack.push_back( planeMask );
+        }
+    }
+
+    return (unsigned int)pObjects->size();
+}
+
+unsigned int RenderGraph_BVH::CullBruteForce(MyMatrix* pMatViewProj, std::vector<RenderGraphObject*>* pObjects)
+{
+    pObjects->clear();
+
+    FrustumPlane planes[6];
+    ExtractFrustumPlanes( pMatViewProj, planes );
+
+    for( unsigned int n=0; n<m_Nodes.size(); n++ )
+    {
+        const Node& node = m_Nodes[n];
+        if( node.m_Height != 0 )
+            continue;
+
+        Vector3 min;
+        Vector3 max;
+        if( GetObjectBounds( node.m_pObject, &min, &max ) == false )
+            continue;
+
+        Vector3 center( (min.x + max.x) * 0.5f, (min.y + max.y) * 0.5f, (min.z + max.z) * 0.5f );
+        Vector3 half( (max.x - min.x) * 0.5f, (max.y - min.y) * 0.5f, (max.z - min.z) * 0.5f );
+
+        bool outside = false;
+        for( int i=0; i<6; i++ )
+        {
+            const FrustumPlane& plane = planes[i];
+            float distance = plane.m_Normal.x*center.x + plane.m_Normal.y*center.y + plane.m_Normal.z*center.z + plane.m_Distance;
+            float radius = fabsf(plane.m_Normal.x)*half.x + fabsf(plane.m_Normal.y)*half.y + fabsf(plane.m_Normal.z)*half.z;
+
+            if( distance < -radius )
+            {
+                outside = true;
+                break;
+            }
+        }
+
+        if( outside == false )
+            pObjects->push_back( node.m_pObject );
+    }
+
+    return (unsigned int)pObjects->size();
+}
+
+void RenderGraph_BVH::BenchmarkCull(MyMatrix* pMatViewProj, unsigned int iterations)
+{
+    if( iterations == 0 )
+        iterations = 1;
+
+    // Cull adds to the per frame stats, keep them as they were.
+    CullStats oldStats = m_CullStats;
+
+    std::vector<RenderGraphObject*> objects;
+    objects.reserve( m_Nodes.size() );
+
+    BenchmarkResults& results = m_LastBenchmarkResults;
+    results.m_Iterations = iterations;
+    results.m_NumObjects = 0;
+    for( unsigned int i=0; i<m_Nodes.size(); i++ )
+    {
+        if( m_Nodes[i].m_Height == 0 )
+            results.m_NumObjects++;
+    }
+
+    double startTime = MyTime_GetSystemTime();
+    for( unsigned int i=0; i<iterations; i++ )
+    {
+        results.m_TreeVisible = Cull( pMatViewProj, &objects );
+    }
+    results.m_TreeCullTime = (float)((MyTime_GetSystemTime() - startTime) * 1000 / iterations);
+
+    startTime = MyTime_GetSystemTime();
+    for( unsigned int i=0; i<iterations; i++ )
+    {
+        results.m_BruteForceVisible = CullBruteForce( pMatViewProj, &objects );
+    }
+    results.m_BruteForceCullTime = (float)((MyTime_GetSystemTime() - startTime) * 1000 / iterations);
+
+    m_CullStats = oldStats;
+}
+
+void RenderGraph_BVH::Draw(bool drawOpaques, EmissiveDrawOptions emissiveDrawOption, unsigned int layersToRender, Vector3* camPos, Vector3* camRot, MyMatrix* pMatProj, MyMatrix* pMatView, MyMatrix* shadowlightVP, TextureDefinition* pShadowTex, ShaderGroup* pShaderOverride, PreDrawCallbackFunctionPtr* pPreDrawCallbackFunc)
+{
+    MyMatrix matViewProj = *pMatProj * *pMatView;
+
+    Cull( &matViewProj, &m_VisibleObjects );
+
+    for( unsigned int i=0; i<m_VisibleObjects.size(); i++ )
+    {
+        RenderGraphObject* pObject = m_VisibleObjects[i];
+
+        if( IsObjectInPass( pObject, drawOpaques, emissiveDrawOption, layersToRender ) )
+        {
+            DrawObject( (RenderGraphObject_BVH*)pObject, camPos, camRot, pMatProj, pMatView, shadowlightVP, pShadowTex, pShaderOverride, pPreDrawCallbackFunc );
+            m_CullStats.m_ObjectsDrawn++;
+        }
+    }
+
+    for( unsigned int i=0; i<m_UnboundedObjects.size(); i++ )
+    {
+        RenderGraphObject_BVH* pObject = m_UnboundedObjects[i];
+
+        if( IsObjectInPass( pObject, drawOpaques, emissiveDrawOption, layersToRender ) )
+        {
+            DrawObject( pObject, camPos, camRot, pMatProj, pMatView, shadowlightVP, pShadowTex, pShaderOverride, pPreDrawCallbackFunc );
+            m_CullStats.m_ObjectsDrawn++;
+        }
+    }
+}
+
+void RenderGraph_BVH::DrawObject(RenderGraphObject_BVH* pObject, Vector3* camPos, Vector3* camRot, MyMatrix* pMatProj, MyMatrix* pMatView, MyMatrix* shadowlightVP, TextureDefinition* pShadowTex, ShaderGroup* pShaderOverride, PreDrawCallbackFunctionPtr* pPreDrawCallbackFunc)
+{
+    if( shadowlightVP && m_pShadowReceiverFunc )
+    {
+        // Objects without bounds pick their shadow matrix from their position.
+        Vector3 min;
+        Vector3 max;
+        if( GetObjectBounds( pObject, &min, &max ) == false )
+        {
+            if( pObject->m_pTransform == nullptr )
+                min.Set( 0, 0, 0 );
+            else
+                min.Set( pObject->m_pTransform->m41, pObject->m_pTransform->m42, pObject->m_pTransform->m43 );
+            max = min;
+        }
+
+        shadowlightVP = m_pShadowReceiverFunc( m_pShadowReceiverUserData, min, max );
+        if( shadowlightVP == nullptr )
+            pShadowTex = nullptr;
+    }
+
+    DrawRenderGraphObject( pObject, camPos, camRot, pMatProj, pMatView, shadowlightVP, pShadowTex, pShaderOverride, pPreDrawCallbackFunc );
+}
@@ -0,0 +1,147 @@
+//
+// Copyright (c) 2020 Jimmy Lord http://www.flatheadgames.com
+//
+// This software is provided 'as-is', without any express or implied warranty.  In no event will the authors be held liable for any damages arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#ifndef __RenderGraph_BVH_H__
+#define __RenderGraph_BVH_H__
+
+#include "../../../Framework/MyFramework/SourceCommon/RenderGraphs/RenderGraph_Base.h"
+#include "ShadowCascades.h"
+
+// RenderGraphObject with the index of the tree leaf that holds it.
+class RenderGraphObject_BVH : public RenderGraphObject
+{
+public:
+    int m_LeafIndex; // -1 if the object has no bounds and is stored in the unbounded list.
+    int m_UnboundedIndex; // Index into the unbounded list, -1 if the object is in the tree.
+};
+
+// Dynamic bounding volume hierarchy render graph, unlike RenderGraph_Octree there are no world limits.
+// Leaves hold "fat" world space bounds, so small moves don't touch the tree.
+// Objects that move outside their fat bounds are removed and reinserted, the tree is rebalanced with rotations as it changes.
+// Culling walks the tree with a mask of frustum planes, planes a node is fully inside of aren't tested again for its children.
+// Objects without mesh bounds (submesh only objects) are kept in a separate list and are never culled.
+class RenderGraph_BVH : public RenderGraph_Base
+{
+public:
+    // Returns false for objects Draw should skip, on top of the usual pass checks.
+    typedef bool ObjectFilterFunc(RenderGraphObject* pObject);
+
+    struct CullStats
+    {
+        unsigned int m_NodesTested;
+        unsigned int m_NodesCulled;
+        unsigned int m_NodesFullyInside; // Subtrees accepted without testing their children.
+        unsigned int m_ObjectsDrawn;
+        unsigned int m_Reinserts;
+    };
+
+    static CullStats m_CullStats;
+
+    // Results of BenchmarkCull, times are the average for one cull in milliseconds.
+    struct BenchmarkResults
+    {
+        unsigned int m_Iterations;
+        unsigned int m_NumObjects; // Bounded objects only, unbounded ones are never culled.
+        unsigned int m_TreeVisible;
+        unsigned int m_BruteForceVisible;
+        float m_TreeCullTime;
+        float m_BruteForceCullTime;
+    };
+
+protected:
+    struct Node
+    {
+        Vector3 m_Min;
+        Vector3 m_Max;
+        int m_Parent; // Also used as the next index in the free list.
+        int m_Child[2]; // -1 for leaves.
+        int m_Height; // 0 for leaves, -1 if the node is free.
+        RenderGraphObject_BVH* m_pObject; // Leaves only.
+
+        bool IsLeaf() const { return m_Child[0] == -1; }
+    };
+
+    struct FrustumPlane
+    {
+        Vector3 m_Normal;
+        float m_Distance;
+    };
+
+    EngineCore* m_pEngineCore;
+
+    std::vector<Node> m_Nodes;
+    int m_RootIndex;
+    int m_FreeListIndex;
+
+    std::vector<RenderGraphObject_BVH*> m_UnboundedObjects;
+
+    std::vector<int> m_CullStack; // Node index and plane mask pairs, reused between draws.
+    std::vector<RenderGraphObject*> m_VisibleObjects; // Results of the last cull, reused between draws.
+
+    ObjectFilterFunc* m_pObjectFilterFunc; // Null to draw everything in the pass.
+
+    ShadowReceiverMatrixFunc* m_pShadowReceiverFunc; // Null to give every object the shadow matrix passed to Draw.
+    void* m_pShadowReceiverUserData;
+
+    BenchmarkResults m_LastBenchmarkResults;
+
+protected:
+    int AllocateNode();
+    void FreeNode(int index);
+
+    void InsertLeaf(int leafIndex);
+    void RemoveLeaf(int leafIndex);
+    int Balance(int index);
+    void RefitAncestors(int index);
+
+    bool GetObjectBounds(RenderGraphObject_BVH* pObject, Vector3* pMin, Vector3* pMax);
+    void AddObjectToTree(RenderGraphObject_BVH* pObject);
+    void RemoveObjectFromTree(RenderGraphObject_BVH* pObject);
+
+    bool IsObjectInPass(RenderGraphObject* pObject, bool drawOpaques, EmissiveDrawOptions emissiveDrawOption, unsigned int layersToRender);
+    void DrawObject(RenderGraphObject_BVH* pObject, Vector3* camPos, Vector3* camRot, MyMatrix* pMatProj, MyMatrix* pMatView, MyMatrix* shadowlightVP, TextureDefinition* pShadowTex, ShaderGroup* pShaderOverride, PreDrawCallbackFunctionPtr* pPreDrawCallbackFunc);
+
+public:
+    static const float FAT_BOUNDS_MARGIN; // Fraction of the object's size added to each side of its leaf.
+    static const float FAT_BOUNDS_MINIMUM_MARGIN;
+
+    static void ExtractFrustumPlanes(MyMatrix* pMatViewProj, FrustumPlane* pPlanes);
+
+public:
+    RenderGraph_BVH(EngineCore* pEngineCore);
+    virtual ~RenderGraph_BVH();
+
+    virtual RenderGraphObject* AddObject(MyMatrix* pTransform, MyMesh* pMesh, MySubmesh* pSubmesh, MaterialDefinition* pMaterial, MyRE::PrimitiveTypes primitiveType, int pointSize, unsigned int layers, void* pUserData);
+    virtual void RemoveObject(RenderGraphObject* pObject);
+    virtual void ObjectMoved(RenderGraphObject* pObject);
+
+    virtual void Draw(bool drawOpaques, EmissiveDrawOptions emissiveDrawOption, unsigned int layersToRender, Vector3* camPos, Vector3* camRot, MyMatrix* pMatProj, MyMatrix* pMatView, MyMatrix* shadowlightVP, TextureDefinition* pShadowTex, ShaderGroup* pShaderOverride, PreDrawCallbackFunctionPtr* pPreDrawCallbackFunc);
+
+    // Fills pObjects with the bounded objects whose leaves intersect the frustum, used for drawing and for timing the cull on its own.
+    unsigned int Cull(MyMatrix* pMatViewProj, std::vector<RenderGraphObject*>* pObjects);
+
+    // Tests every bounded object's own bounds against the frustum without using the tree, only used to benchmark Cull.
+    // Cull tests the fat leaf bounds, so it can find a few more objects than this.
+    unsigned int CullBruteForce(MyMatrix* pMatViewProj, std::vector<RenderGraphObject*>* pObjects);
+
+    // Times both culls against the same frustum, doesn't touch m_CullStats.
+    void BenchmarkCull(MyMatrix* pMatViewProj, unsigned int iterations);
+    const BenchmarkResults& GetLastBenchmarkResults() { return m_LastBenchmarkResults; }
+
+    // Applies to all draws until it's set back to null, used to split static and dynamic shadow casters.
+    void SetObjectFilter(ObjectFilterFunc* pFilterFunc) { m_pObjectFilterFunc = pFilterFunc; }
+
+    // Applies to all draws until it's set back to null, used by cascaded shadows to pick a cascade for each object's bounds.
+    void SetShadowReceiverFunc(ShadowReceiverMatrixFunc* pFunc, void* pUserData) { m_pShadowReceiverFunc = pFunc; m_pShadowReceiverUserData = pUserData; }
+
+    int GetHeight() { return m_RootIndex == -1 ? 0 : m_Nodes[m_RootIndex].m_Height; }
+    unsigned int GetNumberOfUnboundedObjects() { return (unsigned int)m_UnboundedObjects.size(); }
+};
+
+#endif //__RenderGraph_BVH_H__
@@ -0,0 +1,166 @@
+//
+// Copyright (c) 2020 Jimmy Lord http://www.flatheadgames.com
+//
+// This software is provided 'as-is', without any express or implied warranty.  In no event will the authors be held liable for any damages arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include "MyEnginePCH.h"
+
+#include "RenderTargetPool.h"
+#include "Core/EngineCore.h"
+
+RenderTargetPool::RenderTargetPool(EngineCore* pEngineCore)
+{
+    m_pEngineCore = pEngineCore;
+
+    m_FrameCount = 0;
+    m_MemoryUsed = 0;
+
+    memset( &m_Stats, 0, sizeof(Stats) );
+}
+
+RenderTargetPool::~RenderTargetPool()
+{
+    // All targets should have been released by the passes that acquired them.
+    MyAssert( GetNumberOfTargetsInUse() == 0 );
+
+    while( m_Targets.size() > 0 )
+    {
+        m_Targets.back().m_InUse = false;
+        FreeTarget( (unsigned int)m_Targets.size() - 1 );
+    }
+}
+
+unsigned int RenderTargetPool::EstimateMemoryUsed(FBODefinition* pFBO, unsigned int width, unsigned int height, FBODefinition::FBOColorFormat colorFormat, int depthBits)
+{
+    // Textures might be padded, so use the actual texture size if it's known.
+    if( pFBO->GetTextureWidth() > 0 && pFBO->GetTextureHeight() > 0 )
+    {
+        width = pFBO->GetTextureWidth();
+        height = pFBO->GetTextureHeight();
+    }
+
+    unsigned int bytesPerPixel = 0;
+    switch( colorFormat )
+    {
+    case FBODefinition::FBOColorFormat_RGBA_UByte:   bytesPerPixel = 4; break;
+    case FBODefinition::FBOColorFormat_RGBA_Float16: bytesPerPixel = 8; break;
+    case FBODefinition::FBOColorFormat_RGB_Float16:  bytesPerPixel = 6; break;
+    default:                                         bytesPerPixel = 4; break;
+    }
+
+    bytesPerPixel += depthBits / 8;
+
+    return width * height * bytesPerPixel;
+}
+
+void RenderTargetPool::FreeTarget(unsigned int index)
+{
+    MyAssert( m_Targets[index].m_InUse == false );
+
+    m_MemoryUsed -= m_Targets[index].m_MemoryUsed;
+    SAFE_RELEASE( m_Targets[index].m_pFBO );
+
+    // Order doesn't matter, so swap with the last target.
+    m_Targets[index] = m_Targets.back();
+    m_Targets.pop_back();
+
+    m_Stats.m_TargetsFreed++;
+}
+
+FBODefinition* RenderTargetPool::Acquire(unsigned int width, unsigned int height, FBODefinition::FBOColorFormat colorFormat, int depthBits)
+{
+    m_Stats.m_TargetsAcquired++;
+
+    for( unsigned int i=0; i<m_Targets.size(); i++ )
+    {
+        RenderTarget& target = m_Targets[i];
+
+        if( target.m_InUse == false &&
+            target.m_Width == width && target.m_Height == height &&
+            target.m_ColorFormat == colorFormat && target.m_DepthBits == depthBits )
+        {
+            target.m_InUse = true;
+            target.m_LastFrameUsed = m_FrameCount;
+            return target.m_pFBO;
+        }
+    }
+
+    // No free target matched, so create a new one.
+    TextureManager* pTextureManager = m_pEngineCore->GetManagers()->GetTextureManager();
+
+    RenderTarget target;
+    target.m_pFBO = pTextureManager->CreateFBO( width, height, MyRE::MinFilter_Nearest, MyRE::MagFilter_Nearest, colorFormat, depthBits, false );
+#if MYFW_EDITOR
+    target.m_pFBO->MemoryPanel_Hide();
+#endif
+    target.m_Width = width;
+    target.m_Height = height;
+    target.m_ColorFormat = colorFormat;
+    target.m_DepthBits = depthBits;
+    target.m_InUse = true;
+    target.m_LastFrameUsed = m_FrameCount;
+    target.m_MemoryUsed = EstimateMemoryUsed( target.m_pFBO, width, height, colorFormat, depthBits );
+
+    m_Targets.push_back( target );
+    m_MemoryUsed += target.m_MemoryUsed;
+
+    m_Stats.m_TargetsCreated++;
+
+    return target.m_pFBO;
+}
+
+void RenderTargetPool::Release(FBODefinition* pFBO)
+{
+    for( unsigned int i=0; i<m_Targets.size(); i++ )
+    {
+        if( m_Targets[i].m_pFBO == pFBO )
+        {
+            MyAssert( m_Targets[i].m_InUse );
+            m_Targets[i].m_InUse = false;
+            return;
+        }
+    }
+
+    // Target didn't come from this pool.
+    MyAssert( false );
+}
+
+void RenderTargetPool::EndFrame()
+{
+    m_FrameCount++;
+
+    // Walk backwards since freeing swaps the last target into the freed slot.
+    for( int i=(int)m_Targets.size()-1; i>=0; i-- )
+    {
+        if( m_Targets[i].m_InUse == false &&
+            m_FrameCount - m_Targets[i].m_LastFrameUsed > FRAMES_BEFORE_FREEING_UNUSED_TARGETS )
+        {
+            FreeTarget( i );
+        }
+    }
+}
+
+void RenderTargetPool::FreeAllUnusedTargets()
+{
+    for( int i=(int)m_Targets.size()-1; i>=0; i-- )
+    {
+        if( m_Targets[i].m_InUse == false )
+            FreeTarget( i );
+    }
+}
+
+unsigned int RenderTargetPool::GetNumberOfTargetsInUse()
+{
+    unsigned int count = 0;
+    for( unsigned int i=0; i<m_Targets.size(); i++ )
+    {
+        if( m_Targets[i].m_InUse )
+            count++;
+    }
+
+    return count;
+}
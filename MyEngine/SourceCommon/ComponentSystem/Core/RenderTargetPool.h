@@ -0,0 +1,73 @@
+//
+// Copyright (c) 2020 Jimmy Lord http://www.flatheadgames.com
+//
+// This software is provided 'as-is', without any express or implied warranty.  In no event will the authors be held liable for any damages arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#ifndef __RenderTargetPool_H__
+#define __RenderTargetPool_H__
+
+// Shared pool of intermediate render targets, keyed by size, color format and depth bits.
+// Targets are acquired for the passes that need them and released when done, so the next pass (or frame)
+//     with the same requirements gets the same FBO back without reallocating it.
+// Targets that go unused for a while are freed, so resizing a viewport doesn't leave old sizes resident.
+class RenderTargetPool
+{
+public:
+    static const unsigned int FRAMES_BEFORE_FREEING_UNUSED_TARGETS = 120;
+
+    struct Stats
+    {
+        unsigned int m_TargetsAcquired;
+        unsigned int m_TargetsCreated;
+        unsigned int m_TargetsFreed;
+    };
+
+protected:
+    struct RenderTarget
+    {
+        FBODefinition* m_pFBO;
+        unsigned int m_Width;
+        unsigned int m_Height;
+        FBODefinition::FBOColorFormat m_ColorFormat;
+        int m_DepthBits;
+        bool m_InUse;
+        unsigned int m_LastFrameUsed;
+        unsigned int m_MemoryUsed; // Estimated, in bytes.
+    };
+
+    EngineCore* m_pEngineCore;
+
+    std::vector<RenderTarget> m_Targets;
+
+    unsigned int m_FrameCount;
+    unsigned int m_MemoryUsed; // Estimated total for all targets, in bytes.
+
+    Stats m_Stats;
+
+protected:
+    unsigned int EstimateMemoryUsed(FBODefinition* pFBO, unsigned int width, unsigned int height, FBODefinition::FBOColorFormat colorFormat, int depthBits);
+    void FreeTarget(unsigned int index);
+
+public:
+    RenderTargetPool(EngineCore* pEngineCore);
+    ~RenderTargetPool();
+
+    // Returns an unused target matching the request, creating one if none are free.
+    FBODefinition* Acquire(unsigned int width, unsigned int height, FBODefinition::FBOColorFormat colorFormat, int depthBits);
+    void Release(FBODefinition* pFBO);
+
+    // Call once per frame after all cameras are drawn, frees targets that haven't been used recently.
+    void EndFrame();
+    void FreeAllUnusedTargets();
+
+    unsigned int GetNumberOfTargets() { return (unsigned int)m_Targets.size(); }
+    unsigned int GetNumberOfTargetsInUse();
+    unsigned int GetMemoryUsed() { return m_MemoryUsed; }
+    Stats& GetStats() { return m_Stats; }
+};
+
+#endif //__RenderTargetPool_H__
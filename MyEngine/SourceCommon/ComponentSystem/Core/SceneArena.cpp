@@ -0,0 +1,134 @@
+//
+// Copyright (c) 2020 Jimmy Lord http://www.flatheadgames.com
+//
+// This software is provided 'as-is', without any express or implied warranty.  In no event will the authors be held liable for any damages arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include "MyEnginePCH.h"
+
+#include "SceneArena.h"
+
+std::map<char*, SceneArena*> SceneArena::m_PageOwners;
+unsigned int SceneArena::m_NumOrphanedArenas = 0;
+
+SceneArena::SceneArena()
+{
+    memset( m_SizeClasses, 0, sizeof(m_SizeClasses) );
+    memset( &m_Stats, 0, sizeof(m_Stats) );
+    m_Orphaned = false;
+}
+
+SceneArena::~SceneArena()
+{
+    MyAssert( m_Stats.m_LiveAllocations == 0 );
+
+    for( unsigned int i=0; i<m_Pages.size(); i++ )
+    {
+        m_PageOwners.erase( m_Pages[i] );
+        delete[] m_Pages[i];
+    }
+
+    if( m_Orphaned )
+        m_NumOrphanedArenas--;
+}
+
+void* SceneArena::Allocate(size_t size)
+{
+    MyAssert( m_Orphaned == false );
+
+    if( size == 0 || size > MAX_ALLOCATION_SIZE )
+        return nullptr;
+
+    unsigned int classIndex = (unsigned int)((size - 1) / SIZE_CLASS_GRANULARITY);
+    unsigned int blockSize = (classIndex + 1) * SIZE_CLASS_GRANULARITY;
+    SizeClass& sizeClass = m_SizeClasses[classIndex];
+
+    void* pMemory = nullptr;
+
+    if( sizeClass.m_pFreeList != nullptr )
+    {
+        pMemory = sizeClass.m_pFreeList;
+        sizeClass.m_pFreeList = sizeClass.m_pFreeList->m_pNext;
+    }
+    else
+    {
+        // Start a new page for this size class if the current one is full.
+        if( sizeClass.m_pNextUnused == nullptr || sizeClass.m_pNextUnused + blockSize > sizeClass.m_pPageEnd )
+        {
+            char* pPage = MyNew char[PAGE_SIZE];
+            m_Pages.push_back( pPage );
+            m_PageOwners[pPage] = this;
+
+            sizeClass.m_pNextUnused = pPage;
+            sizeClass.m_pPageEnd = pPage + (PAGE_SIZE / blockSize) * blockSize;
+
+            m_Stats.m_NumPages++;
+            m_Stats.m_BytesReserved += PAGE_SIZE;
+        }
+
+        pMemory = sizeClass.m_pNextUnused;
+        sizeClass.m_pNextUnused += blockSize;
+    }
+
+    m_Stats.m_BytesInUse += blockSize;
+    m_Stats.m_LiveAllocations++;
+    m_Stats.m_TotalAllocations++;
+
+    return pMemory;
+}
+
+void SceneArena::Free(void* pMemory, size_t size)
+{
+    MyAssert( size > 0 && size <= MAX_ALLOCATION_SIZE );
+    MyAssert( m_Stats.m_LiveAllocations > 0 );
+
+    unsigned int classIndex = (unsigned int)((size - 1) / SIZE_CLASS_GRANULARITY);
+    unsigned int blockSize = (classIndex + 1) * SIZE_CLASS_GRANULARITY;
+    SizeClass& sizeClass = m_SizeClasses[classIndex];
+
+    FreeBlock* pBlock = (FreeBlock*)pMemory;
+    pBlock->m_pNext = sizeClass.m_pFreeList;
+    sizeClass.m_pFreeList = pBlock;
+
+    m_Stats.m_BytesInUse -= blockSize;
+    m_Stats.m_LiveAllocations--;
+
+    if( m_Orphaned && m_Stats.m_LiveAllocations == 0 )
+        delete this;
+}
+
+void SceneArena::Release()
+{
+    MyAssert( m_Orphaned == false );
+
+    if( m_Stats.m_LiveAllocations == 0 )
+    {
+        delete this;
+        return;
+    }
+
+    // Some objects outlived the scene (e.g. unmanaged objects), keep the pages until they're deleted.
+    m_Orphaned = true;
+    m_NumOrphanedArenas++;
+}
+
+bool SceneArena::FreeFromAnyArena(void* pMemory, size_t size)
+{
+    if( pMemory == nullptr || m_PageOwners.empty() )
+        return false;
+
+    // Find the last page starting at or before this address.
+    std::map<char*, SceneArena*>::iterator it = m_PageOwners.upper_bound( (char*)pMemory );
+    if( it == m_PageOwners.begin() )
+        return false;
+    it--;
+
+    if( (char*)pMemory >= it->first + PAGE_SIZE )
+        return false;
+
+    it->second->Free( pMemory, size );
+    return true;
+}
@@ -0,0 +1,77 @@
+//
+// Copyright (c) 2020 Jimmy Lord http://www.flatheadgames.com
+//
+// This software is provided 'as-is', without any express or implied warranty.  In no event will the authors be held liable for any damages arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#ifndef __SceneArena_H__
+#define __SceneArena_H__
+
+// Slab allocator for the GameObjects and components of a single scene.
+// Allocations are rounded up into size classes, each with its own pages and free list, so every component type
+//     is packed in with objects of the same size. All pages are released in one go when the scene is unloaded.
+// Objects are still destroyed one by one, GameObject and ComponentBase have a class level operator delete
+//     that hands the memory back to whichever arena it came from.
+// Not thread safe, GameObjects and components must only be created and deleted on the main thread.
+class SceneArena
+{
+public:
+    static const unsigned int PAGE_SIZE = 64*1024;
+    static const unsigned int SIZE_CLASS_GRANULARITY = 16;
+    static const unsigned int MAX_ALLOCATION_SIZE = 4096; // Anything larger comes from the heap.
+
+    struct Stats
+    {
+        unsigned int m_NumPages;
+        unsigned int m_BytesReserved;
+        unsigned int m_BytesInUse;
+        unsigned int m_LiveAllocations;
+        unsigned int m_TotalAllocations;
+    };
+
+protected:
+    struct FreeBlock
+    {
+        FreeBlock* m_pNext;
+    };
+
+    struct SizeClass
+    {
+        FreeBlock* m_pFreeList;
+        char* m_pNextUnused; // Never handed out blocks in the most recent page.
+        char* m_pPageEnd;
+    };
+
+    static std::map<char*, SceneArena*> m_PageOwners; // Pages from every arena, used to find where memory came from. Main thread only, no lock.
+    static unsigned int m_NumOrphanedArenas;
+
+    SizeClass m_SizeClasses[MAX_ALLOCATION_SIZE / SIZE_CLASS_GRANULARITY];
+    std::vector<char*> m_Pages;
+    Stats m_Stats;
+    bool m_Orphaned; // Scene was unloaded while some of its objects were still alive, delete once they're gone.
+
+protected:
+    ~SceneArena(); // Use Release().
+
+    void Free(void* pMemory, size_t size);
+
+public:
+    SceneArena();
+
+    // Returns nullptr if the size is too large, caller should fall back on the heap.
+    void* Allocate(size_t size);
+
+    // Call when the scene is unloaded, frees all pages now or once the last object allocated from this arena is deleted.
+    void Release();
+
+    const Stats& GetStats() { return m_Stats; }
+
+    // Returns false if the memory didn't come from an arena.
+    static bool FreeFromAnyArena(void* pMemory, size_t size);
+    static unsigned int GetNumberOfOrphanedArenas() { return m_NumOrphanedArenas; }
+};
+
+#endif //__SceneArena_H__
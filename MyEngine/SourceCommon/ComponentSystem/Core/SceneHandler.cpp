@@ -11,10 +11,13 @@
 
 #include "SceneHandler.h"
 #include "ComponentSystem/Core/GameObject.h"
+#include "ComponentSystem/Core/SceneArena.h"
 
 SceneInfo::SceneInfo()
 {
     m_pBox2DWorld = 0;
+    m_pBox2DContactListener = 0;
+    m_pArena = nullptr;
 
     Reset();
 }
@@ -39,8 +42,11 @@ void SceneInfo::Reset()
 
 #if MYFW_USING_BOX2D
     SAFE_DELETE( m_pBox2DWorld );
+    m_pBox2DContactListener = nullptr;
 #endif
 
+    ReleaseArena();
+
     m_FullPath[0] = 0;
 
     m_NextGameObjectID = 1;
@@ -49,6 +55,16 @@ void SceneInfo::Reset()
     m_InUse = false;
 }
 
+void SceneInfo::ReleaseArena()
+{
+    if( m_pArena == nullptr )
+        return;
+
+    // Frees all the scene's pages at once, the arena will stick around if any objects from it are still alive.
+    m_pArena->Release();
+    m_pArena = nullptr;
+}
+
 void SceneInfo::ChangePath(const char* newfullpath)
 {
     // Store a relative path, rather than the full path.
@@ -11,7 +11,9 @@
 #define __SceneHandler_H__
 
 class Box2DWorld;
+class EngineBox2DContactListener;
 class GameObject;
+class SceneArena;
 
 class SceneInfo
 {
@@ -22,6 +24,8 @@ public:
     
     TCPPListHead<GameObject*> m_GameObjects; // scene level game objects, children are stored in a list inside the game object.
     Box2DWorld* m_pBox2DWorld; // each scene has it's own Box2D world, TODO: runtime created physics objects won't work.
+    EngineBox2DContactListener* m_pBox2DContactListener; // Owned by m_pBox2DWorld, queues contact events until the step is done.
+    SceneArena* m_pArena; // GameObjects and components for this scene are allocated from here, if scene arenas are enabled.
 
     char m_FullPath[MAX_PATH];
     unsigned int m_NextGameObjectID;
@@ -32,6 +36,7 @@ public:
     SceneInfo();
 
     void Reset();
+    void ReleaseArena();
 
     void ChangePath(const char* newfullpath);
 };
@@ -0,0 +1,591 @@
+//
+// Copyright (c) 2020 Jimmy Lord http://www.flatheadgames.com
+//
+// This software is provided 'as-is', without any express or implied warranty.  In no event will the authors be held liable for any damages arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include "MyEnginePCH.h"
+
+#include "SceneLoader.h"
+#include "ComponentSystem/Core/ComponentTypeManager.h"
+#include "ComponentSystem/Core/GameObject.h"
+#include "Core/EngineCore.h"
+
+SceneLoader::Stats SceneLoader::m_Stats;
+
+static const char* g_BlockArrayNames[SceneLoader::BlockArray_NumArrays] =
+{
+    "Files",
+    "GameObjects",
+    "Transforms",
+    "Components",
+};
+
+//====================================================================================================
+// Scene text splitting.
+//====================================================================================================
+
+static char* SkipWhitespace(char* p)
+{
+    while( *p != '\0' && (unsigned char)*p <= ' ' )
+        p++;
+
+    return p;
+}
+
+// p points at the opening quote, returns a pointer to the closing quote or nullptr if the text ends first.
+static char* FindEndOfString(char* p)
+{
+    for( p++; *p != '\0'; p++ )
+    {
+        if( *p == '\\' )
+        {
+            p++;
+            if( *p == '\0' )
+                return nullptr;
+        }
+        else if( *p == '"' )
+        {
+            return p;
+        }
+    }
+
+    return nullptr;
+}
+
+// Returns a pointer just past the end of the value starting at p, or nullptr if the text ends first.
+// Brackets aren't checked against each other, cJSON will catch that when the block is parsed.
+static char* FindEndOfValue(char* p)
+{
+    if( *p == '"' )
+    {
+        char* pEnd = FindEndOfString( p );
+        return pEnd ? pEnd + 1 : nullptr;
+    }
+
+    if( *p == '{' || *p == '[' )
+    {
+        int depth = 0;
+        for( ; *p != '\0'; p++ )
+        {
+            if( *p == '"' )
+            {
+                p = FindEndOfString( p );
+                if( p == nullptr )
+                    return nullptr;
+            }
+            else if( *p == '{' || *p == '[' )
+            {
+                depth++;
+            }
+            else if( *p == '}' || *p == ']' )
+            {
+                depth--;
+                if( depth == 0 )
+                    return p + 1;
+            }
+        }
+
+        return nullptr;
+    }
+
+    // Number, true, false or null.
+    while( *p != '\0' && *p != ',' && *p != '}' && *p != ']' && (unsigned char)*p > ' ' )
+        p++;
+
+    return p;
+}
+
+//====================================================================================================
+// SceneLoaderParseJob
+//====================================================================================================
+
+class SceneLoaderParseJob : public MyJob
+{
+protected:
+    SceneLoader* m_pLoader;
+    unsigned int m_FirstBlock;
+    unsigned int m_NumBlocks;
+
+public:
+    SceneLoaderParseJob()
+    {
+        m_pLoader = nullptr;
+        m_FirstBlock = 0;
+        m_NumBlocks = 0;
+    }
+
+    // Call before adding the job to the job manager.
+    void PrepareToParse(SceneLoader* pLoader, unsigned int firstBlock, unsigned int numBlocks)
+    {
+        m_IsStarted = false;
+        m_IsFinished = false;
+
+        m_pLoader = pLoader;
+        m_FirstBlock = firstBlock;
+        m_NumBlocks = numBlocks;
+    }
+
+    virtual void DoWork()
+    {
+        m_pLoader->ParseBlocks( m_FirstBlock, m_NumBlocks );
+    }
+};
+
+//====================================================================================================
+// SceneLoader
+//====================================================================================================
+
+SceneLoader::SceneLoader(ComponentTypeManager* pComponentTypeManager)
+{
+    m_pComponentTypeManager = pComponentTypeManager;
+
+    for( int i=0; i<MAX_JOBS; i++ )
+    {
+        m_pJobs[i] = MyNew SceneLoaderParseJob;
+    }
+
+    m_pBuffer = nullptr;
+    m_jRoot = nullptr;
+
+    for( int i=0; i<BlockArray_NumArrays; i++ )
+    {
+        m_ArrayStart[i] = 0;
+        m_ArrayCount[i] = 0;
+    }
+
+    m_SceneID = SCENEID_NotSet;
+    m_GetSceneIDFromEachObject = false;
+}
+
+SceneLoader::~SceneLoader()
+{
+    for( int i=0; i<MAX_JOBS; i++ )
+    {
+        delete m_pJobs[i];
+    }
+
+    // Blocks split from the text own their json, blocks gathered from a full parse are freed with the root.
+    for( unsigned int i=0; i<m_Blocks.size(); i++ )
+    {
+        if( m_Blocks[i].m_pText && m_Blocks[i].m_jObject )
+            cJSON_Delete( m_Blocks[i].m_jObject );
+    }
+
+    if( m_jRoot )
+        cJSON_Delete( m_jRoot );
+
+    delete[] m_pBuffer;
+}
+
+void SceneLoader::AddBlock(BlockArray array, char* pText, cJSON* jObject)
+{
+    SceneLoaderBlock block;
+    block.m_Array = array;
+    block.m_pText = pText;
+    block.m_jObject = jObject;
+    block.m_IsValid = false;
+    block.m_SceneID = m_SceneID;
+    block.m_ID = 0;
+    block.m_GameObjectID = 0;
+    block.m_ComponentType = -1;
+    block.m_IsFolder = false;
+    block.m_HasTransform = true;
+
+    m_Blocks.push_back( block );
+}
+
+bool SceneLoader::SplitText(const char* jsonString)
+{
+    size_t length = strlen( jsonString );
+    m_pBuffer = MyNew char[length + 1];
+    memcpy( m_pBuffer, jsonString, length + 1 );
+
+    // The end of each block, only terminated once the whole text is scanned since it's usually a ',' or ']'.
+    std::vector<char*> blockEnds;
+
+    bool arrayFound[BlockArray_NumArrays] = {};
+
+    char* p = SkipWhitespace( m_pBuffer );
+    if( *p != '{' )
+        return false;
+
+    p = SkipWhitespace( p + 1 );
+    while( *p != '}' )
+    {
+        // Read the key.
+        if( *p != '"' )
+            return false;
+
+        char* pKeyEnd = FindEndOfString( p );
+        if( pKeyEnd == nullptr )
+            return false;
+
+        int array = -1;
+        size_t keyLength = pKeyEnd - (p + 1);
+        for( int i=0; i<BlockArray_NumArrays; i++ )
+        {
+            if( strlen( g_BlockArrayNames[i] ) == keyLength && strncmp( p + 1, g_BlockArrayNames[i], keyLength ) == 0 )
+                array = i;
+        }
+
+        p = SkipWhitespace( pKeyEnd + 1 );
+        if( *p != ':' )
+            return false;
+        p = SkipWhitespace( p + 1 );
+
+        if( array == -1 )
+        {
+            // Not one of ours, skip it.
+            // It's still parsed, so a scene the full parse would reject doesn't get through here.
+            char* pEnd = FindEndOfValue( p );
+            if( pEnd == nullptr )
+                return false;
+
+            char endChar = *pEnd;
+            *pEnd = '\0';
+            cJSON* jValue = cJSON_ParseWithOpts( p, nullptr, 1 );
+            *pEnd = endChar;
+
+            if( jValue == nullptr )
+                return false;
+            cJSON_Delete( jValue );
+
+            p = pEnd;
+        }
+        else
+        {
+            // cJSON_GetObjectItem would only see the first array with this name.
+            if( *p != '[' || arrayFound[array] )
+                return false;
+
+            arrayFound[array] = true;
+            m_ArrayStart[array] = (unsigned int)m_Blocks.size();
+
+            p = SkipWhitespace( p + 1 );
+            while( *p != ']' )
+            {
+                char* pEnd = FindEndOfValue( p );
+                if( pEnd == nullptr )
+                    return false;
+
+                AddBlock( (BlockArray)array, p, nullptr );
+                blockEnds.push_back( pEnd );
+
+                p = SkipWhitespace( pEnd );
+                if( *p == ',' )
+                    p = SkipWhitespace( p + 1 );
+                else if( *p != ']' )
+                    return false;
+            }
+
+            m_ArrayCount[array] = (unsigned int)m_Blocks.size() - m_ArrayStart[array];
+            p++;
+        }
+
+        p = SkipWhitespace( p );
+        if( *p == ',' )
+            p = SkipWhitespace( p + 1 );
+        else if( *p != '}' )
+            return false;
+    }
+
+    for( unsigned int i=0; i<blockEnds.size(); i++ )
+    {
+        *blockEnds[i] = '\0';
+    }
+
+    return true;
+}
+
+void SceneLoader::GatherBlocksFromTree()
+{
+    for( int array=0; array<BlockArray_NumArrays; array++ )
+    {
+        m_ArrayStart[array] = (unsigned int)m_Blocks.size();
+
+        cJSON* jArray = cJSON_GetObjectItem( m_jRoot, g_BlockArrayNames[array] );
+        if( jArray )
+        {
+            for( int i=0; i<cJSON_GetArraySize( jArray ); i++ )
+            {
+                AddBlock( (BlockArray)array, nullptr, cJSON_GetArrayItem( jArray, i ) );
+            }
+        }
+
+        m_ArrayCount[array] = (unsigned int)m_Blocks.size() - m_ArrayStart[array];
+    }
+}
+
+bool SceneLoader::Parse(const char* jsonString, SceneID sceneID, bool getSceneIDFromEachObject, bool parseInParallel)
+{
+    double startTime = MyTime_GetSystemTime();
+
+    memset( &m_Stats, 0, sizeof(Stats) );
+
+    m_SceneID = sceneID;
+    m_GetSceneIDFromEachObject = getSceneIDFromEachObject;
+
+    // Phase 1: Find each entry in the text.
+    if( SplitText( jsonString ) == false )
+    {
+        // Not laid out the way SaveSceneToJSON writes it, parse it in one go.
+        m_Stats.m_SplitFailed = true;
+
+        m_Blocks.clear();
+        for( int i=0; i<BlockArray_NumArrays; i++ )
+        {
+            m_ArrayStart[i] = 0;
+            m_ArrayCount[i] = 0;
+        }
+
+        delete[] m_pBuffer;
+        m_pBuffer = nullptr;
+
+        m_jRoot = cJSON_Parse( jsonString );
+        if( m_jRoot == nullptr )
+            return false;
+
+        GatherBlocksFromTree();
+    }
+
+    double splitEndTime = MyTime_GetSystemTime();
+    m_Stats.m_SplitTime = (float)((splitEndTime - startTime) * 1000);
+
+    // Phase 2: Parse and pre-validate the blocks.
+    // Split the blocks into even chunks, queue all but the first and parse the first chunk here.
+    unsigned int numBlocks = (unsigned int)m_Blocks.size();
+    if( numBlocks > 0 )
+    {
+        unsigned int numChunks = 1;
+        if( parseInParallel && g_pEngineCore->GetManagers()->GetJobManager() != nullptr )
+        {
+            numChunks = numBlocks / MIN_BLOCKS_PER_JOB;
+            if( numChunks > (unsigned int)MAX_JOBS+1 )
+                numChunks = MAX_JOBS+1;
+            if( numChunks == 0 )
+                numChunks = 1;
+        }
+
+        unsigned int chunkSize = (numBlocks + numChunks - 1) / numChunks;
+
+        unsigned int numQueued = 0;
+        for( unsigned int i=1; i<numChunks; i++ )
+        {
+            unsigned int first = i * chunkSize;
+            if( first >= numBlocks )
+                break;
+
+            unsigned int count = numBlocks - first < chunkSize ? numBlocks - first : chunkSize;
+
+            m_pJobs[i-1]->PrepareToParse( this, first, count );
+            g_pEngineCore->GetManagers()->GetJobManager()->AddJob( m_pJobs[i-1] );
+            numQueued++;
+        }
+
+        ParseBlocks( 0, numBlocks < chunkSize ? numBlocks : chunkSize );
+
+        for( unsigned int i=0; i<numQueued; i++ )
+        {
+            g_pEngineCore->GetManagers()->GetJobManager()->WaitForJobToComplete( m_pJobs[i] );
+        }
+
+        m_Stats.m_JobsUsed = numQueued;
+    }
+
+    m_Stats.m_BlocksParsed = numBlocks;
+    m_Stats.m_ParseTime = (float)((MyTime_GetSystemTime() - splitEndTime) * 1000);
+
+    // A block that isn't valid json fails the load, same as if the whole scene failed to parse.
+    for( unsigned int i=0; i<numBlocks; i++ )
+    {
+        if( m_Blocks[i].m_jObject == nullptr )
+        {
+            LOGError( LOGTag, "Scene file has an invalid %s entry (%d).\n", g_BlockArrayNames[m_Blocks[i].m_Array], i - m_ArrayStart[m_Blocks[i].m_Array] );
+            return false;
+        }
+    }
+
+    // Entries saved without a SceneID belong to the same scene as the entry before them,
+    //     carried across the arrays in the order they appear in the file.
+    if( m_GetSceneIDFromEachObject )
+    {
+        SceneID previousSceneID = m_SceneID;
+        for( unsigned int i=0; i<numBlocks; i++ )
+        {
+            if( m_Blocks[i].m_Array == BlockArray_Files )
+                continue;
+
+            if( m_Blocks[i].m_SceneID == SCENEID_NotSet )
+                m_Blocks[i].m_SceneID = previousSceneID;
+            else
+                previousSceneID = m_Blocks[i].m_SceneID;
+        }
+    }
+
+    return true;
+}
+
+void SceneLoader::ParseBlocks(unsigned int first, unsigned int count)
+{
+    for( unsigned int i=first; i<first+count; i++ )
+    {
+        ParseBlock( &m_Blocks[i] );
+    }
+}
+
+void SceneLoader::ParseBlock(SceneLoaderBlock* pBlock)
+{
+    if( pBlock->m_pText )
+        pBlock->m_jObject = cJSON_Parse( pBlock->m_pText );
+
+    cJSON* jObject = pBlock->m_jObject;
+    if( jObject == nullptr )
+        return;
+
+    // Entries without a SceneID are given the one from the entry before them once all blocks are parsed.
+    if( m_GetSceneIDFromEachObject && pBlock->m_Array != BlockArray_Files )
+    {
+        pBlock->m_SceneID = SCENEID_NotSet;
+        cJSONExt_GetUnsignedInt( jObject, "SceneID", (unsigned int*)&pBlock->m_SceneID );
+    }
+
+    switch( pBlock->m_Array )
+    {
+    case BlockArray_Files:
+        pBlock->m_IsValid = true;
+        break;
+
+    case BlockArray_GameObjects:
+        {
+            unsigned int id = -1;
+            cJSONExt_GetUnsignedInt( jObject, "ID", &id );
+            pBlock->m_ID = id;
+            pBlock->m_IsValid = (id != -1);
+
+            // LEGACY: Support for old scene files with folders in them, now stored as "SubType".
+            cJSONExt_GetBool( jObject, "IsFolder", &pBlock->m_IsFolder );
+
+            cJSON* jSubtype = cJSON_GetObjectItem( jObject, "SubType" );
+            if( jSubtype )
+            {
+                if( strcmp( jSubtype->valuestring, "Folder" ) == 0 )
+                {
+                    pBlock->m_IsFolder = true;
+                    pBlock->m_HasTransform = false;
+                }
+                else if( strcmp( jSubtype->valuestring, "Logic" ) == 0 )
+                {
+                    pBlock->m_HasTransform = false;
+                }
+            }
+        }
+        break;
+
+    case BlockArray_Transforms:
+        cJSONExt_GetUnsignedInt( jObject, "GOID", &pBlock->m_GameObjectID );
+        pBlock->m_IsValid = (pBlock->m_GameObjectID > 0);
+        break;
+
+    case BlockArray_Components:
+        {
+            cJSONExt_GetUnsignedInt( jObject, "GOID", &pBlock->m_GameObjectID );
+            cJSONExt_GetUnsignedInt( jObject, "ID", &pBlock->m_ID );
+
+            // Type names are looked up in a table that doesn't change after startup.
+            cJSON* jType = cJSON_GetObjectItem( jObject, "Type" );
+            if( jType )
+                pBlock->m_ComponentType = m_pComponentTypeManager->GetTypeByName( jType->valuestring );
+
+            pBlock->m_IsValid = (pBlock->m_GameObjectID > 0);
+        }
+        break;
+    }
+}
+
+//====================================================================================================
+// SceneLoadIDMap
+//====================================================================================================
+
+void SceneLoadIDMap::AddGameObjectList(SceneID sceneID, GameObject* pFirst)
+{
+    for( GameObject* pGameObject = pFirst; pGameObject != nullptr; pGameObject = pGameObject->GetNext() )
+    {
+        if( pGameObject->IsManaged() )
+        {
+            // Keep the first match, same as walking the list would.
+            uint64 key = MakeKey( sceneID, pGameObject->GetID() );
+            if( m_GameObjects.find( key ) == m_GameObjects.end() )
+                m_GameObjects[key] = pGameObject;
+        }
+
+        if( pGameObject->GetFirstChild() )
+            AddGameObjectList( sceneID, pGameObject->GetFirstChild() );
+    }
+}
+
+void SceneLoadIDMap::RemoveGameObject(GameObject* pGameObject)
+{
+    std::unordered_map<uint64, GameObject*>::iterator it = m_GameObjects.find( MakeKey( pGameObject->GetSceneID(), pGameObject->GetID() ) );
+    if( it != m_GameObjects.end() && it->second == pGameObject )
+    {
+        m_GameObjects.erase( it );
+        return;
+    }
+
+    // The object may have been added under a different scene, objects are rarely deleted while loading.
+    for( it = m_GameObjects.begin(); it != m_GameObjects.end(); it++ )
+    {
+        if( it->second == pGameObject )
+        {
+            m_GameObjects.erase( it );
+            return;
+        }
+    }
+}
+
+void SceneLoadIDMap::RemoveComponent(ComponentBase* pComponent)
+{
+    std::unordered_map<uint64, ComponentBase*>::iterator it = m_Components.find( MakeKey( pComponent->GetSceneID(), pComponent->GetID() ) );
+    if( it != m_Components.end() && it->second == pComponent )
+    {
+        m_Components.erase( it );
+        return;
+    }
+
+    for( it = m_Components.begin(); it != m_Components.end(); it++ )
+    {
+        if( it->second == pComponent )
+        {
+            m_Components.erase( it );
+            return;
+        }
+    }
+}
+
+GameObject* SceneLoadIDMap::FindGameObject(SceneID sceneID, unsigned int id)
+{
+    std::unordered_map<uint64, GameObject*>::iterator it = m_GameObjects.find( MakeKey( sceneID, id ) );
+    if( it == m_GameObjects.end() )
+        return nullptr;
+
+    if( it->second->IsManaged() == false || it->second->GetID() != id || it->second->GetSceneID() != sceneID )
+        return nullptr;
+
+    return it->second;
+}
+
+ComponentBase* SceneLoadIDMap::FindComponent(SceneID sceneID, unsigned int id)
+{
+    std::unordered_map<uint64, ComponentBase*>::iterator it = m_Components.find( MakeKey( sceneID, id ) );
+    if( it == m_Components.end() )
+        return nullptr;
+
+    if( it->second->GetID() != id || it->second->GetSceneID() != sceneID )
+        return nullptr;
+
+    return it->second;
+}
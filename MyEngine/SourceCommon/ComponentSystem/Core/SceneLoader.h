@@ -0,0 +1,127 @@
+//
+// Copyright (c) 2020 Jimmy Lord http://www.flatheadgames.com
+//
+// This software is provided 'as-is', without any express or implied warranty.  In no event will the authors be held liable for any damages arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#ifndef __SceneLoader_H__
+#define __SceneLoader_H__
+
+class SceneLoaderParseJob;
+
+// One GameObject, transform, component or file entry from a scene file.
+struct SceneLoaderBlock
+{
+    int m_Array; // SceneLoader::BlockArray.
+    char* m_pText; // This entry in the loader's copy of the scene text, nullptr if m_jObject is part of a tree parsed in one go.
+    cJSON* m_jObject;
+
+    // Filled in by the parse jobs.
+    bool m_IsValid;
+    SceneID m_SceneID;
+    unsigned int m_ID; // GameObject ID for GameObjects, component ID for components.
+    unsigned int m_GameObjectID; // Owning GameObject for transforms and components.
+    int m_ComponentType; // -1 if the type name isn't known.
+    bool m_IsFolder;
+    bool m_HasTransform;
+};
+
+// Multi-phase scene parser.
+//     The scene text is split into one block per array entry, then the blocks are parsed with cJSON and
+//     their IDs/types pulled out on the job threads. Creating and importing objects is left to the caller
+//     on the main thread, since none of that is thread safe.
+// If the text can't be split (i.e. it isn't laid out the way SaveSceneToJSON writes it) the whole scene is
+//     parsed in one go and only the pre-validation runs on the job threads.
+class SceneLoader
+{
+    static const int MAX_JOBS = 4; // The main thread also takes a share of blocks.
+    static const unsigned int MIN_BLOCKS_PER_JOB = 64;
+
+public:
+    enum BlockArray
+    {
+        BlockArray_Files,
+        BlockArray_GameObjects,
+        BlockArray_Transforms,
+        BlockArray_Components,
+        BlockArray_NumArrays,
+    };
+
+    // Timing breakdown of the last scene load, in ms.
+    struct Stats
+    {
+        float m_SplitTime;
+        float m_ParseTime;
+        float m_CreateTime; // Files, GameObjects, transforms and empty components.
+        float m_ImportTime; // Component properties.
+        float m_TotalTime;
+        unsigned int m_BlocksParsed;
+        unsigned int m_JobsUsed;
+        bool m_SplitFailed;
+    };
+
+protected:
+    static Stats m_Stats;
+
+    ComponentTypeManager* m_pComponentTypeManager;
+    SceneLoaderParseJob* m_pJobs[MAX_JOBS]; // The first chunk is parsed on the main thread, chunk i uses m_pJobs[i-1].
+
+    char* m_pBuffer; // Copy of the scene text, split in place.
+    cJSON* m_jRoot; // Only set if the text couldn't be split.
+
+    std::vector<SceneLoaderBlock> m_Blocks;
+    unsigned int m_ArrayStart[BlockArray_NumArrays];
+    unsigned int m_ArrayCount[BlockArray_NumArrays];
+
+    SceneID m_SceneID;
+    bool m_GetSceneIDFromEachObject;
+
+protected:
+    bool SplitText(const char* jsonString);
+    void GatherBlocksFromTree();
+    void AddBlock(BlockArray array, char* pText, cJSON* jObject);
+    void ParseBlock(SceneLoaderBlock* pBlock);
+
+public:
+    SceneLoader(ComponentTypeManager* pComponentTypeManager);
+    ~SceneLoader();
+
+    // Split and parse the scene, returns false if the text isn't valid json.
+    bool Parse(const char* jsonString, SceneID sceneID, bool getSceneIDFromEachObject, bool parseInParallel);
+
+    // Called from the job threads, each block is only touched by one thread.
+    void ParseBlocks(unsigned int first, unsigned int count);
+
+    unsigned int GetNumBlocks(BlockArray array) { return m_ArrayCount[array]; }
+    SceneLoaderBlock* GetBlock(BlockArray array, unsigned int index) { return &m_Blocks[m_ArrayStart[array] + index]; }
+
+    static Stats& GetStats() { return m_Stats; }
+};
+
+// ID to object lookups used while a scene is loading, so finding objects by ID doesn't walk every list.
+//     Hits are checked against the object's current ID and scene, anything stale is treated as a miss.
+class SceneLoadIDMap
+{
+protected:
+    std::unordered_map<uint64, GameObject*> m_GameObjects;
+    std::unordered_map<uint64, ComponentBase*> m_Components;
+
+    static uint64 MakeKey(SceneID sceneID, unsigned int id) { return ((uint64)sceneID << 32) | id; }
+
+public:
+    // Adds all managed GameObjects in the list and their children.
+    void AddGameObjectList(SceneID sceneID, GameObject* pFirst);
+
+    void AddGameObject(SceneID sceneID, unsigned int id, GameObject* pGameObject) { m_GameObjects[MakeKey( sceneID, id )] = pGameObject; }
+    void AddComponent(SceneID sceneID, unsigned int id, ComponentBase* pComponent) { m_Components[MakeKey( sceneID, id )] = pComponent; }
+    void RemoveGameObject(GameObject* pGameObject);
+    void RemoveComponent(ComponentBase* pComponent);
+
+    GameObject* FindGameObject(SceneID sceneID, unsigned int id);
+    ComponentBase* FindComponent(SceneID sceneID, unsigned int id);
+};
+
+#endif //__SceneLoader_H__
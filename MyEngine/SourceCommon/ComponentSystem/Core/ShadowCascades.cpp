@@ -0,0 +1,181 @@
+//
+// Copyright (c) 2020 Jimmy Lord http://www.flatheadgames.com
+//
+// This software is provided 'as-is', without any express or implied warranty.  In no event will the authors be held liable for any damages arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include "MyEnginePCH.h"
+
+#include "ShadowCascades.h"
+
+ShadowCascades::ShadowCascades()
+{
+    m_NumCascades = 0;
+    m_AtlasResolution = 0;
+    m_TileResolution = 0;
+
+    m_ViewPosition.Set( 0, 0, 0 );
+    m_ViewDirection.Set( 0, 0, -1 );
+}
+
+void ShadowCascades::CalculateSplitDistances(float nearZ, float farZ, int numCascades, float lambda, float* pSplits)
+{
+    MyAssert( nearZ > 0 && farZ > nearZ );
+    MyAssert( numCascades > 0 );
+
+    pSplits[0] = nearZ;
+
+    for( int i=1; i<numCascades; i++ )
+    {
+        float perc = (float)i / numCascades;
+
+        float logSplit = nearZ * powf( farZ / nearZ, perc );
+        float uniformSplit = nearZ + (farZ - nearZ) * perc;
+
+        pSplits[i] = lambda * logSplit + (1 - lambda) * uniformSplit;
+    }
+
+    pSplits[numCascades] = farZ;
+}
+
+float ShadowCascades::CalculateStableOrthoProjection(const MyMatrix& matLightView, const Vector3* pWorldCorners, int tileResolution, float casterDistance, MyMatrix* pMatProj)
+{
+    MyAssert( tileResolution > 0 );
+
+    // Use a bounding sphere rather than a box, so the projection's size doesn't change as the view rotates.
+    Vector3 center( 0, 0, 0 );
+    for( int i=0; i<8; i++ )
+        center += pWorldCorners[i];
+    center = center / 8.0f;
+
+    float radius = 0;
+    for( int i=0; i<8; i++ )
+    {
+        float distance = (pWorldCorners[i] - center).Length();
+        if( distance > radius )
+            radius = distance;
+    }
+
+    // Round the radius up, otherwise float error changes the texel size from frame to frame.
+    radius = ceilf( radius * 16.0f ) / 16.0f;
+    if( radius <= 0 )
+        radius = 1.0f/16.0f;
+
+    // Snap the center to whole texels in light space.
+    Vector4 lightSpaceCenter = matLightView * Vector4( center.x, center.y, center.z, 1 );
+
+    float texelSize = (radius * 2) / tileResolution;
+    float x = floorf( lightSpaceCenter.x / texelSize ) * texelSize;
+    float y = floorf( lightSpaceCenter.y / texelSize ) * texelSize;
+
+    // The light looks down -z in its view space.
+    float nearZ = -lightSpaceCenter.z - radius - casterDistance;
+    float farZ = -lightSpaceCenter.z + radius;
+
+    pMatProj->CreateOrtho( x - radius, x + radius, y - radius, y + radius, nearZ, farZ );
+
+    return radius;
+}
+
+void ShadowCascades::CalculateAtlasTileMatrix(int tileX, int tileY, int tilesPerRow, MyMatrix* pMatTile)
+{
+    MyAssert( tilesPerRow > 0 );
+
+    float scale = 1.0f / tilesPerRow;
+
+    pMatTile->SetIdentity();
+    pMatTile->m11 = scale;
+    pMatTile->m22 = scale;
+    pMatTile->m41 = -1 + (2*tileX + 1) * scale;
+    pMatTile->m42 = -1 + (2*tileY + 1) * scale;
+}
+
+void ShadowCascades::Update(MyMatrix* pMatViewerProj, MyMatrix* pMatViewerView, float viewerNearZ, float viewerFarZ, float maxDistance, MyMatrix* pMatLightView, int numCascades, float splitLambda, float casterDistance, int atlasResolution)
+{
+    MyAssert( viewerFarZ > viewerNearZ );
+
+    if( numCascades < 1 )
+        numCascades = 1;
+    if( numCascades > MAX_CASCADES )
+        numCascades = MAX_CASCADES;
+
+    int tilesPerRow = numCascades > 1 ? 2 : 1;
+
+    m_NumCascades = numCascades;
+    m_AtlasResolution = atlasResolution;
+    m_TileResolution = atlasResolution / tilesPerRow;
+
+    // Find the world space corners of the viewer's near and far planes.
+    MyMatrix invViewProj = ( *pMatViewerProj * *pMatViewerView ).GetInverse();
+
+    Vector3 nearCorners[4];
+    Vector3 farCorners[4];
+    Vector3 nearCenter( 0, 0, 0 );
+    Vector3 farCenter( 0, 0, 0 );
+    for( int i=0; i<4; i++ )
+    {
+        float x = (i & 1) ? 1.0f : -1.0f;
+        float y = (i & 2) ? 1.0f : -1.0f;
+
+        Vector4 nearPos = invViewProj * Vector4( x, y, -1, 1 );
+        Vector4 farPos = invViewProj * Vector4( x, y, 1, 1 );
+
+        nearCorners[i].Set( nearPos.x / nearPos.w, nearPos.y / nearPos.w, nearPos.z / nearPos.w );
+        farCorners[i].Set( farPos.x / farPos.w, farPos.y / farPos.w, farPos.z / farPos.w );
+
+        nearCenter += nearCorners[i];
+        farCenter += farCorners[i];
+    }
+    nearCenter = nearCenter / 4.0f;
+    farCenter = farCenter / 4.0f;
+
+    m_ViewDirection = (farCenter - nearCenter).GetNormalized();
+    m_ViewPosition = nearCenter - m_ViewDirection * viewerNearZ;
+
+    // Split the view depth between the near plane and the shadow distance.
+    float shadowFarZ = viewerFarZ;
+    if( maxDistance > viewerNearZ && maxDistance < viewerFarZ )
+        shadowFarZ = maxDistance;
+
+    float splits[MAX_CASCADES + 1];
+    CalculateSplitDistances( viewerNearZ < 0.01f ? 0.01f : viewerNearZ, shadowFarZ, m_NumCascades, splitLambda, splits );
+
+    for( int i=0; i<m_NumCascades; i++ )
+    {
+        Cascade* pCascade = &m_Cascades[i];
+
+        pCascade->m_SplitNear = splits[i];
+        pCascade->m_SplitFar = splits[i+1];
+
+        // View depth is linear along each edge of the frustum, so slice corners can be interpolated.
+        float nearPerc = (pCascade->m_SplitNear - viewerNearZ) / (viewerFarZ - viewerNearZ);
+        float farPerc = (pCascade->m_SplitFar - viewerNearZ) / (viewerFarZ - viewerNearZ);
+
+        Vector3 sliceCorners[8];
+        for( int c=0; c<4; c++ )
+        {
+            Vector3 edge = farCorners[c] - nearCorners[c];
+            sliceCorners[c] = nearCorners[c] + edge * nearPerc;
+            sliceCorners[c+4] = nearCorners[c] + edge * farPerc;
+        }
+
+        pCascade->m_Radius = CalculateStableOrthoProjection( *pMatLightView, sliceCorners, m_TileResolution, casterDistance, &pCascade->m_matProj );
+        pCascade->m_matViewProj = pCascade->m_matProj * *pMatLightView;
+
+        int tileX = i % tilesPerRow;
+        int tileY = i / tilesPerRow;
+
+        MyMatrix matTile;
+        CalculateAtlasTileMatrix( tileX, tileY, tilesPerRow, &matTile );
+        pCascade->m_matAtlasViewProj = matTile * pCascade->m_matViewProj;
+
+        pCascade->m_AtlasX = tileX * m_TileResolution;
+        pCascade->m_AtlasY = tileY * m_TileResolution;
+
+        float tileSize = 1.0f / tilesPerRow;
+        pCascade->m_AtlasUVBounds = Vector4( tileX * tileSize, tileY * tileSize, (tileX + 1) * tileSize, (tileY + 1) * tileSize );
+    }
+}
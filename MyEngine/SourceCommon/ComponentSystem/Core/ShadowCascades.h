@@ -0,0 +1,74 @@
+//
+// Copyright (c) 2020 Jimmy Lord http://www.flatheadgames.com
+//
+// This software is provided 'as-is', without any express or implied warranty.  In no event will the authors be held liable for any damages arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#ifndef __ShadowCascades_H__
+#define __ShadowCascades_H__
+
+// Picks the shadow matrix for a receiver's world bounds, returns null if the receiver shouldn't be shadowed.
+// Used by draws that take a single matrix per object, since no one cascade covers every receiver.
+typedef MyMatrix* ShadowReceiverMatrixFunc(void* pUserData, const Vector3& boundsMin, const Vector3& boundsMax);
+
+// Splits a view camera's frustum into slices and fits a stable orthographic light projection around each one.
+// Each cascade renders into its own tile of a single shadow map atlas, 2x2 tiles when there's more than one.
+class ShadowCascades
+{
+public:
+    static const int MAX_CASCADES = 4;
+
+    struct Cascade
+    {
+        float m_SplitNear; // View depth range covered by this cascade.
+        float m_SplitFar;
+        float m_Radius; // Radius of the sphere around the frustum slice, rounded up to keep it stable while the view rotates.
+
+        MyMatrix m_matProj; // Light projection, used to draw casters into this cascade's atlas tile.
+        MyMatrix m_matViewProj;
+        MyMatrix m_matAtlasViewProj; // Clip space scaled and offset into this cascade's tile of the atlas.
+        Vector4 m_AtlasUVBounds; // Min and max texture coords of this cascade's tile, receivers reject anything outside it.
+
+        int m_AtlasX; // Tile offset in texels.
+        int m_AtlasY;
+    };
+
+protected:
+    int m_NumCascades;
+    int m_AtlasResolution;
+    int m_TileResolution;
+
+    Cascade m_Cascades[MAX_CASCADES];
+
+    Vector3 m_ViewPosition; // Eye position and direction of the view camera, used by receivers to pick a cascade.
+    Vector3 m_ViewDirection;
+
+public:
+    ShadowCascades();
+
+    // Blends logarithmic and uniform splits, lambda of 1 is fully logarithmic.
+    // pSplits needs room for numCascades+1 values, the first is nearZ and the last is farZ.
+    static void CalculateSplitDistances(float nearZ, float farZ, int numCascades, float lambda, float* pSplits);
+
+    // Fits an ortho projection around a sphere bounding the 8 world space corners.
+    // The sphere's center is snapped to whole texels in light space so shadow edges don't shimmer as the view moves.
+    // casterDistance extends the near plane towards the light so casters outside the slice are still drawn.
+    static float CalculateStableOrthoProjection(const MyMatrix& matLightView, const Vector3* pWorldCorners, int tileResolution, float casterDistance, MyMatrix* pMatProj);
+
+    // Builds the matrix that maps a tile's clip space into the atlas' clip space.
+    static void CalculateAtlasTileMatrix(int tileX, int tileY, int tilesPerRow, MyMatrix* pMatTile);
+
+    // viewerNearZ and viewerFarZ must match the viewer's projection, shadows stop at maxDistance if it's closer than the far plane.
+    void Update(MyMatrix* pMatViewerProj, MyMatrix* pMatViewerView, float viewerNearZ, float viewerFarZ, float maxDistance, MyMatrix* pMatLightView, int numCascades, float splitLambda, float casterDistance, int atlasResolution);
+
+    int GetNumCascades() { return m_NumCascades; }
+    int GetTileResolution() { return m_TileResolution; }
+    Cascade* GetCascade(int index) { MyAssert( index >= 0 && index < m_NumCascades ); return &m_Cascades[index]; }
+    Vector3 GetViewPosition() { return m_ViewPosition; }
+    Vector3 GetViewDirection() { return m_ViewDirection; }
+};
+
+#endif //__ShadowCascades_H__
@@ -0,0 +1,375 @@
+//
+// Copyright (c) 2020 Jimmy Lord http://www.flatheadgames.com
+//
+// This software is provided 'as-is', without any express or implied warranty.  In no event will the authors be held liable for any damages arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include "MyEnginePCH.h"
+
+#include "SpriteBatcher.h"
+#include "ComponentSystem/BaseComponents/ComponentCamera.h"
+#include "ComponentSystem/BaseComponents/ComponentTransform.h"
+#include "ComponentSystem/Core/ComponentSystemManager.h"
+#include "ComponentSystem/Core/LightRegistry.h"
+#include "ComponentSystem/FrameworkComponents/ComponentSprite.h"
+#include "Core/EngineCore.h"
+
+SpriteBatcher::SpriteBatcher(EngineCore* pEngineCore)
+{
+    m_pEngineCore = pEngineCore;
+
+    m_Enabled = true;
+    m_NextBatchMesh = 0;
+
+    m_pShadowReceiverFunc = nullptr;
+    m_pShadowReceiverUserData = nullptr;
+
+    memset( &m_Stats, 0, sizeof(Stats) );
+}
+
+SpriteBatcher::~SpriteBatcher()
+{
+    // Sprites unregister when they're removed from the scene, so there shouldn't be any left.
+    MyAssert( m_Sprites.size() == 0 );
+
+    for( unsigned int i=0; i<m_BatchMeshes.size(); i++ )
+    {
+        SAFE_RELEASE( m_BatchMeshes[i] );
+    }
+}
+
+void SpriteBatcher::RegisterSprite(ComponentSprite* pSprite)
+{
+    MyAssert( pSprite->m_SpriteBatcherIndex == -1 );
+
+    pSprite->m_SpriteBatcherIndex = (int)m_Sprites.size();
+    m_Sprites.push_back( pSprite );
+}
+
+void SpriteBatcher::UnregisterSprite(ComponentSprite* pSprite)
+{
+    int index = pSprite->m_SpriteBatcherIndex;
+    if( index == -1 )
+        return;
+
+    MyAssert( m_Sprites[index] == pSprite );
+
+    // Swap the last sprite into this slot.
+    ComponentSprite* pLastSprite = m_Sprites.back();
+    m_Sprites[index] = pLastSprite;
+    pLastSprite->m_SpriteBatcherIndex = index;
+    m_Sprites.pop_back();
+
+    pSprite->m_SpriteBatcherIndex = -1;
+}
+
+bool SpriteBatcher::IsSpriteVisible(ComponentSprite* pSprite, ComponentCamera* pCamera)
+{
+    if( pSprite->IsVisible() == false )
+        return false;
+
+    if( pSprite->ExistsOnLayer( pCamera->m_LayersToRender ) == false )
+        return false;
+
+    MaterialDefinition* pMaterial = pSprite->GetMaterial( 0 );
+    if( pMaterial == nullptr || pMaterial->IsFullyLoaded() == false )
+        return false;
+
+    return true;
+}
+
+bool SpriteBatcher::IsSpriteInPass(ComponentSprite* pSprite, bool drawOpaques, bool drawTransparents)
+{
+    // Match the render graph, any blending puts the sprite in the transparent pass.
+    bool isTransparent = pSprite->GetMaterial( 0 )->GetBlendType() != MyRE::MaterialBlendType_Off;
+
+    if( isTransparent )
+        return drawTransparents;
+
+    return drawOpaques;
+}
+
+// Same clip space test as ComponentMesh::DrawCallback, using the 4 corners of the quad.
+bool SpriteBatcher::IsQuadOnScreen(Vector4* pCorners, MyMatrix* pMatViewProj)
+{
+    Vector4 clippos[4];
+    for( int i=0; i<4; i++ )
+    {
+        clippos[i] = *pMatViewProj * pCorners[i];
+    }
+
+    for( int component=0; component<3; component++ ) // Loop through x/y/z.
+    {
+        bool insideMin = false;
+        bool insideMax = false;
+        for( int i=0; i<4; i++ )
+        {
+            if( clippos[i][component] >= -clippos[i].w )
+                insideMin = true;
+            if( clippos[i][component] <= clippos[i].w )
+                insideMax = true;
+        }
+
+        // All points are outside of one plane.
+        if( insideMin == false || insideMax == false )
+            return false;
+    }
+
+    return true;
+}
+
+void SpriteBatcher::BuildBatches(ComponentCamera* pCamera, MyMatrix* pMatView, MyMatrix* pMatViewProj, bool drawOpaques)
+{
+    ClearQuads();
+
+    // Collect the sprites this camera can see in this pass.
+    for( unsigned int i=0; i<m_Sprites.size(); i++ )
+    {
+        ComponentSprite* pSprite = m_Sprites[i];
+
+        if( IsSpriteVisible( pSprite, pCamera ) == false )
+            continue;
+
+        if( IsSpriteInPass( pSprite, drawOpaques, !drawOpaques ) == false )
+            continue;
+
+        MaterialDefinition* pMaterial = pSprite->GetMaterial( 0 );
+        MyMatrix* pMatWorld = pSprite->m_pComponentTransform->GetWorldTransform();
+
+        SpriteQuad quad;
+        quad.m_SortLayer = pSprite->m_SortLayer;
+        quad.m_Depth = 0;
+        if( drawOpaques == false )
+        {
+            // Draw transparent sprites back to front within each layer.
+            // Sort on view space depth rather than distance, so ortho cameras sort the same way the depth buffer does.
+            Vector3 pos = pMatWorld->GetTranslation();
+            Vector4 viewPos = *pMatView * Vector4( pos.x, pos.y, pos.z, 1 );
+            quad.m_Depth = viewPos.z;
+        }
+        quad.m_pTexture = pMaterial->GetTextureColor();
+        quad.m_pMaterial = pMaterial;
+        quad.m_SpriteIndex = i;
+        quad.m_pMatWorld = pMatWorld;
+        quad.m_Size = pSprite->m_Size;
+        quad.m_UVStart = pSprite->m_UVStart;
+        quad.m_UVEnd = pSprite->m_UVEnd;
+        AddQuad( quad );
+    }
+
+    BuildBatchesFromQuads( pMatViewProj );
+}
+
+void SpriteBatcher::ClearQuads()
+{
+    memset( &m_Stats, 0, sizeof(Stats) );
+
+    m_Quads.clear();
+    m_Vertices.clear();
+    m_Batches.clear();
+}
+
+void SpriteBatcher::BuildBatchesFromQuads(MyMatrix* pMatViewProj)
+{
+    m_Vertices.clear();
+    m_Batches.clear();
+
+    if( m_Quads.size() == 0 )
+        return;
+
+    std::sort( m_Quads.begin(), m_Quads.end() );
+
+    m_Vertices.reserve( m_Quads.size() * 4 );
+
+    // Transform each quad into world space and start a new batch whenever the layer or material changes.
+    Batch* pCurrentBatch = nullptr;
+    for( unsigned int i=0; i<m_Quads.size(); i++ )
+    {
+        SpriteQuad& quad = m_Quads[i];
+
+        MyMatrix* pMatWorld = quad.m_pMatWorld;
+
+        // Sprites are created centered, so the corners are at +/- half size.
+        float halfWidth = quad.m_Size.x / 2;
+        float halfHeight = quad.m_Size.y / 2;
+
+        Vector4 corners[4];
+        corners[0] = *pMatWorld * Vector4( -halfWidth, -halfHeight, 0, 1 ); // Bottom Left.
+        corners[1] = *pMatWorld * Vector4(  halfWidth, -halfHeight, 0, 1 ); // Bottom Right.
+        corners[2] = *pMatWorld * Vector4( -halfWidth,  halfHeight, 0, 1 ); // Top Left.
+        corners[3] = *pMatWorld * Vector4(  halfWidth,  halfHeight, 0, 1 ); // Top Right.
+
+        if( pMatViewProj && IsQuadOnScreen( corners, pMatViewProj ) == false )
+        {
+            m_Stats.m_SpritesCulled++;
+            continue;
+        }
+
+        if( pCurrentBatch == nullptr ||
+            pCurrentBatch->m_SortLayer != quad.m_SortLayer ||
+            pCurrentBatch->m_pMaterial != quad.m_pMaterial ||
+            pCurrentBatch->m_NumSprites >= MAX_SPRITES_PER_BATCH )
+        {
+            Batch batch;
+            batch.m_pMaterial = quad.m_pMaterial;
+            batch.m_SortLayer = quad.m_SortLayer;
+            batch.m_FirstSprite = (unsigned int)(m_Vertices.size() / 4);
+            batch.m_NumSprites = 0;
+            batch.m_BoundsMin.Set( FLT_MAX, FLT_MAX, FLT_MAX );
+            batch.m_BoundsMax.Set( -FLT_MAX, -FLT_MAX, -FLT_MAX );
+            m_Batches.push_back( batch );
+
+            pCurrentBatch = &m_Batches.back();
+        }
+
+        Vector4 normal = *pMatWorld * Vector4( 0, 0, 1, 0 );
+
+        // Same UV range the sprite's own quad was created with.
+        Vector2 uvStart = quad.m_UVStart;
+        Vector2 uvEnd = quad.m_UVEnd;
+        const float uvs[4][2] =
+        {
+            { uvStart.x, uvEnd.y }, // Bottom Left.
+            { uvEnd.x, uvEnd.y }, // Bottom Right.
+            { uvStart.x, uvStart.y }, // Top Left.
+            { uvEnd.x, uvStart.y }, // Top Right.
+        };
+        for( int c=0; c<4; c++ )
+        {
+            Vertex_XYZUVNorm vert;
+            vert.pos.x = corners[c].x;
+            vert.pos.y = corners[c].y;
+            vert.pos.z = corners[c].z;
+            vert.uv.x = uvs[c][0];
+            vert.uv.y = uvs[c][1];
+            vert.normal.Set( normal.x, normal.y, normal.z );
+            m_Vertices.push_back( vert );
+
+            Vector3& boundsMin = pCurrentBatch->m_BoundsMin;
+            Vector3& boundsMax = pCurrentBatch->m_BoundsMax;
+            if( corners[c].x < boundsMin.x ) boundsMin.x = corners[c].x;
+            if( corners[c].y < boundsMin.y ) boundsMin.y = corners[c].y;
+            if( corners[c].z < boundsMin.z ) boundsMin.z = corners[c].z;
+            if( corners[c].x > boundsMax.x ) boundsMax.x = corners[c].x;
+            if( corners[c].y > boundsMax.y ) boundsMax.y = corners[c].y;
+            if( corners[c].z > boundsMax.z ) boundsMax.z = corners[c].z;
+        }
+
+        pCurrentBatch->m_NumSprites++;
+        m_Stats.m_SpritesBatched++;
+    }
+
+    m_Stats.m_Batches = (unsigned int)m_Batches.size();
+}
+
+MyMesh* SpriteBatcher::GetBatchMesh(unsigned int batchIndex)
+{
+    // Create meshes as needed, each is sized for a full batch and has its index buffer filled once.
+    while( batchIndex >= m_BatchMeshes.size() )
+    {
+        unsigned int numVerts = MAX_SPRITES_PER_BATCH * 4;
+        unsigned int numIndices = MAX_SPRITES_PER_BATCH * 6;
+
+        MyMesh* pMesh = MyNew MyMesh( m_pEngineCore );
+        pMesh->RebuildShapeBuffers( numVerts, VertexFormat_XYZUVNorm, MyRE::PrimitiveType_Triangles, numIndices, MyRE::IndexType_U32, "SpriteBatcher" );
+
+        unsigned int* pIndices = (unsigned int*)pMesh->GetSubmesh( 0 )->m_pIndexBuffer->GetData( true );
+        for( unsigned int i=0; i<MAX_SPRITES_PER_BATCH; i++ )
+        {
+            // BL - BR - TR.
+            pIndices[i*6 + 0] = i*4 + 0;
+            pIndices[i*6 + 1] = i*4 + 1;
+            pIndices[i*6 + 2] = i*4 + 3;
+
+            // BL - TR - TL.
+            pIndices[i*6 + 3] = i*4 + 0;
+            pIndices[i*6 + 4] = i*4 + 3;
+            pIndices[i*6 + 5] = i*4 + 2;
+        }
+
+        pMesh->SetReady();
+
+        m_BatchMeshes.push_back( pMesh );
+    }
+
+    return m_BatchMeshes[batchIndex];
+}
+
+void SpriteBatcher::Draw(ComponentCamera* pCamera, MyMatrix* pMatProj, MyMatrix* pMatView, MyMatrix* pShadowVP, TextureDefinition* pShadowTex, bool drawOpaques)
+{
+    if( m_Sprites.size() == 0 )
+    {
+        memset( &m_Stats, 0, sizeof(Stats) );
+        return;
+    }
+
+    MyMatrix matViewProj = *pMatProj * *pMatView;
+    BuildBatches( pCamera, pMatView, &matViewProj, drawOpaques );
+
+    LightRegistry* pLightRegistry = m_pEngineCore->GetComponentSystemManager()->m_pLightRegistry;
+
+    Vector3 campos = pCamera->m_pComponentTransform->GetLocalPosition();
+    Vector3 camrot = pCamera->m_pComponentTransform->GetLocalRotation();
+
+    // Quads are already in world space.
+    MyMatrix matWorld;
+    matWorld.SetIdentity();
+
+    // Each pass and camera takes the next unused meshes, so nothing drawn earlier this frame is overwritten.
+    unsigned int firstMesh = m_NextBatchMesh;
+
+    for( unsigned int i=0; i<m_Batches.size(); i++ )
+    {
+        Batch* pBatch = &m_Batches[i];
+        MyMesh* pMesh = GetBatchMesh( m_NextBatchMesh++ );
+        MySubmesh* pSubmesh = pMesh->GetSubmesh( 0 );
+
+        Vertex_XYZUVNorm* pVerts = (Vertex_XYZUVNorm*)pSubmesh->m_pVertexBuffer->GetData( true );
+        memcpy( pVerts, &m_Vertices[pBatch->m_FirstSprite * 4], sizeof(Vertex_XYZUVNorm) * 4 * pBatch->m_NumSprites );
+        pSubmesh->m_NumIndicesToDraw = pBatch->m_NumSprites * 6;
+
+        // Light the whole batch with the point lights nearest to its bounds, the same query meshes use.
+        MyLight* pLights[MAX_LIGHTS];
+        int numLights = pLightRegistry->FindNearestLights( LightType_Point, MAX_LIGHTS, pBatch->m_BoundsMin, pBatch->m_BoundsMax, pLights );
+
+        MyMatrix* pBatchShadowVP = pShadowVP;
+        TextureDefinition* pBatchShadowTex = pShadowTex;
+        if( pShadowVP && m_pShadowReceiverFunc )
+        {
+            pBatchShadowVP = m_pShadowReceiverFunc( m_pShadowReceiverUserData, pBatch->m_BoundsMin, pBatch->m_BoundsMax );
+            if( pBatchShadowVP == nullptr )
+                pBatchShadowTex = nullptr;
+        }
+
+        pMesh->SetMaterial( pBatch->m_pMaterial, 0 );
+        pMesh->Draw( pMatProj, pMatView, &matWorld, &campos, &camrot, pLights, numLights, pBatchShadowVP, pBatchShadowTex, nullptr, nullptr );
+    }
+
+    // Don't hold a reference to the materials between frames.
+    for( unsigned int i=firstMesh; i<m_NextBatchMesh; i++ )
+    {
+        m_BatchMeshes[i]->SetMaterial( nullptr, 0 );
+    }
+}
+
+void SpriteBatcher::DrawIndividually(ComponentCamera* pCamera, MyMatrix* pMatProj, MyMatrix* pMatView, ShaderGroup* pShaderOverride, SpriteBatcherPerObjectCallbackFunc* pCallback, bool drawOpaques, bool drawTransparents)
+{
+    for( unsigned int i=0; i<m_Sprites.size(); i++ )
+    {
+        ComponentSprite* pSprite = m_Sprites[i];
+
+        if( IsSpriteVisible( pSprite, pCamera ) == false )
+            continue;
+
+        if( IsSpriteInPass( pSprite, drawOpaques, drawTransparents ) == false )
+            continue;
+
+        if( pCallback )
+            pCallback( pSprite, pShaderOverride );
+
+        pSprite->m_pSprite->Draw( pMatProj, pMatView, pSprite->m_pComponentTransform->GetWorldTransform(), pShaderOverride, true );
+    }
+}
@@ -0,0 +1,137 @@
+//
+// Copyright (c) 2020 Jimmy Lord http://www.flatheadgames.com
+//
+// This software is provided 'as-is', without any express or implied warranty.  In no event will the authors be held liable for any damages arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#ifndef __SpriteBatcher_H__
+#define __SpriteBatcher_H__
+
+#include "ShadowCascades.h"
+
+class ComponentBase;
+class ComponentCamera;
+class ComponentSprite;
+
+typedef void SpriteBatcherPerObjectCallbackFunc(ComponentBase* pComponent, ShaderGroup* pShaderOverride);
+
+// Collects visible sprites for a camera, sorts them by sort layer, texture and material,
+//     then writes world space quads into one shared vertex array and draws each run of matching sprites at once.
+// Opaque and transparent sprites are drawn in their matching passes, transparent ones are also sorted back to front.
+// Verts are pre-transformed, so sprites with materials that rely on the world matrix should turn batching off.
+// Each batch is lit by the point lights nearest to its bounds, sprites that need their own lights should also turn batching off.
+class SpriteBatcher
+{
+public:
+    static const unsigned int MAX_SPRITES_PER_BATCH = 4096; // Larger runs are split into multiple batches.
+
+    struct Batch
+    {
+        MaterialDefinition* m_pMaterial;
+        int m_SortLayer;
+        unsigned int m_FirstSprite; // Index into the shared vertex array, in quads.
+        unsigned int m_NumSprites;
+        Vector3 m_BoundsMin; // World space bounds of all quads in the batch, used to find lights.
+        Vector3 m_BoundsMax;
+    };
+
+    // Everything BuildBatchesFromQuads needs to know about one sprite.
+    struct SpriteQuad
+    {
+        int m_SortLayer;
+        float m_Depth; // View space z for transparent sprites, so the furthest sort first. 0 for opaque ones.
+        TextureDefinition* m_pTexture;
+        MaterialDefinition* m_pMaterial;
+        unsigned int m_SpriteIndex;
+        MyMatrix* m_pMatWorld;
+        Vector2 m_Size;
+        Vector2 m_UVStart;
+        Vector2 m_UVEnd;
+
+        bool operator<(const SpriteQuad& other) const
+        {
+            if( m_SortLayer != other.m_SortLayer ) return m_SortLayer < other.m_SortLayer;
+            if( m_Depth != other.m_Depth ) return m_Depth < other.m_Depth;
+            if( m_pTexture != other.m_pTexture ) return m_pTexture < other.m_pTexture;
+            if( m_pMaterial != other.m_pMaterial ) return m_pMaterial < other.m_pMaterial;
+            return m_SpriteIndex < other.m_SpriteIndex; // Keep registration order within a batch.
+        }
+    };
+
+    struct Stats
+    {
+        unsigned int m_SpritesBatched;
+        unsigned int m_SpritesCulled;
+        unsigned int m_Batches;
+    };
+
+protected:
+    static const int MAX_LIGHTS = 4;
+
+    EngineCore* m_pEngineCore;
+
+    bool m_Enabled; // Set before loading scenes, sprites only check this when they're added to the scene.
+
+    std::vector<ComponentSprite*> m_Sprites;
+    std::vector<SpriteQuad> m_Quads; // Rebuilt each draw.
+    std::vector<Vertex_XYZUVNorm> m_Vertices; // Shared by all batches, 4 verts per sprite.
+    std::vector<Batch> m_Batches;
+
+    // One mesh per batch drawn this frame across all passes and cameras,
+    //     so a buffer isn't overwritten while an earlier draw might still use it.
+    std::vector<MyMesh*> m_BatchMeshes;
+    unsigned int m_NextBatchMesh; // Reset by StartFrame.
+
+    ShadowReceiverMatrixFunc* m_pShadowReceiverFunc; // Null to give every batch the shadow matrix passed to Draw.
+    void* m_pShadowReceiverUserData;
+
+    Stats m_Stats;
+
+protected:
+    bool IsSpriteVisible(ComponentSprite* pSprite, ComponentCamera* pCamera);
+    bool IsSpriteInPass(ComponentSprite* pSprite, bool drawOpaques, bool drawTransparents);
+    bool IsQuadOnScreen(Vector4* pCorners, MyMatrix* pMatViewProj);
+    MyMesh* GetBatchMesh(unsigned int batchIndex);
+
+public:
+    SpriteBatcher(EngineCore* pEngineCore);
+    ~SpriteBatcher();
+
+    bool IsEnabled() { return m_Enabled; }
+    void SetEnabled(bool enabled) { m_Enabled = enabled; }
+
+    // Called once before any cameras draw, lets the batch meshes used last frame be refilled.
+    void StartFrame() { m_NextBatchMesh = 0; }
+
+    // Applies to all draws until it's set back to null, used by cascaded shadows to pick a cascade for each batch's bounds.
+    void SetShadowReceiverFunc(ShadowReceiverMatrixFunc* pFunc, void* pUserData) { m_pShadowReceiverFunc = pFunc; m_pShadowReceiverUserData = pUserData; }
+
+    void RegisterSprite(ComponentSprite* pSprite);
+    void UnregisterSprite(ComponentSprite* pSprite);
+
+    // Culls, sorts and fills the shared vertex array for either the opaque or transparent sprites, doesn't touch the renderer.
+    void BuildBatches(ComponentCamera* pCamera, MyMatrix* pMatView, MyMatrix* pMatViewProj, bool drawOpaques);
+
+    // The CPU side of BuildBatches, split out so it can run without any sprites or a renderer.
+    // pMatViewProj can be null to skip culling.
+    void ClearQuads();
+    void AddQuad(const SpriteQuad& quad) { m_Quads.push_back( quad ); }
+    void BuildBatchesFromQuads(MyMatrix* pMatViewProj);
+
+    // Builds and draws the batches for one pass, one draw call per batch.
+    void Draw(ComponentCamera* pCamera, MyMatrix* pMatProj, MyMatrix* pMatView, MyMatrix* pShadowVP, TextureDefinition* pShadowTex, bool drawOpaques);
+
+    // Draws each sprite on its own with the given shader, used by passes with shader overrides (shadows, mouse picking).
+    void DrawIndividually(ComponentCamera* pCamera, MyMatrix* pMatProj, MyMatrix* pMatView, ShaderGroup* pShaderOverride, SpriteBatcherPerObjectCallbackFunc* pCallback, bool drawOpaques, bool drawTransparents);
+
+    unsigned int GetNumberOfSprites() { return (unsigned int)m_Sprites.size(); }
+    unsigned int GetNumberOfBatches() { return (unsigned int)m_Batches.size(); }
+    const Batch* GetBatch(unsigned int index) { return &m_Batches[index]; }
+    const Vertex_XYZUVNorm* GetVertices() { return m_Vertices.size() > 0 ? &m_Vertices[0] : nullptr; }
+    const Stats& GetStats() { return m_Stats; }
+};
+
+#endif //__SpriteBatcher_H__
@@ -185,14 +185,14 @@ void ComponentLuaScript::CreateNewScriptFile()
         bool isMeshScript = false;
 
         // If a ComponentMenuPage is attached to this game object, then offer to make the file in the menus folder.
-        if( m_pGameObject->GetFirstComponentOfType( "MenuPageComponent" ) != nullptr )
+        if( m_pGameObject->GetFirstComponentOfTypeID( ComponentTypeID_MenuPage ) != nullptr )
         {
             isMenuActionScript = true;
             initialPath = "Data\\Menus\\";
         }
 
         // If a ComponentMesh is attached to this game object, then add a SetupCustomUniforms callback.
-        if( m_pGameObject->GetFirstComponentOfType( "MeshComponent" ) != nullptr )
+        if( m_pGameObject->GetFirstComponentOfTypeID( ComponentTypeID_Mesh ) != nullptr )
         {
             isMeshScript = true;
         }
@@ -261,6 +261,28 @@ public:
         return false;
     }
 
+    template <class P1, class P2, class P3, class P4>
+    bool CallFunction(const char* pFuncName, P1 p1, P2 p2, P3 p3, P4 p4)
+    {
+        if( m_ScriptLoaded == false ) return false;
+        if( m_ErrorInScript ) return false;
+        if( m_Playing == false ) return false;
+
+        // Find the function and call it.
+        luabridge::LuaRef LuaObject = luabridge::getGlobal( m_pLuaGameState->m_pLuaState, m_pScriptFile->GetFilenameWithoutExtension() );
+        MyAssert( LuaObject.isNil() == false );
+
+        // Call pFuncName.
+        if( LuaObject[pFuncName].isFunction() == false ) return false;
+
+        luabridge::LuaRef gameObjectData = luabridge::getGlobal( m_pLuaGameState->m_pLuaState, m_LuaGameObjectName );
+
+        ProgramVariables( false );
+        try { if( LuaObject[pFuncName]( gameObjectData, p1, p2, p3, p4 ) == LUA_OK ) return true; return false; }
+        catch(luabridge::LuaException const& e) { HandleLuaError( pFuncName, e.what() ); }
+        return false;
+    }
+
     template <class P1, class P2, class P3, class P4, class P5>
     bool CallFunction(const char* pFuncName, P1 p1, P2 p2, P3 p3, P4 p4, P5 p5)
     {
@@ -49,6 +49,7 @@ ComponentMonoScript::ComponentMonoScript(EngineCore* pEngineCore, ComponentSyste
     m_pScriptFile = nullptr;
     m_MonoClassName[0] = '\0';
     m_pMonoObjectInstance = nullptr;
+    m_MonoInstanceImageGeneration = 0;
 
     m_pMonoFuncPtr_OnLoad = nullptr;
     m_pMonoFuncPtr_OnPlay = nullptr;
@@ -185,14 +186,14 @@ void ComponentMonoScript::CreateNewScriptFile()
         bool isMeshScript = false;
 
         // If a ComponentMenuPage is attached to this game object, then offer to make the file in the menus folder.
-        if( m_pGameObject->GetFirstComponentOfType( "MenuPageComponent" ) != nullptr )
+        if( m_pGameObject->GetFirstComponentOfTypeID( ComponentTypeID_MenuPage ) != nullptr )
         {
             isMenuActionScript = true;
             initialPath = "Data\\Menus\\";
         }
 
         // If a ComponentMesh is attached to this game object, then add a SetupCustomUniforms callback.
-        if( m_pGameObject->GetFirstComponentOfType( "MeshComponent" ) != nullptr )
+        if( m_pGameObject->GetFirstComponentOfTypeID( ComponentTypeID_Mesh ) != nullptr )
         {
             isMeshScript = true;
         }
@@ -313,8 +314,7 @@ void ComponentMonoScript::AddAllVariablesToWatchPanel(CommandStack* pCommandStac
         }
         else
         {
-            MonoClass* pClass = mono_class_from_name( pMonoImage, "", m_MonoClassName );
-            if( pClass == nullptr )
+            if( m_pMonoGameState->GetScriptClassInfo( m_MonoClassName ) == nullptr )
             {
                 ImGui::Indent( 20 );
                 ImGui::Text( "Class not found in dll", m_MonoClassName );
@@ -721,57 +721,31 @@ void ComponentMonoScript::LoadScript(bool forceLoad)
         
         if( pMonoImage )
         {
-            MonoClass* pClass = mono_class_from_name( pMonoImage, "", m_MonoClassName );
+            MonoScriptClassInfo* pClassInfo = m_pMonoGameState->GetScriptClassInfo( m_MonoClassName );
 
             // Get pointers to all the interface methods of the object.
-            if( pClass )
+            if( pClassInfo )
             {
-                {
-                    MonoMethod* pMonoMethod;
-
-                    pMonoMethod = mono_class_get_method_from_name( pClass, "OnLoad", 0 );
-                    if( pMonoMethod )
-                        m_pMonoFuncPtr_OnLoad = (OnLoadFunc*)mono_method_get_unmanaged_thunk( pMonoMethod );
-
-                    pMonoMethod = mono_class_get_method_from_name( pClass, "OnPlay", 0 );
-                    if( pMonoMethod )
-                        m_pMonoFuncPtr_OnPlay = (OnPlayFunc*)mono_method_get_unmanaged_thunk( pMonoMethod );
-
-                    pMonoMethod = mono_class_get_method_from_name( pClass, "OnStop", 0 );
-                    if( pMonoMethod )
-                        m_pMonoFuncPtr_OnStop = (OnStopFunc*)mono_method_get_unmanaged_thunk( pMonoMethod );
-
-                    pMonoMethod = mono_class_get_method_from_name( pClass, "OnTouch", 6 );
-                    if( pMonoMethod )
-                        m_pMonoFuncPtr_OnTouch = (OnTouchFunc*)mono_method_get_unmanaged_thunk( pMonoMethod );
-
-                    pMonoMethod = mono_class_get_method_from_name( pClass, "OnButtons", 2 );
-                    if( pMonoMethod )
-                        m_pMonoFuncPtr_OnButtons = (OnButtonsFunc*)mono_method_get_unmanaged_thunk( pMonoMethod );
-
-                    pMonoMethod = mono_class_get_method_from_name( pClass, "Update", 1 );
-                    if( pMonoMethod )
-                        m_pMonoFuncPtr_Update = (UpdateFunc*)mono_method_get_unmanaged_thunk( pMonoMethod );
-                }
+                m_pMonoFuncPtr_OnLoad = (OnLoadFunc*)pClassInfo->m_pThunk_OnLoad;
+                m_pMonoFuncPtr_OnPlay = (OnPlayFunc*)pClassInfo->m_pThunk_OnPlay;
+                m_pMonoFuncPtr_OnStop = (OnStopFunc*)pClassInfo->m_pThunk_OnStop;
+                m_pMonoFuncPtr_OnTouch = (OnTouchFunc*)pClassInfo->m_pThunk_OnTouch;
+                m_pMonoFuncPtr_OnButtons = (OnButtonsFunc*)pClassInfo->m_pThunk_OnButtons;
+                m_pMonoFuncPtr_Update = (UpdateFunc*)pClassInfo->m_pThunk_Update;
 
                 // Create an instance of this class type and call the constructor.
-                m_pMonoObjectInstance = mono_object_new( pMonoDomain, pClass );
-                MonoMethod* pConstructor = mono_class_get_method_from_name( pClass, ".ctor", 0 );
-                mono_runtime_invoke( pConstructor, m_pMonoObjectInstance, nullptr, nullptr );
+                m_pMonoObjectInstance = mono_object_new( pMonoDomain, pClassInfo->m_pClass );
+                if( pClassInfo->m_pConstructor )
+                    mono_runtime_invoke( pClassInfo->m_pConstructor, m_pMonoObjectInstance, nullptr, nullptr );
+                m_MonoInstanceImageGeneration = MonoGameState::g_ImageGeneration;
 
                 // Create and setup the GameObject variable in this m_pMonoObjectInstance.
+                if( pClassInfo->m_pGameObjectField )
                 {
-                    MonoClass* pGameObjectClass = mono_class_from_name( pMonoImage, "MyEngine", "GameObject" );
-                    if( pGameObjectClass )
+                    MonoObject* pMonoGameObjectInstance = Mono_ConstructGameObject( m_pGameObject );
+                    if( pMonoGameObjectInstance )
                     {
-                        MonoObject* pMonoGameObjectInstance = mono_object_new( pMonoDomain, pGameObjectClass );
-                        mono_runtime_object_init( pMonoGameObjectInstance );
-            
-                        MonoClassField* pNativeGameObjectField = mono_class_get_field_from_name( pGameObjectClass, "m_pNativeObject" );
-                        mono_field_set_value( pMonoGameObjectInstance, pNativeGameObjectField, &m_pGameObject );
-
-                        MonoClassField* pGameObjectField = mono_class_get_field_from_name( pClass, "m_GameObject" );
-                        mono_field_set_value( m_pMonoObjectInstance, pGameObjectField, pMonoGameObjectInstance );
+                        mono_field_set_value( m_pMonoObjectInstance, pClassInfo->m_pGameObjectField, pMonoGameObjectInstance );
                     }
                 }
 
@@ -805,13 +779,12 @@ void ComponentMonoScript::ParseExterns(MonoGameState* pMonoGameState)
         m_ExposedVars[i]->inUse = false;
     }
 
-    MonoDomain* pMonoDomain = m_pMonoGameState->GetActiveDomain();
-    MonoImage* pMonoImage = m_pMonoGameState->GetImage();
+    MonoScriptClassInfo* pClassInfo = m_pMonoGameState->GetScriptClassInfo( m_MonoClassName );
 
-    MonoClass* pClass = mono_class_from_name( pMonoImage, "", m_MonoClassName );
-
-    if( pClass )
+    if( pClassInfo )
     {
+        MonoClass* pClass = pClassInfo->m_pClass;
+
         // TODO: Grab parent fields recursively.
         //MonoClass* pParentClass = mono_class_get_parent( pClass );
 
@@ -855,6 +828,7 @@ void ComponentMonoScript::ParseExterns(MonoGameState* pMonoGameState)
                 }
 
                 pVar->name = varName;
+                pVar->fieldOffset = mono_field_get_offset( pField );
 
                 if( strcmp( typeName, "System.Single" ) == 0 )
                 {
@@ -942,65 +916,48 @@ void ComponentMonoScript::ProgramVariables(bool updateExposedVariables)
     // Only program the exposed vars if they change.
     if( updateExposedVariables )
     {
-        MonoDomain* pMonoDomain = m_pMonoGameState->GetActiveDomain();
-        MonoImage* pMonoImage = m_pMonoGameState->GetImage();
+        // Field offsets are from the last ParseExterns(), don't use them if the instance came from an older dll.
+        if( m_pMonoObjectInstance == nullptr || m_MonoInstanceImageGeneration != MonoGameState::g_ImageGeneration )
+            return;
 
-        MonoClass* pClass = mono_class_from_name( pMonoImage, "", m_MonoClassName );
+        char* pInstanceData = (char*)m_pMonoObjectInstance;
 
-        if( pClass )
+        for( unsigned int i=0; i<m_ExposedVars.Count(); i++ )
         {
-            for( unsigned int i=0; i<m_ExposedVars.Count(); i++ )
-            {
-                ExposedVariableDesc* pVar = m_ExposedVars[i];
+            ExposedVariableDesc* pVar = m_ExposedVars[i];
 
-                switch( pVar->value.type )
-                {
-                case ExposedVariableType::Float:
-                    {
-                        MonoClassField* pField = mono_class_get_field_from_name( pClass, pVar->name.c_str() );
-                        float value = (float)pVar->value.valueDouble;
-                        mono_field_set_value( m_pMonoObjectInstance, pField, &value );
-                    }
-                    break;
+            if( pVar->fieldOffset == -1 )
+                continue;
 
-                case ExposedVariableType::Bool:
-                    {
-                        MonoClassField* pField = mono_class_get_field_from_name( pClass, pVar->name.c_str() );
-                        bool value = (bool)pVar->value.valueBool;
-                        mono_field_set_value( m_pMonoObjectInstance, pField, &value );
-                    }
-                    break;
+            void* pFieldData = pInstanceData + pVar->fieldOffset;
 
-                case ExposedVariableType::Vector3:
-                    {
-                        MonoClassField* pField = mono_class_get_field_from_name( pClass, pVar->name.c_str() );
-
-                        MonoClass* pVec3Class = mono_class_from_name( pMonoImage, "MyEngine", "vec3" );
-                        MonoClassField* pFieldX = mono_class_get_field_from_name( pVec3Class, "x" );
-                        MonoClassField* pFieldY = mono_class_get_field_from_name( pVec3Class, "y" );
-                        MonoClassField* pFieldZ = mono_class_get_field_from_name( pVec3Class, "z" );
-
-                        MonoObject* pVec3Instance = mono_field_get_value_object( pMonoDomain, pField, m_pMonoObjectInstance );
-                        Vector3 value = pVar->value.valueVec3;
-                        mono_field_set_value( pVec3Instance, pFieldX, &value.x );
-                        mono_field_set_value( pVec3Instance, pFieldY, &value.y );
-                        mono_field_set_value( pVec3Instance, pFieldZ, &value.z );
-                    }
-                    break;
+            switch( pVar->value.type )
+            {
+            case ExposedVariableType::Float:
+                *(float*)pFieldData = (float)pVar->value.valueDouble;
+                break;
 
-                case ExposedVariableType::GameObject:
-                    {
-                        MonoClassField* pField = mono_class_get_field_from_name( pClass, pVar->name.c_str() );
-                        GameObject* pGameObject = (GameObject*)pVar->value.valuePointer;
-                        MonoObject* pMonoGO = Mono_ConstructGameObject( pGameObject );
-                        mono_field_set_value( m_pMonoObjectInstance, pField, pMonoGO );
-                    }
-                    break;
-                
-                case ExposedVariableType::Unused:
-                    MyAssert( false );
-                    break;
+            case ExposedVariableType::Bool:
+                *(MonoBoolean*)pFieldData = pVar->value.valueBool ? 1 : 0;
+                break;
+
+            case ExposedVariableType::Vector3:
+                // vec3 is a struct, so it's stored inline in the script object.
+                *(Vector3*)pFieldData = pVar->value.valueVec3;
+                break;
+
+            case ExposedVariableType::GameObject:
+                {
+                    // References to managed objects need to go through the GC write barrier.
+                    GameObject* pGameObject = (GameObject*)pVar->value.valuePointer;
+                    MonoObject* pMonoGO = Mono_ConstructGameObject( pGameObject );
+                    mono_gc_wbarrier_set_field( m_pMonoObjectInstance, pFieldData, pMonoGO );
                 }
+                break;
+                
+            case ExposedVariableType::Unused:
+                MyAssert( false );
+                break;
             }
         }
     }
@@ -51,6 +51,7 @@ protected:
     MyFileObject* m_pScriptFile;
     char m_MonoClassName[255];
     MonoObject* m_pMonoObjectInstance;
+    unsigned int m_MonoInstanceImageGeneration; // Image generation the instance and the exposed var field offsets belong to.
 
     // Mono function ptrs.
     OnLoadFunc* m_pMonoFuncPtr_OnLoad;
@@ -12,10 +12,14 @@
 #include "ComponentObjectPool.h"
 #include "ComponentSystem/Core/ComponentSystemManager.h"
 #include "ComponentSystem/Core/GameObject.h"
+#include "ComponentSystem/BaseComponents/ComponentTransform.h"
+#include "Core/EngineCore.h"
 
 // Component Variable List
 MYFW_COMPONENT_IMPLEMENT_VARIABLE_LIST( ComponentObjectPool ); //_VARIABLE_LIST
 
+ComponentObjectPool::Stats ComponentObjectPool::m_Stats;
+
 ComponentObjectPool::ComponentObjectPool(EngineCore* pEngineCore, ComponentSystemManager* pComponentSystemManager)
 : ComponentBase( pEngineCore, pComponentSystemManager )
 {
@@ -33,6 +37,9 @@ ComponentObjectPool::ComponentObjectPool(EngineCore* pEngineCore, ComponentSyste
 ComponentObjectPool::~ComponentObjectPool()
 {
     MYFW_COMPONENT_VARIABLE_LIST_DESTRUCTOR(); //_VARIABLE_LIST
+
+    // Pooled objects can point at our name buffer, so delete any that are left.
+    DeleteAllPooledObjects();
 }
 
 void ComponentObjectPool::RegisterVariables(TCPPListHead<ComponentVariable*>* pList, ComponentObjectPool* pThis) //_VARIABLE_LIST
@@ -196,52 +203,264 @@ void ComponentObjectPool::OnPlay()
 {
     ComponentBase::OnPlay();
 
-    if( m_pGameObjectInPool )
+    if( m_pGameObjectInPool == nullptr )
+        return;
+
+    double startTime = MyTime_GetSystemTime();
+
+    m_BlueprintObjects.clear();
+    m_BlueprintComponents.clear();
+    BuildBlueprint( m_pGameObjectInPool, -1 );
+
+    // Allocate everything the pool needs up front, getting and returning objects won't allocate.
+    m_Slots.resize( m_PoolSize );
+    m_FreeSlots.resize( m_PoolSize );
+    m_Names.resize( (m_PoolSize + 1) * MAX_POOLED_OBJECT_NAME_LENGTH );
+
+    // Objects share the source's name until they're first checked out.
+    char* sharedName = &m_Names[m_PoolSize * MAX_POOLED_OBJECT_NAME_LENGTH];
+    strncpy( sharedName, m_pGameObjectInPool->GetName(), MAX_POOLED_OBJECT_NAME_LENGTH-1 );
+    sharedName[MAX_POOLED_OBJECT_NAME_LENGTH-1] = '\0';
+
+    for( uint32 i=0; i<m_PoolSize; i++ )
     {
-        m_GameObjectPtrPool.AllocateObjects( m_PoolSize );
-        for( uint32 i=0; i<m_PoolSize; i++ )
-        {
-            GameObject* pObject = g_pComponentSystemManager->CopyGameObject( m_pGameObjectInPool, "PoolObject-TODO-ImproveName", true );
-            m_GameObjectPtrPool.AddInactiveObject( pObject );
+        GameObject* pObject = CloneFromBlueprint();
 
-            pObject->SetOriginatingPool( this );
-            pObject->SetManaged( false );
-        }
+        pObject->SetSharedName( sharedName );
+        pObject->SetOriginatingPool( this, i );
+        pObject->SetManaged( false );
+        pObject->RegisterOnDeleteCallback( this, StaticOnPooledObjectDeleted );
+
+        m_Slots[i].m_pGameObject = pObject;
+        m_Slots[i].m_FreeIndex = m_PoolSize - 1 - i;
+        m_Slots[i].m_InUse = false;
+        m_Slots[i].m_Named = false;
+
+        // Fill the stack in reverse, so objects are handed out in slot order.
+        m_FreeSlots[m_PoolSize - 1 - i] = i;
     }
+
+    m_Stats.m_ObjectsWarmedUp += m_PoolSize;
+    m_Stats.m_WarmupTime += (float)((MyTime_GetSystemTime() - startTime) * 1000);
 }
 
 void ComponentObjectPool::OnStop()
 {
     ComponentBase::OnStop();
 
-    m_GameObjectPtrPool.DeleteAllObjectsInPool();
-    m_GameObjectPtrPool.DeallocateObjectLists();
+    DeleteAllPooledObjects();
 }
 
-GameObject* ComponentObjectPool::GetObjectFromPool()
+void ComponentObjectPool::BuildBlueprint(GameObject* pSource, int parentIndex)
 {
-    GameObject* pObject = m_GameObjectPtrPool.MakeObjectActive();
+    BlueprintObject object;
+    object.m_pSource = pSource;
+    object.m_ParentIndex = parentIndex;
+    object.m_FirstComponent = (unsigned int)m_BlueprintComponents.size();
+    object.m_NumComponents = pSource->GetComponentCount();
 
-    if( pObject != 0 )
+    for( unsigned int i=0; i<object.m_NumComponents; i++ )
     {
-        pObject->SetManaged( true );
+        ComponentBase* pComponent = pSource->GetComponentByIndex( i );
+
+        BlueprintComponent component;
+        component.m_Type = pComponent->GetType();
+        component.m_pSource = pComponent;
+        component.m_IsJoint = pComponent->IsA( "2DJoint-" );
+
+        m_BlueprintComponents.push_back( component );
     }
-    else
+
+    int objectIndex = (int)m_BlueprintObjects.size();
+    m_BlueprintObjects.push_back( object );
+
+    for( GameObject* pChild = pSource->GetFirstChild(); pChild != nullptr; pChild = pChild->GetNext() )
     {
+        BuildBlueprint( pChild, objectIndex );
+    }
+}
+
+GameObject* ComponentObjectPool::CloneFromBlueprint()
+{
+    // Same result as ComponentSystemManager::CopyGameObject with disableNewObject set,
+    //     but types, joint ordering and the hierarchy come from the blueprint.
+    ComponentSystemManager* pComponentSystemManager = g_pComponentSystemManager;
+    bool inEditorMode = g_pEngineCore->IsInEditorMode();
+
+    m_ClonedObjects.resize( m_BlueprintObjects.size() );
+
+    for( unsigned int i=0; i<m_BlueprintObjects.size(); i++ )
+    {
+        const BlueprintObject& object = m_BlueprintObjects[i];
+        GameObject* pSource = object.m_pSource;
+
+        SceneID sceneID = inEditorMode ? pSource->GetSceneID() : SCENEID_Unmanaged;
+
+        GameObject* pObject = pComponentSystemManager->CreateGameObject( true, sceneID, pSource->IsFolder(),
+                                                                         pSource->GetTransform() ? true : false, pSource->GetPrefabRef() );
+
+        // The root object is named by the pool, children keep their names.
+        // Children are created under their cloned parent, parents are always cloned before their children.
+        if( object.m_ParentIndex != -1 )
+        {
+            pObject->SetName( pSource->GetName() );
+            pObject->SetParentGameObject( m_ClonedObjects[object.m_ParentIndex] );
+        }
+
+        pObject->SetEnabled( false, false );
+        pObject->SetPhysicsSceneID( pSource->GetPhysicsSceneID() );
+        pObject->SetFlags( pSource->GetFlags() );
+
+        // Copy the object inherited from if in editor mode, prefab inheritance was handled by CreateGameObject.
+        if( inEditorMode && pSource->GetPrefabRef() == nullptr )
+            pObject->SetGameObjectThisInheritsFrom( pSource->GetGameObjectThisInheritsFrom() );
+
+        for( unsigned int c=0; c<object.m_NumComponents; c++ )
+        {
+            const BlueprintComponent& component = m_BlueprintComponents[object.m_FirstComponent + c];
+
+            ComponentBase* pComponent = pObject->AddNewComponent( component.m_Type, pObject->GetSceneID(), pComponentSystemManager );
+            pComponent->OnGameObjectDisabled();
+            pComponent->CopyFromSameType_Dangerous( component.m_pSource );
+            pComponent->OnLoad();
+        }
+
+        // Call OnPlay for all components whether they are enabled or disabled, joints last.
+        if( inEditorMode == false )
+        {
+            for( unsigned int c=0; c<object.m_NumComponents; c++ )
+            {
+                if( m_BlueprintComponents[object.m_FirstComponent + c].m_IsJoint == false )
+                    pObject->GetComponentByIndex( c )->OnPlay();
+            }
+            for( unsigned int c=0; c<object.m_NumComponents; c++ )
+            {
+                if( m_BlueprintComponents[object.m_FirstComponent + c].m_IsJoint == true )
+                    pObject->GetComponentByIndex( c )->OnPlay();
+            }
+        }
+
+        if( object.m_ParentIndex == -1 && pSource->GetParentGameObject() != nullptr )
+            pObject->SetParentGameObject( pSource->GetParentGameObject() );
+
+        if( pSource->IsFolder() == false && pSource->GetTransform() != nullptr )
+        {
+            ComponentTransform* pSourceTransform = pSource->GetTransform();
+
+            // Copying a child's whole transform would parent it to the source's parent, only take the local values.
+            if( object.m_ParentIndex == -1 )
+                *pObject->GetTransform() = *pSourceTransform;
+            else
+                pObject->GetTransform()->SetLocalPositionRotationScale( pSourceTransform->GetLocalPosition(), pSourceTransform->GetLocalRotation(), pSourceTransform->GetLocalScale() );
+        }
+
+        m_ClonedObjects[i] = pObject;
+    }
+
+    return m_ClonedObjects[0];
+}
+
+void ComponentObjectPool::DeleteAllPooledObjects()
+{
+    for( unsigned int i=0; i<m_Slots.size(); i++ )
+    {
+        GameObject* pObject = m_Slots[i].m_pGameObject;
+        if( pObject == nullptr )
+            continue;
+
+        pObject->UnregisterOnDeleteCallback( this, StaticOnPooledObjectDeleted );
+        m_Slots[i].m_pGameObject = nullptr;
+        delete pObject;
+    }
+
+    m_Slots.clear();
+    m_FreeSlots.clear();
+    m_Names.clear();
+}
+
+void ComponentObjectPool::OnPooledObjectDeleted(GameObject* pGameObject)
+{
+    // A pooled object was deleted by something else (e.g. its parent was deleted), forget about it.
+    unsigned int slotIndex = pGameObject->GetPoolSlotIndex();
+    MyAssert( slotIndex < m_Slots.size() && m_Slots[slotIndex].m_pGameObject == pGameObject );
+
+    m_Slots[slotIndex].m_pGameObject = nullptr;
+
+    if( m_Slots[slotIndex].m_InUse == false )
+    {
+        // Swap the top of the free stack into this slot's place.
+        unsigned int freeIndex = m_Slots[slotIndex].m_FreeIndex;
+        MyAssert( freeIndex < m_FreeSlots.size() && m_FreeSlots[freeIndex] == slotIndex );
+
+        unsigned int lastSlotIndex = m_FreeSlots.back();
+        m_FreeSlots[freeIndex] = lastSlotIndex;
+        m_Slots[lastSlotIndex].m_FreeIndex = freeIndex;
+        m_FreeSlots.pop_back();
+    }
+}
+
+GameObject* ComponentObjectPool::GetObjectFromPool()
+{
+    double startTime = MyTime_GetSystemTime();
+
+    if( m_FreeSlots.size() == 0 )
+    {
+        m_Stats.m_EmptyCheckouts++;
+
         if( m_LogWarningsWhenEmpty )
         {
             LOGInfo( LOGTag, "(%s) Pool is empty!\n", m_pGameObject->GetName() );
         }
+
+        return nullptr;
+    }
+
+    unsigned int slotIndex = m_FreeSlots.back();
+    m_FreeSlots.pop_back();
+
+    Slot& slot = m_Slots[slotIndex];
+    MyAssert( slot.m_InUse == false );
+    slot.m_InUse = true;
+
+    GameObject* pObject = slot.m_pGameObject;
+
+    // Name the object the first time it's used, into the space reserved for it.
+    if( slot.m_Named == false )
+    {
+        char* name = &m_Names[slotIndex * MAX_POOLED_OBJECT_NAME_LENGTH];
+        sprintf_s( name, MAX_POOLED_OBJECT_NAME_LENGTH, "%s-%d", m_pGameObjectInPool ? m_pGameObjectInPool->GetName() : "PoolObject", slotIndex );
+        pObject->SetSharedName( name );
+        slot.m_Named = true;
     }
 
+    pObject->SetManaged( true );
+
+    m_Stats.m_Checkouts++;
+    m_Stats.m_CheckoutTime += (float)((MyTime_GetSystemTime() - startTime) * 1000);
+
     return pObject;
 }
 
 void ComponentObjectPool::ReturnObjectToPool(GameObject* pObject)
 {
-    m_GameObjectPtrPool.MakeObjectInactive( pObject );
+    double startTime = MyTime_GetSystemTime();
+
+    MyAssert( pObject->GetOriginatingPool() == this );
+
+    unsigned int slotIndex = pObject->GetPoolSlotIndex();
+    MyAssert( slotIndex < m_Slots.size() && m_Slots[slotIndex].m_pGameObject == pObject );
+    MyAssert( m_Slots[slotIndex].m_InUse );
+
+    m_Slots[slotIndex].m_InUse = false;
+    m_Slots[slotIndex].m_FreeIndex = (unsigned int)m_FreeSlots.size();
+    m_FreeSlots.push_back( slotIndex );
+
+    // Disabling unregisters the object's callbacks, which is O(1) on the intrusive callback lists.
     pObject->SetEnabled( false, true );
     pObject->SetManaged( false );
+
+    m_Stats.m_Returns++;
+    m_Stats.m_ReturnTime += (float)((MyTime_GetSystemTime() - startTime) * 1000);
 }
 
 //void ComponentObjectPool::TickCallback(float deltaTime)
@@ -19,8 +19,55 @@ private:
     MYFW_COMPONENT_DECLARE_VARIABLE_LIST( ComponentObjectPool );
 
 public:
-    MyActivePool<GameObject*> m_GameObjectPtrPool;
+    static const int MAX_POOLED_OBJECT_NAME_LENGTH = 64;
+
+    struct Stats
+    {
+        unsigned int m_ObjectsWarmedUp;
+        float m_WarmupTime; // In milliseconds.
+        unsigned int m_Checkouts;
+        unsigned int m_EmptyCheckouts;
+        float m_CheckoutTime; // In milliseconds.
+        unsigned int m_Returns;
+        float m_ReturnTime; // In milliseconds.
+    };
 
+protected:
+    // Flattened copy of m_pGameObjectInPool, built once in OnPlay and used to clone every object in the pool.
+    struct BlueprintObject
+    {
+        GameObject* m_pSource;
+        int m_ParentIndex; // -1 for the root object, parents always come before their children.
+        unsigned int m_FirstComponent; // Into m_BlueprintComponents.
+        unsigned int m_NumComponents;
+    };
+
+    struct BlueprintComponent
+    {
+        int m_Type;
+        ComponentBase* m_pSource;
+        bool m_IsJoint; // Joints get OnPlay after everything else, so physics bodies exist first.
+    };
+
+    struct Slot
+    {
+        GameObject* m_pGameObject;
+        unsigned int m_FreeIndex; // Position in m_FreeSlots while the slot isn't in use.
+        bool m_InUse;
+        bool m_Named;
+    };
+
+    static Stats m_Stats;
+
+    std::vector<Slot> m_Slots;
+    std::vector<unsigned int> m_FreeSlots; // Stack of indices into m_Slots.
+    std::vector<char> m_Names; // MAX_POOLED_OBJECT_NAME_LENGTH per slot, followed by the name shared by objects that were never checked out.
+
+    std::vector<BlueprintObject> m_BlueprintObjects;
+    std::vector<BlueprintComponent> m_BlueprintComponents;
+    std::vector<GameObject*> m_ClonedObjects; // Scratch list used while cloning.
+
+public:
     GameObject* m_pGameObjectInPool;
     uint32 m_PoolSize;
     bool m_LogWarningsWhenEmpty;
@@ -50,6 +97,17 @@ public:
     GameObject* GetObjectFromPool();
     void ReturnObjectToPool(GameObject* pObject);
 
+    unsigned int GetNumberOfObjectsInUse() { return (unsigned int)(m_Slots.size() - m_FreeSlots.size()); }
+    static Stats& GetStats() { return m_Stats; }
+
+protected:
+    void BuildBlueprint(GameObject* pSource, int parentIndex);
+    GameObject* CloneFromBlueprint();
+    void DeleteAllPooledObjects();
+
+    static void StaticOnPooledObjectDeleted(void* pObjectPtr, GameObject* pGameObject) { ((ComponentObjectPool*)pObjectPtr)->OnPooledObjectDeleted( pGameObject ); }
+    void OnPooledObjectDeleted(GameObject* pGameObject);
+
 protected:
     // Callback functions for various events.
     //MYFW_DECLARE_COMPONENT_CALLBACK_TICK(); // TickCallback
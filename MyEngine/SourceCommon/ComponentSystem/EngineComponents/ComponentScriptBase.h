@@ -75,6 +75,7 @@ public:
     bool divorced;
     bool inUse; // Used internally when reparsing the file.
     int controlID;
+    int fieldOffset; // Offset of the matching field in a Mono script object, -1 if unknown.
 
     ExposedVariableDesc()
     {
@@ -88,6 +89,7 @@ public:
         divorced = false;
         inUse = false;
         controlID = -1;
+        fieldOffset = -1;
     }
 };
 
@@ -9,12 +9,18 @@
 
 #include "MyEnginePCH.h"
 
+#include "../../../Framework/MyFramework/SourceCommon/Renderers/BaseClasses/Shader_Base.h"
+
 #include "ComponentCameraShadow.h"
 #include "ComponentSystem/BaseComponents/ComponentTransform.h"
 #include "ComponentSystem/Core/ComponentSystemManager.h"
+#include "ComponentSystem/Core/EngineFileManager.h"
 #include "ComponentSystem/Core/GameObject.h"
+#include "ComponentSystem/Core/LightRegistry.h"
 #include "Core/EngineCore.h"
 
+ComponentCameraShadow::ShadowCasterStats ComponentCameraShadow::m_ShadowCasterStats = { 0, 0, 0, 0 };
+
 ComponentCameraShadow::ComponentCameraShadow(EngineCore* pEngineCore, ComponentSystemManager* pComponentSystemManager)
 : ComponentCamera( pEngineCore, pComponentSystemManager )
 {
@@ -24,6 +30,22 @@ ComponentCameraShadow::ComponentCameraShadow(EngineCore* pEngineCore, ComponentS
 
     m_pComponentTransform = 0;
     m_pDepthFBO = 0;
+    m_pStaticDepthFBO = 0;
+
+    m_pDepthCopyShaderFile = 0;
+    m_pDepthCopyShader = 0;
+    m_pDepthCopyMaterial = 0;
+    m_pDepthCopyQuadMesh = 0;
+
+    m_NumCascades = 0;
+    m_CascadeSplitLambda = 0.75f;
+    m_CascadeMaxDistance = 100.0f;
+    m_CascadesActive = false;
+
+    m_StaticDepthValid = false;
+    m_StaticDepthNumViews = 0;
+    m_StaticDepthLayers = 0;
+    m_StaticDepthVersion = 0;
 
     m_pLight = 0;
 }
@@ -31,13 +53,21 @@ ComponentCameraShadow::ComponentCameraShadow(EngineCore* pEngineCore, ComponentS
 ComponentCameraShadow::~ComponentCameraShadow()
 {
     SAFE_RELEASE( m_pDepthFBO );
+    SAFE_RELEASE( m_pStaticDepthFBO );
+
+    if( m_pDepthCopyShaderFile )
+        m_pEngineCore->GetManagers()->GetFileManager()->FreeFile( m_pDepthCopyShaderFile );
+    SAFE_RELEASE( m_pDepthCopyShader );
+    SAFE_RELEASE( m_pDepthCopyMaterial );
+    SAFE_RELEASE( m_pDepthCopyQuadMesh );
 
-    m_pGameObject->GetTransform()->UnregisterTransformChangedCallbacks( this );
+    m_pGameObject->GetTransform()->UnregisterTransformChangedCallback( this, StaticOnTransformChanged );
 
     if( m_pLight )
     {
         LightManager* pLightManager = m_pEngineCore->GetManagers()->GetLightManager();
         pLightManager->DestroyLight( m_pLight );
+        m_pComponentSystemManager->m_pLightRegistry->OnLightChanged();
     }
 }
 
@@ -66,6 +96,10 @@ void ComponentCameraShadow::FillPropertiesWindow(bool clear, bool addcomponentva
             g_pPanelWatch->AddColorFloat( "Color", &m_pLight->m_Color, 0, 1 );
             g_pPanelWatch->AddVector3( "Attenuation", &m_pLight->m_Attenuation, 0, 1 );
         }
+
+        g_pPanelWatch->AddUnsignedInt( "Cascades", &m_NumCascades, 0, ShadowCascades::MAX_CASCADES );
+        g_pPanelWatch->AddFloat( "Cascade Split Lambda", &m_CascadeSplitLambda, 0, 1 );
+        g_pPanelWatch->AddFloat( "Cascade Distance", &m_CascadeMaxDistance, 0, 10000 );
     }
 }
 
@@ -91,6 +125,13 @@ cJSON* ComponentCameraShadow::ExportAsJSONObject(bool savesceneid, bool saveid)
     cJSONExt_AddFloatArrayToObject( jComponent, "Color", &m_pLight->m_Color.r, 4 );
     cJSONExt_AddFloatArrayToObject( jComponent, "Atten", &m_pLight->m_Attenuation.x, 3 );
 
+    if( m_NumCascades > 0 )
+    {
+        cJSON_AddNumberToObject( jComponent, "Cascades", m_NumCascades );
+        cJSON_AddNumberToObject( jComponent, "CascadeLambda", m_CascadeSplitLambda );
+        cJSON_AddNumberToObject( jComponent, "CascadeDist", m_CascadeMaxDistance );
+    }
+
     return jComponent;
 }
 
@@ -111,11 +152,19 @@ void ComponentCameraShadow::ImportFromJSONObject(cJSON* jsonobj, SceneID sceneid
     cJSONExt_GetFloatArray( jsonobj, "Color", &m_pLight->m_Color.r, 4 );
     cJSONExt_GetFloatArray( jsonobj, "Atten", &m_pLight->m_Attenuation.x, 3 );
 
+    cJSONExt_GetUnsignedInt( jsonobj, "Cascades", &m_NumCascades );
+    cJSONExt_GetFloat( jsonobj, "CascadeLambda", &m_CascadeSplitLambda );
+    cJSONExt_GetFloat( jsonobj, "CascadeDist", &m_CascadeMaxDistance );
+
+    if( m_NumCascades > ShadowCascades::MAX_CASCADES )
+        m_NumCascades = ShadowCascades::MAX_CASCADES;
+
     MyAssert( m_pLight );
 
     m_pLight->m_LightType = LightType_Directional;
     m_pLight->m_Position = m_pGameObject->GetTransform()->GetWorldPosition();
     m_pLight->m_SpotDirectionVector = m_pGameObject->GetTransform()->GetWorldTransform()->GetAt();
+    m_pComponentSystemManager->m_pLightRegistry->OnLightChanged();
 
     ComputeProjectionMatrices();
 }
@@ -125,6 +174,8 @@ void ComponentCameraShadow::Reset()
     ComponentCamera::Reset();
 
     SAFE_RELEASE( m_pDepthFBO );
+    SAFE_RELEASE( m_pStaticDepthFBO );
+    m_StaticDepthValid = false;
 
     TextureManager* pTextureManager = m_pEngineCore->GetManagers()->GetTextureManager();
 
@@ -133,10 +184,13 @@ void ComponentCameraShadow::Reset()
     m_pDepthFBO = pTextureManager->CreateFBO( texres, texres, MyRE::MinFilter_Linear, MyRE::MagFilter_Linear, FBODefinition::FBOColorFormat_RGBA_UByte, 0, false );
 #else
     m_pDepthFBO = pTextureManager->CreateFBO( texres, texres, MyRE::MinFilter_Linear, MyRE::MagFilter_Linear, FBODefinition::FBOColorFormat_RGBA_UByte, 32, true );
+    m_pStaticDepthFBO = pTextureManager->CreateFBO( texres, texres, MyRE::MinFilter_Nearest, MyRE::MagFilter_Nearest, FBODefinition::FBOColorFormat_RGBA_UByte, 32, true );
 #endif
 
 #if MYFW_EDITOR
     m_pDepthFBO->MemoryPanel_Hide();
+    if( m_pStaticDepthFBO )
+        m_pStaticDepthFBO->MemoryPanel_Hide();
 #endif
 
     if( m_pLight == 0 )
@@ -151,6 +205,8 @@ void ComponentCameraShadow::Reset()
     m_pLight->m_SpotDirectionVector.Set( 0, 0, 0 );
     m_pLight->m_Color.Set( 1, 1, 1, 1 );
     m_pLight->m_Attenuation.Set( 0, 0, 0.09f );
+
+    m_pComponentSystemManager->m_pLightRegistry->OnLightChanged();
 }
 
 ComponentCameraShadow& ComponentCameraShadow::operator=(const ComponentCameraShadow& other)
@@ -162,6 +218,10 @@ ComponentCameraShadow& ComponentCameraShadow::operator=(const ComponentCameraSha
     this->m_pLight->m_Color = other.m_pLight->m_Color;
     this->m_pLight->m_Attenuation = other.m_pLight->m_Attenuation;
 
+    this->m_NumCascades = other.m_NumCascades;
+    this->m_CascadeSplitLambda = other.m_CascadeSplitLambda;
+    this->m_CascadeMaxDistance = other.m_CascadeMaxDistance;
+
     return *this;
 }
 
@@ -218,6 +278,7 @@ void ComponentCameraShadow::OnGameObjectEnabled()
     {
         LightManager* pLightManager = m_pEngineCore->GetManagers()->GetLightManager();
         pLightManager->SetLightEnabled( m_pLight, true );
+        m_pComponentSystemManager->m_pLightRegistry->OnLightChanged();
     }
 }
 
@@ -229,6 +290,7 @@ void ComponentCameraShadow::OnGameObjectDisabled()
     {
         LightManager* pLightManager = m_pEngineCore->GetManagers()->GetLightManager();
         pLightManager->SetLightEnabled( m_pLight, false );
+        m_pComponentSystemManager->m_pLightRegistry->OnLightChanged();
     }
 }
 
@@ -238,6 +300,9 @@ void ComponentCameraShadow::OnTransformChanged(const Vector3& newPos, const Vect
 
     m_pLight->m_Position = m_pGameObject->GetTransform()->GetWorldPosition();
     m_pLight->m_SpotDirectionVector = m_pGameObject->GetTransform()->GetWorldTransform()->GetAt();
+
+    // Only matters before the light is made directional, but it's cheap.
+    m_pComponentSystemManager->m_pLightRegistry->OnLightChanged();
 }
 
 void ComponentCameraShadow::Tick(float deltaTime)
@@ -256,11 +321,87 @@ void ComponentCameraShadow::OnDrawFrame()
 {
     //glCullFace( GL_FRONT );
 
-    g_ActiveShaderPass = ShaderPass_ShadowCastRGBA;
+    MyMatrix* pMatProj;
+    MyMatrix* pMatView;
+    if( m_Orthographic )
+    {
+        pMatProj = &m_Camera2D.m_matProj;
+        pMatView = &m_Camera2D.m_matView;
+    }
+    else
+    {
+        pMatProj = &m_Camera3D.m_matProj;
+        pMatView = &m_Camera3D.m_matView;
+    }
 
-    m_pDepthFBO->Bind( false );
+    // Cascaded lights draw each cascade into its own tile of the depth FBO, otherwise there's a single view.
+    int numViews = 1;
+    m_CascadesActive = false;
+    if( m_NumCascades > 0 && UpdateCascades( pMatView ) )
+    {
+        m_CascadesActive = true;
+        numViews = m_Cascades.GetNumCascades();
+    }
+
+    ShadowCasterStats& stats = m_ShadowCasterStats;
+
+    g_ActiveShaderPass = ShaderPass_ShadowCastRGBA;
 
     MyViewport viewport( 0, 0, m_pDepthFBO->GetWidth(), m_pDepthFBO->GetHeight() );
+
+    bool drawStaticCasters = true;
+
+#if !MYFW_OPENGLES2
+    // Redraw the static casters into their own FBO only if the light or any static renderable changed.
+    if( CreateDepthCopyResources() )
+    {
+        unsigned int staticVersion = g_pComponentSystemManager->GetStaticRenderablesVersion();
+
+        bool staticDepthValid = m_StaticDepthValid &&
+                                m_StaticDepthVersion == staticVersion &&
+                                m_StaticDepthLayers == m_LayersToRender &&
+                                m_StaticDepthNumViews == numViews;
+
+        for( int view=0; view<numViews && staticDepthValid; view++ )
+        {
+            MyMatrix* pMatViewProj = m_CascadesActive ? &m_Cascades.GetCascade( view )->m_matViewProj : GetViewProjMatrix();
+            if( memcmp( &m_StaticDepthViewProj[view], pMatViewProj, sizeof(MyMatrix) ) != 0 )
+                staticDepthValid = false;
+        }
+
+        if( staticDepthValid == false )
+        {
+            m_pStaticDepthFBO->Bind( false );
+            g_pRenderer->EnableViewport( &viewport, true );
+
+            g_pRenderer->SetClearColor( ColorFloat( 1, 1, 1, 1 ) );
+            g_pRenderer->SetClearDepth( 1 );
+            g_pRenderer->ClearBuffers( true, true, false );
+
+            for( int view=0; view<numViews; view++ )
+            {
+                MyMatrix* pMatViewProj;
+                MyMatrix* pViewMatProj = EnableView( view, pMatProj, &pMatViewProj );
+
+                g_pComponentSystemManager->DrawShadowCasters( this, pViewMatProj, pMatView, true, false, &stats.m_StaticCastersDrawn, &stats.m_CastersCulled );
+
+                m_StaticDepthViewProj[view] = *pMatViewProj;
+            }
+
+            m_pStaticDepthFBO->Unbind( false );
+
+            m_StaticDepthValid = true;
+            m_StaticDepthNumViews = numViews;
+            m_StaticDepthLayers = m_LayersToRender;
+            m_StaticDepthVersion = staticVersion;
+            stats.m_StaticDepthRebuilds++;
+        }
+
+        drawStaticCasters = false;
+    }
+#endif //!MYFW_OPENGLES2
+
+    m_pDepthFBO->Bind( false );
     g_pRenderer->EnableViewport( &viewport, true );
 
 #if MYFW_OPENGLES2
@@ -270,15 +411,28 @@ void ComponentCameraShadow::OnDrawFrame()
     g_pRenderer->SetClearColor( ColorFloat( 1, 1, 1, 1 ) );
     g_pRenderer->SetClearDepth( 1 );
     g_pRenderer->ClearBuffers( true, true, false );
-#endif
 
-    if( m_Orthographic )
+    if( drawStaticCasters == false )
     {
-        g_pComponentSystemManager->DrawFrame( this, &m_Camera2D.m_matProj, &m_Camera2D.m_matView, 0, true, false, EmissiveDrawOption_EitherEmissiveOrNot, false );
+        // Copy the cached static depth, depth testing stays on since disabling it also disables depth writes.
+        g_ActiveShaderPass = ShaderPass_Main;
+        m_pDepthCopyMaterial->SetTextureColor( m_pStaticDepthFBO->GetDepthTexture() );
+        g_pRenderer->SetDepthFunction( MyRE::DepthFunc_Always );
+        m_pDepthCopyQuadMesh->Draw( 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 );
+        g_pRenderer->SetDepthFunction( MyRE::DepthFunc_LEqual );
+        g_ActiveShaderPass = ShaderPass_ShadowCastRGBA;
     }
-    else
+#endif
+
+    // Draw the dynamic casters on top, along with the static ones if they weren't cached.
+    // Each cascade culls casters against its own projection.
+    unsigned int* pNumDrawn = drawStaticCasters ? &stats.m_StaticCastersDrawn : &stats.m_DynamicCastersDrawn;
+    for( int view=0; view<numViews; view++ )
     {
-        g_pComponentSystemManager->DrawFrame( this, &m_Camera3D.m_matProj, &m_Camera3D.m_matView, 0, true, false, EmissiveDrawOption_EitherEmissiveOrNot, false );
+        MyMatrix* pMatViewProj;
+        MyMatrix* pViewMatProj = EnableView( view, pMatProj, &pMatViewProj );
+
+        g_pComponentSystemManager->DrawShadowCasters( this, pViewMatProj, pMatView, drawStaticCasters, true, pNumDrawn, &stats.m_CastersCulled );
     }
 
     m_pDepthFBO->Unbind( false );
@@ -286,9 +440,197 @@ void ComponentCameraShadow::OnDrawFrame()
     //glCullFace( GL_BACK );
 }
 
+bool ComponentCameraShadow::UpdateCascades(MyMatrix* pMatLightView)
+{
+    // Fit the cascades to the camera the scene is being viewed through.
+    ComponentCamera* pViewCamera = g_pComponentSystemManager->GetFirstCamera( true );
+    if( pViewCamera == nullptr || pViewCamera == this )
+        return false;
+
+    MyMatrix* pMatViewerProj;
+    MyMatrix* pMatViewerView;
+    float nearZ;
+    float farZ;
+    if( pViewCamera->m_Orthographic )
+    {
+        pMatViewerProj = &pViewCamera->m_Camera2D.m_matProj;
+        pMatViewerView = &pViewCamera->m_Camera2D.m_matView;
+        nearZ = pViewCamera->m_OrthoNearZ;
+        farZ = pViewCamera->m_OrthoFarZ;
+    }
+    else
+    {
+        pMatViewerProj = &pViewCamera->m_Camera3D.m_matProj;
+        pMatViewerView = &pViewCamera->m_Camera3D.m_matView;
+        nearZ = pViewCamera->m_PerspectiveNearZ;
+        farZ = pViewCamera->m_PerspectiveFarZ;
+    }
+
+    if( nearZ <= 0 || farZ <= nearZ )
+        return false;
+
+    // Casters between the light and each cascade are kept by pulling the near plane back by the light's ortho depth.
+    m_Cascades.Update( pMatViewerProj, pMatViewerView, nearZ, farZ, m_CascadeMaxDistance, pMatLightView,
+                       m_NumCascades, m_CascadeSplitLambda, m_OrthoFarZ, m_pDepthFBO->GetWidth() );
+
+    return true;
+}
+
+MyMatrix* ComponentCameraShadow::EnableView(int viewIndex, MyMatrix* pMatProj, MyMatrix** ppMatViewProj)
+{
+    // Sets the viewport for a cascade or the whole FBO and returns the projection to draw that view with.
+    if( m_CascadesActive )
+    {
+        ShadowCascades::Cascade* pCascade = m_Cascades.GetCascade( viewIndex );
+        int tileResolution = m_Cascades.GetTileResolution();
+
+        MyViewport viewport( pCascade->m_AtlasX, pCascade->m_AtlasY, tileResolution, tileResolution );
+        g_pRenderer->EnableViewport( &viewport, true );
+
+        *ppMatViewProj = &pCascade->m_matViewProj;
+        return &pCascade->m_matProj;
+    }
+
+    MyViewport viewport( 0, 0, m_pDepthFBO->GetWidth(), m_pDepthFBO->GetHeight() );
+    g_pRenderer->EnableViewport( &viewport, true );
+
+    *ppMatViewProj = GetViewProjMatrix();
+    return pMatProj;
+}
+
+bool ComponentCameraShadow::CreateDepthCopyResources()
+{
+    if( m_pStaticDepthFBO == 0 )
+        return false;
+
+    if( m_pDepthCopyShaderFile == 0 )
+    {
+        TextureManager* pTextureManager = m_pEngineCore->GetManagers()->GetTextureManager();
+        TextureDefinition* pErrorTexture = pTextureManager->GetErrorTexture();
+        MaterialManager* pMaterialManager = m_pEngineCore->GetManagers()->GetMaterialManager();
+        FileManager* pFileManager = m_pEngineCore->GetManagers()->GetFileManager();
+        EngineFileManager* pEngineFileManager = static_cast<EngineFileManager*>( pFileManager );
+
+        m_pDepthCopyShaderFile = pEngineFileManager->RequestFile_UntrackedByScene( "Data/DataEngine/Shaders/Shader_ShadowDepthCopy.glsl" );
+#if MYFW_EDITOR
+        m_pDepthCopyShaderFile->MemoryPanel_Hide();
+#endif
+        m_pDepthCopyShader = MyNew ShaderGroup( m_pEngineCore, m_pDepthCopyShaderFile, pErrorTexture );
+        m_pDepthCopyMaterial = MyNew MaterialDefinition( pMaterialManager, m_pDepthCopyShader );
+
+        m_pDepthCopyQuadMesh = MyNew MyMesh( m_pEngineCore );
+        m_pDepthCopyQuadMesh->CreateClipSpaceQuad( Vector2( 0, 0 ), Vector2( m_pStaticDepthFBO->GetWidth()/(float)m_pStaticDepthFBO->GetTextureWidth(), m_pStaticDepthFBO->GetHeight()/(float)m_pStaticDepthFBO->GetTextureHeight() ) );
+        m_pDepthCopyQuadMesh->SetMaterial( m_pDepthCopyMaterial, 0 );
+    }
+
+    // Until everything is ready, all casters get drawn directly into m_pDepthFBO.
+    if( m_pDepthCopyShaderFile->IsFinishedLoading() == false )
+        return false;
+
+    if( m_pStaticDepthFBO->IsFullyLoaded() == false || m_pDepthFBO->IsFullyLoaded() == false )
+        return false;
+
+    return true;
+}
+
+// Receivers that take a single matrix can't pick a cascade per pixel, so pick the tightest cascade that covers the whole box.
+// Returns nullptr if the box is outside the widest cascade, since it would only sample other cascades' tiles.
+MyMatrix* ComponentCameraShadow::GetReceiverViewProjMatrix(const Vector3& boundsMin, const Vector3& boundsMax)
+{
+    if( m_CascadesActive == false )
+        return GetViewProjMatrix();
+
+    int numCascades = m_Cascades.GetNumCascades();
+    for( int i=0; i<numCascades; i++ )
+    {
+        ShadowCascades::Cascade* pCascade = m_Cascades.GetCascade( i );
+
+        // Find the box's extents in the cascade's clip space, the projection is ortho so w is always 1.
+        Vector2 clipMin( FLT_MAX, FLT_MAX );
+        Vector2 clipMax( -FLT_MAX, -FLT_MAX );
+        for( int c=0; c<8; c++ )
+        {
+            Vector4 corner( (c & 1) ? boundsMax.x : boundsMin.x, (c & 2) ? boundsMax.y : boundsMin.y, (c & 4) ? boundsMax.z : boundsMin.z, 1 );
+            Vector4 clippos = pCascade->m_matViewProj * corner;
+
+            if( clippos.x < clipMin.x ) clipMin.x = clippos.x;
+            if( clippos.y < clipMin.y ) clipMin.y = clippos.y;
+            if( clippos.x > clipMax.x ) clipMax.x = clippos.x;
+            if( clippos.y > clipMax.y ) clipMax.y = clippos.y;
+        }
+
+        if( clipMin.x >= -1 && clipMin.y >= -1 && clipMax.x <= 1 && clipMax.y <= 1 )
+            return &pCascade->m_matAtlasViewProj;
+
+        // Boxes partly covered by the widest cascade still use it, boxes it doesn't touch aren't shadowed.
+        if( i == numCascades - 1 )
+        {
+            if( clipMax.x < -1 || clipMax.y < -1 || clipMin.x > 1 || clipMin.y > 1 )
+                return nullptr;
+
+            return &pCascade->m_matAtlasViewProj;
+        }
+    }
+
+    return nullptr;
+}
+
+// Programs the cascade data for shaders that pick a cascade per pixel, shaders without u_ShadowCascadeCount are skipped.
+// pShadowCamera can be null or not cascaded, which sets the count to 0.
+void ComponentCameraShadow::ProgramCascadeUniforms(Shader_Base* pShader, ComponentCameraShadow* pShadowCamera)
+{
+    GLint countLocation = glGetUniformLocation( pShader->m_ProgramHandle, "u_ShadowCascadeCount" );
+    if( countLocation == -1 )
+        return;
+
+    ShadowCascades* pCascades = pShadowCamera ? pShadowCamera->GetCascades() : nullptr;
+    if( pCascades == nullptr )
+    {
+        glUniform1f( countLocation, 0 );
+        return;
+    }
+
+    // Maps clip space to texture space, matching what u_ShadowLightWVPT is given.
+    MyMatrix matClipToTexture;
+    matClipToTexture.SetIdentity();
+    matClipToTexture.m11 = matClipToTexture.m22 = matClipToTexture.m33 = 0.5f;
+    matClipToTexture.m41 = matClipToTexture.m42 = matClipToTexture.m43 = 0.5f;
+
+    // Unused cascades repeat the last one and are never picked since the last cascade's split comes first.
+    // Pixels past the last split aren't shadowed.
+    int numCascades = pCascades->GetNumCascades();
+    MyMatrix matrices[ShadowCascades::MAX_CASCADES];
+    Vector4 tiles[ShadowCascades::MAX_CASCADES];
+    float splits[ShadowCascades::MAX_CASCADES];
+    for( int i=0; i<ShadowCascades::MAX_CASCADES; i++ )
+    {
+        ShadowCascades::Cascade* pCascade = pCascades->GetCascade( i < numCascades ? i : numCascades - 1 );
+        matrices[i] = matClipToTexture * pCascade->m_matAtlasViewProj;
+        tiles[i] = pCascade->m_AtlasUVBounds;
+        splits[i] = pCascade->m_SplitFar;
+    }
+
+    Vector3 viewPosition = pCascades->GetViewPosition();
+    Vector3 viewDirection = pCascades->GetViewDirection();
+
+    glUniform1f( countLocation, (float)numCascades );
+    glUniformMatrix4fv( glGetUniformLocation( pShader->m_ProgramHandle, "u_ShadowCascadeWVPT" ), ShadowCascades::MAX_CASCADES, GL_FALSE, &matrices[0].m11 );
+    glUniform4fv( glGetUniformLocation( pShader->m_ProgramHandle, "u_ShadowCascadeTiles" ), ShadowCascades::MAX_CASCADES, &tiles[0].x );
+    glUniform4f( glGetUniformLocation( pShader->m_ProgramHandle, "u_ShadowCascadeSplits" ), splits[0], splits[1], splits[2], splits[3] );
+    glUniform3f( glGetUniformLocation( pShader->m_ProgramHandle, "u_ShadowCascadeViewPos" ), viewPosition.x, viewPosition.y, viewPosition.z );
+    glUniform3f( glGetUniformLocation( pShader->m_ProgramHandle, "u_ShadowCascadeViewDir" ), viewDirection.x, viewDirection.y, viewDirection.z );
+}
+
+// With cascades there's no single matrix that covers every receiver, this returns the nearest cascade
+//     for draws that pick a cascade per pixel themselves, like the deferred light pass.
+// Forward draws pick one per object with GetReceiverViewProjMatrix.
 MyMatrix* ComponentCameraShadow::GetViewProjMatrix()
 {
-    if( m_Orthographic )
+    if( m_CascadesActive )
+    {
+        return &m_Cascades.GetCascade( 0 )->m_matAtlasViewProj;
+    }
+    else if( m_Orthographic )
     {
         return &m_Camera2D.m_matViewProj;
     }
@@ -13,6 +13,7 @@
 #include "Camera/Camera2D.h"
 #include "Camera/Camera3D.h"
 #include "ComponentSystem/BaseComponents/ComponentCamera.h"
+#include "ComponentSystem/Core/ShadowCascades.h"
 
 class ComponentTransform;
 
@@ -20,12 +21,49 @@ class ComponentCameraShadow : public ComponentCamera
 {
 protected:
     FBODefinition* m_pDepthFBO;
+    FBODefinition* m_pStaticDepthFBO; // Static casters only, copied into m_pDepthFBO before dynamic casters are drawn.
+
+    // Resources to copy the static caster depth, not used on GLES2 since it can't write to the depth buffer.
+    MyFileObject* m_pDepthCopyShaderFile;
+    ShaderGroup* m_pDepthCopyShader;
+    MaterialDefinition* m_pDepthCopyMaterial;
+    MyMesh* m_pDepthCopyQuadMesh;
+
+    // Cascaded shadows, used for directional lights if m_NumCascades is more than 0.
+    // The view camera's frustum is split into cascades, each drawn into one tile of m_pDepthFBO.
+    unsigned int m_NumCascades;
+    float m_CascadeSplitLambda; // 0 for uniform splits, 1 for logarithmic.
+    float m_CascadeMaxDistance; // No shadows past this view depth.
+    ShadowCascades m_Cascades;
+    bool m_CascadesActive; // False if there was no view camera to fit the cascades to.
+
+    // Static caster depth is reused until the light, the layers or any static renderable changes.
+    bool m_StaticDepthValid;
+    int m_StaticDepthNumViews;
+    MyMatrix m_StaticDepthViewProj[ShadowCascades::MAX_CASCADES];
+    unsigned int m_StaticDepthLayers;
+    unsigned int m_StaticDepthVersion;
 
     MyLight* m_pLight;
 
+public:
+    // Caster counts for all shadow cameras, reset by the Timing window.
+    struct ShadowCasterStats
+    {
+        unsigned int m_StaticCastersDrawn;
+        unsigned int m_DynamicCastersDrawn;
+        unsigned int m_CastersCulled; // Render graph nodes culled, each can hold many casters.
+        unsigned int m_StaticDepthRebuilds;
+    };
+    static ShadowCasterStats m_ShadowCasterStats;
+
 public:
     FBODefinition* GetFBO() { return m_pDepthFBO; }
     MyMatrix* GetViewProjMatrix();
+    MyMatrix* GetReceiverViewProjMatrix(const Vector3& boundsMin, const Vector3& boundsMax);
+    static MyMatrix* StaticGetReceiverViewProjMatrix(void* pObjectPtr, const Vector3& boundsMin, const Vector3& boundsMax) { return ((ComponentCameraShadow*)pObjectPtr)->GetReceiverViewProjMatrix( boundsMin, boundsMax ); }
+    ShadowCascades* GetCascades() { return m_CascadesActive ? &m_Cascades : nullptr; }
+    static void ProgramCascadeUniforms(Shader_Base* pShader, ComponentCameraShadow* pShadowCamera);
 
 public:
     ComponentCameraShadow(EngineCore* pEngineCore, ComponentSystemManager* pComponentSystemManager);
@@ -52,6 +90,11 @@ public:
     virtual void OnSurfaceChanged(uint32 x, uint32 y, uint32 width, uint32 height, unsigned int desiredaspectwidth, unsigned int desiredaspectheight);
     virtual void OnDrawFrame();
 
+protected:
+    bool CreateDepthCopyResources();
+    bool UpdateCascades(MyMatrix* pMatLightView);
+    MyMatrix* EnableView(int viewIndex, MyMatrix* pMatProj, MyMatrix** ppMatViewProj);
+
 public:
 #if MYFW_EDITOR
 #if MYFW_USING_WX
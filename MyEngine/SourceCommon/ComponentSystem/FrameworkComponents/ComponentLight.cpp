@@ -12,7 +12,9 @@
 #include "ComponentLight.h"
 #include "ComponentSystem/BaseComponents/ComponentCamera.h"
 #include "ComponentSystem/BaseComponents/ComponentTransform.h"
+#include "ComponentSystem/Core/ComponentSystemManager.h"
 #include "ComponentSystem/Core/GameObject.h"
+#include "ComponentSystem/Core/LightRegistry.h"
 #include "Core/EngineCore.h"
 
 #if MYFW_EDITOR
@@ -45,12 +47,13 @@ ComponentLight::~ComponentLight()
 {
     MYFW_COMPONENT_VARIABLE_LIST_DESTRUCTOR();
 
-    m_pGameObject->GetTransform()->UnregisterTransformChangedCallbacks( this );
+    m_pGameObject->GetTransform()->UnregisterTransformChangedCallback( this, StaticOnTransformChanged );
 
     if( m_pLight )
     {
         LightManager* pLightManager = m_pEngineCore->GetManagers()->GetLightManager();
         pLightManager->DestroyLight( m_pLight );
+        m_pComponentSystemManager->m_pLightRegistry->OnLightChanged();
     }
 }
 
@@ -86,6 +89,8 @@ void ComponentLight::Reset()
     m_pLight->m_SpotDirectionVector.Set( 0, 0, 0 );
     m_pLight->m_Color.Set( 1, 1, 1, 1 );
     m_pLight->m_Attenuation.Set( 0, 0, 0.09f );
+
+    m_pComponentSystemManager->m_pLightRegistry->OnLightChanged();
 }
 
 #if MYFW_EDITOR
@@ -105,6 +110,7 @@ void ComponentLight::AddAllVariablesToWatchPanel(CommandStack* pCommandStack)
         //ImGui::DragFloat3( "Attenuation", &m_pLight->m_Attenuation.x, 0.01f, 0, 20 );
         if( ImGui::DragFloat( "Range", &m_pLight->m_Attenuation.x, 0.1f, 0, 30 ) )
         {
+            m_pComponentSystemManager->m_pLightRegistry->OnLightChanged();
             m_LightSphereRenderTimeRemaining = 3.0f;
         }
     }
@@ -134,6 +140,7 @@ void* ComponentLight::OnValueChanged(ComponentVariable* pVar, bool changedByInte
         MyAssert( m_pLight != nullptr );
 
         m_pLight->m_LightType = m_LightType;
+        m_pComponentSystemManager->m_pLightRegistry->OnLightChanged();
     }
 
     m_LightSphereRenderTimeRemaining = 3.0f;
@@ -164,6 +171,8 @@ void ComponentLight::ImportFromJSONObject(cJSON* jComponent, SceneID sceneID)
     m_pLight->m_LightType = m_LightType;
     m_pLight->m_Position = m_pGameObject->GetTransform()->GetWorldPosition();
     m_pLight->m_SpotDirectionVector = m_pGameObject->GetTransform()->GetWorldTransform()->GetAt();
+
+    m_pComponentSystemManager->m_pLightRegistry->OnLightChanged();
 }
 
 void ComponentLight::OnTransformChanged(const Vector3& newPos, const Vector3& newRot, const Vector3& newScale, bool changedByUserInEditor)
@@ -172,6 +181,8 @@ void ComponentLight::OnTransformChanged(const Vector3& newPos, const Vector3& ne
 
     m_pLight->m_Position = m_pGameObject->GetTransform()->GetWorldPosition();
     m_pLight->m_SpotDirectionVector = m_pGameObject->GetTransform()->GetWorldTransform()->GetAt();
+
+    m_pComponentSystemManager->m_pLightRegistry->OnLightChanged();
 }
 
 ComponentLight& ComponentLight::operator=(const ComponentLight& other)
@@ -185,6 +196,8 @@ ComponentLight& ComponentLight::operator=(const ComponentLight& other)
     this->m_pLight->m_Color = other.m_pLight->m_Color;
     this->m_pLight->m_Attenuation = other.m_pLight->m_Attenuation;
 
+    m_pComponentSystemManager->m_pLightRegistry->OnLightChanged();
+
     return *this;
 }
 
@@ -267,6 +280,8 @@ bool ComponentLight::SetEnabled(bool enableComponent)
         pLightManager->SetLightEnabled( m_pLight, false );
     }
 
+    m_pComponentSystemManager->m_pLightRegistry->OnLightChanged();
+
     return true;
 }
 
@@ -13,6 +13,7 @@
 #include "ComponentMesh.h"
 #include "ComponentSystem/BaseComponents/ComponentTransform.h"
 #include "ComponentSystem/Core/GameObject.h"
+#include "ComponentSystem/Core/LightRegistry.h"
 #include "ComponentSystem/EngineComponents/ComponentLuaScript.h"
 #include "Core/EngineCore.h"
 #include "../../../Framework/MyFramework/SourceCommon/RenderGraphs/RenderGraph_Base.h"
@@ -62,6 +63,10 @@ ComponentMesh::ComponentMesh(EngineCore* pEngineCore, ComponentSystemManager* pC
 
     m_pComponentLuaScript = nullptr;
 
+    m_NumCachedLights = 0;
+    m_CachedLightsGeneration = 0;
+    m_CachedLightsDirty = true;
+
     if( m_pComponentSystemManager )
     {
         EventManager* pEventManager = m_pEngineCore->GetManagers()->GetEventManager();
@@ -81,7 +86,7 @@ ComponentMesh::~ComponentMesh()
 
     if( m_pGameObject )
     {
-        m_pGameObject->GetTransform()->UnregisterTransformChangedCallbacks( this );
+        m_pGameObject->GetTransform()->UnregisterTransformChangedCallback( this, StaticOnTransformChanged );
     }
 
     SAFE_RELEASE( m_pMesh );
@@ -422,7 +427,7 @@ void ComponentMesh::OnPlay()
     m_pMesh->RegisterSetupCustomUniformsCallback( nullptr, nullptr );
 
 #if MYFW_USING_LUA
-    m_pComponentLuaScript = (ComponentLuaScript*)m_pGameObject->GetFirstComponentOfType( "LuaScriptComponent" );
+    m_pComponentLuaScript = (ComponentLuaScript*)m_pGameObject->GetFirstComponentOfTypeID( ComponentTypeID_LuaScript );
 
     if( m_pComponentLuaScript )
     {
@@ -477,6 +482,9 @@ bool ComponentMesh::OnEvent(MyEvent* pEvent)
 
 void ComponentMesh::OnTransformChanged(const Vector3& newPos, const Vector3& newRot, const Vector3& newScale, bool changedByUserInEditor)
 {
+    m_CachedLightsDirty = true;
+    OnStaticRenderableChanged();
+
     if( m_pMesh )
     {
         for( unsigned int i=0; i<m_pMesh->GetSubmeshListCount(); i++ )
@@ -505,6 +513,8 @@ void ComponentMesh::SetMaterial(MaterialDefinition* pMaterial, int submeshIndex)
         // Update the material on the RenderGraphObject along with the opaque/transparent flags.
         m_pRenderGraphObjects[submeshIndex]->SetMaterial( pMaterial, true );
     }
+
+    OnStaticRenderableChanged();
 }
 
 void ComponentMesh::SetVisible(bool visible)
@@ -518,6 +528,8 @@ void ComponentMesh::SetVisible(bool visible)
             m_pRenderGraphObjects[i]->m_Visible = visible;
         }
     }
+
+    OnStaticRenderableChanged();
 }
 
 //bool ComponentMesh::IsVisible()
@@ -539,6 +551,8 @@ void ComponentMesh::SetMesh(MyMesh* pMesh)
     SAFE_RELEASE( m_pMesh );
     m_pMesh = pMesh;
 
+    m_CachedLightsDirty = true;
+
     if( m_pMesh )
         AddToRenderGraph();
 }
@@ -578,6 +592,7 @@ void ComponentMesh::AddToRenderGraph()
         }
 
         m_WaitingToAddToRenderGraph = false;
+        OnStaticRenderableChanged();
 
         MYFW_UNREGISTER_COMPONENT_CALLBACK( Tick );
     }
@@ -610,6 +625,8 @@ void ComponentMesh::RemoveFromRenderGraph()
             m_pRenderGraphObjects[i] = nullptr;
         }
     }
+
+    OnStaticRenderableChanged();
 }
 
 void ComponentMesh::PushChangesToRenderGraphObjects()
@@ -630,6 +647,10 @@ void ComponentMesh::PushChangesToRenderGraphObjects()
             m_pRenderGraphObjects[i]->m_PointSize = this->m_PointSize;
         }
     }
+
+    // The static flag itself might have changed, so invalidate cached shadow maps either way.
+    if( m_pComponentSystemManager )
+        m_pComponentSystemManager->OnStaticRenderableChanged();
 }
 
 MyAABounds* ComponentMesh::GetBounds()
@@ -688,6 +709,23 @@ void ComponentMesh::TickCallback(float deltaTime)
     }
 }
 
+// Finds the world space AABB of the 8 local bounding box corners.
+static void GetWorldBounds(const MyMatrix& worldTransform, const Vector4* localCorners, Vector3* pBoundsMin, Vector3* pBoundsMax)
+{
+    pBoundsMin->Set( FLT_MAX, FLT_MAX, FLT_MAX );
+    pBoundsMax->Set( -FLT_MAX, -FLT_MAX, -FLT_MAX );
+    for( int i=0; i<8; i++ )
+    {
+        Vector4 worldPos = worldTransform * localCorners[i];
+        if( worldPos.x < pBoundsMin->x ) pBoundsMin->x = worldPos.x;
+        if( worldPos.y < pBoundsMin->y ) pBoundsMin->y = worldPos.y;
+        if( worldPos.z < pBoundsMin->z ) pBoundsMin->z = worldPos.z;
+        if( worldPos.x > pBoundsMax->x ) pBoundsMax->x = worldPos.x;
+        if( worldPos.y > pBoundsMax->y ) pBoundsMax->y = worldPos.y;
+        if( worldPos.z > pBoundsMax->z ) pBoundsMax->z = worldPos.z;
+    }
+}
+
 void ComponentMesh::DrawCallback(ComponentCamera* pCamera, MyMatrix* pMatProj, MyMatrix* pMatView, ShaderGroup* pShaderOverride)
 {
     ComponentRenderable::Draw( pMatProj, pMatView, pShaderOverride, 0 );
@@ -703,25 +741,29 @@ void ComponentMesh::DrawCallback(ComponentCamera* pCamera, MyMatrix* pMatProj, M
         else
             worldTransform.SetIdentity();
 
+        MyAABounds* bounds = m_pMesh->GetBounds();
+        Vector3 center = bounds->GetCenter();
+        Vector3 half = bounds->GetHalfSize();
+
+        Vector4 localCorners[8]; // Also used to find the world space bounds for light queries below.
+        localCorners[0] = Vector4(center.x - half.x, center.y - half.y, center.z - half.z, 1);
+        localCorners[1] = Vector4(center.x - half.x, center.y - half.y, center.z + half.z, 1);
+        localCorners[2] = Vector4(center.x - half.x, center.y + half.y, center.z - half.z, 1);
+        localCorners[3] = Vector4(center.x - half.x, center.y + half.y, center.z + half.z, 1);
+        localCorners[4] = Vector4(center.x + half.x, center.y - half.y, center.z - half.z, 1);
+        localCorners[5] = Vector4(center.x + half.x, center.y - half.y, center.z + half.z, 1);
+        localCorners[6] = Vector4(center.x + half.x, center.y + half.y, center.z - half.z, 1);
+        localCorners[7] = Vector4(center.x + half.x, center.y + half.y, center.z + half.z, 1);
+
         // Simple frustum check.
         {
-            MyAABounds* bounds = m_pMesh->GetBounds();
-            Vector3 center = bounds->GetCenter();
-            Vector3 half = bounds->GetHalfSize();
-
             MyMatrix wvp = matViewProj * worldTransform;
 
             Vector4 clippos[8];
 
             // Transform AABB extents into clip space.
-            clippos[0] = wvp * Vector4(center.x - half.x, center.y - half.y, center.z - half.z, 1);
-            clippos[1] = wvp * Vector4(center.x - half.x, center.y - half.y, center.z + half.z, 1);
-            clippos[2] = wvp * Vector4(center.x - half.x, center.y + half.y, center.z - half.z, 1);
-            clippos[3] = wvp * Vector4(center.x - half.x, center.y + half.y, center.z + half.z, 1);
-            clippos[4] = wvp * Vector4(center.x + half.x, center.y - half.y, center.z - half.z, 1);
-            clippos[5] = wvp * Vector4(center.x + half.x, center.y - half.y, center.z + half.z, 1);
-            clippos[6] = wvp * Vector4(center.x + half.x, center.y + half.y, center.z - half.z, 1);
-            clippos[7] = wvp * Vector4(center.x + half.x, center.y + half.y, center.z + half.z, 1);
+            for( int i=0; i<8; i++ )
+                clippos[i] = wvp * localCorners[i];
 
             // Check visibility two planes at a time.
             bool visible = false;
@@ -768,10 +810,35 @@ void ComponentMesh::DrawCallback(ComponentCamera* pCamera, MyMatrix* pMatProj, M
 
         //m_pMesh->SetTransform( worldtransform );
 
-        // Find nearest lights.
-        LightManager* pLightManager = m_pEngineCore->GetManagers()->GetLightManager();
-        MyLight* lights[4];
-        int numlights = pLightManager->FindNearestLights( LightType_Point, 4, worldTransform.GetTranslation(), lights );
+        // World space AABB of the mesh, only found if the light cache or the shadow camera below need it.
+        Vector3 worldBoundsMin;
+        Vector3 worldBoundsMax;
+        bool worldBoundsFound = false;
+
+        // Find nearest lights, the LightRegistry is updated once per DrawFrame so reuse the last results if nothing moved.
+        LightRegistry* pLightRegistry = m_pComponentSystemManager->m_pLightRegistry;
+        bool boundsChanged = m_CachedLightsDirty ||
+            m_CachedLightsBoundsCenter.x != center.x || m_CachedLightsBoundsCenter.y != center.y || m_CachedLightsBoundsCenter.z != center.z ||
+            m_CachedLightsBoundsHalfSize.x != half.x || m_CachedLightsBoundsHalfSize.y != half.y || m_CachedLightsBoundsHalfSize.z != half.z;
+        if( boundsChanged || m_CachedLightsGeneration != pLightRegistry->GetGeneration() )
+        {
+            GetWorldBounds( worldTransform, localCorners, &worldBoundsMin, &worldBoundsMax );
+            worldBoundsFound = true;
+
+            // Lights moving elsewhere in the scene don't change which lights reach this mesh.
+            if( boundsChanged || pLightRegistry->HaveLightsChangedInBounds( m_CachedLightsGeneration, worldBoundsMin, worldBoundsMax ) )
+            {
+                m_NumCachedLights = pLightRegistry->FindNearestLights( LightType_Point, MAX_LIGHTS, worldBoundsMin, worldBoundsMax, m_pCachedLights );
+            }
+
+            m_CachedLightsGeneration = pLightRegistry->GetGeneration();
+            m_CachedLightsDirty = false;
+            m_CachedLightsBoundsCenter = center;
+            m_CachedLightsBoundsHalfSize = half;
+        }
+
+        MyLight** lights = m_pCachedLights;
+        int numlights = m_NumCachedLights;
 
         // Find nearest shadow casting light.
         MyMatrix* pShadowVP = nullptr;
@@ -782,15 +849,25 @@ void ComponentMesh::DrawCallback(ComponentCamera* pCamera, MyMatrix* pMatProj, M
             if( pObject )
             {
                 ComponentBase* pComponent = pObject->GetFirstComponentOfBaseType( BaseComponentType_Camera );
-                ComponentCameraShadow* pShadowCam = pComponent->IsA( "CameraShadowComponent" ) ? (ComponentCameraShadow*)pComponent : nullptr;
+                ComponentCameraShadow* pShadowCam = pComponent->IsType( ComponentTypeID_CameraShadow ) ? (ComponentCameraShadow*)pComponent : nullptr;
                 if( pShadowCam )
                 {
-                    pShadowVP = pShadowCam->GetViewProjMatrix();
+                    // Cascaded lights pick the cascade that covers the mesh's bounds.
+                    if( worldBoundsFound == false )
+                    {
+                        GetWorldBounds( worldTransform, localCorners, &worldBoundsMin, &worldBoundsMax );
+                        worldBoundsFound = true;
+                    }
+
+                    pShadowVP = pShadowCam->GetReceiverViewProjMatrix( worldBoundsMin, worldBoundsMax );
+                    if( pShadowVP )
+                    {
 #if 1
-                    pShadowTex = pShadowCam->GetFBO()->GetDepthTexture();
+                        pShadowTex = pShadowCam->GetFBO()->GetDepthTexture();
 #else
-                    pShadowTex = pShadowCam->GetFBO()->GetColorTexture( 0 );
+                        pShadowTex = pShadowCam->GetFBO()->GetColorTexture( 0 );
 #endif
+                    }
                 }
             }
         }
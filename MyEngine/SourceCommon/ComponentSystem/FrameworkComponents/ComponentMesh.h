@@ -40,6 +40,15 @@ protected:
     // Vars to allow script object callbacks.
     ComponentLuaScript* m_pComponentLuaScript;
 
+    // Nearest lights from the LightRegistry, kept until this mesh moves or the registry is rebuilt.
+    static const int MAX_LIGHTS = 4;
+    MyLight* m_pCachedLights[MAX_LIGHTS];
+    int m_NumCachedLights;
+    unsigned int m_CachedLightsGeneration;
+    bool m_CachedLightsDirty;
+    Vector3 m_CachedLightsBoundsCenter; // Local bounds the cache was built with, meshes can finish loading after the first draw.
+    Vector3 m_CachedLightsBoundsHalfSize;
+
 public:
     ComponentMesh(EngineCore* pEngineCore, ComponentSystemManager* pComponentSystemManager);
     virtual ~ComponentMesh();
@@ -311,6 +311,31 @@ ComponentMeshPrimitive& ComponentMeshPrimitive::operator=(ComponentMeshPrimitive
     return *this;
 }
 
+void ComponentMeshPrimitive::CopyFromPrototype_Dangerous(ComponentBase* pObject)
+{
+    ComponentMeshPrimitive& other = (ComponentMeshPrimitive&)*pObject;
+    MyAssert( &other != this );
+
+    ComponentMesh::operator=( other );
+
+    // Unlike operator=, keep the prototype's type and build a mesh of our own.
+    // References to other mesh primitives are resolved by FinishImportingFromJSONObject.
+    SetMesh( nullptr );
+
+    this->m_MeshPrimitiveType = other.m_MeshPrimitiveType;
+    this->m_pOtherMeshPrimitive = nullptr;
+
+    this->m_Plane_Size = other.m_Plane_Size;
+    this->m_Plane_VertCount = other.m_Plane_VertCount;
+    this->m_Plane_UVsPerQuad = other.m_Plane_UVsPerQuad;
+    this->m_Plane_UVStart = other.m_Plane_UVStart;
+    this->m_Plane_UVRange = other.m_Plane_UVRange;
+
+    this->m_Sphere_Radius = other.m_Sphere_Radius;
+
+    CreatePrimitive();
+}
+
 void ComponentMeshPrimitive::RegisterCallbacks()
 {
     MyAssert( m_EnabledState == EnabledState_Enabled );
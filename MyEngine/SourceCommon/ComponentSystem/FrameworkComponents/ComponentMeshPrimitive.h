@@ -65,6 +65,7 @@ public:
 
     virtual void Reset() override;
     virtual void CopyFromSameType_Dangerous(ComponentBase* pObject) override { *this = (ComponentMeshPrimitive&)*pObject; }
+    virtual void CopyFromPrototype_Dangerous(ComponentBase* pObject) override;
     virtual ComponentMeshPrimitive& operator=(ComponentMeshPrimitive& other);
 
     virtual void RegisterCallbacks() override;
@@ -12,6 +12,7 @@
 #include "ComponentParticleEmitter.h"
 #include "ComponentSystem/BaseComponents/ComponentCamera.h"
 #include "ComponentSystem/BaseComponents/ComponentTransform.h"
+#include "ComponentSystem/Core/ParticleSystemManager.h"
 #include "Core/EngineCore.h"
 #include "../../../Framework/MyFramework/SourceCommon/RenderGraphs/RenderGraph_Base.h"
 
@@ -19,6 +20,140 @@
 bool ComponentParticleEmitter::m_PanelWatchBlockVisible = true;
 #endif
 
+//====================================================================================================
+// ParticleStore
+//====================================================================================================
+
+ParticleStore::ParticleStore()
+{
+    m_pBuffer = nullptr;
+    for( int i=0; i<Stream_NumStreams; i++ )
+        m_pStreams[i] = nullptr;
+
+    m_Capacity = 0;
+    m_Count = 0;
+}
+
+ParticleStore::~ParticleStore()
+{
+    SAFE_DELETE_ARRAY( m_pBuffer );
+}
+
+void ParticleStore::Allocate(unsigned int capacity)
+{
+    SAFE_DELETE_ARRAY( m_pBuffer );
+
+    // Round up to a multiple of 4 so each stream starts on a 16 byte boundary relative to the buffer.
+    m_Capacity = (capacity + 3) & ~3;
+    m_Count = 0;
+
+    m_pBuffer = MyNew float[m_Capacity * Stream_NumStreams];
+    for( int i=0; i<Stream_NumStreams; i++ )
+        m_pStreams[i] = &m_pBuffer[i * m_Capacity];
+}
+
+int ParticleStore::Add()
+{
+    if( m_Count >= m_Capacity )
+        return -1;
+
+    m_Count++;
+    return m_Count - 1;
+}
+
+unsigned int ParticleStore::AddRange(unsigned int count, unsigned int* pFirstIndex)
+{
+    *pFirstIndex = m_Count;
+
+    if( count > m_Capacity - m_Count )
+        count = m_Capacity - m_Count;
+
+    m_Count += count;
+    return count;
+}
+
+void ParticleStore::RemoveAt(unsigned int index)
+{
+    MyAssert( index < m_Count );
+
+    m_Count--;
+    if( index != m_Count )
+    {
+        for( int i=0; i<Stream_NumStreams; i++ )
+            m_pStreams[i][index] = m_pStreams[i][m_Count];
+    }
+}
+
+void ParticleStore::Integrate(float deltaTime)
+{
+    // pos += dir * deltaTime, done one axis at a time so each loop only reads 2 streams.
+    for( int axis=0; axis<3; axis++ )
+    {
+        float* pPos = m_pStreams[Stream_PosX + axis];
+        const float* pDir = m_pStreams[Stream_DirX + axis];
+
+        for( unsigned int i=0; i<m_Count; i++ )
+            pPos[i] += pDir[i] * deltaTime;
+    }
+}
+
+void ParticleStore::Age(float deltaTime)
+{
+    float* pTimeAlive = m_pStreams[Stream_TimeAlive];
+
+    for( unsigned int i=0; i<m_Count; i++ )
+        pTimeAlive[i] += deltaTime;
+}
+
+// Returns the number of particles removed.
+unsigned int ParticleStore::RemoveExpired()
+{
+    const float* pTimeAlive = m_pStreams[Stream_TimeAlive];
+    const float* pTimeToLive = m_pStreams[Stream_TimeToLive];
+
+    // Walk backwards so the particle swapped into a hole has already been checked.
+    unsigned int removed = 0;
+    for( unsigned int i=m_Count; i>0; i-- )
+    {
+        if( pTimeAlive[i-1] > pTimeToLive[i-1] )
+        {
+            RemoveAt( i-1 );
+            removed++;
+        }
+    }
+
+    return removed;
+}
+
+void ParticleStore::ComputeBounds(Vector3* pMin, Vector3* pMax)
+{
+    float min[3] = { 0, 0, 0 };
+    float max[3] = { 0, 0, 0 };
+
+    if( m_Count > 0 )
+    {
+        for( int axis=0; axis<3; axis++ )
+        {
+            const float* pPos = m_pStreams[Stream_PosX + axis];
+
+            min[axis] = pPos[0];
+            max[axis] = pPos[0];
+            for( unsigned int i=1; i<m_Count; i++ )
+            {
+                min[axis] = pPos[i] < min[axis] ? pPos[i] : min[axis];
+                max[axis] = pPos[i] > max[axis] ? pPos[i] : max[axis];
+            }
+        }
+    }
+
+    pMin->Set( min[0], min[1], min[2] );
+    pMax->Set( max[0], max[1], max[2] );
+}
+
+//====================================================================================================
+// ComponentParticleEmitter
+//====================================================================================================
+
 ComponentParticleEmitter::ComponentParticleEmitter(EngineCore* pEngineCore, ComponentSystemManager* pComponentSystemManager)
 : ComponentRenderable( pEngineCore, pComponentSystemManager )
 {
@@ -26,12 +161,7 @@ ComponentParticleEmitter::ComponentParticleEmitter(EngineCore* pEngineCore, Comp
 
     m_BaseType = BaseComponentType_Renderable;
 
-    m_Particles.AllocateObjects( 1000 );
-    for( unsigned int i=0; i<m_Particles.Length(); i++ )
-    {
-        Particle* pObj = MyNew Particle;
-        m_Particles.AddInactiveObject( pObj );
-    }
+    m_Particles.Allocate( 1000 );
 
     BufferManager* pBufferManager = g_pComponentSystemManager->GetEngineCore()->GetManagers()->GetBufferManager();
 
@@ -49,11 +179,22 @@ ComponentParticleEmitter::ComponentParticleEmitter(EngineCore* pEngineCore, Comp
 
     m_pRenderGraphObject = 0;
     m_pMaterial = 0;
+
+    m_ParticleSystemManagerIndex = -1;
+    m_TimeSinceLastUpdate = 0;
+    m_ParticleBoundsMin.Set( 0, 0, 0 );
+    m_ParticleBoundsMax.Set( 0, 0, 0 );
 }
 
 ComponentParticleEmitter::~ComponentParticleEmitter()
 {
-    m_Particles.DeleteAllObjectsInPool();
+    // Should have been unregistered when disabled, but make sure the manager doesn't hold a dangling pointer.
+    // The manager might already be gone if this is destroyed during shutdown.
+    if( m_ParticleSystemManagerIndex != -1 )
+    {
+        if( g_pComponentSystemManager && g_pComponentSystemManager->m_pParticleSystemManager )
+            g_pComponentSystemManager->m_pParticleSystemManager->UnregisterEmitter( this );
+    }
 
     SAFE_DELETE( m_pParticleRenderer );
 
@@ -101,6 +242,8 @@ void ComponentParticleEmitter::Reset()
 
     m_AlphaModifier = 1.0f;
 
+    m_Seed = 0;
+
 #if MYFW_USING_WX
     m_pPanelWatchBlockVisible = &m_PanelWatchBlockVisible;
 #endif //MYFW_USING_WX
@@ -112,6 +255,7 @@ void ComponentParticleEmitter::LuaRegister(lua_State* luastate)
     luabridge::getGlobalNamespace( luastate )
         .beginClass<ComponentParticleEmitter>( "ComponentParticleEmitter" )
             .addFunction( "CreateBurst", &ComponentParticleEmitter::CreateBurst ) // void ComponentParticleEmitter::CreateBurst(int number, Vector3 offset)
+            .addFunction( "SetSeed", &ComponentParticleEmitter::SetSeed ) // void ComponentParticleEmitter::SetSeed(unsigned int seed)
         .endClass();
 }
 #endif //MYFW_USING_LUA
@@ -137,6 +281,9 @@ cJSON* ComponentParticleEmitter::ExportAsJSONObject(bool savesceneid, bool savei
     cJSONExt_AddFloatArrayToObject( component, "color1", &m_Color1.r, 4 );
     cJSONExt_AddFloatArrayToObject( component, "color2", &m_Color2.r, 4 );
 
+    if( m_Seed != 0 )
+        cJSON_AddNumberToObject( component, "Seed", m_Seed );
+
     if( m_pMaterial && m_pMaterial->GetFile() )
         cJSON_AddStringToObject( component, "Material", m_pMaterial->GetMaterialDescription() );
 
@@ -164,6 +311,8 @@ void ComponentParticleEmitter::ImportFromJSONObject(cJSON* jsonobj, SceneID scen
     cJSONExt_GetFloatArray( jsonobj, "color1", &m_Color1.r, 4 );
     cJSONExt_GetFloatArray( jsonobj, "color2", &m_Color2.r, 4 );
 
+    cJSONExt_GetUnsignedInt( jsonobj, "Seed", &m_Seed );
+
     cJSON* materialstringobj = cJSON_GetObjectItem( jsonobj, "Material" );
     if( materialstringobj )
     {
@@ -197,6 +346,8 @@ ComponentParticleEmitter& ComponentParticleEmitter::operator=(const ComponentPar
     this->m_Color1              = other.m_Color1;
     this->m_Color2              = other.m_Color2;
 
+    this->m_Seed                = other.m_Seed;
+
     m_pMaterial = other.m_pMaterial;
     if( m_pMaterial )
         m_pMaterial->AddRef();
@@ -212,7 +363,8 @@ void ComponentParticleEmitter::RegisterCallbacks()
     {
         m_CallbacksRegistered = true;
 
-        MYFW_REGISTER_COMPONENT_CALLBACK( ComponentParticleEmitter, Tick );
+        m_pComponentSystemManager->m_pParticleSystemManager->RegisterEmitter( this );
+        //MYFW_REGISTER_COMPONENT_CALLBACK( ComponentParticleEmitter, Tick );
         //MYFW_REGISTER_COMPONENT_CALLBACK( ComponentParticleEmitter, OnSurfaceChanged );
         MYFW_FILL_COMPONENT_CALLBACK_STRUCT( ComponentParticleEmitter, Draw ); //MYFW_REGISTER_COMPONENT_CALLBACK( ComponentParticleEmitter, Draw );
         //MYFW_REGISTER_COMPONENT_CALLBACK( ComponentParticleEmitter, OnTouch );
@@ -228,7 +380,8 @@ void ComponentParticleEmitter::UnregisterCallbacks()
 
     if( m_CallbacksRegistered == true )
     {
-        MYFW_UNREGISTER_COMPONENT_CALLBACK( Tick );
+        m_pComponentSystemManager->m_pParticleSystemManager->UnregisterEmitter( this );
+        //MYFW_UNREGISTER_COMPONENT_CALLBACK( Tick );
         //MYFW_UNREGISTER_COMPONENT_CALLBACK( OnSurfaceChanged );
         //MYFW_UNREGISTER_COMPONENT_CALLBACK( Draw );
         //MYFW_UNREGISTER_COMPONENT_CALLBACK( OnTouch );
@@ -248,6 +401,15 @@ void ComponentParticleEmitter::OnLoad()
         AddToRenderGraph();
 }
 
+void ComponentParticleEmitter::OnPlay()
+{
+    ComponentRenderable::OnPlay();
+
+    // Restart the stream so every play spawns the exact same particles.
+    if( m_Seed != 0 )
+        m_RandomStream.SetSeed( m_Seed );
+}
+
 void ComponentParticleEmitter::SetMaterial(MaterialDefinition* pMaterial, int submeshindex)
 {
     ComponentRenderable::SetMaterial( pMaterial, submeshindex );
@@ -313,126 +475,197 @@ void ComponentParticleEmitter::PushChangesToRenderGraphObjects()
 // Exposed to Lua, change elsewhere if function signature changes.
 void ComponentParticleEmitter::CreateBurst(int number, Vector3 offset)
 {
-    while( number )
-    {
-        number--;
+    if( number <= 0 )
+        return;
 
-        Particle* pParticle = m_Particles.MakeObjectActive();
-        if( pParticle )
+    unsigned int first;
+    unsigned int count = m_Particles.AddRange( number, &first );
+    if( count == 0 )
+        return;
+
+    Vector3 pos = m_pComponentTransform->GetWorldPosition() + m_InitialOffset;
+
+    float* pPosX       = &m_Particles.GetStream( ParticleStore::Stream_PosX )[first];
+    float* pPosY       = &m_Particles.GetStream( ParticleStore::Stream_PosY )[first];
+    float* pPosZ       = &m_Particles.GetStream( ParticleStore::Stream_PosZ )[first];
+    float* pDirX       = &m_Particles.GetStream( ParticleStore::Stream_DirX )[first];
+    float* pDirY       = &m_Particles.GetStream( ParticleStore::Stream_DirY )[first];
+    float* pDirZ       = &m_Particles.GetStream( ParticleStore::Stream_DirZ )[first];
+    float* pSize       = &m_Particles.GetStream( ParticleStore::Stream_Size )[first];
+    float* pColorR     = &m_Particles.GetStream( ParticleStore::Stream_ColorR )[first];
+    float* pColorG     = &m_Particles.GetStream( ParticleStore::Stream_ColorG )[first];
+    float* pColorB     = &m_Particles.GetStream( ParticleStore::Stream_ColorB )[first];
+    float* pColorA     = &m_Particles.GetStream( ParticleStore::Stream_ColorA )[first];
+    float* pTimeAlive  = &m_Particles.GetStream( ParticleStore::Stream_TimeAlive )[first];
+    float* pTimeToLive = &m_Particles.GetStream( ParticleStore::Stream_TimeToLive )[first];
+
+    // Each stream is filled for the whole burst at once, variations are centered on the base value
+    //     except size which only grows.
+    m_RandomStream.FillFloats( pPosX, count, pos.x - m_CenterVariation.x/2, pos.x + m_CenterVariation.x/2 );
+    m_RandomStream.FillFloats( pPosY, count, pos.y - m_CenterVariation.y/2, pos.y + m_CenterVariation.y/2 );
+    for( unsigned int i=0; i<count; i++ )
+        pPosZ[i] = pos.z;
+
+    m_RandomStream.FillFloats( pSize, count, m_Size, m_Size + m_SizeVariation );
+
+    if( m_UseColorsAsOptions )
+    {
+        for( unsigned int i=0; i<count; i++ )
         {
-            Vector3 emitterpos = m_pComponentTransform->GetWorldPosition();
+            ColorFloat& color = m_RandomStream.NextUInt( 2 ) == 0 ? m_Color1 : m_Color2;
+            pColorR[i] = color.r;
+            pColorG[i] = color.g;
+            pColorB[i] = color.b;
+            pColorA[i] = color.a;
+        }
+    }
+    else
+    {
+        m_RandomStream.FillFloats( pColorR, count, 0, 1 );
+        m_RandomStream.FillFloats( pColorG, count, 0, 1 );
+        m_RandomStream.FillFloats( pColorB, count, 0, 1 );
+        for( unsigned int i=0; i<count; i++ )
+            pColorA[i] = 1;
+    }
 
-            pParticle->pos = emitterpos + m_InitialOffset;
-            if( m_CenterVariation.x != 0 )
-                pParticle->pos.x += (rand()%(int)(m_CenterVariation.x*10000))/10000.0f - m_CenterVariation.x/2;
-            if( m_CenterVariation.y != 0 )
-                pParticle->pos.y += (rand()%(int)(m_CenterVariation.y*10000))/10000.0f - m_CenterVariation.y/2;
-            pParticle->size = m_Size + (rand()%10000)/10000.0f * m_SizeVariation;
+    m_RandomStream.FillDirections( pDirX, pDirY, pDirZ, count, m_Dir, m_DirVariation );
 
-            if( m_UseColorsAsOptions )
-            {
-                int color = rand()%2;
-                if( color == 0 )
-                    pParticle->color = m_Color1;
-                else //if( color == 1 )
-                    pParticle->color = m_Color2;
-            }
-            else
-            {
-                pParticle->color = ColorFloat( rand()%255/255.0f, rand()%255/255.0f, rand()%255/255.0f, 255/255.0f );
-            }
+    for( unsigned int i=0; i<count; i++ )
+        pTimeAlive[i] = 0;
 
-            pParticle->dir.x = m_Dir.x + m_DirVariation.x * (rand()%10000-5000)/10000.0f;
-            pParticle->dir.y = m_Dir.y + m_DirVariation.y * (rand()%10000-5000)/10000.0f;
-            pParticle->dir.z = m_Dir.z + m_DirVariation.z * (rand()%10000-5000)/10000.0f;
-            pParticle->timealive = 0;
-            pParticle->timetolive = m_TimeToLive;
-            if( m_TimeToLiveVariation != 0 )
-                pParticle->timetolive += (rand()%10000-5000)/10000.0f * m_TimeToLiveVariation;
-
-            //if( m_InitialSpeedBoost )
-            //if( 0 )
-            //{
-            //    pParticle->pos.x += pParticle->dir.x * m_InitialSpeedBoost;
-            //    pParticle->pos.y += pParticle->dir.y * m_InitialSpeedBoost;
-            //}
-        }
-    }
+    m_RandomStream.FillFloats( pTimeToLive, count, m_TimeToLive - m_TimeToLiveVariation/2, m_TimeToLive + m_TimeToLiveVariation/2 );
 }
 
-void ComponentParticleEmitter::TickCallback(float deltaTime)
+// Exposed to Lua, change elsewhere if function signature changes.
+void ComponentParticleEmitter::SetSeed(unsigned int seed)
+{
+    m_Seed = seed;
+
+    if( m_Seed != 0 )
+        m_RandomStream.SetSeed( m_Seed );
+    else
+        m_RandomStream.SetSeed( RandomStream::GenerateUniqueSeed() );
+}
+
+float ComponentParticleEmitter::GetEmitterDeltaTime(float deltaTime)
 {
 #if MYFW_USING_WX
     if( m_RunInEditor && g_pEngineCore->IsInEditorMode() )
         deltaTime = g_pGameCore->GetTimePassedUnpausedLastFrame();
 #endif
 
+    return deltaTime;
+}
+
+// Doesn't touch anything outside this emitter, the camera rotation is worked out once by the manager.
+void ComponentParticleEmitter::UpdateParticles(float deltaTime, MyMatrix* pMatCameraRotation)
+{
     // TODO: if we want to share particle renderers, then don't reset like this.
     m_pParticleRenderer->Reset();
 
     // rebuild the quad to face the camera each frame. // TODO: don't rebuild if billboarding is disabled.
     if( m_BillboardSprites )
-    {
-        // Get the camera rotation vector, use the editor camera if in editor mode.
-        Vector3 camrot( 0, 0, 0 );
-        ComponentCamera* pCamera = g_pComponentSystemManager->GetFirstCamera( true );
-        if( pCamera )
-            camrot = pCamera->m_pComponentTransform->GetLocalRotation();
-
-        MyMatrix matcamrot;
-        matcamrot.CreateSRT( Vector3(1), camrot, Vector3(0) );
-
-        m_pParticleRenderer->RebuildParticleQuad( &matcamrot );
-    }
+        m_pParticleRenderer->RebuildParticleQuad( pMatCameraRotation );
     else
-    {
         m_pParticleRenderer->RebuildParticleQuad( 0 );
-    }
 
-    //m_TimeAlive += deltaTime;
+    m_Particles.Integrate( deltaTime );
+    m_Particles.Age( deltaTime );
 
-    for( unsigned int i=0; i<m_Particles.m_ActiveObjects.Count(); i++ )
-    {
-        Particle* pParticle = m_Particles.m_ActiveObjects[i];
-        pParticle->pos += pParticle->dir * deltaTime;
-        
-        pParticle->timealive += deltaTime;
+    // Particles are drawn on the frame they expire, then removed.
+    OutputParticles();
+    m_Particles.RemoveExpired();
 
-        float perc = pParticle->timealive / pParticle->timetolive;
-        MyClamp( perc, 0.0f, 1.0f );
-        //float antiperc = 1 - perc;
+    m_Particles.ComputeBounds( &m_ParticleBoundsMin, &m_ParticleBoundsMax );
+}
 
-        ColorByte color;
-        float tempperc = (perc - m_ColorTransitionDelay) / (1 - m_ColorTransitionDelay);
-        MyClamp( tempperc, 0.0f, 1.0f );
-        color.r = (unsigned char)((pParticle->color.r + pParticle->color.r * m_ColorTransitionSpeed * tempperc) * 255);
-        color.g = (unsigned char)((pParticle->color.g + pParticle->color.g * m_ColorTransitionSpeed * tempperc) * 255);
-        color.b = (unsigned char)((pParticle->color.b + pParticle->color.b * m_ColorTransitionSpeed * tempperc) * 255);
-        color.a = (unsigned char)((pParticle->color.a + pParticle->color.a * m_ColorTransitionSpeed * tempperc) * 255);
+void ComponentParticleEmitter::UpdateSpawning(float deltaTime)
+{
+    if( m_ContinuousSpawn || m_RunInEditor )
+        m_TimeTilNextSpawn -= deltaTime;
 
-        color.a = (unsigned char)(color.a * m_AlphaModifier);
+    if( m_TimeTilNextSpawn < 0 )
+    {
+        CreateBurst( 1, Vector3(0,0,0) );
+        m_TimeTilNextSpawn = m_SpawnTime;
+    }
+}
 
-        float size = pParticle->size + pParticle->size * m_ScaleSpeed * perc;
+// Bounds of the live particles, grown to cover anything spawned before the next update.
+void ComponentParticleEmitter::GetBounds(Vector3* pMin, Vector3* pMax)
+{
+    Vector3 spawnPos = m_pComponentTransform->GetWorldPosition() + m_InitialOffset;
+    Vector3 spawnExtents( m_CenterVariation.x/2 + m_Size + m_SizeVariation,
+                          m_CenterVariation.y/2 + m_Size + m_SizeVariation,
+                          m_Size + m_SizeVariation );
 
-        if( pParticle->timealive > pParticle->timetolive )
-        {
-            m_Particles.MakeObjectInactiveByIndex( i );
-            i--;
-        }
+    Vector3 spawnMin = spawnPos - spawnExtents;
+    Vector3 spawnMax = spawnPos + spawnExtents;
 
-        if( size > 0 )
-        {
-            m_pParticleRenderer->AddPoint( pParticle->pos, 0, color, size );
-        }
+    if( m_Particles.GetCount() == 0 )
+    {
+        *pMin = spawnMin;
+        *pMax = spawnMax;
+        return;
     }
 
-    if( m_ContinuousSpawn || m_RunInEditor )
-        m_TimeTilNextSpawn -= deltaTime;
+    // Particle sizes aren't tracked in the bounds, so pad by the largest spawn size.
+    float padding = m_Size + m_SizeVariation;
+    *pMin = m_ParticleBoundsMin - Vector3( padding );
+    *pMax = m_ParticleBoundsMax + Vector3( padding );
+
+    if( spawnMin.x < pMin->x ) pMin->x = spawnMin.x;
+    if( spawnMin.y < pMin->y ) pMin->y = spawnMin.y;
+    if( spawnMin.z < pMin->z ) pMin->z = spawnMin.z;
+    if( spawnMax.x > pMax->x ) pMax->x = spawnMax.x;
+    if( spawnMax.y > pMax->y ) pMax->y = spawnMax.y;
+    if( spawnMax.z > pMax->z ) pMax->z = spawnMax.z;
+}
 
-    if( m_TimeTilNextSpawn < 0 )
+// Fade colors and sizes based on age, and write every live particle to the renderer in a single pass.
+void ComponentParticleEmitter::OutputParticles()
+{
+    const float* pPosX       = m_Particles.GetStream( ParticleStore::Stream_PosX );
+    const float* pPosY       = m_Particles.GetStream( ParticleStore::Stream_PosY );
+    const float* pPosZ       = m_Particles.GetStream( ParticleStore::Stream_PosZ );
+    const float* pSize       = m_Particles.GetStream( ParticleStore::Stream_Size );
+    const float* pColorR     = m_Particles.GetStream( ParticleStore::Stream_ColorR );
+    const float* pColorG     = m_Particles.GetStream( ParticleStore::Stream_ColorG );
+    const float* pColorB     = m_Particles.GetStream( ParticleStore::Stream_ColorB );
+    const float* pColorA     = m_Particles.GetStream( ParticleStore::Stream_ColorA );
+    const float* pTimeAlive  = m_Particles.GetStream( ParticleStore::Stream_TimeAlive );
+    const float* pTimeToLive = m_Particles.GetStream( ParticleStore::Stream_TimeToLive );
+
+    // Hoist the per-emitter values out of the loop.
+    float colorTransitionDelay = m_ColorTransitionDelay;
+    float colorTransitionSpeed = m_ColorTransitionSpeed;
+    float colorTransitionScale = 1 / (1 - colorTransitionDelay);
+    float scaleSpeed = m_ScaleSpeed;
+    float alphaModifier = m_AlphaModifier;
+
+    unsigned int count = m_Particles.GetCount();
+    for( unsigned int i=0; i<count; i++ )
     {
-        CreateBurst( 1, Vector3(0,0,0) );
-        m_TimeTilNextSpawn = m_SpawnTime;
+        float perc = pTimeAlive[i] / pTimeToLive[i];
+        MyClamp( perc, 0.0f, 1.0f );
+
+        float size = pSize[i] + pSize[i] * scaleSpeed * perc;
+        if( size <= 0 )
+            continue;
+
+        float tempperc = (perc - colorTransitionDelay) * colorTransitionScale;
+        MyClamp( tempperc, 0.0f, 1.0f );
+        float colorScale = (1 + colorTransitionSpeed * tempperc) * 255;
+
+        ColorByte color;
+        color.r = (unsigned char)(pColorR[i] * colorScale);
+        color.g = (unsigned char)(pColorG[i] * colorScale);
+        color.b = (unsigned char)(pColorB[i] * colorScale);
+        color.a = (unsigned char)(pColorA[i] * colorScale);
+
+        color.a = (unsigned char)(color.a * alphaModifier);
+
+        m_pParticleRenderer->AddPoint( Vector3( pPosX[i], pPosY[i], pPosZ[i] ), 0, color, size );
     }
 }
 
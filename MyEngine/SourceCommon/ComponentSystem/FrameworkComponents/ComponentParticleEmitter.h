@@ -11,22 +11,76 @@
 #define __ComponentParticleEmitter_H__
 
 #include "ComponentSystem/BaseComponents/ComponentRenderable.h"
+#include "Core/RandomStream.h"
 
 class ComponentTransform;
 
-class ComponentParticleEmitter : public ComponentRenderable
+// Particles stored as a structure of arrays, each stream is contiguous so the update loops
+//     touch only the values they need and can be vectorized by the compiler.
+// Removal swaps the last particle into the hole, so order isn't preserved.
+class ParticleStore
 {
 public:
-    struct Particle
+    enum Streams
     {
-        Vector3 pos;
-        float size;
-        ColorFloat color;
-        Vector3 dir;
-        float timealive;
-        float timetolive;
+        Stream_PosX,
+        Stream_PosY,
+        Stream_PosZ,
+        Stream_DirX,
+        Stream_DirY,
+        Stream_DirZ,
+        Stream_Size,
+        Stream_ColorR,
+        Stream_ColorG,
+        Stream_ColorB,
+        Stream_ColorA,
+        Stream_TimeAlive,
+        Stream_TimeToLive,
+        Stream_NumStreams,
     };
 
+protected:
+    float* m_pBuffer; // One allocation, holding all streams back to back.
+    float* m_pStreams[Stream_NumStreams];
+    unsigned int m_Capacity;
+    unsigned int m_Count;
+
+public:
+    ParticleStore();
+    ~ParticleStore();
+
+    void Allocate(unsigned int capacity);
+
+    unsigned int GetCount() { return m_Count; }
+    unsigned int GetCapacity() { return m_Capacity; }
+    float* GetStream(Streams stream) { return m_pStreams[stream]; }
+
+    // Returns the index of the new particle or -1 if the store is full, values are left uninitialized.
+    int Add();
+    // Adds up to count particles at the end of the store, returns how many were added starting at *pFirstIndex.
+    unsigned int AddRange(unsigned int count, unsigned int* pFirstIndex);
+    void RemoveAt(unsigned int index);
+    void Clear() { m_Count = 0; }
+
+    // Update kernels.
+    void Integrate(float deltaTime);
+    void Age(float deltaTime);
+    unsigned int RemoveExpired();
+    void ComputeBounds(Vector3* pMin, Vector3* pMax);
+};
+
+class ComponentParticleEmitter : public ComponentRenderable
+{
+    friend class ParticleSystemManager;
+    friend class ParticleEmitterUpdateJob;
+
+protected:
+    // Managed by the ParticleSystemManager.
+    int m_ParticleSystemManagerIndex; // -1 if not registered.
+    float m_TimeSinceLastUpdate; // Time owed to the particles if updates were throttled or culled.
+    Vector3 m_ParticleBoundsMin;
+    Vector3 m_ParticleBoundsMax;
+
 public:
     RenderGraphObject* m_pRenderGraphObject;
 
@@ -38,7 +92,11 @@ public:
     bool m_RunInEditor;
     //bool m_RunWhenPaused;
 
-    MyActivePool<Particle*> m_Particles;
+    ParticleStore m_Particles;
+
+    // Each emitter has its own random stream, if m_Seed isn't 0 the stream restarts from it on play.
+    RandomStream m_RandomStream;
+    unsigned int m_Seed;
 
     bool m_ContinuousSpawn;
     float m_TimeTilNextSpawn;
@@ -90,6 +148,7 @@ public:
     virtual void UnregisterCallbacks();
 
     virtual void OnLoad();
+    virtual void OnPlay();
 
     virtual MaterialDefinition* GetMaterial(int submeshindex) { return m_pMaterial; }
     virtual void SetMaterial(MaterialDefinition* pMaterial, int submeshindex);
@@ -101,10 +160,20 @@ public:
     virtual void PushChangesToRenderGraphObjects();
 
     void CreateBurst(int number, Vector3 offset);
+    void SetSeed(unsigned int seed);
+
+protected:
+    void OutputParticles();
+
+    // Called by the ParticleSystemManager.
+    float GetEmitterDeltaTime(float deltaTime);
+    void UpdateParticles(float deltaTime, MyMatrix* pMatCameraRotation); // Safe to call from a job thread.
+    void UpdateSpawning(float deltaTime);
+    void GetBounds(Vector3* pMin, Vector3* pMax);
 
 protected:
     // Callback functions for various events.
-    MYFW_DECLARE_COMPONENT_CALLBACK_TICK(); // TickCallback
+    //MYFW_DECLARE_COMPONENT_CALLBACK_TICK(); // TickCallback, particles are updated by the ParticleSystemManager.
     //MYFW_DECLARE_COMPONENT_CALLBACK_ONSURFACECHANGED(); // OnSurfaceChangedCallback
     MYFW_DECLARE_COMPONENT_CALLBACK_DRAW(); // DrawCallback
     //MYFW_DECLARE_COMPONENT_CALLBACK_ONTOUCH(); // OnTouchCallback
@@ -27,6 +27,7 @@ ComponentPostEffect::ComponentPostEffect(EngineCore* pEngineCore, ComponentSyste
     m_BaseType = BaseComponentType_Data;
 
     m_pFullScreenQuad = nullptr;
+    m_QuadUVMax.Set( 0, 0 );
     m_pMaterial = nullptr;
 }
 
@@ -87,6 +88,7 @@ void ComponentPostEffect::Reset()
 
     m_pFullScreenQuad = MyNew MySprite();
     m_pFullScreenQuad->Create( pBufferManager, 2, 2, 0, 1, 1, 0, Justify_Center, false );
+    m_QuadUVMax.Set( 1, 1 );
     m_pMaterial = nullptr;
 
 #if MYFW_USING_WX
@@ -100,9 +102,15 @@ ComponentPostEffect& ComponentPostEffect::operator=(const ComponentPostEffect& o
 
     ComponentData::operator=( other );
 
-    m_pFullScreenQuad = other.m_pFullScreenQuad;
-    if( m_pFullScreenQuad )
-        m_pFullScreenQuad->AddRef();
+    // Each copy keeps its own quad, since the uvs are rebuilt to match the target it's drawing from.
+    if( m_pFullScreenQuad == nullptr )
+    {
+        BufferManager* pBufferManager = m_pEngineCore->GetManagers()->GetBufferManager();
+
+        m_pFullScreenQuad = MyNew MySprite();
+        m_pFullScreenQuad->Create( pBufferManager, 2, 2, 0, 1, 1, 0, Justify_Center, false );
+        m_QuadUVMax.Set( 1, 1 );
+    }
 
     m_pMaterial = other.m_pMaterial;
     if( m_pMaterial )
@@ -131,7 +139,14 @@ void ComponentPostEffect::Render(FBODefinition* pFBO)
     m_pMaterial->SetTextureColor( pFBO->GetColorTexture( 0 ) );
 
     m_pFullScreenQuad->SetMaterial( m_pMaterial );
-    m_pFullScreenQuad->Create( pBufferManager, 2, 2, 0, (float)pFBO->GetWidth()/pFBO->GetTextureWidth(), (float)pFBO->GetHeight()/pFBO->GetTextureHeight(), 0, Justify_Center, false );
+
+    // Only rebuild the quad if the part of the texture being used changed, i.e. the viewport was resized.
+    Vector2 uvMax( (float)pFBO->GetWidth()/pFBO->GetTextureWidth(), (float)pFBO->GetHeight()/pFBO->GetTextureHeight() );
+    if( uvMax.x != m_QuadUVMax.x || uvMax.y != m_QuadUVMax.y )
+    {
+        m_pFullScreenQuad->Create( pBufferManager, 2, 2, 0, uvMax.x, uvMax.y, 0, Justify_Center, false );
+        m_QuadUVMax = uvMax;
+    }
 
     if( m_pFullScreenQuad->Setup( nullptr, nullptr, nullptr ) )
     {
@@ -25,6 +25,7 @@ private:
 
 public:
     MySprite* m_pFullScreenQuad;
+    Vector2 m_QuadUVMax; // UVs the quad was last built with, it's only rebuilt when these change.
 
     MaterialDefinition* m_pMaterial;
 
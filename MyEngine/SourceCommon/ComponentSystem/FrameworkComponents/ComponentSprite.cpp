@@ -12,6 +12,7 @@
 #include "ComponentSprite.h"
 #include "ComponentSystem/BaseComponents/ComponentTransform.h"
 #include "ComponentSystem/Core/GameObject.h"
+#include "ComponentSystem/Core/SpriteBatcher.h"
 #include "Core/EngineCore.h"
 #include "../../../Framework/MyFramework/SourceCommon/RenderGraphs/RenderGraph_Base.h"
 
@@ -35,6 +36,8 @@ ComponentSprite::ComponentSprite(EngineCore* pEngineCore, ComponentSystemManager
     m_pRenderGraphObject = 0;
 
     m_pSprite = 0;
+
+    m_SpriteBatcherIndex = -1;
 }
 
 ComponentSprite::~ComponentSprite()
@@ -44,7 +47,7 @@ ComponentSprite::~ComponentSprite()
     SAFE_RELEASE( m_pSprite );
 
     MYFW_UNREGISTER_COMPONENT_CALLBACK( Tick );
-    m_pGameObject->GetTransform()->UnregisterTransformChangedCallbacks( this );
+    m_pGameObject->GetTransform()->UnregisterTransformChangedCallback( this, StaticOnTransformChanged );
 
     RemoveFromRenderGraph();
 
@@ -64,12 +67,20 @@ void ComponentSprite::RegisterVariables(TCPPListHead<ComponentVariable*>* pList,
 #if MYFW_USING_WX
     AddVar( pList, "Tint",     ComponentVariableType::ColorByte, MyOffsetOf( pThis, &pThis->m_Tint ),  true,  true, 0, (CVarFunc_ValueChanged)&ComponentSprite::OnValueChanged, (CVarFunc_DropTarget)&ComponentSprite::OnDrop, 0 );
     AddVar( pList, "Size",     ComponentVariableType::Vector2,   MyOffsetOf( pThis, &pThis->m_Size ),  true,  true, 0, (CVarFunc_ValueChanged)&ComponentSprite::OnValueChanged, (CVarFunc_DropTarget)&ComponentSprite::OnDrop, 0 );
+    AddVar( pList, "UVStart",  ComponentVariableType::Vector2,   MyOffsetOf( pThis, &pThis->m_UVStart ),  true,  true, "UV Start", (CVarFunc_ValueChanged)&ComponentSprite::OnValueChanged, (CVarFunc_DropTarget)&ComponentSprite::OnDrop, 0 );
+    AddVar( pList, "UVEnd",    ComponentVariableType::Vector2,   MyOffsetOf( pThis, &pThis->m_UVEnd ),  true,  true, "UV End", (CVarFunc_ValueChanged)&ComponentSprite::OnValueChanged, (CVarFunc_DropTarget)&ComponentSprite::OnDrop, 0 );
+    AddVar( pList, "SortLayer", ComponentVariableType::Int,      MyOffsetOf( pThis, &pThis->m_SortLayer ),  true,  true, "Sort Layer", (CVarFunc_ValueChanged)&ComponentSprite::OnValueChanged, (CVarFunc_DropTarget)&ComponentSprite::OnDrop, 0 );
+    AddVar( pList, "Batch",    ComponentVariableType::Bool,      MyOffsetOf( pThis, &pThis->m_AllowBatching ),  true,  true, "Allow Batching", (CVarFunc_ValueChanged)&ComponentSprite::OnValueChanged, (CVarFunc_DropTarget)&ComponentSprite::OnDrop, 0 );
     AddVarPointer( pList, "Material", true,  true, 0,
        (CVarFunc_GetPointerValue)&ComponentSprite::GetPointerValue, (CVarFunc_SetPointerValue)&ComponentSprite::SetPointerValue, (CVarFunc_GetPointerDesc)&ComponentSprite::GetPointerDesc, (CVarFunc_SetPointerDesc)&ComponentSprite::SetPointerDesc,
        (CVarFunc_ValueChanged)&ComponentSprite::OnValueChanged, (CVarFunc_DropTarget)&ComponentSprite::OnDrop, 0 );
 #else
     AddVar( pList, "Tint",     ComponentVariableType::ColorByte, MyOffsetOf( pThis, &pThis->m_Tint ),  true,  true, 0, (CVarFunc_ValueChanged)&ComponentSprite::OnValueChanged, 0, 0 );
     AddVar( pList, "Size",     ComponentVariableType::Vector2,   MyOffsetOf( pThis, &pThis->m_Size ),  true,  true, 0, (CVarFunc_ValueChanged)&ComponentSprite::OnValueChanged, 0, 0 );
+    AddVar( pList, "UVStart",  ComponentVariableType::Vector2,   MyOffsetOf( pThis, &pThis->m_UVStart ),  true,  true, "UV Start", (CVarFunc_ValueChanged)&ComponentSprite::OnValueChanged, 0, 0 );
+    AddVar( pList, "UVEnd",    ComponentVariableType::Vector2,   MyOffsetOf( pThis, &pThis->m_UVEnd ),  true,  true, "UV End", (CVarFunc_ValueChanged)&ComponentSprite::OnValueChanged, 0, 0 );
+    AddVar( pList, "SortLayer", ComponentVariableType::Int,      MyOffsetOf( pThis, &pThis->m_SortLayer ),  true,  true, "Sort Layer", (CVarFunc_ValueChanged)&ComponentSprite::OnValueChanged, 0, 0 );
+    AddVar( pList, "Batch",    ComponentVariableType::Bool,      MyOffsetOf( pThis, &pThis->m_AllowBatching ),  true,  true, "Allow Batching", (CVarFunc_ValueChanged)&ComponentSprite::OnValueChanged, 0, 0 );
     ComponentVariable* pVar = AddVarPointer( pList, "Material", true,  true, 0,
        (CVarFunc_GetPointerValue)&ComponentSprite::GetPointerValue,
        (CVarFunc_SetPointerValue)&ComponentSprite::SetPointerValue,
@@ -103,6 +114,11 @@ void ComponentSprite::Reset()
 
     m_Size.Set( 1.0f, 1.0f );
     m_Tint.Set( 255,255,255,255 );
+    m_UVStart.Set( 0, 0 );
+    m_UVEnd.Set( 1, 1 );
+
+    m_SortLayer = 0;
+    m_AllowBatching = true;
 
 #if MYFW_USING_WX
     m_pPanelWatchBlockVisible = &m_PanelWatchBlockVisible;
@@ -209,6 +225,10 @@ ComponentSprite& ComponentSprite::operator=(const ComponentSprite& other)
     // TODO: replace this with a CopyComponentVariablesFromOtherObject... or something similar.
     this->m_Tint = other.m_Tint;
     this->m_Size = other.m_Size;
+    this->m_UVStart = other.m_UVStart;
+    this->m_UVEnd = other.m_UVEnd;
+    this->m_SortLayer = other.m_SortLayer;
+    this->m_AllowBatching = other.m_AllowBatching;
     this->SetMaterial( other.m_pSprite->GetMaterial(), 0 );
 
     return *this;
@@ -255,9 +275,9 @@ void ComponentSprite::OnLoad()
     ComponentRenderable::OnLoad();
 
     BufferManager* pBufferManager = m_pEngineCore->GetManagers()->GetBufferManager();
-    m_pSprite->Create( pBufferManager, "ComponentSprite", m_Size.x, m_Size.y, 0, 1, 0, 1, Justify_Center, false );
+    m_pSprite->Create( pBufferManager, "ComponentSprite", m_Size.x, m_Size.y, m_UVStart.x, m_UVEnd.x, m_UVStart.y, m_UVEnd.y, Justify_Center, false );
 
-    if( m_pRenderGraphObject == 0 )
+    if( m_pRenderGraphObject == 0 && m_SpriteBatcherIndex == -1 )
         AddToRenderGraph();
 }
 
@@ -267,6 +287,8 @@ void ComponentSprite::OnTransformChanged(const Vector3& newPos, const Vector3& n
     {
         g_pComponentSystemManager->GetRenderGraph()->ObjectMoved( m_pRenderGraphObject );
     }
+
+    OnStaticRenderableChanged();
 }
 
 void ComponentSprite::SetMaterial(MaterialDefinition* pMaterial, int submeshIndex)
@@ -281,10 +303,10 @@ void ComponentSprite::SetMaterial(MaterialDefinition* pMaterial, int submeshInde
         m_pSprite->SetMaterial( pMaterial );
 
         // Create a RenderGraph object if this is the first time we set the material.
-        if( m_pRenderGraphObject == 0 && pMaterial != 0 )
+        if( m_pRenderGraphObject == 0 && m_SpriteBatcherIndex == -1 && pMaterial != 0 )
         {
             BufferManager* pBufferManager = m_pEngineCore->GetManagers()->GetBufferManager();
-            m_pSprite->Create( pBufferManager, "ComponentSprite", m_Size.x, m_Size.y, 0, 1, 0, 1, Justify_Center, false );
+            m_pSprite->Create( pBufferManager, "ComponentSprite", m_Size.x, m_Size.y, m_UVStart.x, m_UVEnd.x, m_UVStart.y, m_UVEnd.y, Justify_Center, false );
 
             AddToRenderGraph();
         }
@@ -299,6 +321,8 @@ void ComponentSprite::SetMaterial(MaterialDefinition* pMaterial, int submeshInde
     {
         m_pRenderGraphObject->SetMaterial( pMaterial, true );
     }
+
+    OnStaticRenderableChanged();
 }
 
 void ComponentSprite::SetVisible(bool visible)
@@ -309,6 +333,13 @@ void ComponentSprite::SetVisible(bool visible)
     {
         m_pRenderGraphObject->m_Visible = visible;
     }
+
+    OnStaticRenderableChanged();
+}
+
+bool ComponentSprite::ShouldBeBatched()
+{
+    return m_AllowBatching && m_pComponentSystemManager->m_pSpriteBatcher->IsEnabled();
 }
 
 void ComponentSprite::AddToRenderGraph()
@@ -322,8 +353,16 @@ void ComponentSprite::AddToRenderGraph()
         return;
 
     MyAssert( m_pRenderGraphObject == 0 );
+    MyAssert( m_SpriteBatcherIndex == -1 );
     MyAssert( m_pSprite );
 
+    // Batched sprites are drawn by the SpriteBatcher, which skips them until their material is loaded.
+    if( ShouldBeBatched() )
+    {
+        m_pComponentSystemManager->m_pSpriteBatcher->RegisterSprite( this );
+        return;
+    }
+
     // Add the submesh to the scene graph if the material is loaded, otherwise check again each tick.
     // TODO: Either register with a material finished loading callback or use events instead of this tick callback.
     if( pMaterial->IsFullyLoaded() )
@@ -331,6 +370,7 @@ void ComponentSprite::AddToRenderGraph()
         m_pRenderGraphObject = g_pComponentSystemManager->AddSubmeshToRenderGraph( this, m_pSprite, pMaterial, MyRE::PrimitiveType_Triangles, 1, m_LayersThisExistsOn );
 
         m_WaitingToAddToRenderGraph = false;
+        OnStaticRenderableChanged();
     }
     else if( m_WaitingToAddToRenderGraph == false )
     {
@@ -351,6 +391,12 @@ void ComponentSprite::RemoveFromRenderGraph()
     {
         g_pComponentSystemManager->RemoveObjectFromRenderGraph( m_pRenderGraphObject );    
         m_pRenderGraphObject = 0;
+        OnStaticRenderableChanged();
+    }
+
+    if( m_SpriteBatcherIndex != -1 )
+    {
+        g_pComponentSystemManager->m_pSpriteBatcher->UnregisterSprite( this );
     }
 }
 
@@ -358,6 +404,14 @@ void ComponentSprite::PushChangesToRenderGraphObjects()
 {
     //ComponentRenderable::PushChangesToRenderGraphObjects(); // pure virtual
 
+    // Move between the RenderGraph and the SpriteBatcher if the batching flag changed.
+    bool batch = ShouldBeBatched();
+    if( (batch && m_pRenderGraphObject) || (batch == false && m_SpriteBatcherIndex != -1) )
+    {
+        RemoveFromRenderGraph();
+        AddToRenderGraph();
+    }
+
     // Sync RenderGraph object
     if( m_pRenderGraphObject )
     {
@@ -368,6 +422,10 @@ void ComponentSprite::PushChangesToRenderGraphObjects()
         //m_pRenderGraphObject->m_GLPrimitiveType = this->m_GLPrimitiveType;
         //m_pRenderGraphObject->m_PointSize = this->m_PointSize;
     }
+
+    // The static flag itself might have changed, so invalidate cached shadow maps either way.
+    if( m_pComponentSystemManager )
+        m_pComponentSystemManager->OnStaticRenderableChanged();
 }
 
 void ComponentSprite::TickCallback(float deltaTime)
@@ -510,7 +568,7 @@ void* ComponentSprite::OnValueChanged(ComponentVariable* pVar, bool changedByInt
     //if( strcmp( pVar->m_Label, "Size" ) == 0 )
     {
         BufferManager* pBufferManager = m_pEngineCore->GetManagers()->GetBufferManager();
-        m_pSprite->Create( pBufferManager, "ComponentSprite", m_Size.x, m_Size.y, 0, 1, 0, 1, Justify_Center, false );
+        m_pSprite->Create( pBufferManager, "ComponentSprite", m_Size.x, m_Size.y, m_UVStart.x, m_UVEnd.x, m_UVStart.y, m_UVEnd.y, Justify_Center, false );
     }
 
     PushChangesToRenderGraphObjects();
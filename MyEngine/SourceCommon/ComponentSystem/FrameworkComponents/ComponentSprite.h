@@ -16,6 +16,8 @@ class ComponentTransform;
 
 class ComponentSprite : public ComponentRenderable
 {
+    friend class SpriteBatcher;
+
 private:
     // Component Variable List
     MYFW_COMPONENT_DECLARE_VARIABLE_LIST( ComponentSprite ); //_VARIABLE_LIST
@@ -28,6 +30,15 @@ public:
     ColorByte m_Tint;
     Vector2 m_Size;
 
+    Vector2 m_UVStart; // UV range the sprite's quad is created with, batched quads use the same range.
+    Vector2 m_UVEnd;
+
+    int m_SortLayer; // Lower layers draw first when batched.
+    bool m_AllowBatching; // Turn off for materials whose shaders need the sprite's world matrix.
+
+protected:
+    int m_SpriteBatcherIndex; // -1 if not registered with the SpriteBatcher.
+
 public:
     ComponentSprite(EngineCore* pEngineCore, ComponentSystemManager* pComponentSystemManager);
     virtual ~ComponentSprite();
@@ -57,6 +68,8 @@ public:
 
     virtual void SetVisible(bool visible);
 
+    bool ShouldBeBatched(); // Only if this sprite allows it and the SpriteBatcher is enabled.
+
     virtual void AddToRenderGraph();
     virtual void RemoveFromRenderGraph();
     virtual void PushChangesToRenderGraphObjects();
@@ -13,7 +13,9 @@
 #include "ComponentSystem/BaseComponents/ComponentCamera.h"
 #include "ComponentSystem/BaseComponents/ComponentTransform.h"
 #include "ComponentSystem/Core/GameObject.h"
+#include "ComponentSystem/EngineComponents/ComponentLuaScript.h"
 #include "Core/EngineCore.h"
+#include "Physics/EngineBox2DContactListener.h"
 
 #include "../../../Framework/MyFramework/SourceCommon/Renderers/BaseClasses/Renderer_Enums.h"
 #include "../../../Framework/MyFramework/SourceCommon/Renderers/BaseClasses/Renderer_Base.h"
@@ -49,6 +51,7 @@ Component2DCollisionObject::Component2DCollisionObject(EngineCore* pEngineCore,
     m_pComponentLuaScript = nullptr;
 
     m_pBox2DWorld = nullptr;
+    m_pContactListener = nullptr;
     m_pBody = nullptr;
     m_pFixture = nullptr;
 
@@ -66,6 +69,9 @@ Component2DCollisionObject::Component2DCollisionObject(EngineCore* pEngineCore,
     m_IsSensor = false;
     m_Friction = 0.2f;
     m_Restitution = 0.0f;
+    m_CategoryBits = 0x0001;
+
+    m_ContactEventMask = 0xFFFF;
 }
 
 Component2DCollisionObject::~Component2DCollisionObject()
@@ -75,7 +81,16 @@ Component2DCollisionObject::~Component2DCollisionObject()
     if( m_pBody )
     {
         MyAssert( m_pBox2DWorld );
-        m_pBox2DWorld->m_pWorld->DestroyBody( m_pBody );
+        DestroyBody();
+    }
+
+    // Destroying the body can queue End events, make sure none of the queued events point to this component.
+    if( m_pContactListener )
+        m_pContactListener->RemoveEventsForComponent( this );
+
+    while( m_ContactCallbacks.GetHead() )
+    {
+        delete (Box2DContactCallbackStruct*)m_ContactCallbacks.RemHead();
     }
 
 #if !MYFW_EDITOR
@@ -101,6 +116,8 @@ void Component2DCollisionObject::RegisterVariables(TCPPListHead<ComponentVariabl
     pVar->SetEditorLimits( 0, 1, 0 );
 #endif //MYFW_EDITOR
     AddVar( pList, "Restitution",   ComponentVariableType::Float, MyOffsetOf( pThis, &pThis->m_Restitution ),     true, true, nullptr, (CVarFunc_ValueChanged)&Component2DCollisionObject::OnValueChanged, nullptr, nullptr );
+    AddVar( pList, "CategoryBits",  ComponentVariableType::UnsignedInt, MyOffsetOf( pThis, &pThis->m_CategoryBits ),     true, true, "Category Bits", (CVarFunc_ValueChanged)&Component2DCollisionObject::OnValueChanged, nullptr, nullptr );
+    AddVar( pList, "ContactEventMask", ComponentVariableType::UnsignedInt, MyOffsetOf( pThis, &pThis->m_ContactEventMask ), true, true, "Contact Event Mask", (CVarFunc_ValueChanged)&Component2DCollisionObject::OnValueChanged, nullptr, nullptr );
 
     //AddVar( pList, "Scale",         ComponentVariableType::Float, MyOffsetOf( pThis, &pThis->m_Scale ),           true, true, nullptr, (CVarFunc_ValueChanged)&Component2DCollisionObject::OnValueChanged, nullptr, nullptr );
 #if MYFW_EDITOR
@@ -124,11 +141,16 @@ void Component2DCollisionObject::Reset()
     if( m_pBody )
     {
         MyAssert( m_pBox2DWorld );
-        m_pBox2DWorld->m_pWorld->DestroyBody( m_pBody );
+        DestroyBody();
+    }
+    if( m_pContactListener )
+    {
+        m_pContactListener->RemoveEventsForComponent( this );
     }
     m_pBody = nullptr;
     m_pFixture = nullptr;
     m_pBox2DWorld = nullptr;
+    m_pContactListener = nullptr;
 
     m_pComponentLuaScript = nullptr;
 
@@ -141,6 +163,9 @@ void Component2DCollisionObject::Reset()
     m_IsSensor = false;
     m_Friction = 0.2f;
     m_Restitution = 0.0f;
+    m_CategoryBits = 0x0001;
+
+    m_ContactEventMask = 0xFFFF;
 
 #if MYFW_USING_WX
     m_pPanelWatchBlockVisible = &m_PanelWatchBlockVisible;
@@ -169,6 +194,10 @@ void Component2DCollisionObject::LuaRegister(lua_State* luastate)
             .addFunction( "IsSensor", &Component2DCollisionObject::IsSensor ) // bool Component2DCollisionObject::IsSensor()
             .addFunction( "GetFriction", &Component2DCollisionObject::GetFriction ) // float Component2DCollisionObject::GetFriction()
             .addFunction( "GetRestitution", &Component2DCollisionObject::GetRestitution ) // float Component2DCollisionObject::GetRestitution()
+            .addFunction( "GetCategoryBits", &Component2DCollisionObject::GetCategoryBits ) // unsigned int Component2DCollisionObject::GetCategoryBits()
+            .addFunction( "GetContactEventMask", &Component2DCollisionObject::GetContactEventMask ) // unsigned int Component2DCollisionObject::GetContactEventMask()
+            .addFunction( "SetCategoryBits", &Component2DCollisionObject::SetCategoryBits ) // void Component2DCollisionObject::SetCategoryBits(unsigned int categoryBits)
+            .addFunction( "SetContactEventMask", &Component2DCollisionObject::SetContactEventMask ) // void Component2DCollisionObject::SetContactEventMask(unsigned int mask)
 #if MYFW_EDITOR
             .addFunction( "Editor_SetVertices", &Component2DCollisionObject::SetVertices ) // void Component2DCollisionObject::SetVertices(const luabridge::LuaRef verts, unsigned int count)
 #endif //MYFW_EDITOR
@@ -340,7 +369,7 @@ void* Component2DCollisionObject::OnValueChanged(ComponentVariable* pVar, bool c
             }
             else
             {
-                Component2DCollisionObject* pComponentWithBody = (Component2DCollisionObject*)m_pGameObject->GetFirstComponentOfType( "2DCollisionObjectComponent" );
+                Component2DCollisionObject* pComponentWithBody = (Component2DCollisionObject*)m_pGameObject->GetFirstComponentOfTypeID( ComponentTypeID_2DCollisionObject );
         
                 MyAssert( pComponentWithBody != this );
                 pComponentWithBody->GetBody()->ResetMassData();
@@ -361,6 +390,11 @@ void* Component2DCollisionObject::OnValueChanged(ComponentVariable* pVar, bool c
         {
             m_pFixture->SetRestitution( m_Restitution );
         }
+
+        if( pVar->m_Offset == MyOffsetOf( this, &m_CategoryBits ) )
+        {
+            SetCategoryBits( m_CategoryBits );
+        }
     }
 
     return oldpointer;
@@ -439,6 +473,9 @@ Component2DCollisionObject& Component2DCollisionObject::operator=(const Componen
     m_IsSensor = other.m_IsSensor;
     m_Friction = other.m_Friction;
     m_Restitution = other.m_Restitution;
+    m_CategoryBits = other.m_CategoryBits;
+
+    m_ContactEventMask = other.m_ContactEventMask;
 
     // Copy vertices.
 #if MYFW_EDITOR
@@ -500,7 +537,7 @@ void Component2DCollisionObject::OnPlay()
 
     if( m_pComponentLuaScript == nullptr )
     {
-        m_pComponentLuaScript = (ComponentLuaScript*)m_pGameObject->GetFirstComponentOfType( "LuaScriptComponent" );
+        m_pComponentLuaScript = (ComponentLuaScript*)m_pGameObject->GetFirstComponentOfTypeID( ComponentTypeID_LuaScript );
     }
 
     MyAssert( m_pGameObject->GetPhysicsSceneID() < MAX_SCENES_LOADED );
@@ -508,6 +545,7 @@ void Component2DCollisionObject::OnPlay()
     if( pSceneInfo )
     {
         m_pBox2DWorld = pSceneInfo->m_pBox2DWorld;
+        m_pContactListener = pSceneInfo->m_pBox2DContactListener;
         MyAssert( m_pBox2DWorld );
     }
 
@@ -516,8 +554,7 @@ void Component2DCollisionObject::OnPlay()
     {
         if( m_pBox2DWorld )
         {
-            m_pBox2DWorld->m_pWorld->DestroyBody( m_pBody );
-            m_pBody = nullptr;
+            DestroyBody();
         }
     }
     MyAssert( m_pFixture == nullptr );
@@ -532,11 +569,15 @@ void Component2DCollisionObject::OnStop()
 
     if( m_pBody )
     {
-        m_pBox2DWorld->m_pWorld->DestroyBody( m_pBody );
-        m_pBody = nullptr;
+        DestroyBody();
+    }
+    if( m_pContactListener )
+    {
+        m_pContactListener->RemoveEventsForComponent( this );
     }
     m_pFixture = nullptr;
     m_pBox2DWorld = nullptr;
+    m_pContactListener = nullptr;
 }
 
 bool Component2DCollisionObject::SetEnabled(bool enableComponent)
@@ -552,6 +593,19 @@ bool Component2DCollisionObject::SetEnabled(bool enableComponent)
     return true;
 }
 
+void Component2DCollisionObject::DestroyBody()
+{
+    MyAssert( m_pBody && m_pBox2DWorld );
+
+    // Let the contact listener drop queued events for the body's fixtures.
+    if( m_pContactListener )
+        m_pContactListener->DestroyBody( m_pBox2DWorld->m_pWorld, m_pBody );
+    else
+        m_pBox2DWorld->m_pWorld->DestroyBody( m_pBody );
+
+    m_pBody = nullptr;
+}
+
 void Component2DCollisionObject::CreateBody()
 {
     MyAssert( m_pBody == nullptr );
@@ -568,7 +622,7 @@ void Component2DCollisionObject::CreateBody()
     // create a body on start
     if( m_pBody == nullptr )
     {
-        Component2DCollisionObject* pComponentWithBody = (Component2DCollisionObject*)m_pGameObject->GetFirstComponentOfType( "2DCollisionObjectComponent" );
+        Component2DCollisionObject* pComponentWithBody = (Component2DCollisionObject*)m_pGameObject->GetFirstComponentOfTypeID( ComponentTypeID_2DCollisionObject );
         
         // if this is the first component of this type, create the body, otherwise get the body from the first component.
         if( pComponentWithBody == this )
@@ -607,7 +661,7 @@ void Component2DCollisionObject::CreateBody()
         fixtureDef.isSensor = m_IsSensor;
         fixtureDef.friction = m_Friction;
         fixtureDef.restitution = m_Restitution;
-        fixtureDef.filter.categoryBits = 0x0001;
+        fixtureDef.filter.categoryBits = (uint16)m_CategoryBits;
         fixtureDef.filter.maskBits = 0xFFFF;
         fixtureDef.filter.groupIndex = 0;
 
@@ -802,6 +856,89 @@ void Component2DCollisionObject::SyncRigidBodyToTransform()
         return;
 }
 
+void Component2DCollisionObject::RegisterContactCallback(void* pObj, Box2DContactCallbackFunc* pCallback, uint16 categoryMask)
+{
+    MyAssert( pCallback != nullptr );
+
+    // Make sure the same callback isn't being registered, update the mask if it is.
+    for( CPPListNode* pNode = m_ContactCallbacks.GetHead(); pNode; pNode = pNode->GetNext() )
+    {
+        Box2DContactCallbackStruct* pCallbackStruct = (Box2DContactCallbackStruct*)pNode;
+        if( pCallbackStruct->pObj == pObj && pCallbackStruct->pFunc == pCallback )
+        {
+            pCallbackStruct->categoryMask = categoryMask;
+            return;
+        }
+    }
+
+    Box2DContactCallbackStruct* pCallbackStruct = MyNew Box2DContactCallbackStruct;
+    pCallbackStruct->pObj = pObj;
+    pCallbackStruct->pFunc = pCallback;
+    pCallbackStruct->categoryMask = categoryMask;
+
+    m_ContactCallbacks.AddTail( pCallbackStruct );
+}
+
+void Component2DCollisionObject::UnregisterContactCallback(void* pObj, Box2DContactCallbackFunc* pCallback)
+{
+    for( CPPListNode* pNode = m_ContactCallbacks.GetHead(); pNode; pNode = pNode->GetNext() )
+    {
+        Box2DContactCallbackStruct* pCallbackStruct = (Box2DContactCallbackStruct*)pNode;
+        if( pCallbackStruct->pObj == pObj && pCallbackStruct->pFunc == pCallback )
+        {
+            pCallbackStruct->Remove();
+            delete pCallbackStruct;
+            return;
+        }
+    }
+}
+
+void Component2DCollisionObject::DispatchContactEvent(const Box2DContactEvent& event, int side)
+{
+    MyAssert( side == 0 || side == 1 );
+
+    Box2DContactInfo info;
+    info.m_pOtherComponent = event.m_pComponent[!side];
+    info.m_pFixture = event.m_pFixture[side];
+    info.m_pOtherFixture = event.m_pFixture[!side];
+    info.m_Normal = event.m_Normal[side];
+    info.m_Impulse = event.m_Impulse;
+
+    uint16 otherCategoryBits = event.m_CategoryBits[!side];
+
+    // Call the C++ callbacks, the callback might unregister itself, so grab the next node first.
+    for( CPPListNode* pNode = m_ContactCallbacks.GetHead(); pNode; )
+    {
+        CPPListNode* pNextNode = pNode->GetNext();
+
+        Box2DContactCallbackStruct* pCallbackStruct = (Box2DContactCallbackStruct*)pNode;
+        if( pCallbackStruct->categoryMask & otherCategoryBits )
+        {
+            pCallbackStruct->pFunc( pCallbackStruct->pObj, event.m_Type, info );
+        }
+
+        pNode = pNextNode;
+    }
+
+#if MYFW_USING_LUA
+    // Call the Lua script.
+    if( m_pComponentLuaScript && (m_ContactEventMask & otherCategoryBits) )
+    {
+        // End events are still sent if the other component was destroyed.
+        GameObject* pOtherGameObject = info.m_pOtherComponent ? info.m_pOtherComponent->GetGameObject() : nullptr;
+
+        if( event.m_Type == Box2DContactEventType::Begin )
+        {
+            m_pComponentLuaScript->CallFunction( "OnCollision", info.m_Normal, pOtherGameObject, info.m_pOtherComponent, info.m_Impulse );
+        }
+        else
+        {
+            m_pComponentLuaScript->CallFunction( "OnCollisionEnd", pOtherGameObject, info.m_pOtherComponent );
+        }
+    }
+#endif //MYFW_USING_LUA
+}
+
 // Exposed to Lua, change elsewhere if function signature changes.
 Vector2 Component2DCollisionObject::GetLinearVelocity()
 {
@@ -856,6 +993,18 @@ float Component2DCollisionObject::GetRestitution()
     return m_Restitution;
 }
 
+// Exposed to Lua, change elsewhere if function signature changes.
+unsigned int Component2DCollisionObject::GetCategoryBits()
+{
+    return m_CategoryBits;
+}
+
+// Exposed to Lua, change elsewhere if function signature changes.
+unsigned int Component2DCollisionObject::GetContactEventMask()
+{
+    return m_ContactEventMask;
+}
+
 // Exposed to Lua, change elsewhere if function signature changes.
 void Component2DCollisionObject::SetPositionAndAngle(Vector2 newPosition, float angle)
 {
@@ -875,6 +1024,25 @@ void Component2DCollisionObject::SetSensor(bool isSensor)
     }
 }
 
+// Exposed to Lua, change elsewhere if function signature changes.
+void Component2DCollisionObject::SetCategoryBits(unsigned int categoryBits)
+{
+    m_CategoryBits = categoryBits;
+
+    if( m_pFixture )
+    {
+        b2Filter filter = m_pFixture->GetFilterData();
+        filter.categoryBits = (uint16)m_CategoryBits;
+        m_pFixture->SetFilterData( filter );
+    }
+}
+
+// Exposed to Lua, change elsewhere if function signature changes.
+void Component2DCollisionObject::SetContactEventMask(unsigned int mask)
+{
+    m_ContactEventMask = mask;
+}
+
 // Exposed to Lua, change elsewhere if function signature changes.
 void Component2DCollisionObject::ClearVelocity()
 {
@@ -15,7 +15,11 @@
 #include "ComponentSystem/BaseComponents/ComponentBase.h"
 #include "ComponentSystem/Core/ComponentSystemManager.h"
 
+class Component2DCollisionObject;
 class ComponentLuaScript;
+class EngineBox2DContactListener;
+struct Box2DContactEvent;
+enum class Box2DContactEventType;
 
 enum Physics2DPrimitiveTypes //ADDING_NEW_Physics2DPrimitiveType - order doesn't matter, saved as string.
 {
@@ -28,6 +32,24 @@ enum Physics2DPrimitiveTypes //ADDING_NEW_Physics2DPrimitiveType - order doesn't
 
 extern const char* Physics2DPrimitiveTypeStrings[Physics2DPrimitive_NumTypes];
 
+// Contact info as seen from one of the two bodies involved.
+struct Box2DContactInfo
+{
+    Component2DCollisionObject* m_pOtherComponent; // nullptr for End events if the other component was destroyed.
+    b2Fixture* m_pFixture;
+    b2Fixture* m_pOtherFixture; // nullptr for End events if the other body was destroyed.
+    Vector2 m_Normal;
+    float m_Impulse;
+};
+
+typedef void Box2DContactCallbackFunc(void* pObjectPtr, Box2DContactEventType type, const Box2DContactInfo& info);
+struct Box2DContactCallbackStruct : CPPListNode
+{
+    void* pObj;
+    Box2DContactCallbackFunc* pFunc;
+    uint16 categoryMask; // Only called for contacts with fixtures in these categories.
+};
+
 class Component2DCollisionObject : public ComponentBase
 {
 private:
@@ -38,6 +60,7 @@ public:
     ComponentLuaScript* m_pComponentLuaScript;
 
     Box2DWorld* m_pBox2DWorld;
+    EngineBox2DContactListener* m_pContactListener; // Contact events for this scene's world are queued here.
     b2Body* m_pBody; // only the first of these components on a gameobject will have a body, every other one is an additional fixture
     b2Fixture* m_pFixture;
 
@@ -55,6 +78,12 @@ public:
     bool m_IsSensor;
     float m_Friction;
     float m_Restitution;
+    unsigned int m_CategoryBits;
+
+    // Only contacts with fixtures in these categories are reported to Lua.
+    unsigned int m_ContactEventMask;
+
+    CPPListHead m_ContactCallbacks;
 
 #if MYFW_EDITOR
     std::vector<Vector2> m_Vertices;
@@ -87,10 +116,16 @@ public:
     virtual bool SetEnabled(bool enabled) override;
 
     void CreateBody();
+    void DestroyBody();
     b2Body* GetBody() { return m_pBody; }
 
     void SyncRigidBodyToTransform();
 
+    // Contact events, queued during the physics step and dispatched after it's done.
+    void RegisterContactCallback(void* pObj, Box2DContactCallbackFunc* pCallback, uint16 categoryMask = 0xFFFF);
+    void UnregisterContactCallback(void* pObj, Box2DContactCallbackFunc* pCallback);
+    void DispatchContactEvent(const Box2DContactEvent& event, int side);
+
     // Getters.
     Vector2 GetLinearVelocity();
     float GetMass();
@@ -101,10 +136,14 @@ public:
     bool IsSensor();
     float GetFriction();
     float GetRestitution();
+    unsigned int GetCategoryBits();
+    unsigned int GetContactEventMask();
 
     // Setters.
     void SetPositionAndAngle(Vector2 newPosition, float angle);
     void SetSensor(bool isSensor);
+    void SetCategoryBits(unsigned int categoryBits);
+    void SetContactEventMask(unsigned int mask);
 
     // Forces.
     void ClearVelocity();
@@ -10,12 +10,12 @@
 #include "MyEnginePCH.h"
 
 #include "Component3DCollisionObject.h"
-#include "BulletCollision/CollisionShapes/btShapeHull.h"
 #include "ComponentSystem/BaseComponents/ComponentTransform.h"
 #include "ComponentSystem/FrameworkComponents/Physics3D/Component3DJointBase.h"
 #include "ComponentSystem/Core/GameObject.h"
 #include "Core/EngineComponentTypeManager.h"
 #include "Core/EngineCore.h"
+#include "Physics/BulletShapeCache.h"
 
 // Component Variable List
 MYFW_COMPONENT_IMPLEMENT_VARIABLE_LIST( Component3DCollisionObject );
@@ -46,13 +46,9 @@ Component3DCollisionObject::Component3DCollisionObject(EngineCore* pEngineCore,
 
 Component3DCollisionObject::~Component3DCollisionObject()
 {
-    m_pGameObject->GetTransform()->UnregisterTransformChangedCallbacks( this );
+    m_pGameObject->GetTransform()->UnregisterTransformChangedCallback( this, StaticOnTransformChanged );
 
-    if( m_pBody )
-    {
-        g_pBulletWorld->m_pDynamicsWorld->removeRigidBody( m_pBody );
-        delete m_pBody;
-    }
+    DestroyBody();
 
     SAFE_RELEASE( m_pMesh );
 
@@ -390,53 +386,18 @@ void Component3DCollisionObject::CreateBody()
     // create a rigidbody on start
     if( m_pBody == 0 )
     {
-        btCollisionShape* colShape = 0;
-        
-        if( m_PrimitiveType == PhysicsPrimitiveType_ConvexHull )
-        {
-            if( m_pMesh && m_pMesh->IsReady() )
-            {
-                //btStridingMeshInterface meshinterface;
-                //colShape = new btBvhTriangleMeshShape( meshinterface );
-
-                // TODO: fix this, it assumes position at the start of the vertex format.
-                unsigned int stride = m_pMesh->GetStride( 0 );
-                colShape = new btConvexHullShape( (btScalar*)m_pMesh->GetVerts( false ), m_pMesh->GetNumVerts(), stride );
-                ((btConvexHullShape*)colShape)->setMargin( 0.2f );
-
-                btShapeHull* hull = new btShapeHull( (btConvexShape*)colShape );
-                btScalar margin = colShape->getMargin();
-                hull->buildHull(margin);
-                delete colShape;
+        // Shapes are shared with every other collision object using the same primitive, mesh and scale.
+        Vector3 localscale = m_pGameObject->GetTransform()->GetLocalScale();
+        btCollisionShape* colShape = g_pBulletWorld->GetShapeCache()->AcquireShape( m_PrimitiveType, m_pMesh, m_Scale, localscale );
 
-                colShape = new btConvexHullShape( (btScalar*)hull->getVertexPointer(), hull->numVertices() );
-                delete hull;
-            }
-            else
-            {
-                LOGInfo( LOGTag, "Mesh not loaded, ConvexHull not created\n" ); 
-                return;
-            }
-        }
-        else
+        // Mesh isn't loaded or the hull is still building, TickCallback will try again next frame.
+        if( colShape == 0 )
         {
-            if( m_PrimitiveType == PhysicsPrimitiveType_Cube )
-            {
-                colShape = new btBoxShape( btVector3(m_Scale.x/2, m_Scale.y/2, m_Scale.z/2) ); // half-extents
-            }
-            else if( m_PrimitiveType == PhysicsPrimitiveType_Sphere )
-            {
-                colShape = new btSphereShape( btScalar(m_Scale.x) );
-            }
-            else if( m_PrimitiveType == PhysicsPrimitiveType_StaticPlane )
-            {
-                // plane is flat on x/z and at origin, rigidbody will have transform to place plane in space.
-                colShape = new btStaticPlaneShape( btVector3(0, 1, 0), 0 );
-            }
+            if( m_PrimitiveType == PhysicsPrimitiveType_ConvexHull && (m_pMesh == nullptr || m_pMesh->IsReady() == false) )
+                LOGInfo( LOGTag, "Mesh not loaded, ConvexHull not created\n" );
+            return;
         }
 
-        g_pBulletWorld->m_CollisionShapes.push_back( colShape );
-
         // Create Dynamic Objects
         btTransform startTransform;
         startTransform.setIdentity();
@@ -452,15 +413,12 @@ void Component3DCollisionObject::CreateBody()
 
         //btVector3 pos(m_pGameObject->GetTransform()->m_Position.x, m_pGameObject->GetTransform()->m_Position.y, m_pGameObject->GetTransform()->m_Position.z );
         //startTransform.setOrigin( pos );
-        Vector3 localscale = m_pGameObject->GetTransform()->GetLocalScale();
-        btVector3 scale( localscale.x, localscale.y, localscale.z );
-        colShape->setLocalScaling( scale );
 
         MyMatrix localmat = m_pGameObject->GetTransform()->GetLocalRotPosMatrix(); //GetLocalTransform();
         startTransform.setFromOpenGLMatrix( &localmat.m11 );
 
         // using motionstate is recommended, it provides interpolation capabilities, and only synchronizes 'active' objects
-        btDefaultMotionState* myMotionState = new btDefaultMotionState( startTransform );
+        BulletMotionState* myMotionState = new BulletMotionState( startTransform );
         btRigidBody::btRigidBodyConstructionInfo rbInfo( m_Mass, myMotionState, colShape, localInertia );
         //rbInfo.m_friction = 1; // TODO: expose friction
         m_pBody = new btRigidBody( rbInfo );
@@ -483,11 +441,18 @@ void Component3DCollisionObject::OnStop()
         }
     }
 
-    if( m_pBody )
-    {
-        g_pBulletWorld->m_pDynamicsWorld->removeRigidBody( m_pBody );
-        SAFE_DELETE( m_pBody );
-    }
+    DestroyBody();
+}
+
+void Component3DCollisionObject::DestroyBody()
+{
+    if( m_pBody == 0 )
+        return;
+
+    g_pBulletWorld->m_pDynamicsWorld->removeRigidBody( m_pBody );
+    g_pBulletWorld->GetShapeCache()->ReleaseShape( m_pBody->getCollisionShape() );
+    delete m_pBody->getMotionState();
+    SAFE_DELETE( m_pBody );
 }
 
 void Component3DCollisionObject::TickCallback(float deltaTime)
@@ -513,8 +478,9 @@ void Component3DCollisionObject::TickCallback(float deltaTime)
     if( pMotionState == 0 )
         return;
 
+    // Blend between the last 2 fixed steps, so objects move smoothly when the frame rate doesn't match the physics rate.
     btTransform transform;
-    pMotionState->getWorldTransform( transform );
+    ((BulletMotionState*)pMotionState)->GetInterpolatedTransform( transform, g_pBulletWorld->GetInterpolationAlpha(), g_pBulletWorld->GetStepCount() );
     MyMatrix matRotPos;
     MyMatrix matBulletGL;
     transform.getOpenGLMatrix( &matBulletGL.m11 );
@@ -548,7 +514,7 @@ void Component3DCollisionObject::SyncRigidBodyToTransform()
     MyMatrix localmat = m_pGameObject->GetTransform()->GetLocalRotPosMatrix();
     transform.setFromOpenGLMatrix( &localmat.m11 );
 
-    m_pBody->getMotionState()->setWorldTransform( transform );
+    ((BulletMotionState*)m_pBody->getMotionState())->Teleport( transform );
     m_pBody->setWorldTransform( transform );
 
     m_pBody->activate( true );
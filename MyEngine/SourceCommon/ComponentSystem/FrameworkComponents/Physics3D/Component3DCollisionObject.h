@@ -44,6 +44,7 @@ protected:
 protected:
     // Internal functions
     void CreateBody();
+    void DestroyBody();
 
 public:
     Component3DCollisionObject(EngineCore* pEngineCore, ComponentSystemManager* pComponentSystemManager);
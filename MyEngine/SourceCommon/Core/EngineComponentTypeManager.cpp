@@ -101,56 +101,56 @@ ComponentBase* EngineComponentTypeManager::CreateComponent(int type)
 
     switch( type ) // ADDING_NEW_ComponentType
     {
-    case ComponentType_Transform:           pComponent = MyNew ComponentTransform(          pEngineCore, m_pComponentSystemManager ); break;
-    case ComponentType_Camera:              pComponent = MyNew ComponentCamera(             pEngineCore, m_pComponentSystemManager ); break;
-    case ComponentType_Sprite:              pComponent = MyNew ComponentSprite(             pEngineCore, m_pComponentSystemManager ); break;
-    case ComponentType_Mesh:                pComponent = MyNew ComponentMesh(               pEngineCore, m_pComponentSystemManager ); break;
-    case ComponentType_MeshOBJ:             pComponent = MyNew ComponentMeshOBJ(            pEngineCore, m_pComponentSystemManager ); break;
-    case ComponentType_MeshPrimitive:       pComponent = MyNew ComponentMeshPrimitive(      pEngineCore, m_pComponentSystemManager ); break;
-    case ComponentType_Heightmap:           pComponent = MyNew ComponentHeightmap(          pEngineCore, m_pComponentSystemManager ); break;
-    case ComponentType_VoxelMesh:           pComponent = MyNew ComponentVoxelMesh(          pEngineCore, m_pComponentSystemManager ); break;
-    case ComponentType_VoxelWorld:          pComponent = MyNew ComponentVoxelWorld(         pEngineCore, m_pComponentSystemManager ); break;
-    case ComponentType_Light:               pComponent = MyNew ComponentLight(              pEngineCore, m_pComponentSystemManager ); break;
-    case ComponentType_CameraShadow:        pComponent = MyNew ComponentCameraShadow(       pEngineCore, m_pComponentSystemManager ); break;
-    case ComponentType_PostEffect:          pComponent = MyNew ComponentPostEffect(         pEngineCore, m_pComponentSystemManager ); break;
+    case ComponentType_Transform:           pComponent = NewComponent<ComponentTransform>(          pEngineCore ); break;
+    case ComponentType_Camera:              pComponent = NewComponent<ComponentCamera>(             pEngineCore ); break;
+    case ComponentType_Sprite:              pComponent = NewComponent<ComponentSprite>(             pEngineCore ); break;
+    case ComponentType_Mesh:                pComponent = NewComponent<ComponentMesh>(               pEngineCore ); break;
+    case ComponentType_MeshOBJ:             pComponent = NewComponent<ComponentMeshOBJ>(            pEngineCore ); break;
+    case ComponentType_MeshPrimitive:       pComponent = NewComponent<ComponentMeshPrimitive>(      pEngineCore ); break;
+    case ComponentType_Heightmap:           pComponent = NewComponent<ComponentHeightmap>(          pEngineCore ); break;
+    case ComponentType_VoxelMesh:           pComponent = NewComponent<ComponentVoxelMesh>(          pEngineCore ); break;
+    case ComponentType_VoxelWorld:          pComponent = NewComponent<ComponentVoxelWorld>(         pEngineCore ); break;
+    case ComponentType_Light:               pComponent = NewComponent<ComponentLight>(              pEngineCore ); break;
+    case ComponentType_CameraShadow:        pComponent = NewComponent<ComponentCameraShadow>(       pEngineCore ); break;
+    case ComponentType_PostEffect:          pComponent = NewComponent<ComponentPostEffect>(         pEngineCore ); break;
 #if MYFW_USING_BULLET
-    case ComponentType_3DCollisionObject:   pComponent = MyNew Component3DCollisionObject(  pEngineCore, m_pComponentSystemManager ); break;
-    case ComponentType_3DJointPoint2Point:  pComponent = MyNew Component3DJointPoint2Point( pEngineCore, m_pComponentSystemManager ); break;
-    case ComponentType_3DJointHinge:        pComponent = MyNew Component3DJointHinge(       pEngineCore, m_pComponentSystemManager ); break;
-    case ComponentType_3DJointSlider:       pComponent = MyNew Component3DJointSlider(      pEngineCore, m_pComponentSystemManager ); break;
+    case ComponentType_3DCollisionObject:   pComponent = NewComponent<Component3DCollisionObject>(  pEngineCore ); break;
+    case ComponentType_3DJointPoint2Point:  pComponent = NewComponent<Component3DJointPoint2Point>( pEngineCore ); break;
+    case ComponentType_3DJointHinge:        pComponent = NewComponent<Component3DJointHinge>(       pEngineCore ); break;
+    case ComponentType_3DJointSlider:       pComponent = NewComponent<Component3DJointSlider>(      pEngineCore ); break;
 #else
-    case ComponentType_3DCollisionObject:   pComponent = MyNew ComponentData(               pEngineCore, m_pComponentSystemManager ); break;
-    case ComponentType_3DJointPoint2Point:  pComponent = MyNew ComponentData(               pEngineCore, m_pComponentSystemManager ); break;
-    case ComponentType_3DJointHinge:        pComponent = MyNew ComponentData(               pEngineCore, m_pComponentSystemManager ); break;
-    case ComponentType_3DJointSlider:       pComponent = MyNew ComponentData(               pEngineCore, m_pComponentSystemManager ); break;
+    case ComponentType_3DCollisionObject:   pComponent = NewComponent<ComponentData>(               pEngineCore ); break;
+    case ComponentType_3DJointPoint2Point:  pComponent = NewComponent<ComponentData>(               pEngineCore ); break;
+    case ComponentType_3DJointHinge:        pComponent = NewComponent<ComponentData>(               pEngineCore ); break;
+    case ComponentType_3DJointSlider:       pComponent = NewComponent<ComponentData>(               pEngineCore ); break;
 #endif
 #if MYFW_USING_BOX2D
-    case ComponentType_2DCollisionObject:   pComponent = MyNew Component2DCollisionObject(  pEngineCore, m_pComponentSystemManager ); break;
-    case ComponentType_2DJointRevolute:     pComponent = MyNew Component2DJointRevolute(    pEngineCore, m_pComponentSystemManager ); break;
-    case ComponentType_2DJointPrismatic:    pComponent = MyNew Component2DJointPrismatic(   pEngineCore, m_pComponentSystemManager ); break;
-    case ComponentType_2DJointWeld:         pComponent = MyNew Component2DJointWeld(        pEngineCore, m_pComponentSystemManager ); break;
+    case ComponentType_2DCollisionObject:   pComponent = NewComponent<Component2DCollisionObject>(  pEngineCore ); break;
+    case ComponentType_2DJointRevolute:     pComponent = NewComponent<Component2DJointRevolute>(    pEngineCore ); break;
+    case ComponentType_2DJointPrismatic:    pComponent = NewComponent<Component2DJointPrismatic>(   pEngineCore ); break;
+    case ComponentType_2DJointWeld:         pComponent = NewComponent<Component2DJointWeld>(        pEngineCore ); break;
 #else
-    case ComponentType_2DCollisionObject:   pComponent = MyNew ComponentData(               pEngineCore, m_pComponentSystemManager ); break;
-    case ComponentType_2DJointRevolute:     pComponent = MyNew ComponentData(               pEngineCore, m_pComponentSystemManager ); break;
-    case ComponentType_2DJointPrismatic:    pComponent = MyNew ComponentData(               pEngineCore, m_pComponentSystemManager ); break;
-    case ComponentType_2DJointWeld:         pComponent = MyNew ComponentData(               pEngineCore, m_pComponentSystemManager ); break;
+    case ComponentType_2DCollisionObject:   pComponent = NewComponent<ComponentData>(               pEngineCore ); break;
+    case ComponentType_2DJointRevolute:     pComponent = NewComponent<ComponentData>(               pEngineCore ); break;
+    case ComponentType_2DJointPrismatic:    pComponent = NewComponent<ComponentData>(               pEngineCore ); break;
+    case ComponentType_2DJointWeld:         pComponent = NewComponent<ComponentData>(               pEngineCore ); break;
 #endif
 #if MYFW_USING_LUA
-    case ComponentType_LuaScript:           pComponent = MyNew ComponentLuaScript(          pEngineCore, m_pComponentSystemManager ); break;
+    case ComponentType_LuaScript:           pComponent = NewComponent<ComponentLuaScript>(          pEngineCore ); break;
 #else
-    case ComponentType_LuaScript:           pComponent = MyNew ComponentData(               pEngineCore, m_pComponentSystemManager ); break;
+    case ComponentType_LuaScript:           pComponent = NewComponent<ComponentData>(               pEngineCore ); break;
 #endif //MYFW_USING_LUA
 #if MYFW_USING_MONO
-    case ComponentType_MonoScript:          pComponent = MyNew ComponentMonoScript(         pEngineCore, m_pComponentSystemManager ); break;
+    case ComponentType_MonoScript:          pComponent = NewComponent<ComponentMonoScript>(         pEngineCore ); break;
 #else
-    case ComponentType_MonoScript:          pComponent = MyNew ComponentData(               pEngineCore, m_pComponentSystemManager ); break;
+    case ComponentType_MonoScript:          pComponent = NewComponent<ComponentData>(               pEngineCore ); break;
 #endif //MYFW_USING_MONO
-    case ComponentType_ParticleEmitter:     pComponent = MyNew ComponentParticleEmitter(    pEngineCore, m_pComponentSystemManager ); break;
-    case ComponentType_AnimationPlayer:     pComponent = MyNew ComponentAnimationPlayer(    pEngineCore, m_pComponentSystemManager ); break;
-    case ComponentType_AnimationPlayer2D:   pComponent = MyNew ComponentAnimationPlayer2D(  pEngineCore, m_pComponentSystemManager ); break;
-    case ComponentType_AudioPlayer:         pComponent = MyNew ComponentAudioPlayer(        pEngineCore, m_pComponentSystemManager ); break;
-    case ComponentType_ObjectPool:          pComponent = MyNew ComponentObjectPool(         pEngineCore, m_pComponentSystemManager ); break;
-    case ComponentType_MenuPage:            pComponent = MyNew ComponentMenuPage(           pEngineCore, m_pComponentSystemManager ); break;
+    case ComponentType_ParticleEmitter:     pComponent = NewComponent<ComponentParticleEmitter>(    pEngineCore ); break;
+    case ComponentType_AnimationPlayer:     pComponent = NewComponent<ComponentAnimationPlayer>(    pEngineCore ); break;
+    case ComponentType_AnimationPlayer2D:   pComponent = NewComponent<ComponentAnimationPlayer2D>(  pEngineCore ); break;
+    case ComponentType_AudioPlayer:         pComponent = NewComponent<ComponentAudioPlayer>(        pEngineCore ); break;
+    case ComponentType_ObjectPool:          pComponent = NewComponent<ComponentObjectPool>(         pEngineCore ); break;
+    case ComponentType_MenuPage:            pComponent = NewComponent<ComponentMenuPage>(           pEngineCore ); break;
     }
 
     MyAssert( pComponent != nullptr );
@@ -15,12 +15,29 @@
 #include "ComponentSystem/Core/ComponentSystemManager.h"
 #include "ComponentSystem/Core/EngineFileManager.h"
 #include "ComponentSystem/Core/GameObject.h"
+#include "ComponentSystem/Core/ParticleSystemManager.h"
+#include "ComponentSystem/Core/PrefabInstantiationTemplate.h"
+#include "ComponentSystem/Core/RenderGraph_BVH.h"
+#include "ComponentSystem/Core/RenderTargetPool.h"
+#include "ComponentSystem/Core/SceneLoader.h"
+#include "ComponentSystem/Core/SpriteBatcher.h"
+#include "ComponentSystem/EngineComponents/ComponentObjectPool.h"
+#include "ComponentSystem/FrameworkComponents/ComponentCameraShadow.h"
 #include "ComponentSystem/FrameworkComponents/ComponentMesh.h"
 #include "Core/EngineComponentTypeManager.h"
 #include "Core/LuaGameState.h"
 #if MYFW_USING_MONO
 #include "Mono/MonoGameState.h"
 #endif
+#if MYFW_USING_BOX2D
+#include "Physics/EngineBox2DContactListener.h"
+#endif
+#if MYFW_USING_BULLET
+#include "Physics/BulletStressBenchmark.h"
+#endif
+#if MYFW_USING_BULLET_MT
+#include "Physics/BulletTaskScheduler.h"
+#endif
 #include "../../../Framework/MyFramework/SourceCommon/Renderers/BaseClasses/Renderer_Base.h"
 #include "../../../SharedGameCode/Core/MyMeshText.h"
 #include "../../../SharedGameCode/Core/RenderTextQuick.h"
@@ -52,6 +69,7 @@ EngineCore::EngineCore(Renderer_Base* pRenderer, bool createAndOwnGlobalManagers
 
     m_pImGuiManager = nullptr;
     m_pBulletWorld = nullptr;
+    m_CreateMultithreadedBulletWorld = MYFW_USING_BULLET_MT ? true : false;
 
 #if MYFW_USING_LUA
     m_pLuaGameState = nullptr;
@@ -503,11 +521,11 @@ void EngineCore::OneTimeInit()
     // Create one bullet world shared between all scenes.
 #if !MYFW_EDITOR
     // Disable debug draw in non-editor builds.
-    m_pBulletWorld = MyNew BulletWorld( 0, 0, 0 );
+    m_pBulletWorld = MyNew BulletWorld( 0, 0, 0, m_CreateMultithreadedBulletWorld );
 #else
     ComponentCamera* pCamera = m_pEditorState->GetEditorCamera();
 #if MYFW_USING_BULLET
-    m_pBulletWorld = MyNew BulletWorld( m_pMaterial_Box2DDebugDraw, &pCamera->m_Camera3D.m_matProj, &pCamera->m_Camera3D.m_matView );
+    m_pBulletWorld = MyNew BulletWorld( m_pMaterial_Box2DDebugDraw, &pCamera->m_Camera3D.m_matProj, &pCamera->m_Camera3D.m_matView, m_CreateMultithreadedBulletWorld );
 #endif
 #endif
 
@@ -770,6 +788,7 @@ float EngineCore::Tick(float deltaTime)
 #endif //MYFW_PROFILING_ENABLED && MYFW_EDITOR
 
 #if MYFW_USING_BULLET
+        // Steps bullet at a fixed rate, bodies are interpolated between the last 2 steps in Component3DCollisionObject.
         m_pBulletWorld->PhysicsUpdate( deltaTime );
 #endif
 
@@ -791,6 +810,18 @@ float EngineCore::Tick(float deltaTime)
             }
         }
 
+#if MYFW_USING_BOX2D
+        // Dispatch any contact events queued during the steps above.
+        //     Done outside of b2World::Step so handlers can safely create and destroy bodies.
+        for( int i=0; i<MAX_SCENES_LOADED_INCLUDING_UNMANAGED; i++ )
+        {
+            if( m_pComponentSystemManager->m_pSceneInfoMap[i].m_InUse && m_pComponentSystemManager->m_pSceneInfoMap[i].m_pBox2DContactListener )
+            {
+                m_pComponentSystemManager->m_pSceneInfoMap[i].m_pBox2DContactListener->DispatchEvents();
+            }
+        }
+#endif //MYFW_USING_BOX2D
+
 #if MYFW_PROFILING_ENABLED && MYFW_EDITOR
         double Physics_Timing_End = MyTime_GetSystemTime();
 
@@ -918,6 +949,10 @@ void EngineCore::OnDrawFrameStart(unsigned int canvasid)
 {
     GameCore::OnDrawFrameStart( canvasid );
 
+    // Batch meshes filled last frame are free to be refilled.
+    if( m_pComponentSystemManager )
+        m_pComponentSystemManager->m_pSpriteBatcher->StartFrame();
+
 #if !MYFW_EDITOR
     if( m_pImGuiManager )
     {
@@ -1143,11 +1178,163 @@ void EngineCore::OnDrawFrame(unsigned int canvasid)
         ImGui::PlotLines( "Tick",          &m_FrameTimingInfo[start].Tick,              numsamplestoshow, 0, "", 0.0f, 1000/60.0f, ImVec2(0,20), sizeof(FrameTimingInfo) );
 
         ImGui::PlotLines( "Physics",       &m_FrameTimingInfo[start].Update_Physics,    numsamplestoshow, 0, "", 0.0f, 1000/60.0f, ImVec2(0,20), sizeof(FrameTimingInfo) );
+#if MYFW_USING_BULLET
+        if( m_pBulletWorld && m_pBulletWorld->m_UseFixedTimeStep )
+        {
+            ImGui::Text( "Bullet Steps: %d (%0.2f ms, longest %0.2f ms)", m_pBulletWorld->m_StepsLastUpdate, m_pBulletWorld->m_StepTimeLastUpdate, m_pBulletWorld->m_LongestStepTimeLastUpdate );
+            ImGui::Text( "Bullet Steps Dropped: %d", m_pBulletWorld->m_TotalStepsDropped );
+        }
+#if MYFW_USING_BULLET_MT
+        if( m_pBulletWorld && m_pBulletWorld->IsMultithreaded() )
+        {
+            int numThreads = m_pBulletWorld->m_pTaskScheduler->getNumThreads();
+            if( ImGui::SliderInt( "Bullet Threads", &numThreads, 1, m_pBulletWorld->m_pTaskScheduler->getMaxNumThreads() ) )
+                m_pBulletWorld->SetNumThreads( numThreads );
+        }
+#endif //MYFW_USING_BULLET_MT
+        if( ImGui::Button( "Run Bullet Stress Benchmark" ) )
+        {
+            // Steps a 4000 box pile in a single threaded and a multithreaded world, results are logged.
+            BulletStressBenchmark::RunComparison( 4000, 300 );
+        }
+        for( int i=0; i<2; i++ )
+        {
+            const BulletStressBenchmark::Results& results = BulletStressBenchmark::GetLastResults( i == 1 );
+            if( results.m_NumSteps > 0 )
+            {
+                ImGui::Text( "Bullet Benchmark %s: %0.3f ms per step", results.m_Multithreaded ? "MT" : "ST", results.m_TotalTime / results.m_NumSteps );
+            }
+        }
+#endif //MYFW_USING_BULLET
 #if MYFW_EDITOR
         ImGui::PlotLines( "Render Editor", &m_FrameTimingInfo[start].Render_Editor,     numsamplestoshow, 0, "", 0.0f, 1000/60.0f, ImVec2(0,20), sizeof(FrameTimingInfo) );
 #endif
         ImGui::PlotLines( "Render Game",   &m_FrameTimingInfo[start].Render_Game,       numsamplestoshow, 0, "", 0.0f, 1000/60.0f, ImVec2(0,20), sizeof(FrameTimingInfo) );
 
+        if( m_pComponentSystemManager )
+        {
+            // Particle throughput for the last frame, culled and throttled emitters aren't included in the time.
+            ParticleSystemManager* pParticleSystemManager = m_pComponentSystemManager->m_pParticleSystemManager;
+            const ParticleSystemManager::Stats& stats = pParticleSystemManager->GetStats();
+            ImGui::Text( "Particles: %d (%0.3f ms, %0.0f per ms)", stats.m_ParticlesSimulated, stats.m_UpdateTime, stats.m_UpdateTime > 0 ? stats.m_ParticlesSimulated / stats.m_UpdateTime : 0 );
+            ImGui::Text( "Particles Skipped: %d  Culled: %d", stats.m_ParticlesSkipped, stats.m_ParticlesCulled );
+            ImGui::Text( "Emitters: %d (Updated: %d  Throttled: %d  Over Budget: %d  Culled: %d)", pParticleSystemManager->GetNumberOfEmitters(), stats.m_EmittersUpdated, stats.m_EmittersThrottled, stats.m_EmittersOverBudget, stats.m_EmittersCulled );
+        }
+
+        {
+            // Deferred point lights for all cameras since the last time this window was drawn.
+            ComponentCamera::DeferredLightStats& stats = ComponentCamera::m_DeferredLightStats;
+            ImGui::Text( "Deferred Lights: %d drawn (Outside: %d  Inside: %d)", stats.m_LightsDrawnFromOutside + stats.m_LightsDrawnFromInside, stats.m_LightsDrawnFromOutside, stats.m_LightsDrawnFromInside );
+            ImGui::Text( "Deferred Lights Culled: Frustum: %d  Size: %d", stats.m_LightsCulledByFrustum, stats.m_LightsCulledBySize );
+            memset( &stats, 0, sizeof(ComponentCamera::DeferredLightStats) );
+        }
+
+        {
+            // Render graph culling for all cameras since the last time this window was drawn.
+            RenderGraph_BVH::CullStats& stats = RenderGraph_BVH::m_CullStats;
+            ImGui::Text( "Render Graph: Drawn: %d  Reinserts: %d", stats.m_ObjectsDrawn, stats.m_Reinserts );
+            ImGui::Text( "Render Graph Nodes: Tested: %d  Culled: %d  Fully Inside: %d", stats.m_NodesTested, stats.m_NodesCulled, stats.m_NodesFullyInside );
+            memset( &stats, 0, sizeof(RenderGraph_BVH::CullStats) );
+        }
+
+        if( m_pComponentSystemManager )
+        {
+            // Times the tree cull against testing every object, from the first camera's view.
+            RenderGraph_BVH* pRenderGraph = m_pComponentSystemManager->GetRenderGraph();
+            if( ImGui::Button( "Benchmark Render Graph Cull" ) )
+            {
+                ComponentCamera* pCamera = m_pComponentSystemManager->GetFirstCamera( true );
+                if( pCamera )
+                {
+                    MyMatrix* pMatViewProj = pCamera->m_Orthographic ? &pCamera->m_Camera2D.m_matViewProj : &pCamera->m_Camera3D.m_matViewProj;
+                    pRenderGraph->BenchmarkCull( pMatViewProj, 100 );
+                }
+            }
+
+            const RenderGraph_BVH::BenchmarkResults& results = pRenderGraph->GetLastBenchmarkResults();
+            if( results.m_Iterations > 0 )
+            {
+                ImGui::Text( "Cull Benchmark: %d objects, %d culls each", results.m_NumObjects, results.m_Iterations );
+                ImGui::Text( "Cull Benchmark: Tree: %0.4f ms (%d visible)  Brute Force: %0.4f ms (%d visible)",
+                    results.m_TreeCullTime, results.m_TreeVisible, results.m_BruteForceCullTime, results.m_BruteForceVisible );
+            }
+        }
+
+        {
+            // Shadow casters for all shadow cameras since the last time this window was drawn.
+            ComponentCameraShadow::ShadowCasterStats& stats = ComponentCameraShadow::m_ShadowCasterStats;
+            ImGui::Text( "Shadow Casters: Static: %d  Dynamic: %d  Culled Nodes: %d", stats.m_StaticCastersDrawn, stats.m_DynamicCastersDrawn, stats.m_CastersCulled );
+            ImGui::Text( "Shadow Static Depth Rebuilds: %d", stats.m_StaticDepthRebuilds );
+            memset( &stats, 0, sizeof(ComponentCameraShadow::ShadowCasterStats) );
+        }
+
+        if( m_pComponentSystemManager )
+        {
+            // Batched sprites for the last camera pass drawn.
+            SpriteBatcher* pSpriteBatcher = m_pComponentSystemManager->m_pSpriteBatcher;
+            const SpriteBatcher::Stats& stats = pSpriteBatcher->GetStats();
+            ImGui::Text( "Sprites: %d (Drawn: %d in %d batches  Culled: %d)", pSpriteBatcher->GetNumberOfSprites(), stats.m_SpritesBatched, stats.m_Batches, stats.m_SpritesCulled );
+        }
+
+        if( m_pComponentSystemManager )
+        {
+            // Post effect render targets, acquire/create/free counts since the last time this window was drawn.
+            RenderTargetPool* pRenderTargetPool = m_pComponentSystemManager->m_pRenderTargetPool;
+            RenderTargetPool::Stats& stats = pRenderTargetPool->GetStats();
+            ImGui::Text( "Render Targets: %d (In use: %d  Memory: %0.2f MB)", pRenderTargetPool->GetNumberOfTargets(), pRenderTargetPool->GetNumberOfTargetsInUse(), pRenderTargetPool->GetMemoryUsed() / (1024.0f * 1024.0f) );
+            ImGui::Text( "Render Targets: Acquired: %d  Created: %d  Freed: %d", stats.m_TargetsAcquired, stats.m_TargetsCreated, stats.m_TargetsFreed );
+            memset( &stats, 0, sizeof(RenderTargetPool::Stats) );
+        }
+
+        {
+            // Prefab instances created from compiled templates since the last time this window was drawn.
+            PrefabInstantiationTemplate::Stats& stats = PrefabInstantiationTemplate::GetStats();
+            float spawnsPerSecond = stats.m_SpawnTime > 0 ? stats.m_Spawns / (stats.m_SpawnTime / 1000.0f) : 0;
+            ImGui::Text( "Prefab Spawns: %d (GameObjects: %d  Templates compiled: %d)", stats.m_Spawns, stats.m_GameObjectsCreated, stats.m_TemplatesCompiled );
+            ImGui::Text( "Prefab Spawns: %0.3f ms (%0.0f spawns/sec)", stats.m_SpawnTime, spawnsPerSecond );
+            memset( &stats, 0, sizeof(PrefabInstantiationTemplate::Stats) );
+        }
+
+        // Object pool stats.
+        {
+            ComponentObjectPool::Stats& stats = ComponentObjectPool::GetStats();
+            ImGui::Text( "Object Pool Warmup: %0.3f ms (Objects: %d)", stats.m_WarmupTime, stats.m_ObjectsWarmedUp );
+            ImGui::Text( "Object Pool Checkouts: %d (Empty: %d)  %0.3f ms", stats.m_Checkouts, stats.m_EmptyCheckouts, stats.m_CheckoutTime );
+            ImGui::Text( "Object Pool Returns: %d  %0.3f ms", stats.m_Returns, stats.m_ReturnTime );
+            memset( &stats, 0, sizeof(ComponentObjectPool::Stats) );
+        }
+
+        // Components currently registered for each callback.
+        {
+            ComponentSystemManager* pManager = m_pComponentSystemManager;
+            ImGui::Text( "Callbacks: Tick: %d  Draw: %d  OnSurfaceChanged: %d  OnFileRenamed: %d",
+                pManager->m_ComponentCallbackList_Tick.GetCount(), pManager->m_ComponentCallbackList_Draw.GetCount(),
+                pManager->m_ComponentCallbackList_OnSurfaceChanged.GetCount(), pManager->m_ComponentCallbackList_OnFileRenamed.GetCount() );
+            ImGui::Text( "Callbacks: OnTouch: %d  OnButtons: %d  OnKeys: %d",
+                pManager->m_ComponentCallbackList_OnTouch.GetCount(), pManager->m_ComponentCallbackList_OnButtons.GetCount(),
+                pManager->m_ComponentCallbackList_OnKeys.GetCount() );
+        }
+
+        // Delete and transform changed observers, shared by all GameObjects and components.
+        {
+            ObserverPool* pPool = ObserverPool::Get();
+            ImGui::Text( "Observers: %d (Slots allocated: %d)", pPool->GetNumSlotsInUse(), pPool->GetNumSlotsAllocated() );
+        }
+
+        // Lazy transform updates and coalesced transform changed notifications.
+        {
+            ComponentTransform::Stats& stats = ComponentTransform::GetStats();
+            ImGui::Text( "Transforms Recalculated: %d  Notifications: %d (Queued: %d)", stats.m_WorldTransformsRecalculated, stats.m_NotificationsSent, stats.m_NotificationsQueued );
+            memset( &stats, 0, sizeof(ComponentTransform::Stats) );
+        }
+
+        {
+            // Not reset each frame, these are for the last scene loaded.
+            SceneLoader::Stats& stats = SceneLoader::GetStats();
+            ImGui::Text( "Last Scene Load: %0.2f ms (Split: %0.2f, Parse: %0.2f on %u jobs, Create: %0.2f, Import: %0.2f)",
+                stats.m_TotalTime, stats.m_SplitTime, stats.m_ParseTime, stats.m_JobsUsed, stats.m_CreateTime, stats.m_ImportTime );
+        }
+
         ImGui::End();
     }
 #endif //MYFW_PROFILING_ENABLED
@@ -1484,6 +1671,9 @@ void EngineCore::OnModeStop()
         // Unload all runtime created objects.
         UnloadScene( SCENEID_Unmanaged, false );
 
+        // Master prefab GameObjects can be changed in the editor, rebuild templates from them next time they're needed.
+        m_pComponentSystemManager->m_pPrefabManager->InvalidateAllInstantiationTemplates();
+
         m_Paused = false;
 
         // Reload the scene objects from the state they were in before "play" was pressed.
@@ -2165,7 +2355,7 @@ void EngineCore::RenderSingleObject(GameObject* pObject, FBODefinition* pFBOToUs
         {
             Vector3 objpos = pObject->GetTransform()->GetWorldPosition();
             Vector3 center(0,0,0);
-            ComponentRenderable* pComponent = (ComponentRenderable*)pObject->GetFirstComponentOfType( "RenderableComponent" );
+            ComponentRenderable* pComponent = (ComponentRenderable*)pObject->GetFirstComponentOfTypeID( ComponentTypeID_Renderable );
             if( pComponent )
             {
                 MyAABounds* pBounds = pComponent->GetBounds();
@@ -2231,7 +2421,7 @@ void EngineCore::SetGridVisible(bool visible)
 {
     if( m_pEditorState && m_pEditorState->m_p3DGridPlane )
     {
-        ComponentMesh* pComponentMesh = (ComponentMesh*)m_pEditorState->m_p3DGridPlane->GetFirstComponentOfType( "MeshComponent" );
+        ComponentMesh* pComponentMesh = (ComponentMesh*)m_pEditorState->m_p3DGridPlane->GetFirstComponentOfTypeID( ComponentTypeID_Mesh );
         pComponentMesh->SetVisible( visible );
     }
 }
@@ -89,6 +89,7 @@ protected:
 
     ImGuiManager* m_pImGuiManager;
     BulletWorld* m_pBulletWorld;
+    bool m_CreateMultithreadedBulletWorld; // Set before OneTimeInit, only works if MYFW_USE_BULLET_MT is set.
 
 #if MYFW_USING_LUA
     LuaGameState* m_pLuaGameState;
@@ -0,0 +1,200 @@
+//
+// Copyright (c) 2020 Jimmy Lord http://www.flatheadgames.com
+//
+// This software is provided 'as-is', without any express or implied warranty.  In no event will the authors be held liable for any damages arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+
+#include "MyEnginePCH.h"
+
+#include "RandomStream.h"
+
+#include <atomic>
+
+static inline uint32 RotateLeft(uint32 value, int bits)
+{
+    return (value << bits) | (value >> (32 - bits));
+}
+
+// Convert the top 24 bits to a float in [0, 1).
+static inline float UInt32ToFloat(uint32 value)
+{
+    return (value >> 8) * (1.0f / 16777216.0f);
+}
+
+// Same steps as NextUInt32(), once for each of the 4 lanes.
+static inline void StepLanes(uint32* s0, uint32* s1, uint32* s2, uint32* s3, uint32* pResults)
+{
+    for( int lane=0; lane<4; lane++ )
+    {
+        pResults[lane] = RotateLeft( s1[lane] * 5, 7 ) * 9;
+        uint32 t = s1[lane] << 9;
+
+        s2[lane] ^= s0[lane];
+        s3[lane] ^= s1[lane];
+        s1[lane] ^= s2[lane];
+        s0[lane] ^= s3[lane];
+        s2[lane] ^= t;
+        s3[lane] = RotateLeft( s3[lane], 11 );
+    }
+}
+
+RandomStream::RandomStream()
+{
+    SetSeed( GenerateUniqueSeed() );
+}
+
+RandomStream::RandomStream(uint64 seed)
+{
+    SetSeed( seed );
+}
+
+uint64 RandomStream::SplitMix64(uint64& state)
+{
+    state += 0x9E3779B97F4A7C15ULL;
+    uint64 z = state;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+void RandomStream::SetSeed(uint64 seed)
+{
+    // Spread the seed out with splitmix64, xoshiro doesn't like mostly zero states.
+    uint64 a = SplitMix64( seed );
+    uint64 b = SplitMix64( seed );
+    m_State[0] = (uint32)a;
+    m_State[1] = (uint32)(a >> 32);
+    m_State[2] = (uint32)b;
+    m_State[3] = (uint32)(b >> 32);
+
+    for( int lane=0; lane<4; lane++ )
+    {
+        uint64 c = SplitMix64( seed );
+        uint64 d = SplitMix64( seed );
+        m_LaneState[0][lane] = (uint32)c;
+        m_LaneState[1][lane] = (uint32)(c >> 32);
+        m_LaneState[2][lane] = (uint32)d;
+        m_LaneState[3][lane] = (uint32)(d >> 32);
+    }
+}
+
+uint64 RandomStream::GenerateUniqueSeed()
+{
+    // Atomic since emitters can be created or replayed from job threads.
+    static std::atomic<uint64> s_Counter( 0 );
+    uint64 counter = s_Counter.fetch_add( 1 ) + 1;
+
+    // Mix in the time so separate runs differ, counter keeps streams created on the same tick apart.
+    uint64 seed = (uint64)(MyTime_GetSystemTime() * 1000000.0) ^ (counter * 0x9E3779B97F4A7C15ULL);
+    return SplitMix64( seed );
+}
+
+uint32 RandomStream::NextUInt32()
+{
+    uint32 result = RotateLeft( m_State[1] * 5, 7 ) * 9;
+    uint32 t = m_State[1] << 9;
+
+    m_State[2] ^= m_State[0];
+    m_State[3] ^= m_State[1];
+    m_State[1] ^= m_State[2];
+    m_State[0] ^= m_State[3];
+    m_State[2] ^= t;
+    m_State[3] = RotateLeft( m_State[3], 11 );
+
+    return result;
+}
+
+unsigned int RandomStream::NextUInt(unsigned int max)
+{
+    if( max == 0 )
+        return 0;
+
+    // Multiply-shift instead of modulo, avoids the divide and most of the bias.
+    return (unsigned int)(((uint64)NextUInt32() * max) >> 32);
+}
+
+float RandomStream::NextFloat()
+{
+    return UInt32ToFloat( NextUInt32() );
+}
+
+float RandomStream::NextFloat(float min, float max)
+{
+    return min + (max - min) * NextFloat();
+}
+
+void RandomStream::LoadLanes(uint32* s0, uint32* s1, uint32* s2, uint32* s3)
+{
+    for( int lane=0; lane<4; lane++ )
+    {
+        s0[lane] = m_LaneState[0][lane];
+        s1[lane] = m_LaneState[1][lane];
+        s2[lane] = m_LaneState[2][lane];
+        s3[lane] = m_LaneState[3][lane];
+    }
+}
+
+void RandomStream::StoreLanes(const uint32* s0, const uint32* s1, const uint32* s2, const uint32* s3)
+{
+    for( int lane=0; lane<4; lane++ )
+    {
+        m_LaneState[0][lane] = s0[lane];
+        m_LaneState[1][lane] = s1[lane];
+        m_LaneState[2][lane] = s2[lane];
+        m_LaneState[3][lane] = s3[lane];
+    }
+}
+
+void RandomStream::FillFloats(float* pOut, unsigned int count, float min, float max)
+{
+    float range = max - min;
+
+    // Work on local copies of the lane state, so the compiler knows pOut can't alias it.
+    uint32 s0[4], s1[4], s2[4], s3[4];
+    LoadLanes( s0, s1, s2, s3 );
+
+    unsigned int i = 0;
+    while( i < count )
+    {
+        uint32 results[4];
+        StepLanes( s0, s1, s2, s3, results );
+
+        for( int lane=0; lane<4 && i < count; lane++, i++ )
+            pOut[i] = min + range * UInt32ToFloat( results[lane] );
+    }
+
+    StoreLanes( s0, s1, s2, s3 );
+}
+
+void RandomStream::FillDirections(float* pOutX, float* pOutY, float* pOutZ, unsigned int count, Vector3 dir, Vector3 variation)
+{
+    Vector3 min = dir - variation * 0.5f;
+
+    uint32 s0[4], s1[4], s2[4], s3[4];
+    LoadLanes( s0, s1, s2, s3 );
+
+    // Each lane produces one particle's x, y and z per pass, so 4 directions are made per 3 lane steps.
+    unsigned int i = 0;
+    while( i < count )
+    {
+        uint32 resultsX[4];
+        uint32 resultsY[4];
+        uint32 resultsZ[4];
+        StepLanes( s0, s1, s2, s3, resultsX );
+        StepLanes( s0, s1, s2, s3, resultsY );
+        StepLanes( s0, s1, s2, s3, resultsZ );
+
+        for( int lane=0; lane<4 && i < count; lane++, i++ )
+        {
+            pOutX[i] = min.x + variation.x * UInt32ToFloat( resultsX[lane] );
+            pOutY[i] = min.y + variation.y * UInt32ToFloat( resultsY[lane] );
+            pOutZ[i] = min.z + variation.z * UInt32ToFloat( resultsZ[lane] );
+        }
+    }
+
+    StoreLanes( s0, s1, s2, s3 );
+}
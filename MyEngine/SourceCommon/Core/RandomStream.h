@@ -0,0 +1,51 @@
+//
+// Copyright (c) 2020 Jimmy Lord http://www.flatheadgames.com
+//
+// This software is provided 'as-is', without any express or implied warranty.  In no event will the authors be held liable for any damages arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+
+#ifndef __RandomStream_H__
+#define __RandomStream_H__
+
+// Small seeded random number generator (xoshiro128**), each owner keeps its own stream
+//     so results don't depend on other systems calling rand() and the same seed replays the same values.
+// The batch fill functions run 4 independent lanes side by side so the loops can be vectorized,
+//     the lanes are seeded from the main stream so they're still deterministic.
+class RandomStream
+{
+protected:
+    uint32 m_State[4];
+    uint32 m_LaneState[4][4]; // [StateWord][Lane], used by the batch functions.
+
+protected:
+    static uint64 SplitMix64(uint64& state);
+
+    void LoadLanes(uint32* s0, uint32* s1, uint32* s2, uint32* s3);
+    void StoreLanes(const uint32* s0, const uint32* s1, const uint32* s2, const uint32* s3);
+
+public:
+    RandomStream();
+    RandomStream(uint64 seed);
+
+    void SetSeed(uint64 seed);
+
+    // Returns a seed that's different every call, for streams that don't need to be reproducible.
+    static uint64 GenerateUniqueSeed();
+
+    uint32 NextUInt32();
+    unsigned int NextUInt(unsigned int max); // [0, max)
+    float NextFloat(); // [0, 1)
+    float NextFloat(float min, float max); // [min, max)
+
+    // Batch versions, fill pOut[0..count-1].
+    void FillFloats(float* pOut, unsigned int count, float min, float max);
+
+    // Fills 3 separate streams with dir +/- variation/2 on each axis, all 3 axes are generated in the same loop.
+    void FillDirections(float* pOutX, float* pOutY, float* pOutZ, unsigned int count, Vector3 dir, Vector3 variation);
+};
+
+#endif //__RandomStream_H__
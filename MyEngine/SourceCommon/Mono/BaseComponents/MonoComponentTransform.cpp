@@ -17,24 +17,14 @@
 #include "Mono/MonoGameState.h"
 #include "Mono/Framework/MonoFrameworkClasses.h"
 
+static MonoCachedClass s_ComponentTransformClass( "MyEngine", "ComponentTransform" );
+
 //============================================================================================================
 // Create a ComponentTransform object in managed memory and give it the pointer to the unmanaged object.
 //============================================================================================================
 MonoObject* Mono_ConstructComponentTransform(ComponentTransform* pObject)
 {
-    MonoClass* pClass = mono_class_from_name( MonoGameState::g_pMonoImage, "MyEngine", "ComponentTransform" );
-    if( pClass )
-    {
-        MonoObject* pInstance = mono_object_new( MonoGameState::g_pActiveDomain, pClass );
-        mono_runtime_object_init( pInstance );
-
-        MonoClassField* pField = mono_class_get_field_from_name( pClass, "m_pNativeObject" );
-        mono_field_set_value( pInstance, pField, &pObject );
-
-        return pInstance;
-    }
-
-    return nullptr;
+    return s_ComponentTransformClass.ConstructWrapper( pObject );
 }
 
 //============================================================================================================
@@ -17,23 +17,14 @@
 #include "Core/EngineCore.h"
 #include "Mono/MonoGameState.h"
 
+static MonoCachedClass s_Mat4Class( "MyEngine", "mat4" );
+
 //============================================================================================================
 // Helpers to create mat4 objects in managed memory.
 //============================================================================================================
 MonoObject* Mono_ConstructMat4()
 {
-    MonoClass* pClass = mono_class_from_name( MonoGameState::g_pMonoImage, "MyEngine", "mat4" );
-    if( pClass )
-    {
-        MonoObject* pInstance = mono_object_new( MonoGameState::g_pActiveDomain, pClass );
-
-        MonoMethod* pConstructor = mono_class_get_method_from_name( pClass, ".ctor", 0 );
-        mono_runtime_invoke( pConstructor, pInstance, nullptr, nullptr );
-
-        return pInstance;
-    }
-
-    return nullptr;
+    return s_Mat4Class.Construct();
 }
 
 //============================================================================================================
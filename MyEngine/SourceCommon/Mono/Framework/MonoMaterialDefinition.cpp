@@ -16,24 +16,14 @@
 #include "Mono/Framework/MonoMaterialDefinition.h"
 #include "Mono/Core/MonoGameObject.h"
 
+static MonoCachedClass s_MaterialClass( "MyEngine", "MyMaterial" );
+
 //============================================================================================================
 // Create a MaterialDefinition object in managed memory and give it the pointer to the unmanaged object.
 //============================================================================================================
 MonoObject* Mono_ConstructMaterialDefinition(MaterialDefinition* pObject)
 {
-    MonoClass* pClass = mono_class_from_name( MonoGameState::g_pMonoImage, "MyEngine", "MyMaterial" );
-    if( pClass )
-    {
-        MonoObject* pInstance = mono_object_new( MonoGameState::g_pActiveDomain, pClass );
-        mono_runtime_object_init( pInstance );
-
-        MonoClassField* pField = mono_class_get_field_from_name( pClass, "m_pNativeObject" );
-        mono_field_set_value( pInstance, pField, &pObject );
-
-        return pInstance;
-    }
-
-    return nullptr;
+    return s_MaterialClass.ConstructWrapper( pObject );
 }
 
 //============================================================================================================
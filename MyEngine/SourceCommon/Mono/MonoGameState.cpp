@@ -41,6 +41,81 @@
 
 MonoDomain* MonoGameState::g_pActiveDomain = nullptr;
 MonoImage* MonoGameState::g_pMonoImage = nullptr;
+unsigned int MonoGameState::g_ImageGeneration = 0;
+
+//============================================================================================================
+// MonoCachedClass.
+//============================================================================================================
+MonoCachedClass::MonoCachedClass(const char* nameSpace, const char* className)
+{
+    m_NameSpace = nameSpace;
+    m_ClassName = className;
+
+    m_ImageGeneration = 0;
+    m_pClass = nullptr;
+    m_pConstructor = nullptr;
+    m_NativeObjectFieldOffset = -1;
+}
+
+void MonoCachedClass::Resolve()
+{
+    m_ImageGeneration = MonoGameState::g_ImageGeneration;
+    m_pClass = nullptr;
+    m_pConstructor = nullptr;
+    m_NativeObjectFieldOffset = -1;
+
+    if( MonoGameState::g_pMonoImage == nullptr )
+        return;
+
+    m_pClass = mono_class_from_name( MonoGameState::g_pMonoImage, m_NameSpace, m_ClassName );
+    if( m_pClass )
+    {
+        m_pConstructor = mono_class_get_method_from_name( m_pClass, ".ctor", 0 );
+
+        MonoClassField* pField = mono_class_get_field_from_name( m_pClass, "m_pNativeObject" );
+        if( pField )
+            m_NativeObjectFieldOffset = mono_field_get_offset( pField );
+    }
+}
+
+MonoClass* MonoCachedClass::GetClass()
+{
+    if( m_ImageGeneration != MonoGameState::g_ImageGeneration )
+        Resolve();
+
+    return m_pClass;
+}
+
+MonoObject* MonoCachedClass::Construct()
+{
+    MonoClass* pClass = GetClass();
+    if( pClass == nullptr )
+        return nullptr;
+
+    MonoObject* pInstance = mono_object_new( MonoGameState::g_pActiveDomain, pClass );
+    if( m_pConstructor )
+        mono_runtime_invoke( m_pConstructor, pInstance, nullptr, nullptr );
+
+    return pInstance;
+}
+
+MonoObject* MonoCachedClass::ConstructWrapper(void* pNativeObject)
+{
+    MonoObject* pInstance = Construct();
+    if( pInstance == nullptr )
+        return nullptr;
+
+    // m_pNativeObject is an IntPtr, so it can be written directly without a GC write barrier.
+    MyAssert( m_NativeObjectFieldOffset != -1 );
+    if( m_NativeObjectFieldOffset != -1 )
+        *(void**)( (char*)pInstance + m_NativeObjectFieldOffset ) = pNativeObject;
+
+    return pInstance;
+}
+
+//============================================================================================================
+// MonoGameState.
+//============================================================================================================
 
 MonoGameState::MonoGameState(EngineCore* pEngineCore)
 {
@@ -86,6 +161,8 @@ MonoGameState::MonoGameState(EngineCore* pEngineCore)
 
 MonoGameState::~MonoGameState()
 {
+    ClearScriptClassInfo();
+
     mono_jit_cleanup( m_pCoreDomain );
 
     SAFE_RELEASE( m_pDLLFile );
@@ -97,6 +174,9 @@ MonoGameState::~MonoGameState()
 
 void MonoGameState::SetAsGlobalState()
 {
+    if( g_pMonoImage != m_pMonoImage )
+        g_ImageGeneration++;
+
     g_pActiveDomain = m_pActiveDomain;
     g_pMonoImage = m_pMonoImage;
 }
@@ -249,6 +329,62 @@ bool MonoGameState::IsRebuilding()
 }
 #endif //MYFW_EDITOR
 
+void MonoGameState::ClearScriptClassInfo()
+{
+    for( std::map<std::string, MonoScriptClassInfo*>::iterator it = m_ScriptClassInfo.begin(); it != m_ScriptClassInfo.end(); it++ )
+    {
+        delete it->second;
+    }
+
+    m_ScriptClassInfo.clear();
+}
+
+MonoScriptClassInfo* MonoGameState::GetScriptClassInfo(const char* className)
+{
+    if( m_pMonoImage == nullptr )
+        return nullptr;
+
+    std::map<std::string, MonoScriptClassInfo*>::iterator it = m_ScriptClassInfo.find( className );
+    if( it != m_ScriptClassInfo.end() )
+        return it->second;
+
+    // Classes that aren't found are stored as nullptr so the lookup isn't repeated until the next Rebuild().
+    MonoScriptClassInfo* pInfo = nullptr;
+
+    MonoClass* pClass = mono_class_from_name( m_pMonoImage, "", className );
+    if( pClass )
+    {
+        pInfo = MyNew MonoScriptClassInfo;
+        pInfo->m_pClass = pClass;
+        pInfo->m_pConstructor = mono_class_get_method_from_name( pClass, ".ctor", 0 );
+        pInfo->m_pGameObjectField = mono_class_get_field_from_name( pClass, "m_GameObject" );
+
+        MonoMethod* pMonoMethod;
+
+        pMonoMethod = mono_class_get_method_from_name( pClass, "OnLoad", 0 );
+        pInfo->m_pThunk_OnLoad = pMonoMethod ? mono_method_get_unmanaged_thunk( pMonoMethod ) : nullptr;
+
+        pMonoMethod = mono_class_get_method_from_name( pClass, "OnPlay", 0 );
+        pInfo->m_pThunk_OnPlay = pMonoMethod ? mono_method_get_unmanaged_thunk( pMonoMethod ) : nullptr;
+
+        pMonoMethod = mono_class_get_method_from_name( pClass, "OnStop", 0 );
+        pInfo->m_pThunk_OnStop = pMonoMethod ? mono_method_get_unmanaged_thunk( pMonoMethod ) : nullptr;
+
+        pMonoMethod = mono_class_get_method_from_name( pClass, "OnTouch", 6 );
+        pInfo->m_pThunk_OnTouch = pMonoMethod ? mono_method_get_unmanaged_thunk( pMonoMethod ) : nullptr;
+
+        pMonoMethod = mono_class_get_method_from_name( pClass, "OnButtons", 2 );
+        pInfo->m_pThunk_OnButtons = pMonoMethod ? mono_method_get_unmanaged_thunk( pMonoMethod ) : nullptr;
+
+        pMonoMethod = mono_class_get_method_from_name( pClass, "Update", 1 );
+        pInfo->m_pThunk_Update = pMonoMethod ? mono_method_get_unmanaged_thunk( pMonoMethod ) : nullptr;
+    }
+
+    m_ScriptClassInfo[className] = pInfo;
+
+    return pInfo;
+}
+
 bool MonoGameState::Rebuild()
 {
     // If the domain has been created and an assembly loaded, then destroy that domain and rebuild.
@@ -265,6 +401,10 @@ bool MonoGameState::Rebuild()
         m_pActiveDomain = nullptr;
         mono_image_close( m_pMonoImage );
         m_pMonoImage = nullptr;
+
+        // All cached class and field handles point into the old image.
+        ClearScriptClassInfo();
+        g_ImageGeneration++;
     }
 
     const char* pMonoDLLFilename = "Data/Mono/Game.dll";
@@ -14,6 +14,7 @@
 #error "Mono disabled for build, header shouldn't be included."
 #endif
 
+#include "mono/metadata/class.h"
 #include "mono/metadata/object-forward.h"
 #include "mono/utils/mono-forward.h"
 
@@ -23,6 +24,48 @@
 //#define fixVec3(x)       ((Vector3*)(((char*)x)+MONO_VTABLE_AND_LOCK_BYTES))
 //#define fixMat4(x)      ((MyMatrix*)(((char*)x)+MONO_VTABLE_AND_LOCK_BYTES))
 
+// Handles to a managed class in the global image, looked up by name once per assembly load.
+// Used by the Mono_Construct* helpers, which are called every time a native object is handed to C#.
+class MonoCachedClass
+{
+protected:
+    const char* m_NameSpace;
+    const char* m_ClassName;
+
+    unsigned int m_ImageGeneration; // Matches MonoGameState::g_ImageGeneration while the handles below are valid.
+    MonoClass* m_pClass;
+    MonoMethod* m_pConstructor;
+    int m_NativeObjectFieldOffset; // Offset of "m_pNativeObject" from the start of the object, -1 if the class has no such field.
+
+    void Resolve();
+
+public:
+    MonoCachedClass(const char* nameSpace, const char* className);
+
+    MonoClass* GetClass();
+
+    // Create an instance and call its parameterless constructor.
+    MonoObject* Construct();
+    // Create an instance and point its m_pNativeObject field at the native object.
+    MonoObject* ConstructWrapper(void* pNativeObject);
+};
+
+// Class, method and field handles for a script class, looked up by name once per assembly load.
+struct MonoScriptClassInfo
+{
+    MonoClass* m_pClass;
+    MonoMethod* m_pConstructor;
+    MonoClassField* m_pGameObjectField;
+
+    // Unmanaged thunks for the script interface methods, nullptr if the class doesn't implement them.
+    void* m_pThunk_OnLoad;
+    void* m_pThunk_OnPlay;
+    void* m_pThunk_OnStop;
+    void* m_pThunk_OnTouch;
+    void* m_pThunk_OnButtons;
+    void* m_pThunk_Update;
+};
+
 class MonoGameState
 {
 public:
@@ -30,6 +73,9 @@ public:
     static MonoDomain* g_pActiveDomain;
     static MonoImage* g_pMonoImage;
 
+    // Changes whenever g_pMonoImage is replaced, any cached class/field handles from an older generation are invalid.
+    static unsigned int g_ImageGeneration;
+
 protected:
     EngineCore* m_pEngineCore;
     MonoDomain* m_pCoreDomain;
@@ -39,6 +85,10 @@ protected:
     MonoDomain* m_pActiveDomain;
     MonoImage* m_pMonoImage;
 
+    std::map<std::string, MonoScriptClassInfo*> m_ScriptClassInfo;
+
+    void ClearScriptClassInfo();
+
 #if MYFW_EDITOR
     bool m_RebuildWhenCompileFinishes;
     JobWithCallbackFunction* m_pJob_RebuildDLL;
@@ -52,6 +102,9 @@ public:
     MonoDomain* GetActiveDomain() { return m_pActiveDomain; }
     MonoImage* GetImage() { return m_pMonoImage; }
 
+    // Returns nullptr if the class isn't in the loaded image, pointer is valid until the next Rebuild().
+    MonoScriptClassInfo* GetScriptClassInfo(const char* className);
+
     // Global State.
     // If multiple MonoGameStates exist, any registered C callback functions need to know which state to work with.
     // This means 2 mono functions from different core domains can't run simultaneously on 2 threads.
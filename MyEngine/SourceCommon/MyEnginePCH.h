@@ -28,6 +28,13 @@
 #define MYFW_USING_BULLET 1
 #endif
 
+// Multithreaded bullet world support, bullet itself also needs to be built with BT_THREADSAFE=1.
+#if MYFW_USING_BULLET && defined(MYFW_USE_BULLET_MT) && MYFW_USE_BULLET_MT == 1
+#define MYFW_USING_BULLET_MT 1
+#else
+#define MYFW_USING_BULLET_MT 0
+#endif
+
 const int g_NumberOfVisibilityLayers = 8;
 
 //============================================================================================================
@@ -59,6 +66,11 @@ const int g_NumberOfVisibilityLayers = 8;
 #if MYFW_USING_BULLET
 #include "../../Libraries/bullet3/src/btBulletDynamicsCommon.h"
 #endif
+#if MYFW_USING_BULLET_MT
+#include "../../Libraries/bullet3/src/BulletCollision/CollisionDispatch/btCollisionDispatcherMt.h"
+#include "../../Libraries/bullet3/src/BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h"
+#include "../../Libraries/bullet3/src/BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolverMt.h"
+#endif
 #if MYFW_WINDOWS
 #pragma warning( pop )
 #endif
@@ -0,0 +1,493 @@
+//
+// Copyright (c) 2020 Jimmy Lord http://www.flatheadgames.com
+//
+// This software is provided 'as-is', without any express or implied warranty.  In no event will the authors be held liable for any damages arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+
+#include "MyEnginePCH.h"
+
+#include "BulletShapeCache.h"
+#include "BulletCollision/CollisionShapes/btShapeHull.h"
+#include "ComponentSystem/FrameworkComponents/Physics3D/Component3DCollisionObject.h"
+
+#if !MYFW_WINDOWS
+#include <sys/stat.h>
+#endif
+
+#if MYFW_USING_BULLET
+
+static const unsigned int CookedHullVersion = 3;
+static const char* CookedHullFolder = "Cache/Hulls";
+
+//====================================================================================================
+// BulletHullBuildJob
+//====================================================================================================
+
+class BulletHullBuildJob : public MyJob
+{
+public:
+    btAlignedObjectArray<btVector3> m_SourcePoints; // Copied from the mesh before the job is queued.
+    btAlignedObjectArray<btVector3> m_HullPoints;
+
+public:
+    virtual void DoWork()
+    {
+        // Same settings as the hulls that used to be built in Component3DCollisionObject::CreateBody().
+        btConvexHullShape sourceShape( &m_SourcePoints[0].getX(), m_SourcePoints.size(), sizeof(btVector3) );
+        sourceShape.setMargin( 0.2f );
+
+        btShapeHull hull( &sourceShape );
+        hull.buildHull( sourceShape.getMargin() );
+
+        m_HullPoints.resize( hull.numVertices() );
+        for( int i=0; i<hull.numVertices(); i++ )
+        {
+            m_HullPoints[i] = hull.getVertexPointer()[i];
+        }
+    }
+};
+
+//====================================================================================================
+// BulletShapeCache
+//====================================================================================================
+
+bool BulletShapeCache::HullKey::operator<(const HullKey& other) const
+{
+    if( m_pMesh != other.m_pMesh ) return m_pMesh < other.m_pMesh;
+    return m_Stamp < other.m_Stamp;
+}
+
+bool BulletShapeCache::ShapeKey::operator<(const ShapeKey& other) const
+{
+    if( m_PrimitiveType != other.m_PrimitiveType ) return m_PrimitiveType < other.m_PrimitiveType;
+    if( m_Hull.m_pMesh != other.m_Hull.m_pMesh ) return m_Hull.m_pMesh < other.m_Hull.m_pMesh;
+    if( m_Hull.m_Stamp != other.m_Hull.m_Stamp ) return m_Hull.m_Stamp < other.m_Hull.m_Stamp;
+
+    if( m_Dimensions.x != other.m_Dimensions.x ) return m_Dimensions.x < other.m_Dimensions.x;
+    if( m_Dimensions.y != other.m_Dimensions.y ) return m_Dimensions.y < other.m_Dimensions.y;
+    if( m_Dimensions.z != other.m_Dimensions.z ) return m_Dimensions.z < other.m_Dimensions.z;
+    if( m_Scale.x != other.m_Scale.x ) return m_Scale.x < other.m_Scale.x;
+    if( m_Scale.y != other.m_Scale.y ) return m_Scale.y < other.m_Scale.y;
+    return m_Scale.z < other.m_Scale.z;
+}
+
+BulletShapeCache::BulletShapeCache()
+{
+    m_BuildHullsOnJobThread = true;
+}
+
+BulletShapeCache::~BulletShapeCache()
+{
+    for( std::map<ShapeKey, ShapeEntry>::iterator it = m_Shapes.begin(); it != m_Shapes.end(); it++ )
+    {
+        delete it->second.m_pShape;
+    }
+    m_Shapes.clear();
+    m_ShapeKeys.clear();
+
+    for( std::map<HullKey, HullEntry>::iterator it = m_Hulls.begin(); it != m_Hulls.end(); it++ )
+    {
+        if( it->second.m_pJob )
+        {
+            g_pEngineCore->GetManagers()->GetJobManager()->WaitForJobToComplete( it->second.m_pJob );
+            SAFE_DELETE( it->second.m_pJob );
+        }
+
+        it->first.m_pMesh->Release();
+    }
+    m_Hulls.clear();
+}
+
+// Changes each time the mesh's file is reloaded with different contents, cheap enough to call every time a shape is requested.
+//     Meshes built in code have no file, those are stamped by vert count only.
+unsigned int BulletShapeCache::CalculateMeshStamp(MyMesh* pMesh)
+{
+    unsigned int stamp = 2166136261u;
+    stamp = (stamp ^ pMesh->GetNumVerts()) * 16777619u;
+
+    MyFileObject* pFile = pMesh->GetFile();
+    if( pFile == nullptr )
+        return stamp;
+
+#if MYFW_WINDOWS
+    stamp = (stamp ^ pFile->GetFileLastWriteTime().dwHighDateTime) * 16777619u;
+    stamp = (stamp ^ pFile->GetFileLastWriteTime().dwLowDateTime) * 16777619u;
+#else
+    stamp = (stamp ^ (unsigned int)pFile->GetFileLastWriteTime()) * 16777619u;
+#endif
+    stamp = (stamp ^ (unsigned int)pFile->GetFileLength()) * 16777619u;
+
+    return stamp;
+}
+
+btCollisionShape* BulletShapeCache::AcquireShape(int primitiveType, MyMesh* pMesh, Vector3 dimensions, Vector3 scale)
+{
+    ShapeKey key;
+    key.m_PrimitiveType = primitiveType;
+    key.m_Hull.m_pMesh = nullptr;
+    key.m_Hull.m_Stamp = 0;
+    key.m_Dimensions = dimensions;
+    key.m_Scale = scale;
+
+    // Only keep the settings each primitive actually uses, so more objects end up sharing shapes.
+    if( primitiveType == PhysicsPrimitiveType_ConvexHull )
+    {
+        if( pMesh == nullptr || pMesh->IsReady() == false )
+            return nullptr;
+
+        key.m_Hull.m_pMesh = pMesh;
+        key.m_Hull.m_Stamp = CalculateMeshStamp( pMesh );
+        key.m_Dimensions = Vector3( 0, 0, 0 );
+    }
+    else if( primitiveType == PhysicsPrimitiveType_Sphere )
+    {
+        key.m_Dimensions = Vector3( dimensions.x, 0, 0 );
+    }
+    else if( primitiveType == PhysicsPrimitiveType_StaticPlane )
+    {
+        key.m_Dimensions = Vector3( 0, 0, 0 );
+    }
+
+    std::map<ShapeKey, ShapeEntry>::iterator it = m_Shapes.find( key );
+    if( it != m_Shapes.end() )
+    {
+        it->second.m_RefCount++;
+        return it->second.m_pShape;
+    }
+
+    btCollisionShape* pShape = CreateShape( key );
+    if( pShape == nullptr )
+        return nullptr;
+
+    ShapeEntry entry;
+    entry.m_pShape = pShape;
+    entry.m_RefCount = 1;
+    m_Shapes[key] = entry;
+    m_ShapeKeys[pShape] = key;
+
+    if( key.m_Hull.m_pMesh )
+        m_Hulls[key.m_Hull].m_RefCount++;
+
+    return pShape;
+}
+
+void BulletShapeCache::ReleaseShape(btCollisionShape* pShape)
+{
+    if( pShape == nullptr )
+        return;
+
+    std::map<btCollisionShape*, ShapeKey>::iterator keyIt = m_ShapeKeys.find( pShape );
+    MyAssert( keyIt != m_ShapeKeys.end() );
+    if( keyIt == m_ShapeKeys.end() )
+        return;
+
+    ShapeKey key = keyIt->second;
+
+    ShapeEntry& entry = m_Shapes[key];
+    MyAssert( entry.m_RefCount > 0 );
+    entry.m_RefCount--;
+    if( entry.m_RefCount > 0 )
+        return;
+
+    delete entry.m_pShape;
+    m_Shapes.erase( key );
+    m_ShapeKeys.erase( keyIt );
+
+    if( key.m_Hull.m_pMesh )
+        ReleaseHull( key.m_Hull );
+}
+
+btCollisionShape* BulletShapeCache::CreateShape(const ShapeKey& key)
+{
+    btCollisionShape* pShape = nullptr;
+
+    if( key.m_PrimitiveType == PhysicsPrimitiveType_ConvexHull )
+    {
+        if( key.m_Hull.m_pMesh == nullptr )
+            return nullptr;
+
+        HullEntry* pHull = FindOrBuildHull( key.m_Hull );
+        if( pHull == nullptr || pHull->m_IsReady == false )
+            return nullptr;
+
+        pShape = new btConvexHullShape( &pHull->m_Points[0].getX(), pHull->m_Points.size(), sizeof(btVector3) );
+    }
+    else if( key.m_PrimitiveType == PhysicsPrimitiveType_Cube )
+    {
+        pShape = new btBoxShape( btVector3(key.m_Dimensions.x/2, key.m_Dimensions.y/2, key.m_Dimensions.z/2) ); // half-extents
+    }
+    else if( key.m_PrimitiveType == PhysicsPrimitiveType_Sphere )
+    {
+        pShape = new btSphereShape( btScalar(key.m_Dimensions.x) );
+    }
+    else if( key.m_PrimitiveType == PhysicsPrimitiveType_StaticPlane )
+    {
+        // plane is flat on x/z and at origin, rigidbody will have transform to place plane in space.
+        pShape = new btStaticPlaneShape( btVector3(0, 1, 0), 0 );
+    }
+
+    if( pShape )
+    {
+        pShape->setLocalScaling( btVector3( key.m_Scale.x, key.m_Scale.y, key.m_Scale.z ) );
+    }
+
+    return pShape;
+}
+
+// Returns nullptr if the hull couldn't be built, the next request will try again.
+BulletShapeCache::HullEntry* BulletShapeCache::FindOrBuildHull(const HullKey& key)
+{
+    MyMesh* pMesh = key.m_pMesh;
+
+    std::map<HullKey, HullEntry>::iterator it = m_Hulls.find( key );
+    if( it != m_Hulls.end() )
+    {
+        HullEntry* pHull = &it->second;
+        if( pHull->m_pJob && pHull->m_pJob->IsFinished() )
+        {
+            FinishHull( key, pHull );
+
+            // Don't keep failed hulls around, they would block any retry for this mesh.
+            if( pHull->m_IsReady == false )
+            {
+                RemoveHull( key );
+                return nullptr;
+            }
+        }
+
+        return pHull;
+    }
+
+    if( pMesh->IsReady() == false )
+        return nullptr;
+
+    // The mesh changed or was reloaded, drop any hulls for its old contents that nothing uses.
+    RemoveUnusedHulls( pMesh );
+
+    unsigned int numVerts = pMesh->GetNumVerts();
+    if( numVerts == 0 )
+    {
+        LOGInfo( LOGTag, "Mesh has no verts, ConvexHull not created\n" );
+        return nullptr;
+    }
+
+    pMesh->AddRef();
+
+    HullEntry* pHull = &m_Hulls[key];
+    pHull->m_pJob = nullptr;
+    pHull->m_IsReady = false;
+    pHull->m_RefCount = 0;
+
+    if( LoadCookedHull( key, pHull ) )
+    {
+        pHull->m_IsReady = true;
+        return pHull;
+    }
+
+    // Copy the positions out on this thread, the job shouldn't touch the mesh.
+    // TODO: fix this, it assumes position at the start of the vertex format.
+    BulletHullBuildJob* pJob = MyNew BulletHullBuildJob;
+    unsigned int stride = pMesh->GetStride( 0 );
+    const char* pVerts = (const char*)pMesh->GetVerts( false );
+
+    pJob->m_SourcePoints.resize( numVerts );
+    for( unsigned int i=0; i<numVerts; i++ )
+    {
+        const float* pPos = (const float*)&pVerts[i*stride];
+        pJob->m_SourcePoints[i].setValue( pPos[0], pPos[1], pPos[2] );
+    }
+
+    pHull->m_pJob = pJob;
+
+    if( m_BuildHullsOnJobThread && g_pEngineCore->GetManagers()->GetJobManager() )
+    {
+        g_pEngineCore->GetManagers()->GetJobManager()->AddJob( pJob );
+    }
+    else
+    {
+        pJob->DoWork();
+        FinishHull( key, pHull );
+
+        if( pHull->m_IsReady == false )
+        {
+            RemoveHull( key );
+            return nullptr;
+        }
+    }
+
+    return pHull;
+}
+
+void BulletShapeCache::FinishHull(const HullKey& key, HullEntry* pHull)
+{
+    MyAssert( pHull->m_pJob );
+
+    pHull->m_Points = pHull->m_pJob->m_HullPoints;
+    pHull->m_IsReady = pHull->m_Points.size() > 0;
+    SAFE_DELETE( pHull->m_pJob );
+
+    if( pHull->m_IsReady )
+        SaveCookedHull( key, pHull );
+}
+
+void BulletShapeCache::ReleaseHull(const HullKey& key)
+{
+    std::map<HullKey, HullEntry>::iterator it = m_Hulls.find( key );
+    MyAssert( it != m_Hulls.end() );
+    if( it == m_Hulls.end() )
+        return;
+
+    MyAssert( it->second.m_RefCount > 0 );
+    it->second.m_RefCount--;
+    if( it->second.m_RefCount > 0 )
+        return;
+
+    // Only finished hulls have shapes, so there's no job to wait on.
+    MyAssert( it->second.m_pJob == nullptr );
+
+    RemoveHull( key );
+}
+
+void BulletShapeCache::RemoveHull(const HullKey& key)
+{
+    std::map<HullKey, HullEntry>::iterator it = m_Hulls.find( key );
+    if( it == m_Hulls.end() )
+        return;
+
+    MyAssert( it->second.m_RefCount == 0 );
+
+    if( it->second.m_pJob )
+    {
+        g_pEngineCore->GetManagers()->GetJobManager()->WaitForJobToComplete( it->second.m_pJob );
+        SAFE_DELETE( it->second.m_pJob );
+    }
+
+    m_Hulls.erase( it );
+    key.m_pMesh->Release();
+}
+
+void BulletShapeCache::RemoveUnusedHulls(MyMesh* pMesh)
+{
+    // Hulls are sorted by mesh first, so all hulls for this mesh are next to each other.
+    HullKey firstKey;
+    firstKey.m_pMesh = pMesh;
+    firstKey.m_Stamp = 0;
+
+    std::map<HullKey, HullEntry>::iterator it = m_Hulls.lower_bound( firstKey );
+    while( it != m_Hulls.end() && it->first.m_pMesh == pMesh )
+    {
+        HullKey key = it->first;
+        bool isUnused = it->second.m_RefCount == 0 && (it->second.m_pJob == nullptr || it->second.m_pJob->IsFinished());
+        it++;
+
+        if( isUnused )
+            RemoveHull( key );
+    }
+}
+
+// Cooked hulls go in a cache folder rather than next to the mesh, the mesh's path is flattened into the filename.
+static bool GetCookedHullFilename(MyMesh* pMesh, char* filename, int bufferSize)
+{
+    MyFileObject* pFile = pMesh->GetFile();
+    if( pFile == nullptr )
+        return false;
+
+    sprintf_s( filename, bufferSize, "%s/%s.myhull", CookedHullFolder, pFile->GetFullPath() );
+    int len = (int)strlen( filename );
+
+    for( int i=(int)strlen( CookedHullFolder ) + 1; i<len; i++ )
+    {
+        if( filename[i] == '/' || filename[i] == '\\' || filename[i] == ':' )
+            filename[i] = '_';
+    }
+
+    return true;
+}
+
+bool BulletShapeCache::LoadCookedHull(const HullKey& key, HullEntry* pHull)
+{
+    char filename[260];
+    if( GetCookedHullFilename( key.m_pMesh, filename, 260 ) == false )
+        return false;
+
+    FILE* file;
+#if MYFW_WINDOWS
+    fopen_s( &file, filename, "rb" );
+#else
+    file = fopen( filename, "rb" );
+#endif
+
+    if( file == nullptr )
+        return false;
+
+    // Header is version, number of source verts, the mesh stamp and number of hull points.
+    //     If the mesh changed since the hull was cooked, rebuild it.
+    unsigned int header[4] = { 0, 0, 0, 0 };
+    bool valid = fread( header, sizeof(unsigned int), 4, file ) == 4 &&
+                 header[0] == CookedHullVersion &&
+                 header[1] == key.m_pMesh->GetNumVerts() &&
+                 header[2] == key.m_Stamp &&
+                 header[3] > 0;
+
+    if( valid )
+    {
+        pHull->m_Points.resize( header[3] );
+        for( unsigned int i=0; i<header[3] && valid; i++ )
+        {
+            float pos[3];
+            valid = fread( pos, sizeof(float), 3, file ) == 3;
+            pHull->m_Points[i].setValue( pos[0], pos[1], pos[2] );
+        }
+    }
+
+    fclose( file );
+
+    if( valid == false )
+        pHull->m_Points.clear();
+
+    return valid;
+}
+
+void BulletShapeCache::SaveCookedHull(const HullKey& key, HullEntry* pHull)
+{
+#if MYFW_EDITOR
+    char filename[260];
+    if( GetCookedHullFilename( key.m_pMesh, filename, 260 ) == false )
+        return;
+
+#if MYFW_WINDOWS
+    CreateDirectoryA( "Cache", nullptr );
+    CreateDirectoryA( CookedHullFolder, nullptr );
+#else
+    mkdir( "Cache", 0755 );
+    mkdir( CookedHullFolder, 0755 );
+#endif
+
+    FILE* file;
+#if MYFW_WINDOWS
+    fopen_s( &file, filename, "wb" );
+#else
+    file = fopen( filename, "wb" );
+#endif
+
+    if( file == nullptr )
+        return;
+
+    unsigned int header[4] = { CookedHullVersion, key.m_pMesh->GetNumVerts(), key.m_Stamp, (unsigned int)pHull->m_Points.size() };
+    fwrite( header, sizeof(unsigned int), 4, file );
+
+    for( int i=0; i<pHull->m_Points.size(); i++ )
+    {
+        float pos[3] = { pHull->m_Points[i].getX(), pHull->m_Points[i].getY(), pHull->m_Points[i].getZ() };
+        fwrite( pos, sizeof(float), 3, file );
+    }
+
+    fclose( file );
+#endif //MYFW_EDITOR
+}
+
+#endif //MYFW_USING_BULLET
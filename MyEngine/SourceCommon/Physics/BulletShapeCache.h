@@ -0,0 +1,93 @@
+//
+// Copyright (c) 2020 Jimmy Lord http://www.flatheadgames.com
+//
+// This software is provided 'as-is', without any express or implied warranty.  In no event will the authors be held liable for any damages arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+
+#ifndef __BulletShapeCache_H__
+#define __BulletShapeCache_H__
+
+#if MYFW_USING_BULLET
+
+class BulletHullBuildJob;
+
+// Reference counted collision shapes shared between all collision objects with the same settings.
+//     Convex hulls are simplified once per mesh, optionally on a job thread,
+//     and cooked to "Cache/Hulls/<meshfile>.myhull" so they don't need to be rebuilt next run.
+//     Hulls are keyed on the mesh and a stamp of its file's write time and size, so a reloaded mesh gets a new hull.
+class BulletShapeCache
+{
+protected:
+    struct HullKey
+    {
+        MyMesh* m_pMesh;
+        unsigned int m_Stamp; // Mesh file's write time and size when the hull was requested.
+
+        bool operator<(const HullKey& other) const;
+    };
+
+    struct ShapeKey
+    {
+        int m_PrimitiveType;
+        HullKey m_Hull; // Only set for convex hulls.
+        Vector3 m_Dimensions;
+        Vector3 m_Scale;
+
+        bool operator<(const ShapeKey& other) const;
+    };
+
+    struct ShapeEntry
+    {
+        btCollisionShape* m_pShape;
+        unsigned int m_RefCount;
+    };
+
+    struct HullEntry
+    {
+        BulletHullBuildJob* m_pJob; // Only set while the hull is building.
+        btAlignedObjectArray<btVector3> m_Points;
+        bool m_IsReady;
+        unsigned int m_RefCount; // Number of shapes using this hull.
+    };
+
+    std::map<ShapeKey, ShapeEntry> m_Shapes;
+    std::map<btCollisionShape*, ShapeKey> m_ShapeKeys;
+    std::map<HullKey, HullEntry> m_Hulls;
+
+    bool m_BuildHullsOnJobThread;
+
+protected:
+    static unsigned int CalculateMeshStamp(MyMesh* pMesh);
+
+    HullEntry* FindOrBuildHull(const HullKey& key);
+    void FinishHull(const HullKey& key, HullEntry* pHull);
+    void ReleaseHull(const HullKey& key);
+    void RemoveHull(const HullKey& key);
+    void RemoveUnusedHulls(MyMesh* pMesh);
+
+    bool LoadCookedHull(const HullKey& key, HullEntry* pHull);
+    void SaveCookedHull(const HullKey& key, HullEntry* pHull);
+
+    btCollisionShape* CreateShape(const ShapeKey& key);
+
+public:
+    BulletShapeCache();
+    ~BulletShapeCache();
+
+    // Returns nullptr if the shape can't be made yet, i.e. the mesh isn't loaded or its hull is still building.
+    btCollisionShape* AcquireShape(int primitiveType, MyMesh* pMesh, Vector3 dimensions, Vector3 scale);
+    void ReleaseShape(btCollisionShape* pShape);
+
+    void SetBuildHullsOnJobThread(bool onJobThread) { m_BuildHullsOnJobThread = onJobThread; }
+
+    unsigned int GetNumberOfShapes() { return (unsigned int)m_Shapes.size(); }
+    unsigned int GetNumberOfHulls() { return (unsigned int)m_Hulls.size(); }
+};
+
+#endif //MYFW_USING_BULLET
+
+#endif //__BulletShapeCache_H__
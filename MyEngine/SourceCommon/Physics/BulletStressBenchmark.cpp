@@ -0,0 +1,121 @@
+//
+// Copyright (c) 2020 Jimmy Lord http://www.flatheadgames.com
+//
+// This software is provided 'as-is', without any express or implied warranty.  In no event will the authors be held liable for any damages arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+
+#include "MyEnginePCH.h"
+
+#include "BulletStressBenchmark.h"
+#include "BulletWorld.h"
+
+#if MYFW_USING_BULLET
+
+BulletStressBenchmark::Results BulletStressBenchmark::m_LastResults[2];
+
+BulletStressBenchmark::Results BulletStressBenchmark::Run(bool multithreaded, int numBodies, int numSteps)
+{
+    MyAssert( numBodies > 0 && numSteps > 0 );
+
+    // Creating a world replaces the global world pointer and the multithreaded world replaces bullet's task scheduler,
+    //     so hang onto both and put them back once the benchmark world is gone.
+    BulletWorld* pOldGlobalWorld = g_pBulletWorld;
+#if MYFW_USING_BULLET_MT
+    btITaskScheduler* pOldTaskScheduler = btGetTaskScheduler();
+#endif
+
+    BulletWorld* pWorld = MyNew BulletWorld( nullptr, nullptr, nullptr, multithreaded );
+
+    // Static ground plane.
+    {
+        btCollisionShape* pGroundShape = new btStaticPlaneShape( btVector3(0,1,0), 0 );
+        pWorld->m_CollisionShapes.push_back( pGroundShape );
+
+        btRigidBody::btRigidBodyConstructionInfo info( 0, nullptr, pGroundShape );
+        pWorld->m_pDynamicsWorld->addRigidBody( new btRigidBody( info ) );
+    }
+
+    // A column of boxes 20x20 wide, slightly offset each layer so the pile topples and stays busy.
+    btCollisionShape* pBoxShape = new btBoxShape( btVector3(0.5f, 0.5f, 0.5f) );
+    pWorld->m_CollisionShapes.push_back( pBoxShape );
+
+    btVector3 localInertia( 0, 0, 0 );
+    pBoxShape->calculateLocalInertia( 1, localInertia );
+
+    const int boxesPerSide = 20;
+    for( int i=0; i<numBodies; i++ )
+    {
+        int x = i % boxesPerSide;
+        int z = (i / boxesPerSide) % boxesPerSide;
+        int y = i / (boxesPerSide*boxesPerSide);
+
+        btTransform startTransform;
+        startTransform.setIdentity();
+        startTransform.setOrigin( btVector3( x*1.05f + y*0.1f, 0.6f + y*1.05f, z*1.05f + y*0.1f ) );
+
+        btDefaultMotionState* pMotionState = new btDefaultMotionState( startTransform );
+        btRigidBody::btRigidBodyConstructionInfo info( 1, pMotionState, pBoxShape, localInertia );
+        pWorld->m_pDynamicsWorld->addRigidBody( new btRigidBody( info ) );
+    }
+
+    Results results;
+    results.m_Multithreaded = pWorld->IsMultithreaded();
+    results.m_NumBodies = numBodies;
+    results.m_NumSteps = numSteps;
+    results.m_TotalTime = 0;
+    results.m_LongestStepTime = 0;
+    results.m_BodiesAwake = 0;
+
+    for( int i=0; i<numSteps; i++ )
+    {
+        double stepStart = MyTime_GetSystemTime();
+        pWorld->PhysicsStep();
+        float stepTime = (float)((MyTime_GetSystemTime() - stepStart)*1000);
+
+        results.m_TotalTime += stepTime;
+        if( stepTime > results.m_LongestStepTime )
+            results.m_LongestStepTime = stepTime;
+    }
+
+    for( int i=0; i<pWorld->m_pDynamicsWorld->getNumCollisionObjects(); i++ )
+    {
+        if( pWorld->m_pDynamicsWorld->getCollisionObjectArray()[i]->isActive() )
+            results.m_BodiesAwake++;
+    }
+
+    SAFE_DELETE( pWorld );
+
+    g_pBulletWorld = pOldGlobalWorld;
+#if MYFW_USING_BULLET_MT
+    btSetTaskScheduler( pOldTaskScheduler );
+#endif
+
+    m_LastResults[multithreaded ? 1 : 0] = results;
+
+    return results;
+}
+
+void BulletStressBenchmark::RunComparison(int numBodies, int numSteps)
+{
+    for( int i=0; i<2; i++ )
+    {
+        Results results = Run( i == 1, numBodies, numSteps );
+
+        LOGInfo( LOGTag, "Bullet stress benchmark (%s): %d bodies, %d steps, %0.2f ms total, %0.3f ms per step, longest %0.2f ms, %d awake\n",
+                 results.m_Multithreaded ? "multithreaded" : "single threaded",
+                 results.m_NumBodies, results.m_NumSteps, results.m_TotalTime, results.m_TotalTime / results.m_NumSteps,
+                 results.m_LongestStepTime, results.m_BodiesAwake );
+    }
+
+    if( m_LastResults[1].m_Multithreaded && m_LastResults[1].m_TotalTime > 0 )
+    {
+        LOGInfo( LOGTag, "Bullet stress benchmark: multithreaded world is %0.2fx the speed of the single threaded world\n",
+                 m_LastResults[0].m_TotalTime / m_LastResults[1].m_TotalTime );
+    }
+}
+
+#endif //MYFW_USING_BULLET
@@ -0,0 +1,46 @@
+//
+// Copyright (c) 2020 Jimmy Lord http://www.flatheadgames.com
+//
+// This software is provided 'as-is', without any express or implied warranty.  In no event will the authors be held liable for any damages arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+
+#ifndef __BulletStressBenchmark_H__
+#define __BulletStressBenchmark_H__
+
+#if MYFW_USING_BULLET
+
+// Drops a pile of boxes into a temporary world and times a fixed number of steps,
+//     used to compare the single threaded and multithreaded bullet worlds on the same scene.
+class BulletStressBenchmark
+{
+public:
+    struct Results
+    {
+        bool m_Multithreaded; // False if a multithreaded world was requested without MYFW_USE_BULLET_MT.
+        int m_NumBodies;
+        int m_NumSteps;
+        float m_TotalTime; // In ms.
+        float m_LongestStepTime; // In ms.
+        int m_BodiesAwake; // After the last step, a sanity check that the pile didn't just fall asleep.
+    };
+
+protected:
+    static Results m_LastResults[2]; // Single threaded, multithreaded.
+
+public:
+    // Creates and destroys its own world, the engine's world and bullet's task scheduler are restored afterwards.
+    static Results Run(bool multithreaded, int numBodies, int numSteps);
+
+    // Runs both world types on the same pile and logs the throughput of each.
+    static void RunComparison(int numBodies, int numSteps);
+
+    static const Results& GetLastResults(bool multithreaded) { return m_LastResults[multithreaded ? 1 : 0]; }
+};
+
+#endif //MYFW_USING_BULLET
+
+#endif //__BulletStressBenchmark_H__
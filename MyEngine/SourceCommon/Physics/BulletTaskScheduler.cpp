@@ -0,0 +1,207 @@
+//
+// Copyright (c) 2020 Jimmy Lord http://www.flatheadgames.com
+//
+// This software is provided 'as-is', without any express or implied warranty.  In no event will the authors be held liable for any damages arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+
+#include "MyEnginePCH.h"
+
+#include "BulletTaskScheduler.h"
+
+#include <thread>
+
+#if MYFW_USING_BULLET_MT
+
+BulletParallelJob::BulletParallelJob()
+{
+    m_pForBody = nullptr;
+    m_pSumBody = nullptr;
+    m_Begin = 0;
+    m_End = 0;
+    m_Sum = 0;
+}
+
+BulletParallelJob::~BulletParallelJob()
+{
+}
+
+void BulletParallelJob::PrepareForLoop(const btIParallelForBody* pBody, int begin, int end)
+{
+    m_IsStarted = false;
+    m_IsFinished = false;
+
+    m_pForBody = pBody;
+    m_pSumBody = nullptr;
+    m_Begin = begin;
+    m_End = end;
+    m_Sum = 0;
+}
+
+void BulletParallelJob::PrepareSumLoop(const btIParallelSumBody* pBody, int begin, int end)
+{
+    m_IsStarted = false;
+    m_IsFinished = false;
+
+    m_pForBody = nullptr;
+    m_pSumBody = pBody;
+    m_Begin = begin;
+    m_End = end;
+    m_Sum = 0;
+}
+
+void BulletParallelJob::DoWork()
+{
+    if( m_pForBody )
+        m_pForBody->forLoop( m_Begin, m_End );
+    else if( m_pSumBody )
+        m_Sum = m_pSumBody->sumLoop( m_Begin, m_End );
+}
+
+BulletTaskScheduler::BulletTaskScheduler()
+: btITaskScheduler( "MyEngineJobs" )
+{
+    for( int i=0; i<MAX_CHUNKS; i++ )
+    {
+        m_pJobs[i] = MyNew BulletParallelJob;
+    }
+
+    // The job manager doesn't report its worker count, so use one chunk per hardware thread,
+    //     the calling thread runs the first chunk and the job threads share the rest.
+    int numHardwareThreads = (int)std::thread::hardware_concurrency();
+    if( numHardwareThreads == 0 )
+        numHardwareThreads = 4;
+
+    setNumThreads( numHardwareThreads );
+
+    m_LoopInFlight = false;
+}
+
+BulletTaskScheduler::~BulletTaskScheduler()
+{
+    // Loops always wait on their jobs before returning, so none of these will be queued.
+    for( int i=0; i<MAX_CHUNKS; i++ )
+    {
+        SAFE_DELETE( m_pJobs[i] );
+    }
+}
+
+void BulletTaskScheduler::setNumThreads(int numThreads)
+{
+    m_NumThreads = MyClamp_Return( numThreads, 1, MAX_CHUNKS );
+}
+
+// Returns the number of chunks to split the range into, 1 if it should run on the calling thread.
+int BulletTaskScheduler::SplitRange(int begin, int end, int grainSize)
+{
+    int count = end - begin;
+    if( count <= 0 )
+        return 0;
+
+    if( g_pEngineCore->GetManagers()->GetJobManager() == nullptr )
+        return 1;
+
+    if( grainSize < 1 )
+        grainSize = 1;
+
+    int numChunks = (count + grainSize - 1) / grainSize;
+    if( numChunks > m_NumThreads )
+        numChunks = m_NumThreads;
+
+    return numChunks;
+}
+
+// Returns false if another loop is using the jobs, the caller should run its loop serially.
+bool BulletTaskScheduler::ClaimJobs()
+{
+    bool expected = false;
+    return m_LoopInFlight.compare_exchange_strong( expected, true );
+}
+
+void BulletTaskScheduler::parallelFor(int iBegin, int iEnd, int grainSize, const btIParallelForBody& body)
+{
+    int numChunks = SplitRange( iBegin, iEnd, grainSize );
+    if( numChunks == 0 )
+        return;
+
+    if( numChunks == 1 || ClaimJobs() == false )
+    {
+        body.forLoop( iBegin, iEnd );
+        return;
+    }
+
+    int chunkSize = (iEnd - iBegin + numChunks - 1) / numChunks;
+
+    // Queue all but the first chunk, then run the first chunk on this thread while the others run.
+    int numQueued = 0;
+    for( int i=1; i<numChunks; i++ )
+    {
+        int begin = iBegin + i*chunkSize;
+        if( begin >= iEnd )
+            break;
+
+        int end = begin + chunkSize;
+        if( end > iEnd )
+            end = iEnd;
+
+        m_pJobs[i]->PrepareForLoop( &body, begin, end );
+        g_pEngineCore->GetManagers()->GetJobManager()->AddJob( m_pJobs[i] );
+        numQueued++;
+    }
+
+    // Chunk 0 never goes past iEnd since there are at least 2 chunks.
+    body.forLoop( iBegin, iBegin + chunkSize );
+
+    for( int i=1; i<=numQueued; i++ )
+    {
+        g_pEngineCore->GetManagers()->GetJobManager()->WaitForJobToComplete( m_pJobs[i] );
+    }
+
+    m_LoopInFlight = false;
+}
+
+btScalar BulletTaskScheduler::parallelSum(int iBegin, int iEnd, int grainSize, const btIParallelSumBody& body)
+{
+    int numChunks = SplitRange( iBegin, iEnd, grainSize );
+    if( numChunks == 0 )
+        return 0;
+
+    if( numChunks == 1 || ClaimJobs() == false )
+        return body.sumLoop( iBegin, iEnd );
+
+    int chunkSize = (iEnd - iBegin + numChunks - 1) / numChunks;
+
+    int numQueued = 0;
+    for( int i=1; i<numChunks; i++ )
+    {
+        int begin = iBegin + i*chunkSize;
+        if( begin >= iEnd )
+            break;
+
+        int end = begin + chunkSize;
+        if( end > iEnd )
+            end = iEnd;
+
+        m_pJobs[i]->PrepareSumLoop( &body, begin, end );
+        g_pEngineCore->GetManagers()->GetJobManager()->AddJob( m_pJobs[i] );
+        numQueued++;
+    }
+
+    btScalar sum = body.sumLoop( iBegin, iBegin + chunkSize );
+
+    // Add the chunks up in order, so the result doesn't depend on which job finished first.
+    for( int i=1; i<=numQueued; i++ )
+    {
+        g_pEngineCore->GetManagers()->GetJobManager()->WaitForJobToComplete( m_pJobs[i] );
+        sum += m_pJobs[i]->GetSum();
+    }
+
+    m_LoopInFlight = false;
+
+    return sum;
+}
+
+#endif //MYFW_USING_BULLET_MT
@@ -0,0 +1,71 @@
+//
+// Copyright (c) 2020 Jimmy Lord http://www.flatheadgames.com
+//
+// This software is provided 'as-is', without any express or implied warranty.  In no event will the authors be held liable for any damages arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+
+#ifndef __BulletTaskScheduler_H__
+#define __BulletTaskScheduler_H__
+
+#if MYFW_USING_BULLET_MT
+
+#include <atomic>
+
+// Runs one chunk of a bullet parallelFor or parallelSum on a job thread.
+class BulletParallelJob : public MyJob
+{
+protected:
+    const btIParallelForBody* m_pForBody;
+    const btIParallelSumBody* m_pSumBody;
+    int m_Begin;
+    int m_End;
+    btScalar m_Sum;
+
+public:
+    BulletParallelJob();
+    virtual ~BulletParallelJob();
+
+    // Call one of these before adding the job to the job manager.
+    void PrepareForLoop(const btIParallelForBody* pBody, int begin, int end);
+    void PrepareSumLoop(const btIParallelSumBody* pBody, int begin, int end);
+
+    virtual void DoWork();
+
+    btScalar GetSum() { return m_Sum; }
+};
+
+// Task scheduler that hands bullet's parallel loops to the engine's job manager.
+//     The jobs are shared by all loops, so a loop started while another is in flight (i.e. from inside a loop body)
+//     runs serially on the calling thread instead.
+class BulletTaskScheduler : public btITaskScheduler
+{
+    static const int MAX_CHUNKS = 16;
+
+protected:
+    BulletParallelJob* m_pJobs[MAX_CHUNKS];
+    int m_NumThreads;
+    std::atomic<bool> m_LoopInFlight; // Set while m_pJobs are queued.
+
+protected:
+    int SplitRange(int begin, int end, int grainSize);
+    bool ClaimJobs();
+
+public:
+    BulletTaskScheduler();
+    virtual ~BulletTaskScheduler();
+
+    // btITaskScheduler overrides.
+    virtual int getMaxNumThreads() const { return MAX_CHUNKS; }
+    virtual int getNumThreads() const { return m_NumThreads; }
+    virtual void setNumThreads(int numThreads);
+    virtual void parallelFor(int iBegin, int iEnd, int grainSize, const btIParallelForBody& body);
+    virtual btScalar parallelSum(int iBegin, int iEnd, int grainSize, const btIParallelSumBody& body);
+};
+
+#endif //MYFW_USING_BULLET_MT
+
+#endif //__BulletTaskScheduler_H__
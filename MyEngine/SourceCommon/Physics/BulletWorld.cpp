@@ -10,17 +10,78 @@
 #include "MyEnginePCH.h"
 
 #include "BulletDebugDraw.h"
+#include "BulletShapeCache.h"
+#include "BulletTaskScheduler.h"
 #include "BulletWorld.h"
 
 BulletWorld* g_pBulletWorld = 0;
 
-BulletWorld::BulletWorld(MaterialDefinition* debugdrawmaterial, MyMatrix* pMatProj, MyMatrix* pMatView)
+BulletMotionState::BulletMotionState(const btTransform& startTransform)
+{
+    m_PreviousTransform = startTransform;
+    m_CurrentTransform = startTransform;
+    m_StepUpdated = 0;
+}
+
+void BulletMotionState::getWorldTransform(btTransform& worldTransform) const
+{
+    worldTransform = m_CurrentTransform;
+}
+
+void BulletMotionState::setWorldTransform(const btTransform& worldTransform)
+{
+    // If the body was asleep for a few steps, m_CurrentTransform is still where it was resting, so it's a valid previous.
+    m_PreviousTransform = m_CurrentTransform;
+    m_CurrentTransform = worldTransform;
+
+    if( g_pBulletWorld )
+        m_StepUpdated = g_pBulletWorld->GetStepCount();
+}
+
+void BulletMotionState::Teleport(const btTransform& worldTransform)
+{
+    m_PreviousTransform = worldTransform;
+    m_CurrentTransform = worldTransform;
+}
+
+void BulletMotionState::GetInterpolatedTransform(btTransform& worldTransform, float alpha, unsigned int lastStep) const
+{
+    // Bodies that weren't moved by the last step (asleep or static) stay put.
+    if( m_StepUpdated != lastStep || alpha >= 1.0f )
+    {
+        worldTransform = m_CurrentTransform;
+        return;
+    }
+
+    worldTransform.setOrigin( m_PreviousTransform.getOrigin().lerp( m_CurrentTransform.getOrigin(), alpha ) );
+    worldTransform.setRotation( m_PreviousTransform.getRotation().slerp( m_CurrentTransform.getRotation(), alpha ) );
+}
+
+BulletWorld::BulletWorld(MaterialDefinition* debugdrawmaterial, MyMatrix* pMatProj, MyMatrix* pMatView, bool multithreaded)
 {
     g_pBulletWorld = this;
 
     m_pBulletDebugDraw = 0;
 
-    CreateWorld( debugdrawmaterial, pMatProj, pMatView );
+    m_pTaskScheduler = nullptr;
+    m_pSolverPool = nullptr;
+    m_pShapeCache = nullptr;
+
+    m_UseFixedTimeStep = true;
+    m_FixedTimeStep = 1/60.0f;
+    m_MaxSubSteps = 5;
+
+    m_TimeAccumulator = 0;
+    m_InterpolationAlpha = 1;
+    m_StepCount = 0;
+
+    m_StepsLastUpdate = 0;
+    m_TimeDroppedLastUpdate = 0;
+    m_StepTimeLastUpdate = 0;
+    m_LongestStepTimeLastUpdate = 0;
+    m_TotalStepsDropped = 0;
+
+    CreateWorld( debugdrawmaterial, pMatProj, pMatView, multithreaded );
 }
 
 BulletWorld::~BulletWorld()
@@ -31,24 +92,59 @@ BulletWorld::~BulletWorld()
     Cleanup();
 }
 
-void BulletWorld::CreateWorld(MaterialDefinition* debugdrawmaterial, MyMatrix* pMatProj, MyMatrix* pMatView)
+void BulletWorld::CreateWorld(MaterialDefinition* debugdrawmaterial, MyMatrix* pMatProj, MyMatrix* pMatView, bool multithreaded)
 {
-    // collision configuration contains default setup for memory, collision setup.
-    //   Advanced users can create their own configuration.
-    m_pCollisionConfiguration = MyNew btDefaultCollisionConfiguration();
+#if !MYFW_USING_BULLET_MT
+    if( multithreaded )
+    {
+        LOGInfo( LOGTag, "Multithreaded bullet world requested, but MYFW_USE_BULLET_MT isn't set, creating a single threaded world\n" );
+        multithreaded = false;
+    }
+#endif
 
-    // use the default collision m_pDispatcher.
-    //   For parallel processing you can use a diffent m_pDispatcher (see Extras/BulletMultiThreaded)
-    m_pDispatcher = MyNew btCollisionDispatcher( m_pCollisionConfiguration );
+    m_pShapeCache = MyNew BulletShapeCache;
 
     // btDbvtBroadphase is a good general purpose broadphase. You can also try out btAxis3Sweep.
     m_pOverlappingPairCache = MyNew btDbvtBroadphase();
 
-    // the default constraint m_pSolver.
-    //   For parallel processing you can use a different m_pSolver (see Extras/BulletMultiThreaded)
-    m_pSolver = new btSequentialImpulseConstraintSolver();
+    if( multithreaded == false )
+    {
+        // collision configuration contains default setup for memory, collision setup.
+        //   Advanced users can create their own configuration.
+        m_pCollisionConfiguration = MyNew btDefaultCollisionConfiguration();
+
+        // use the default collision m_pDispatcher.
+        m_pDispatcher = MyNew btCollisionDispatcher( m_pCollisionConfiguration );
 
-    m_pDynamicsWorld = new btDiscreteDynamicsWorld( m_pDispatcher, m_pOverlappingPairCache, m_pSolver, m_pCollisionConfiguration );
+        // the default constraint m_pSolver.
+        m_pSolver = new btSequentialImpulseConstraintSolver();
+
+        m_pDynamicsWorld = new btDiscreteDynamicsWorld( m_pDispatcher, m_pOverlappingPairCache, m_pSolver, m_pCollisionConfiguration );
+    }
+#if MYFW_USING_BULLET_MT
+    else
+    {
+        // Bullet's parallel loops are run on the engine's job threads.
+        m_pTaskScheduler = MyNew BulletTaskScheduler;
+        btSetTaskScheduler( m_pTaskScheduler );
+
+        // Manifolds and collision algorithms are allocated from multiple threads, so make the pools big enough
+        //     that they don't fall back to the heap in large piles.
+        btDefaultCollisionConstructionInfo cci;
+        cci.m_defaultMaxPersistentManifoldPoolSize = 80000;
+        cci.m_defaultMaxCollisionAlgorithmPoolSize = 80000;
+        m_pCollisionConfiguration = MyNew btDefaultCollisionConfiguration( cci );
+
+        // Narrowphase is split across threads in chunks of 40 pairs.
+        m_pDispatcher = MyNew btCollisionDispatcherMt( m_pCollisionConfiguration, 40 );
+
+        // Islands are solved in parallel, each thread grabs a free solver from the pool.
+        m_pSolverPool = new btConstraintSolverPoolMt( BT_MAX_THREAD_COUNT );
+        m_pSolver = new btSequentialImpulseConstraintSolverMt();
+
+        m_pDynamicsWorld = new btDiscreteDynamicsWorldMt( m_pDispatcher, m_pOverlappingPairCache, m_pSolverPool, m_pSolver, m_pCollisionConfiguration );
+    }
+#endif //MYFW_USING_BULLET_MT
 
     if( debugdrawmaterial != 0 )
     {
@@ -61,15 +157,69 @@ void BulletWorld::CreateWorld(MaterialDefinition* debugdrawmaterial, MyMatrix* p
 
 void BulletWorld::PhysicsUpdate(float deltatime)
 {
-    // Update physics based on how much time passed since last frame
-    //    TODO: fix to use substeps properly, at the moment it's causing speed variations.
-    m_pDynamicsWorld->stepSimulation( deltatime, 0 );
+    m_StepsLastUpdate = 0;
+    m_TimeDroppedLastUpdate = 0;
+    m_StepTimeLastUpdate = 0;
+    m_LongestStepTimeLastUpdate = 0;
+
+    if( deltatime <= 0 )
+        return;
+
+    if( m_UseFixedTimeStep == false )
+    {
+        // Variable step, no interpolation needed since the bodies are exactly where the frame time says they should be.
+        double stepStart = MyTime_GetSystemTime();
+        m_StepCount++;
+        m_pDynamicsWorld->stepSimulation( deltatime, 0 );
+        m_StepTimeLastUpdate = (float)((MyTime_GetSystemTime() - stepStart)*1000);
+        m_LongestStepTimeLastUpdate = m_StepTimeLastUpdate;
+        m_StepsLastUpdate = 1;
+        m_InterpolationAlpha = 1;
+        return;
+    }
+
+    m_TimeAccumulator += deltatime;
+
+    int numSteps = (int)(m_TimeAccumulator / m_FixedTimeStep);
+
+    // Spiral of death guard, if we can't keep up then drop the extra time rather than trying to catch up next frame.
+    if( numSteps > m_MaxSubSteps )
+    {
+        int stepsDropped = numSteps - m_MaxSubSteps;
+        m_TimeDroppedLastUpdate = stepsDropped * m_FixedTimeStep;
+        m_TimeAccumulator -= m_TimeDroppedLastUpdate;
+        m_TotalStepsDropped += stepsDropped;
+        numSteps = m_MaxSubSteps;
+    }
+
+    for( int i=0; i<numSteps; i++ )
+    {
+        double stepStart = MyTime_GetSystemTime();
+
+        // Bump the step count first, so motion states know which step they were updated on.
+        m_StepCount++;
+
+        // Passing 0 for maxSubSteps makes bullet take exactly one step of the size passed in.
+        m_pDynamicsWorld->stepSimulation( m_FixedTimeStep, 0 );
+
+        float stepTime = (float)((MyTime_GetSystemTime() - stepStart)*1000);
+        m_StepTimeLastUpdate += stepTime;
+        if( stepTime > m_LongestStepTimeLastUpdate )
+            m_LongestStepTimeLastUpdate = stepTime;
+
+        m_TimeAccumulator -= m_FixedTimeStep;
+    }
+
+    m_StepsLastUpdate = numSteps;
+    m_InterpolationAlpha = (float)(m_TimeAccumulator / m_FixedTimeStep);
 }
 
 void BulletWorld::PhysicsStep()
 {
-    // TODO: look into this, it's not updating consistantly
-    m_pDynamicsWorld->stepSimulation( 1.0f/60.0f, 10 );
+    // Take a single fixed step, ignoring the accumulator.
+    m_StepCount++;
+    m_pDynamicsWorld->stepSimulation( m_FixedTimeStep, 0 );
+    m_InterpolationAlpha = 1;
 
     //// print positions of all objects
     //for( int j=m_pDynamicsWorld->getNumCollisionObjects()-1; j>=0; j-- )
@@ -88,6 +238,14 @@ void BulletWorld::PhysicsStep()
     //}
 }
 
+void BulletWorld::SetNumThreads(int numThreads)
+{
+#if MYFW_USING_BULLET_MT
+    if( m_pTaskScheduler )
+        m_pTaskScheduler->setNumThreads( numThreads );
+#endif
+}
+
 void BulletWorld::Cleanup()
 {
     int i;
@@ -105,6 +263,9 @@ void BulletWorld::Cleanup()
         delete obj;
     }
 
+    // delete shared collision shapes, after the bodies using them are gone.
+    SAFE_DELETE( m_pShapeCache );
+
     // delete collision shapes
     for( int j=0; j<m_CollisionShapes.size(); j++ )
     {
@@ -120,6 +281,8 @@ void BulletWorld::Cleanup()
 
     // delete m_pSolver
     delete m_pSolver;
+    delete m_pSolverPool;
+    m_pSolverPool = nullptr;
 
     // delete broadphase
     delete m_pOverlappingPairCache;
@@ -129,6 +292,15 @@ void BulletWorld::Cleanup()
 
     delete m_pCollisionConfiguration;
 
+#if MYFW_USING_BULLET_MT
+    if( m_pTaskScheduler )
+    {
+        // Hand bullet back its own scheduler before ours goes away.
+        btSetTaskScheduler( btGetSequentialTaskScheduler() );
+        SAFE_DELETE( m_pTaskScheduler );
+    }
+#endif
+
     // next line is optional: it will be cleared by the destructor when the array goes out of scope
     m_CollisionShapes.clear();
 }
@@ -14,32 +14,93 @@
 
 class BulletWorld;
 class BulletDebugDraw;
+class BulletTaskScheduler;
+class BulletShapeCache;
+class btConstraintSolverPoolMt;
 
 extern BulletWorld* g_pBulletWorld;
 
+// Motion state that keeps the body transforms from the last 2 fixed steps.
+//     Bullet calls setWorldTransform after each step for active bodies,
+//     GetInterpolatedTransform() blends between those for rendering.
+class BulletMotionState : public btMotionState
+{
+protected:
+    btTransform m_PreviousTransform;
+    btTransform m_CurrentTransform;
+    unsigned int m_StepUpdated; // Step count of the world when m_CurrentTransform was last set.
+
+public:
+    BulletMotionState(const btTransform& startTransform);
+
+    // btMotionState overrides.
+    virtual void getWorldTransform(btTransform& worldTransform) const;
+    virtual void setWorldTransform(const btTransform& worldTransform);
+
+    // Move the body without interpolating from the old position.
+    void Teleport(const btTransform& worldTransform);
+
+    void GetInterpolatedTransform(btTransform& worldTransform, float alpha, unsigned int lastStep) const;
+};
+
 class BulletWorld
 {
 public:
     btDiscreteDynamicsWorld* m_pDynamicsWorld;
-    btSequentialImpulseConstraintSolver* m_pSolver;
+    btConstraintSolver* m_pSolver;
     btDefaultCollisionConfiguration* m_pCollisionConfiguration;
     btCollisionDispatcher* m_pDispatcher;
     btBroadphaseInterface* m_pOverlappingPairCache;
 
+    // Only set if the world was created multithreaded.
+    BulletTaskScheduler* m_pTaskScheduler;
+    btConstraintSolverPoolMt* m_pSolverPool;
+
     // keep track of the shapes, we release memory at exit.
     // make sure to re-use collision shapes among rigid bodies whenever possible!
     btAlignedObjectArray<btCollisionShape*> m_CollisionShapes;
 
+    // Shapes shared between collision objects, these are released through the cache rather than the array above.
+    BulletShapeCache* m_pShapeCache;
+
     BulletDebugDraw* m_pBulletDebugDraw;
 
+    // Fixed timestep settings.
+    bool m_UseFixedTimeStep;
+    float m_FixedTimeStep;
+    int m_MaxSubSteps; // Time beyond this many steps per update is dropped to avoid a spiral of death.
+
+    double m_TimeAccumulator;
+    float m_InterpolationAlpha; // How far between the last 2 steps we are, used by BulletMotionState.
+    unsigned int m_StepCount;
+
+    // Stats from the last call to PhysicsUpdate.
+    int m_StepsLastUpdate;
+    float m_TimeDroppedLastUpdate; // In seconds.
+    float m_StepTimeLastUpdate; // Total time spent in stepSimulation in ms.
+    float m_LongestStepTimeLastUpdate; // In ms.
+    unsigned int m_TotalStepsDropped;
+
 public:
-    BulletWorld(MaterialDefinition* debugdrawmaterial, MyMatrix* pMatProj, MyMatrix* pMatView);
+    BulletWorld(MaterialDefinition* debugdrawmaterial, MyMatrix* pMatProj, MyMatrix* pMatView, bool multithreaded = false);
     ~BulletWorld();
 
-    void CreateWorld(MaterialDefinition* debugdrawmaterial, MyMatrix* pMatProj, MyMatrix* pMatView);
+    void CreateWorld(MaterialDefinition* debugdrawmaterial, MyMatrix* pMatProj, MyMatrix* pMatView, bool multithreaded);
     void PhysicsUpdate(float deltatime);
     void PhysicsStep();
     void Cleanup();
+
+    void SetUseFixedTimeStep(bool useFixedTimeStep) { m_UseFixedTimeStep = useFixedTimeStep; m_TimeAccumulator = 0; }
+    void SetFixedTimeStep(float timeStep) { MyAssert( timeStep > 0 ); m_FixedTimeStep = timeStep; }
+    void SetMaxSubSteps(int maxSubSteps) { MyAssert( maxSubSteps > 0 ); m_MaxSubSteps = maxSubSteps; }
+
+    BulletShapeCache* GetShapeCache() { return m_pShapeCache; }
+
+    bool IsMultithreaded() { return m_pTaskScheduler != nullptr; }
+    void SetNumThreads(int numThreads);
+
+    float GetInterpolationAlpha() { return m_InterpolationAlpha; }
+    unsigned int GetStepCount() { return m_StepCount; }
 };
 
 #endif //MYFW_USING_BULLET
@@ -10,69 +10,77 @@
 #include "MyEnginePCH.h"
 
 #include "EngineBox2DContactListener.h"
-#include "ComponentSystem/EngineComponents/ComponentLuaScript.h"
 #include "ComponentSystem/FrameworkComponents/Physics2D/Component2DCollisionObject.h"
 
 EngineBox2DContactListener::EngineBox2DContactListener()
 {
+    m_Dispatching = false;
+    m_FirstPendingEvent = 0;
 }
 
 EngineBox2DContactListener::~EngineBox2DContactListener()
 {
 }
 
-void EngineBox2DContactListener::BeginContact(b2Contact* contact)
+Box2DContactEvent* EngineBox2DContactListener::FindOrAddEvent(b2Contact* contact, Box2DContactEventType type)
 {
-    //Box2DContactListener::BeginContact( contact );
-    
-    b2Fixture* pFixture[2];
-    b2Body* pBody[2];
-    Component2DCollisionObject* pCollisionComponent[2];
+    ContactKey key;
+    key.m_pFixtureA = contact->GetFixtureA();
+    key.m_pFixtureB = contact->GetFixtureB();
+
+    // If the last event queued for this fixture pair is of the same type, coalesce them into one.
+    // Otherwise queue a new event, so a Begin/End/Begin sequence is dispatched in the order it happened.
+    std::map<ContactKey, unsigned int>::iterator it = m_EventIndices.find( key );
+    if( it != m_EventIndices.end() && m_Events[it->second].m_Type == type )
+    {
+        return &m_Events[it->second];
+    }
+
+    Box2DContactEvent event;
+    event.m_Type = type;
+    event.m_Impulse = 0;
 
-    pFixture[0] = contact->GetFixtureA();
-    pFixture[1] = contact->GetFixtureB();
+    event.m_pFixture[0] = key.m_pFixtureA;
+    event.m_pFixture[1] = key.m_pFixtureB;
 
     for( int i=0; i<2; i++ )
     {
-        pBody[i] = pFixture[i]->GetBody();
-        pCollisionComponent[i] = (Component2DCollisionObject*)pBody[i]->GetUserData().pointer;
+        event.m_pComponent[i] = (Component2DCollisionObject*)event.m_pFixture[i]->GetBody()->GetUserData().pointer;
+        event.m_CategoryBits[i] = event.m_pFixture[i]->GetFilterData().categoryBits;
+        event.m_Normal[i].Set( 0, 0 );
+
+        MyAssert( event.m_pComponent[i] );
     }
 
+    m_EventIndices[key] = (unsigned int)m_Events.size();
+    m_Events.push_back( event );
+
+    return &m_Events.back();
+}
+
+void EngineBox2DContactListener::BeginContact(b2Contact* contact)
+{
+    //Box2DContactListener::BeginContact( contact );
+
+    Box2DContactEvent* pEvent = FindOrAddEvent( contact, Box2DContactEventType::Begin );
+
+    // Store the normal as each side will see it.
+    b2Manifold* pManifold = contact->GetManifold();
+
     for( int i=0; i<2; i++ )
     {
-        MyAssert( pCollisionComponent[i] );
-
-        if( pCollisionComponent[i] && pCollisionComponent[i]->m_pComponentLuaScript )
+        if( pManifold->pointCount > 0 )
         {
-            if( pCollisionComponent[i]->m_pComponentLuaScript )
-            {
-                b2Manifold* pManifold = contact->GetManifold();
-
-                Component2DCollisionObject* otherComponent = pCollisionComponent[!i];
-                GameObject* otherGameObject = otherComponent->GetGameObject();
-
-                if( pManifold->pointCount > 0 )
-                {
-                    b2Vec2 b2normal = pManifold->localNormal;
-                    Vector2 normal( b2normal.x, b2normal.y );
-                    if( i == 0 )
-                        normal *= -1;
-
-#if MYFW_USING_LUA
-                    pCollisionComponent[i]->m_pComponentLuaScript->CallFunction( "OnCollision", normal, otherGameObject, otherComponent );
-#endif
-                }
-                else
-                {
-                    Vector2 normal( 0, 0 );
-                    if( pFixture[i]->IsSensor() )
-                        normal = (Vector2&)pBody[!i]->GetLinearVelocity();
-
-#if MYFW_USING_LUA
-                    pCollisionComponent[i]->m_pComponentLuaScript->CallFunction( "OnCollision", normal, otherGameObject, otherComponent );
-#endif
-                }
-            }
+            b2Vec2 b2normal = pManifold->localNormal;
+            pEvent->m_Normal[i].Set( b2normal.x, b2normal.y );
+            if( i == 0 )
+                pEvent->m_Normal[i] *= -1;
+        }
+        else
+        {
+            pEvent->m_Normal[i].Set( 0, 0 );
+            if( pEvent->m_pFixture[i]->IsSensor() )
+                pEvent->m_Normal[i] = (Vector2&)pEvent->m_pFixture[!i]->GetBody()->GetLinearVelocity();
         }
     }
 }
@@ -80,4 +88,168 @@ void EngineBox2DContactListener::BeginContact(b2Contact* contact)
 void EngineBox2DContactListener::EndContact(b2Contact* contact)
 {
     //Box2DContactListener::EndContact( contact );
+
+    FindOrAddEvent( contact, Box2DContactEventType::End );
+}
+
+void EngineBox2DContactListener::PostSolve(b2Contact* contact, const b2ContactImpulse* impulse)
+{
+    // Only track impulses for contacts that began since the last dispatch.
+    ContactKey key;
+    key.m_pFixtureA = contact->GetFixtureA();
+    key.m_pFixtureB = contact->GetFixtureB();
+
+    std::map<ContactKey, unsigned int>::iterator it = m_EventIndices.find( key );
+    if( it == m_EventIndices.end() || m_Events[it->second].m_Type != Box2DContactEventType::Begin )
+        return;
+
+    float totalImpulse = 0;
+    for( int i=0; i<impulse->count; i++ )
+        totalImpulse += impulse->normalImpulses[i];
+
+    Box2DContactEvent* pEvent = &m_Events[it->second];
+    if( totalImpulse > pEvent->m_Impulse )
+        pEvent->m_Impulse = totalImpulse;
+}
+
+void EngineBox2DContactListener::DispatchEvents()
+{
+    MyAssert( m_Dispatching == false );
+    if( m_Dispatching )
+        return;
+
+    m_Dispatching = true;
+
+    // Handlers are free to create or destroy bodies, destroying a body can queue new End events
+    //     and can clear component pointers in queued events, so access by index and copy each event.
+    for( unsigned int eventIndex=0; eventIndex<m_Events.size(); eventIndex++ )
+    {
+        m_FirstPendingEvent = eventIndex + 1;
+
+        Box2DContactEvent event = m_Events[eventIndex];
+
+        for( int i=0; i<2; i++ )
+        {
+            // Re-read the components, the handler for the first side might have destroyed either of them.
+            event.m_pComponent[0] = m_Events[eventIndex].m_pComponent[0];
+            event.m_pComponent[1] = m_Events[eventIndex].m_pComponent[1];
+
+            if( event.m_pComponent[i] == nullptr )
+                continue;
+
+            // A Begin needs both sides to still exist, an End is still sent to a side whose other body is gone.
+            if( event.m_Type == Box2DContactEventType::Begin && event.m_pComponent[!i] == nullptr )
+                continue;
+
+            event.m_pComponent[i]->DispatchContactEvent( event, i );
+        }
+    }
+
+    m_Dispatching = false;
+    m_FirstPendingEvent = 0;
+
+    ClearEvents();
+}
+
+void EngineBox2DContactListener::ClearEvents()
+{
+    MyAssert( m_Dispatching == false );
+
+    m_Events.clear();
+    m_EventIndices.clear();
+}
+
+void EngineBox2DContactListener::RemoveEventsForComponent(Component2DCollisionObject* pComponent)
+{
+    // Don't remove the events from the list, DispatchEvents() might be iterating over it.
+    for( unsigned int eventIndex=0; eventIndex<m_Events.size(); eventIndex++ )
+    {
+        Box2DContactEvent* pEvent = &m_Events[eventIndex];
+
+        for( int i=0; i<2; i++ )
+        {
+            if( pEvent->m_pComponent[i] == pComponent )
+                pEvent->m_pComponent[i] = nullptr;
+        }
+    }
+}
+
+void EngineBox2DContactListener::DestroyBody(b2World* pWorld, b2Body* pBody)
+{
+    MyAssert( pWorld && pBody );
+
+    // Grab the fixture pointers before the body is destroyed, they're only compared against after that.
+    std::vector<b2Fixture*> fixtures;
+    for( b2Fixture* pFixture = pBody->GetFixtureList(); pFixture; pFixture = pFixture->GetNext() )
+        fixtures.push_back( pFixture );
+
+    pWorld->DestroyBody( pBody );
+
+    // Forget every pair using the body, so a new fixture at the same address won't coalesce with its events.
+    for( std::map<ContactKey, unsigned int>::iterator it = m_EventIndices.begin(); it != m_EventIndices.end(); )
+    {
+        bool usesBody = false;
+        for( unsigned int i=0; i<fixtures.size(); i++ )
+        {
+            if( it->first.m_pFixtureA == fixtures[i] || it->first.m_pFixtureB == fixtures[i] )
+                usesBody = true;
+        }
+
+        if( usesBody )
+            it = m_EventIndices.erase( it );
+        else
+            it++;
+    }
+
+    // Don't remove the events from the list, DispatchEvents() might be iterating over it.
+    // Pending Begin events are dropped, along with any End that follows them, since the other side never saw the Begin.
+    // Other End events keep the other side's fixture and component, so it still hears the contact end.
+    std::vector<ContactKey> droppedPairs;
+    for( unsigned int eventIndex=m_FirstPendingEvent; eventIndex<m_Events.size(); eventIndex++ )
+    {
+        Box2DContactEvent* pEvent = &m_Events[eventIndex];
+
+        int destroyedSide = -1;
+        for( unsigned int i=0; i<fixtures.size(); i++ )
+        {
+            if( pEvent->m_pFixture[0] == fixtures[i] )
+                destroyedSide = 0;
+            else if( pEvent->m_pFixture[1] == fixtures[i] )
+                destroyedSide = 1;
+        }
+
+        if( destroyedSide == -1 )
+            continue;
+
+        ContactKey key;
+        key.m_pFixtureA = pEvent->m_pFixture[0];
+        key.m_pFixtureB = pEvent->m_pFixture[1];
+
+        bool drop = (pEvent->m_Type == Box2DContactEventType::Begin);
+        if( drop )
+        {
+            droppedPairs.push_back( key );
+        }
+        else
+        {
+            for( unsigned int i=0; i<droppedPairs.size(); i++ )
+            {
+                if( droppedPairs[i].m_pFixtureA == key.m_pFixtureA && droppedPairs[i].m_pFixtureB == key.m_pFixtureB )
+                    drop = true;
+            }
+        }
+
+        if( drop )
+        {
+            for( int i=0; i<2; i++ )
+            {
+                pEvent->m_pFixture[i] = nullptr;
+                pEvent->m_pComponent[i] = nullptr;
+            }
+        }
+        else
+        {
+            pEvent->m_pFixture[destroyedSide] = nullptr;
+        }
+    }
 }
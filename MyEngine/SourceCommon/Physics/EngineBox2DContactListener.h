@@ -10,16 +10,71 @@
 #ifndef __EngineBox2DContactListener_H__
 #define __EngineBox2DContactListener_H__
 
+class Component2DCollisionObject;
+
+enum class Box2DContactEventType
+{
+    Begin,
+    End,
+};
+
+// A single contact event, recorded during b2World::Step and dispatched once the step is done.
+// All values are stored for both fixtures, so each side can be handed its own view of the contact.
+struct Box2DContactEvent
+{
+    Box2DContactEventType m_Type;
+    b2Fixture* m_pFixture[2]; // Set to nullptr if the fixture's body was destroyed before dispatch.
+    Component2DCollisionObject* m_pComponent[2]; // Set to nullptr if the component was destroyed before dispatch.
+    uint16 m_CategoryBits[2];
+    Vector2 m_Normal[2]; // Normal as seen by each side, sensors get the other body's velocity.
+    float m_Impulse; // Largest total normal impulse applied to the contact, only set for Begin events.
+};
+
 class EngineBox2DContactListener : public Box2DContactListener
 {
-public:
+protected:
+    struct ContactKey
+    {
+        b2Fixture* m_pFixtureA;
+        b2Fixture* m_pFixtureB;
+
+        bool operator<(const ContactKey& other) const
+        {
+            if( m_pFixtureA != other.m_pFixtureA ) return m_pFixtureA < other.m_pFixtureA;
+            return m_pFixtureB < other.m_pFixtureB;
+        }
+    };
+
+    std::vector<Box2DContactEvent> m_Events;
+    std::map<ContactKey, unsigned int> m_EventIndices; // Index of the last event queued for each fixture pair, used to coalesce repeats.
+
+    bool m_Dispatching;
+    unsigned int m_FirstPendingEvent; // Events before this index were already dispatched.
+
+protected:
+    Box2DContactEvent* FindOrAddEvent(b2Contact* contact, Box2DContactEventType type);
 
 public:
     EngineBox2DContactListener();
     ~EngineBox2DContactListener();
 
-	virtual void BeginContact(b2Contact* contact);
-	virtual void EndContact(b2Contact* contact);
+    // b2ContactListener overrides, called from inside b2World::Step, these only record events.
+    virtual void BeginContact(b2Contact* contact);
+    virtual void EndContact(b2Contact* contact);
+    virtual void PostSolve(b2Contact* contact, const b2ContactImpulse* impulse);
+
+    // Call after the world is done stepping, it's safe to create/destroy bodies from the handlers.
+    void DispatchEvents();
+    void ClearEvents();
+
+    // Called when a collision component is being destroyed, so queued events don't reference it.
+    void RemoveEventsForComponent(Component2DCollisionObject* pComponent);
+
+    // Destroys the body and fixes up queued events for its fixtures, including End events queued by the destroy.
+    //     Begin events are dropped, End events are still sent to the other body unless its Begin was dropped too.
+    void DestroyBody(b2World* pWorld, b2Body* pBody);
+
+    unsigned int GetNumberOfQueuedEvents() { return (unsigned int)m_Events.size(); }
 };
 
 #endif //__EngineBox2DContactListener_H__
@@ -498,13 +498,17 @@ void ComponentVoxelWorld::TickCallback(float deltaTime)
     Vector3 pos = pPlayer->GetTransform()->GetWorldPosition();
 
     m_pVoxelWorld->SetWorldCenter( pos );
-    RenderGraph_Base* pRenderGraph = g_pComponentSystemManager->GetRenderGraph();
 
     // Change the octree dimensions if the player moves too far from the previous center.
-    pos.x = MyRoundToMultipleOf( pos.x, 16 );
-    pos.y = MyRoundToMultipleOf( pos.y, 16 );
-    pos.z = MyRoundToMultipleOf( pos.z, 16 );
-    ((RenderGraph_Octree*)pRenderGraph)->Resize( pos.x-32, pos.y-32, pos.z-32, pos.x+32, pos.y+32, pos.z+32 );
+    // Other render graphs have no world limits, so there's nothing to resize.
+    RenderGraph_Octree* pOctree = dynamic_cast<RenderGraph_Octree*>( g_pComponentSystemManager->GetRenderGraph() );
+    if( pOctree )
+    {
+        pos.x = MyRoundToMultipleOf( pos.x, 16 );
+        pos.y = MyRoundToMultipleOf( pos.y, 16 );
+        pos.z = MyRoundToMultipleOf( pos.z, 16 );
+        pOctree->Resize( pos.x-32, pos.y-32, pos.z-32, pos.x+32, pos.y+32, pos.z+32 );
+    }
 }
 
 #if MYFW_EDITOR
@@ -67,6 +67,9 @@ public:
     virtual void RemoveFromRenderGraph();
     virtual void PushChangesToRenderGraphObjects();
 
+    // Chunks come and go as the world ticks, so they're always drawn with the dynamic shadow casters.
+    virtual bool IsStaticShadowCaster() { return false; }
+
 protected:
     // Callback functions for various events.
     MYFW_DECLARE_COMPONENT_CALLBACK_TICK(); // TickCallback
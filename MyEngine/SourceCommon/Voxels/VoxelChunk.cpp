@@ -58,6 +58,7 @@ void VoxelChunk::Initialize(VoxelWorld* world, Vector3 pos, Vector3Int chunkoffs
 
     m_Transform.SetIdentity();
     m_Transform.SetTranslation( pos );
+    UpdateRenderGraphBounds();
 
     m_BlockSize = blocksize;
     m_ChunkOffset = chunkoffset;
@@ -226,6 +227,8 @@ void VoxelChunk::CalculateBounds()
 
     MyAABounds* pBounds = GetBounds();
     pBounds->Set( center, extents );
+
+    UpdateRenderGraphBounds();
 }
 
 // ============================================================================================================================
@@ -1436,6 +1439,7 @@ void VoxelChunk::OverrideRenderGraphObjectTransform(MyMatrix* pTransform)
         return;
 
     m_pRenderGraphObject->m_pTransform = pTransform;
+    UpdateRenderGraphBounds();
 }
 
 void VoxelChunk::RemoveFromRenderGraph()
@@ -1447,6 +1451,15 @@ void VoxelChunk::RemoveFromRenderGraph()
     m_pRenderGraphObject = 0;
 }
 
+void VoxelChunk::UpdateRenderGraphBounds()
+{
+    if( m_pRenderGraphObject == 0 )
+        return;
+
+    // Chunks are reused at new positions and their bounds change as the mesh is rebuilt, so the graph needs to re-bin them.
+    g_pComponentSystemManager->GetRenderGraph()->ObjectMoved( m_pRenderGraphObject );
+}
+
 // ============================================================================================================================
 // MyMesh overrides
 // ============================================================================================================================
@@ -97,6 +97,7 @@ public:
     void AddToRenderGraph(void* pUserData, MaterialDefinition* pMaterial);
     void OverrideRenderGraphObjectTransform(MyMatrix* pTransform);
     void RemoveFromRenderGraph();
+    void UpdateRenderGraphBounds(); // Call when the chunk's transform or bounds change while it's in the render graph.
 
     // MyMesh overrides
     virtual void SetMaterial(MaterialDefinition* pMaterial, int submeshindex);
@@ -15,6 +15,7 @@
 #include "ComponentSystem/BaseComponents/ComponentCamera.h"
 #include "ComponentSystem/BaseComponents/ComponentTransform.h"
 #include "ComponentSystem/Core/GameObject.h"
+#include "ComponentSystem/Core/SceneArena.h"
 #include "ComponentSystem/FrameworkComponents/ComponentAnimationPlayer2D.h"
 #include "ComponentSystem/FrameworkComponents/ComponentAudioPlayer.h"
 #include "ComponentSystem/FrameworkComponents/ComponentMeshOBJ.h"
@@ -2940,6 +2941,15 @@ void EditorMainFrame_ImGui::AddMemoryPanel()
                     ImGui::EndChild();
                 }
 
+                if( ImGui::BeginTabItem( "Scenes" ) )
+                {
+                    ImGui::EndTabItem();
+
+                    ImGui::BeginChild( "Memory Details" );
+                    AddMemoryPanel_SceneArenas();
+                    ImGui::EndChild();
+                }
+
                 if( ImGui::BeginTabItem( "Buffers" ) )
                 {
                     ImGui::EndTabItem();
@@ -3765,6 +3775,42 @@ void EditorMainFrame_ImGui::AddMemoryPanel_Files()
     }
 }
 
+void EditorMainFrame_ImGui::AddMemoryPanel_SceneArenas()
+{
+    ComponentSystemManager* pComponentSystemManager = m_pEngineCore->GetComponentSystemManager();
+
+    if( pComponentSystemManager->AreSceneArenasEnabled() == false )
+    {
+        ImGui::Text( "Scene arenas are disabled." );
+    }
+
+    char bytesInUse[32];
+    char bytesReserved[32];
+
+    for( int i=0; i<MAX_SCENES_LOADED_INCLUDING_UNMANAGED; i++ )
+    {
+        SceneInfo* pSceneInfo = pComponentSystemManager->GetSceneInfo( (SceneID)i );
+        if( pSceneInfo->m_pArena == nullptr )
+            continue;
+
+        const char* sceneName = pSceneInfo->m_FullPath;
+        if( i == SCENEID_Unmanaged )
+            sceneName = "Unmanaged";
+        else if( sceneName[0] == '\0' )
+            sceneName = "Unsaved scene";
+
+        const SceneArena::Stats& stats = pSceneInfo->m_pArena->GetStats();
+        PrintNumberWithCommas( bytesInUse, 32, stats.m_BytesInUse );
+        PrintNumberWithCommas( bytesReserved, 32, stats.m_BytesReserved );
+
+        ImGui::Text( "%s (%d)", sceneName, i );
+        ImGui::Text( "    Bytes: %s / %s (Pages: %d)", bytesInUse, bytesReserved, stats.m_NumPages );
+        ImGui::Text( "    Allocations: %d (Total: %d)", stats.m_LiveAllocations, stats.m_TotalAllocations );
+    }
+
+    ImGui::Text( "Arenas waiting on objects from unloaded scenes: %d", SceneArena::GetNumberOfOrphanedArenas() );
+}
+
 void EditorMainFrame_ImGui::AddMemoryPanel_DrawCalls()
 {
     ImGuiTreeNodeFlags baseNodeFlags = ImGuiTreeNodeFlags_OpenOnArrow | ImGuiTreeNodeFlags_OpenOnDoubleClick | ImGuiTreeNodeFlags_DefaultOpen;
@@ -210,6 +210,7 @@ protected:
     void AddMemoryPanel_SoundCues();
     void AddMemoryPanel_Files();
     void AddMemoryPanel_DrawCalls();
+    void AddMemoryPanel_SceneArenas();
 
     void AddMaterialEditor();
     void Add2DAnimationEditor();
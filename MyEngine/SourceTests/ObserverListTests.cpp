@@ -0,0 +1,139 @@
+//
+// Copyright (c) 2020 Jimmy Lord http://www.flatheadgames.com
+//
+// This software is provided 'as-is', without any express or implied warranty.  In no event will the authors be held liable for any damages arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+
+#include "MyEnginePCH.h"
+
+#include "ComponentSystem/Core/ObserverList.h"
+#include "TestHelpers.h"
+
+static const int NUM_STRESS_OBSERVERS = 100000;
+
+static int g_NumNotified = 0;
+
+static void ObserverA() { g_NumNotified++; }
+static void ObserverB() { g_NumNotified++; }
+
+static int CountSlots(ObserverList& list)
+{
+    int count = 0;
+    for( unsigned int slot = list.GetFirstSlot(); slot != ObserverPool::INVALID_SLOT; slot = list.GetNextSlot( slot ) )
+        count++;
+    return count;
+}
+
+static void TestSubscribeAndUnsubscribe()
+{
+    ObserverList list;
+    int objects[2];
+
+    TEST_CHECK( list.Subscribe( &objects[0], ObserverA ) == true );
+    TEST_CHECK( list.Subscribe( &objects[0], ObserverB ) == true );
+    TEST_CHECK( list.Subscribe( &objects[1], ObserverA ) == true );
+
+    // The same object/function pair is only subscribed once.
+    TEST_CHECK( list.Subscribe( &objects[0], ObserverA ) == false );
+    TEST_CHECK( list.GetCount() == 3 );
+
+    // Observers are kept in the order they subscribed.
+    unsigned int slot = list.GetFirstSlot();
+    TEST_CHECK( list.GetSlot( slot ).m_pObj == &objects[0] && list.GetSlot( slot ).m_pFunc == ObserverA );
+    slot = list.GetNextSlot( slot );
+    TEST_CHECK( list.GetSlot( slot ).m_pObj == &objects[0] && list.GetSlot( slot ).m_pFunc == ObserverB );
+
+    TEST_CHECK( list.Unsubscribe( &objects[0], ObserverB ) == true );
+    TEST_CHECK( list.Unsubscribe( &objects[0], ObserverB ) == false );
+    TEST_CHECK( list.GetCount() == 2 );
+    TEST_CHECK( CountSlots( list ) == 2 );
+
+    // The same pair on another list is a separate subscription.
+    ObserverList otherList;
+    TEST_CHECK( otherList.Subscribe( &objects[1], ObserverA ) == true );
+    TEST_CHECK( otherList.Unsubscribe( &objects[0], ObserverA ) == false );
+    TEST_CHECK( list.Unsubscribe( &objects[1], ObserverA ) == true );
+    TEST_CHECK( otherList.GetCount() == 1 );
+
+    // PopFirst hands back observers in order and empties the list.
+    void* pObj;
+    ObserverFunc* pFunc;
+    TEST_CHECK( list.PopFirst( &pObj, &pFunc ) == true );
+    TEST_CHECK( pObj == &objects[0] && pFunc == ObserverA );
+    TEST_CHECK( list.PopFirst( &pObj, &pFunc ) == false );
+    TEST_CHECK( list.GetCount() == 0 );
+
+    // Copies start out empty.
+    ObserverList copiedList( otherList );
+    TEST_CHECK( copiedList.GetCount() == 0 );
+}
+
+static void TestStress()
+{
+    ObserverPool* pPool = ObserverPool::Get();
+    unsigned int slotsInUseBefore = pPool->GetNumSlotsInUse();
+
+    std::vector<int> objects( NUM_STRESS_OBSERVERS );
+    ObserverList lists[4];
+
+    for( int i=0; i<NUM_STRESS_OBSERVERS; i++ )
+    {
+        TEST_CHECK( lists[i % 4].Subscribe( &objects[i], ObserverA ) == true );
+    }
+
+    TEST_CHECK( pPool->GetNumSlotsInUse() == slotsInUseBefore + NUM_STRESS_OBSERVERS );
+    TEST_CHECK( pPool->GetNumSlotsAllocated() >= (unsigned int)NUM_STRESS_OBSERVERS );
+
+    // Every subscription can still be found after the pool grew.
+    for( int i=0; i<NUM_STRESS_OBSERVERS; i++ )
+    {
+        TEST_CHECK( lists[i % 4].Subscribe( &objects[i], ObserverA ) == false );
+    }
+
+    // Unsubscribe every other observer, then notify the rest.
+    for( int i=0; i<NUM_STRESS_OBSERVERS; i+=2 )
+    {
+        TEST_CHECK( lists[i % 4].Unsubscribe( &objects[i], ObserverA ) == true );
+    }
+
+    g_NumNotified = 0;
+    for( int l=0; l<4; l++ )
+    {
+        for( unsigned int slot = lists[l].GetFirstSlot(); slot != ObserverPool::INVALID_SLOT; slot = lists[l].GetNextSlot( slot ) )
+        {
+            lists[l].GetSlot( slot ).m_pFunc();
+        }
+    }
+    TEST_CHECK( g_NumNotified == NUM_STRESS_OBSERVERS / 2 );
+
+    for( int i=0; i<NUM_STRESS_OBSERVERS; i++ )
+    {
+        bool shouldBeSubscribed = (i % 2) == 1;
+        TEST_CHECK( lists[i % 4].Unsubscribe( &objects[i], ObserverA ) == shouldBeSubscribed );
+    }
+
+    // Freed slots are reused without allocating more chunks.
+    unsigned int slotsAllocated = pPool->GetNumSlotsAllocated();
+    for( int i=0; i<NUM_STRESS_OBSERVERS; i++ )
+    {
+        lists[0].Subscribe( &objects[i], ObserverB );
+    }
+    TEST_CHECK( pPool->GetNumSlotsAllocated() == slotsAllocated );
+    TEST_CHECK( lists[0].GetCount() == NUM_STRESS_OBSERVERS );
+
+    lists[0].UnsubscribeAll();
+    TEST_CHECK( lists[0].GetCount() == 0 );
+    TEST_CHECK( pPool->GetNumSlotsInUse() == slotsInUseBefore );
+}
+
+int main()
+{
+    TEST_RUN( TestSubscribeAndUnsubscribe );
+    TEST_RUN( TestStress );
+
+    return TestResult();
+}
@@ -0,0 +1,169 @@
+//
+// Copyright (c) 2020 Jimmy Lord http://www.flatheadgames.com
+//
+// This software is provided 'as-is', without any express or implied warranty.  In no event will the authors be held liable for any damages arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+
+#include "MyEnginePCH.h"
+
+#include "ComponentSystem/Core/SceneLoader.h"
+#include "TestHelpers.h"
+
+// Components are left without a "Type", so the loader never needs a ComponentTypeManager.
+static const char* g_Scene =
+    "{\n"
+    "    \"Files\": [ { \"Path\": \"Data/Textures/a.png\" } ],\n"
+    "    \"GameObjects\": [\n"
+    "        { \"ID\": 1, \"Name\": \"Root\" },\n"
+    "        { \"ID\": 2, \"Name\": \"Folder\", \"SubType\": \"Folder\" },\n"
+    "        { \"ID\": 3, \"Name\": \"Logic\", \"SubType\": \"Logic\" }\n"
+    "    ],\n"
+    "    \"Transforms\": [ { \"GOID\": 1, \"Pos\": [ 0, 1, 2 ] } ],\n"
+    "    \"Components\": [ { \"GOID\": 1, \"ID\": 7 }, { \"GOID\": 3, \"ID\": 8 } ]\n"
+    "}\n";
+
+static const char* GetBlockName(SceneLoader& loader, unsigned int index)
+{
+    cJSON* jName = cJSON_GetObjectItem( loader.GetBlock( SceneLoader::BlockArray_GameObjects, index )->m_jObject, "Name" );
+    return jName ? jName->valuestring : "";
+}
+
+static void TestSplit()
+{
+    SceneLoader loader( nullptr );
+    TEST_CHECK( loader.Parse( g_Scene, SCENEID_MainScene, false, false ) );
+    TEST_CHECK( SceneLoader::GetStats().m_SplitFailed == false );
+
+    TEST_CHECK( loader.GetNumBlocks( SceneLoader::BlockArray_Files ) == 1 );
+    TEST_CHECK( loader.GetNumBlocks( SceneLoader::BlockArray_GameObjects ) == 3 );
+    TEST_CHECK( loader.GetNumBlocks( SceneLoader::BlockArray_Transforms ) == 1 );
+    TEST_CHECK( loader.GetNumBlocks( SceneLoader::BlockArray_Components ) == 2 );
+
+    SceneLoaderBlock* pFolder = loader.GetBlock( SceneLoader::BlockArray_GameObjects, 1 );
+    TEST_CHECK( pFolder->m_pText != nullptr );
+    TEST_CHECK( pFolder->m_IsValid && pFolder->m_ID == 2 && pFolder->m_IsFolder && pFolder->m_HasTransform == false );
+
+    SceneLoaderBlock* pLogic = loader.GetBlock( SceneLoader::BlockArray_GameObjects, 2 );
+    TEST_CHECK( pLogic->m_IsFolder == false && pLogic->m_HasTransform == false );
+
+    SceneLoaderBlock* pComponent = loader.GetBlock( SceneLoader::BlockArray_Components, 1 );
+    TEST_CHECK( pComponent->m_IsValid && pComponent->m_GameObjectID == 3 && pComponent->m_ID == 8 && pComponent->m_ComponentType == -1 );
+}
+
+static void TestStringsWithEscapesAndBrackets()
+{
+    // Quotes, backslashes and brackets inside strings mustn't end a block early.
+    const char* scene =
+        "{ \"GameObjects\": [\n"
+        "    { \"ID\": 1, \"Name\": \"say \\\"hi\\\" ]},{\" },\n"
+        "    { \"ID\": 2, \"Name\": \"ends with a backslash \\\\\" },\n"
+        "    { \"ID\": 3, \"Name\": \"[{\" }\n"
+        "] }";
+
+    SceneLoader loader( nullptr );
+    TEST_CHECK( loader.Parse( scene, SCENEID_MainScene, false, false ) );
+    TEST_CHECK( SceneLoader::GetStats().m_SplitFailed == false );
+    TEST_CHECK( loader.GetNumBlocks( SceneLoader::BlockArray_GameObjects ) == 3 );
+
+    TEST_CHECK( strcmp( GetBlockName( loader, 0 ), "say \"hi\" ]},{" ) == 0 );
+    TEST_CHECK( strcmp( GetBlockName( loader, 1 ), "ends with a backslash \\" ) == 0 );
+    TEST_CHECK( strcmp( GetBlockName( loader, 2 ), "[{" ) == 0 );
+    TEST_CHECK( loader.GetBlock( SceneLoader::BlockArray_GameObjects, 2 )->m_ID == 3 );
+}
+
+static void TestUnknownKeys()
+{
+    // Values under other keys are skipped, including ones holding brackets and arrays with our names.
+    const char* scene =
+        "{ \"Version\": 3, \"Settings\": { \"GameObjects\": [ \"]\" ], \"Flag\": true },\n"
+        "  \"GameObjects\": [ { \"ID\": 1, \"Name\": \"A\" } ], \"Empty\": null }";
+
+    SceneLoader loader( nullptr );
+    TEST_CHECK( loader.Parse( scene, SCENEID_MainScene, false, false ) );
+    TEST_CHECK( SceneLoader::GetStats().m_SplitFailed == false );
+    TEST_CHECK( loader.GetNumBlocks( SceneLoader::BlockArray_GameObjects ) == 1 );
+
+    // An invalid value under an unknown key fails the split and then the full parse, same as without the split.
+    const char* invalidScenes[] =
+    {
+        "{ \"Version\": tru, \"GameObjects\": [ { \"ID\": 1 } ] }",
+        "{ \"Version\": 12abc, \"GameObjects\": [ { \"ID\": 1 } ] }",
+        "{ \"Settings\": { \"a\": }, \"GameObjects\": [ { \"ID\": 1 } ] }",
+        "{ \"Settings\": [ 1, 2 }, \"GameObjects\": [ { \"ID\": 1 } ] }",
+    };
+
+    for( int i=0; i<4; i++ )
+    {
+        SceneLoader invalidLoader( nullptr );
+        TEST_CHECK( invalidLoader.Parse( invalidScenes[i], SCENEID_MainScene, false, false ) == false );
+        TEST_CHECK( SceneLoader::GetStats().m_SplitFailed == true );
+    }
+}
+
+static void TestDuplicateArrays()
+{
+    // cJSON_GetObjectItem only sees the first array, so the split hands the scene to the full parse.
+    const char* scene =
+        "{ \"GameObjects\": [ { \"ID\": 1, \"Name\": \"First\" } ],\n"
+        "  \"GameObjects\": [ { \"ID\": 2, \"Name\": \"Second\" }, { \"ID\": 3, \"Name\": \"Third\" } ] }";
+
+    SceneLoader loader( nullptr );
+    TEST_CHECK( loader.Parse( scene, SCENEID_MainScene, false, false ) );
+    TEST_CHECK( SceneLoader::GetStats().m_SplitFailed == true );
+    TEST_CHECK( loader.GetNumBlocks( SceneLoader::BlockArray_GameObjects ) == 1 );
+    TEST_CHECK( strcmp( GetBlockName( loader, 0 ), "First" ) == 0 );
+    TEST_CHECK( loader.GetBlock( SceneLoader::BlockArray_GameObjects, 0 )->m_pText == nullptr );
+}
+
+static void TestFullParseFallback()
+{
+    // Valid json that isn't laid out the way SaveSceneToJSON writes it is parsed in one go.
+    const char* scene = "{ \"Files\": {}, \"GameObjects\": [ { \"ID\": 4, \"Name\": \"A\" } ] }";
+
+    SceneLoader loader( nullptr );
+    TEST_CHECK( loader.Parse( scene, SCENEID_MainScene, false, false ) );
+    TEST_CHECK( SceneLoader::GetStats().m_SplitFailed == true );
+    TEST_CHECK( loader.GetNumBlocks( SceneLoader::BlockArray_Files ) == 0 );
+    TEST_CHECK( loader.GetNumBlocks( SceneLoader::BlockArray_GameObjects ) == 1 );
+    TEST_CHECK( loader.GetBlock( SceneLoader::BlockArray_GameObjects, 0 )->m_ID == 4 );
+
+    // Text that isn't json at all fails either way.
+    SceneLoader invalidLoader( nullptr );
+    TEST_CHECK( invalidLoader.Parse( "{ \"GameObjects\": [ { \"ID\": 1 } ]", SCENEID_MainScene, false, false ) == false );
+    TEST_CHECK( SceneLoader::GetStats().m_SplitFailed == true );
+
+    // A split block that isn't valid json fails the load.
+    SceneLoader invalidBlockLoader( nullptr );
+    TEST_CHECK( invalidBlockLoader.Parse( "{ \"GameObjects\": [ { \"ID\": 1, } ] }", SCENEID_MainScene, false, false ) == false );
+    TEST_CHECK( SceneLoader::GetStats().m_SplitFailed == false );
+}
+
+static void TestSceneIDsFromEachObject()
+{
+    // Entries without a SceneID take the one from the entry before them.
+    const char* scene =
+        "{ \"GameObjects\": [ { \"ID\": 1, \"SceneID\": 2 }, { \"ID\": 2 } ],\n"
+        "  \"Transforms\": [ { \"GOID\": 1, \"SceneID\": 5 }, { \"GOID\": 2 } ] }";
+
+    SceneLoader loader( nullptr );
+    TEST_CHECK( loader.Parse( scene, SCENEID_MainScene, true, false ) );
+    TEST_CHECK( loader.GetBlock( SceneLoader::BlockArray_GameObjects, 0 )->m_SceneID == 2 );
+    TEST_CHECK( loader.GetBlock( SceneLoader::BlockArray_GameObjects, 1 )->m_SceneID == 2 );
+    TEST_CHECK( loader.GetBlock( SceneLoader::BlockArray_Transforms, 1 )->m_SceneID == 5 );
+}
+
+int main()
+{
+    TEST_RUN( TestSplit );
+    TEST_RUN( TestStringsWithEscapesAndBrackets );
+    TEST_RUN( TestUnknownKeys );
+    TEST_RUN( TestDuplicateArrays );
+    TEST_RUN( TestFullParseFallback );
+    TEST_RUN( TestSceneIDsFromEachObject );
+
+    return TestResult();
+}
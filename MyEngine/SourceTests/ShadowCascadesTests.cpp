@@ -0,0 +1,212 @@
+//
+// Copyright (c) 2020 Jimmy Lord http://www.flatheadgames.com
+//
+// This software is provided 'as-is', without any express or implied warranty.  In no event will the authors be held liable for any damages arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include "MyEnginePCH.h"
+
+#include "ComponentSystem/Core/ShadowCascades.h"
+#include "TestHelpers.h"
+
+static void GetBoxCorners(const Vector3& center, float halfSize, Vector3* pCorners)
+{
+    for( int i=0; i<8; i++ )
+    {
+        pCorners[i].Set( center.x + ((i & 1) ? halfSize : -halfSize),
+                         center.y + ((i & 2) ? halfSize : -halfSize),
+                         center.z + ((i & 4) ? halfSize : -halfSize) );
+    }
+}
+
+static void TestSplitDistances()
+{
+    float splits[ShadowCascades::MAX_CASCADES + 1];
+
+    // Lambda 0 is uniform.
+    ShadowCascades::CalculateSplitDistances( 1, 100, 4, 0, splits );
+    TEST_CHECK_NEAR( splits[0], 1, 0.0001f );
+    TEST_CHECK_NEAR( splits[1], 25.75f, 0.001f );
+    TEST_CHECK_NEAR( splits[2], 50.5f, 0.001f );
+    TEST_CHECK_NEAR( splits[3], 75.25f, 0.001f );
+    TEST_CHECK_NEAR( splits[4], 100, 0.0001f );
+
+    // Lambda 1 is logarithmic, each split is the same ratio further than the last.
+    ShadowCascades::CalculateSplitDistances( 1, 100, 4, 1, splits );
+    TEST_CHECK_NEAR( splits[1], 3.1623f, 0.001f );
+    TEST_CHECK_NEAR( splits[2], 10, 0.001f );
+    TEST_CHECK_NEAR( splits[3], 31.623f, 0.01f );
+    TEST_CHECK_NEAR( splits[4], 100, 0.0001f );
+
+    // Anything in between stays between the two and increases.
+    float uniformSplits[ShadowCascades::MAX_CASCADES + 1];
+    float logSplits[ShadowCascades::MAX_CASCADES + 1];
+    ShadowCascades::CalculateSplitDistances( 0.5f, 200, 4, 0, uniformSplits );
+    ShadowCascades::CalculateSplitDistances( 0.5f, 200, 4, 1, logSplits );
+    ShadowCascades::CalculateSplitDistances( 0.5f, 200, 4, 0.75f, splits );
+    for( int i=1; i<4; i++ )
+    {
+        TEST_CHECK( splits[i] > splits[i-1] );
+        TEST_CHECK( splits[i] >= logSplits[i] && splits[i] <= uniformSplits[i] );
+    }
+
+    // A single cascade covers the whole range.
+    ShadowCascades::CalculateSplitDistances( 2, 50, 1, 0.5f, splits );
+    TEST_CHECK_NEAR( splits[0], 2, 0.0001f );
+    TEST_CHECK_NEAR( splits[1], 50, 0.0001f );
+}
+
+static void TestStableOrthoProjection()
+{
+    // The light looks down -z from the origin.
+    MyMatrix matLightView;
+    matLightView.SetIdentity();
+
+    int tileResolution = 512;
+    float casterDistance = 10;
+
+    // A cube with half size 1 has a bounding sphere radius of sqrt(3), rounded up to the next 1/16.
+    float radius = 28.0f / 16.0f;
+    float texelSize = radius * 2 / tileResolution;
+    Vector3 center( texelSize * 100.25f, texelSize * -40.75f, -20 );
+
+    Vector3 corners[8];
+    GetBoxCorners( center, 1, corners );
+
+    MyMatrix matProj;
+    TEST_CHECK_NEAR( ShadowCascades::CalculateStableOrthoProjection( matLightView, corners, tileResolution, casterDistance, &matProj ), radius, 0.0001f );
+
+    // The center lands within a texel of the middle of the tile, snapped down to a whole texel.
+    Vector4 clipCenter = matProj * Vector4( center.x, center.y, center.z, 1 );
+    float texelInClipSpace = 2.0f / tileResolution;
+    TEST_CHECK( clipCenter.x >= 0 && clipCenter.x < texelInClipSpace );
+    TEST_CHECK( clipCenter.y >= 0 && clipCenter.y < texelInClipSpace );
+
+    // Depth covers the sphere plus the caster distance towards the light.
+    Vector4 clipNear = matProj * Vector4( center.x, center.y, center.z + radius + casterDistance, 1 );
+    Vector4 clipFar = matProj * Vector4( center.x, center.y, center.z - radius, 1 );
+    TEST_CHECK_NEAR( clipNear.z, -1, 0.0001f );
+    TEST_CHECK_NEAR( clipFar.z, 1, 0.0001f );
+
+    // Moving less than a texel doesn't change the projection, so shadow edges don't shimmer.
+    Vector3 movedCorners[8];
+    GetBoxCorners( center + Vector3( texelSize * 0.5f, texelSize * 0.5f, 0 ), 1, movedCorners );
+
+    MyMatrix matMovedProj;
+    ShadowCascades::CalculateStableOrthoProjection( matLightView, movedCorners, tileResolution, casterDistance, &matMovedProj );
+    TEST_CHECK_NEAR( matMovedProj.m41, matProj.m41, 0.00001f );
+    TEST_CHECK_NEAR( matMovedProj.m42, matProj.m42, 0.00001f );
+    TEST_CHECK_NEAR( matMovedProj.m11, matProj.m11, 0.00001f );
+
+    // Moving a whole texel moves the projection by exactly one texel.
+    GetBoxCorners( center + Vector3( texelSize, 0, 0 ), 1, movedCorners );
+    ShadowCascades::CalculateStableOrthoProjection( matLightView, movedCorners, tileResolution, casterDistance, &matMovedProj );
+    TEST_CHECK_NEAR( matProj.m41 - matMovedProj.m41, texelInClipSpace, 0.0001f );
+}
+
+static void TestAtlasTileMatrix()
+{
+    MyMatrix matTile;
+
+    // One tile covers the whole atlas.
+    ShadowCascades::CalculateAtlasTileMatrix( 0, 0, 1, &matTile );
+    Vector4 pos = matTile * Vector4( -1, 1, 0.5f, 1 );
+    TEST_CHECK_NEAR( pos.x, -1, 0.0001f );
+    TEST_CHECK_NEAR( pos.y, 1, 0.0001f );
+    TEST_CHECK_NEAR( pos.z, 0.5f, 0.0001f );
+
+    // 2x2 tiles each cover a quarter, depth is untouched.
+    ShadowCascades::CalculateAtlasTileMatrix( 1, 0, 2, &matTile );
+    Vector4 tileMin = matTile * Vector4( -1, -1, 0.5f, 1 );
+    Vector4 tileMax = matTile * Vector4( 1, 1, 0.5f, 1 );
+    TEST_CHECK_NEAR( tileMin.x, 0, 0.0001f ); TEST_CHECK_NEAR( tileMin.y, -1, 0.0001f );
+    TEST_CHECK_NEAR( tileMax.x, 1, 0.0001f ); TEST_CHECK_NEAR( tileMax.y, 0, 0.0001f );
+    TEST_CHECK_NEAR( tileMax.z, 0.5f, 0.0001f );
+
+    ShadowCascades::CalculateAtlasTileMatrix( 0, 1, 2, &matTile );
+    tileMin = matTile * Vector4( -1, -1, 0, 1 );
+    tileMax = matTile * Vector4( 1, 1, 0, 1 );
+    TEST_CHECK_NEAR( tileMin.x, -1, 0.0001f ); TEST_CHECK_NEAR( tileMin.y, 0, 0.0001f );
+    TEST_CHECK_NEAR( tileMax.x, 0, 0.0001f ); TEST_CHECK_NEAR( tileMax.y, 1, 0.0001f );
+}
+
+static void TestUpdate()
+{
+    // Viewer at the origin looking down -z, light looking straight down.
+    MyMatrix matViewerProj;
+    matViewerProj.CreatePerspectiveVFoV( 60, 1, 1, 100 );
+
+    MyMatrix matViewerView;
+    matViewerView.SetIdentity();
+
+    MyMatrix matLightView;
+    matLightView.CreateLookAtView( Vector3( 0, 50, 0 ), Vector3( 0, 0, -1 ), Vector3( 0, 0, 0 ) );
+
+    ShadowCascades cascades;
+    cascades.Update( &matViewerProj, &matViewerView, 1, 100, 50, &matLightView, 4, 0.5f, 10, 1024 );
+
+    TEST_CHECK( cascades.GetNumCascades() == 4 );
+    TEST_CHECK( cascades.GetTileResolution() == 512 );
+
+    Vector3 viewPosition = cascades.GetViewPosition();
+    Vector3 viewDirection = cascades.GetViewDirection();
+    TEST_CHECK_NEAR( viewPosition.x, 0, 0.001f ); TEST_CHECK_NEAR( viewPosition.y, 0, 0.001f ); TEST_CHECK_NEAR( viewPosition.z, 0, 0.001f );
+    TEST_CHECK_NEAR( viewDirection.x, 0, 0.001f ); TEST_CHECK_NEAR( viewDirection.y, 0, 0.001f ); TEST_CHECK_NEAR( viewDirection.z, -1, 0.001f );
+
+    // Splits chain from the near plane to the max distance, matching CalculateSplitDistances.
+    float splits[ShadowCascades::MAX_CASCADES + 1];
+    ShadowCascades::CalculateSplitDistances( 1, 50, 4, 0.5f, splits );
+
+    for( int i=0; i<4; i++ )
+    {
+        ShadowCascades::Cascade* pCascade = cascades.GetCascade( i );
+
+        TEST_CHECK_NEAR( pCascade->m_SplitNear, splits[i], 0.001f );
+        TEST_CHECK_NEAR( pCascade->m_SplitFar, splits[i+1], 0.001f );
+        if( i > 0 )
+        {
+            TEST_CHECK( pCascade->m_Radius > cascades.GetCascade( i-1 )->m_Radius );
+        }
+
+        // Tiles fill the atlas left to right, then bottom to top.
+        TEST_CHECK( pCascade->m_AtlasX == (i % 2) * 512 );
+        TEST_CHECK( pCascade->m_AtlasY == (i / 2) * 512 );
+
+        // Points in the middle of the slice are inside the cascade and land in its tile of the atlas.
+        float depth = (pCascade->m_SplitNear + pCascade->m_SplitFar) * 0.5f;
+        Vector4 points[3] = { Vector4( 0, 0, -depth, 1 ), Vector4( depth * 0.5f, 0, -depth, 1 ), Vector4( 0, -depth * 0.5f, -depth, 1 ) };
+        for( int p=0; p<3; p++ )
+        {
+            Vector4 clipPos = pCascade->m_matViewProj * points[p];
+            TEST_CHECK( clipPos.x > -1 && clipPos.x < 1 );
+            TEST_CHECK( clipPos.y > -1 && clipPos.y < 1 );
+            TEST_CHECK( clipPos.z > -1 && clipPos.z < 1 );
+
+            Vector4 atlasPos = pCascade->m_matAtlasViewProj * points[p];
+            float u = atlasPos.x * 0.5f + 0.5f;
+            float v = atlasPos.y * 0.5f + 0.5f;
+            TEST_CHECK( u > pCascade->m_AtlasUVBounds.x && u < pCascade->m_AtlasUVBounds.z );
+            TEST_CHECK( v > pCascade->m_AtlasUVBounds.y && v < pCascade->m_AtlasUVBounds.w );
+        }
+    }
+
+    // A single cascade uses the whole atlas.
+    cascades.Update( &matViewerProj, &matViewerView, 1, 100, 0, &matLightView, 1, 0.5f, 10, 1024 );
+    TEST_CHECK( cascades.GetNumCascades() == 1 );
+    TEST_CHECK( cascades.GetTileResolution() == 1024 );
+    TEST_CHECK_NEAR( cascades.GetCascade( 0 )->m_SplitFar, 100, 0.001f );
+    TEST_CHECK_NEAR( cascades.GetCascade( 0 )->m_AtlasUVBounds.z, 1, 0.0001f );
+}
+
+int main()
+{
+    TEST_RUN( TestSplitDistances );
+    TEST_RUN( TestStableOrthoProjection );
+    TEST_RUN( TestAtlasTileMatrix );
+    TEST_RUN( TestUpdate );
+
+    return TestResult();
+}
@@ -0,0 +1,176 @@
+//
+// Copyright (c) 2020 Jimmy Lord http://www.flatheadgames.com
+//
+// This software is provided 'as-is', without any express or implied warranty.  In no event will the authors be held liable for any damages arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#include "MyEnginePCH.h"
+
+#include "ComponentSystem/Core/SpriteBatcher.h"
+#include "TestHelpers.h"
+
+// Materials and textures are only compared as sort keys, so any distinct addresses will do.
+static int g_MaterialA;
+static int g_MaterialB;
+static int g_Texture;
+#define MATERIAL_A ((MaterialDefinition*)&g_MaterialA)
+#define MATERIAL_B ((MaterialDefinition*)&g_MaterialB)
+#define TEXTURE ((TextureDefinition*)&g_Texture)
+
+static SpriteBatcher::SpriteQuad MakeQuad(MyMatrix* pMatWorld, MaterialDefinition* pMaterial, int sortLayer, float depth, unsigned int spriteIndex)
+{
+    SpriteBatcher::SpriteQuad quad;
+    quad.m_SortLayer = sortLayer;
+    quad.m_Depth = depth;
+    quad.m_pTexture = TEXTURE;
+    quad.m_pMaterial = pMaterial;
+    quad.m_SpriteIndex = spriteIndex;
+    quad.m_pMatWorld = pMatWorld;
+    quad.m_Size.Set( 2, 4 );
+    quad.m_UVStart.Set( 0, 0 );
+    quad.m_UVEnd.Set( 1, 1 );
+    return quad;
+}
+
+static void TestVertexContents()
+{
+    SpriteBatcher batcher( nullptr );
+
+    MyMatrix matWorld;
+    matWorld.SetIdentity();
+    matWorld.SetTranslation( Vector3( 10, 20, 30 ) );
+
+    SpriteBatcher::SpriteQuad quad = MakeQuad( &matWorld, MATERIAL_A, 0, 0, 0 );
+    quad.m_UVStart.Set( 0.25f, 0.5f );
+    quad.m_UVEnd.Set( 0.75f, 1.0f );
+
+    batcher.ClearQuads();
+    batcher.AddQuad( quad );
+    batcher.BuildBatchesFromQuads( nullptr );
+
+    TEST_CHECK( batcher.GetNumberOfBatches() == 1 );
+    TEST_CHECK( batcher.GetBatch( 0 )->m_NumSprites == 1 );
+
+    // BL, BR, TL, TR around the translation, with V flipped to match the sprite's own quad.
+    const Vertex_XYZUVNorm* pVerts = batcher.GetVertices();
+    TEST_CHECK_NEAR( pVerts[0].pos.x,  9, 0.0001f ); TEST_CHECK_NEAR( pVerts[0].pos.y, 18, 0.0001f );
+    TEST_CHECK_NEAR( pVerts[1].pos.x, 11, 0.0001f ); TEST_CHECK_NEAR( pVerts[1].pos.y, 18, 0.0001f );
+    TEST_CHECK_NEAR( pVerts[2].pos.x,  9, 0.0001f ); TEST_CHECK_NEAR( pVerts[2].pos.y, 22, 0.0001f );
+    TEST_CHECK_NEAR( pVerts[3].pos.x, 11, 0.0001f ); TEST_CHECK_NEAR( pVerts[3].pos.y, 22, 0.0001f );
+    for( int i=0; i<4; i++ )
+    {
+        TEST_CHECK_NEAR( pVerts[i].pos.z, 30, 0.0001f );
+        TEST_CHECK_NEAR( pVerts[i].normal.z, 1, 0.0001f );
+    }
+    TEST_CHECK_NEAR( pVerts[0].uv.x, 0.25f, 0.0001f ); TEST_CHECK_NEAR( pVerts[0].uv.y, 1.0f, 0.0001f );
+    TEST_CHECK_NEAR( pVerts[3].uv.x, 0.75f, 0.0001f ); TEST_CHECK_NEAR( pVerts[3].uv.y, 0.5f, 0.0001f );
+
+    // Bounds cover the whole quad.
+    TEST_CHECK_NEAR( batcher.GetBatch( 0 )->m_BoundsMin.x,  9, 0.0001f );
+    TEST_CHECK_NEAR( batcher.GetBatch( 0 )->m_BoundsMax.y, 22, 0.0001f );
+}
+
+static void TestBatchSplitting()
+{
+    SpriteBatcher batcher( nullptr );
+
+    MyMatrix matWorld;
+    matWorld.SetIdentity();
+
+    // Interleaved materials on one layer sort into one batch per material, a second layer gets its own batch.
+    batcher.ClearQuads();
+    batcher.AddQuad( MakeQuad( &matWorld, MATERIAL_A, 0, 0, 0 ) );
+    batcher.AddQuad( MakeQuad( &matWorld, MATERIAL_B, 0, 0, 1 ) );
+    batcher.AddQuad( MakeQuad( &matWorld, MATERIAL_A, 0, 0, 2 ) );
+    batcher.AddQuad( MakeQuad( &matWorld, MATERIAL_B, 0, 0, 3 ) );
+    batcher.AddQuad( MakeQuad( &matWorld, MATERIAL_A, 1, 0, 4 ) );
+    batcher.BuildBatchesFromQuads( nullptr );
+
+    TEST_CHECK( batcher.GetNumberOfBatches() == 3 );
+    TEST_CHECK( batcher.GetBatch( 0 )->m_NumSprites == 2 );
+    TEST_CHECK( batcher.GetBatch( 1 )->m_NumSprites == 2 );
+    TEST_CHECK( batcher.GetBatch( 0 )->m_pMaterial != batcher.GetBatch( 1 )->m_pMaterial );
+    TEST_CHECK( batcher.GetBatch( 2 )->m_SortLayer == 1 );
+    TEST_CHECK( batcher.GetBatch( 2 )->m_FirstSprite == 4 );
+    TEST_CHECK( batcher.GetStats().m_SpritesBatched == 5 );
+    TEST_CHECK( batcher.GetStats().m_Batches == 3 );
+
+    // Long runs are split at MAX_SPRITES_PER_BATCH.
+    batcher.ClearQuads();
+    for( unsigned int i=0; i<SpriteBatcher::MAX_SPRITES_PER_BATCH + 10; i++ )
+    {
+        batcher.AddQuad( MakeQuad( &matWorld, MATERIAL_A, 0, 0, i ) );
+    }
+    batcher.BuildBatchesFromQuads( nullptr );
+
+    TEST_CHECK( batcher.GetNumberOfBatches() == 2 );
+    TEST_CHECK( batcher.GetBatch( 0 )->m_NumSprites == SpriteBatcher::MAX_SPRITES_PER_BATCH );
+    TEST_CHECK( batcher.GetBatch( 1 )->m_NumSprites == 10 );
+    TEST_CHECK( batcher.GetBatch( 1 )->m_FirstSprite == SpriteBatcher::MAX_SPRITES_PER_BATCH );
+}
+
+static void TestDepthSorting()
+{
+    SpriteBatcher batcher( nullptr );
+
+    MyMatrix matNear;
+    matNear.SetIdentity();
+    matNear.SetTranslation( Vector3( 0, 0, -1 ) );
+
+    MyMatrix matFar;
+    matFar.SetIdentity();
+    matFar.SetTranslation( Vector3( 0, 0, -10 ) );
+
+    // Depth is view space z, so the more negative one is further away and has to be drawn first.
+    batcher.ClearQuads();
+    batcher.AddQuad( MakeQuad( &matNear, MATERIAL_A, 0, -1, 0 ) );
+    batcher.AddQuad( MakeQuad( &matFar, MATERIAL_A, 0, -10, 1 ) );
+    batcher.BuildBatchesFromQuads( nullptr );
+
+    TEST_CHECK( batcher.GetNumberOfBatches() == 1 );
+    TEST_CHECK_NEAR( batcher.GetVertices()[0].pos.z, -10, 0.0001f );
+    TEST_CHECK_NEAR( batcher.GetVertices()[4].pos.z, -1, 0.0001f );
+}
+
+static void TestCulling()
+{
+    SpriteBatcher batcher( nullptr );
+
+    MyMatrix matViewProj;
+    matViewProj.CreateOrtho( -10, 10, -10, 10, -100, 100 );
+
+    MyMatrix matOnScreen;
+    matOnScreen.SetIdentity();
+
+    MyMatrix matOffScreen;
+    matOffScreen.SetIdentity();
+    matOffScreen.SetTranslation( Vector3( 50, 0, 0 ) );
+
+    MyMatrix matPartlyOnScreen;
+    matPartlyOnScreen.SetIdentity();
+    matPartlyOnScreen.SetTranslation( Vector3( 10.5f, 0, 0 ) );
+
+    batcher.ClearQuads();
+    batcher.AddQuad( MakeQuad( &matOnScreen, MATERIAL_A, 0, 0, 0 ) );
+    batcher.AddQuad( MakeQuad( &matOffScreen, MATERIAL_A, 0, 0, 1 ) );
+    batcher.AddQuad( MakeQuad( &matPartlyOnScreen, MATERIAL_A, 0, 0, 2 ) );
+    batcher.BuildBatchesFromQuads( &matViewProj );
+
+    TEST_CHECK( batcher.GetStats().m_SpritesBatched == 2 );
+    TEST_CHECK( batcher.GetStats().m_SpritesCulled == 1 );
+    TEST_CHECK( batcher.GetNumberOfBatches() == 1 );
+    TEST_CHECK( batcher.GetBatch( 0 )->m_NumSprites == 2 );
+}
+
+int main()
+{
+    TEST_RUN( TestVertexContents );
+    TEST_RUN( TestBatchSplitting );
+    TEST_RUN( TestDepthSorting );
+    TEST_RUN( TestCulling );
+
+    return TestResult();
+}
@@ -0,0 +1,23 @@
+//
+// Copyright (c) 2020 Jimmy Lord http://www.flatheadgames.com
+//
+// This software is provided 'as-is', without any express or implied warranty.  In no event will the authors be held liable for any damages arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+
+#ifndef __EnginePCH_H__
+#define __EnginePCH_H__
+
+// Stand-in for the engine's precompiled header, for tests that build engine files with no MyFramework dependencies.
+// Only add what those files actually use.
+
+#include <assert.h>
+#include <stddef.h>
+#include <vector>
+
+#define MyAssert(condition) assert( condition )
+
+#endif //__EnginePCH_H__
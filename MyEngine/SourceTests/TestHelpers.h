@@ -0,0 +1,51 @@
+//
+// Copyright (c) 2020 Jimmy Lord http://www.flatheadgames.com
+//
+// This software is provided 'as-is', without any express or implied warranty.  In no event will the authors be held liable for any damages arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+
+#ifndef __TestHelpers_H__
+#define __TestHelpers_H__
+
+#include <math.h>
+#include <stdio.h>
+
+// Minimal checks for the headless tests, each test is its own executable and exits with 1 if any check failed.
+static int g_TestFailures = 0;
+
+#define TEST_CHECK(condition) \
+    do \
+    { \
+        if( !(condition) ) \
+        { \
+            printf( "%s(%d): check failed: %s\n", __FILE__, __LINE__, #condition ); \
+            g_TestFailures++; \
+        } \
+    } while( 0 )
+
+#define TEST_CHECK_NEAR(a, b, epsilon) TEST_CHECK( fabs( (double)(a) - (double)(b) ) <= (epsilon) )
+
+#define TEST_RUN(testFunc) \
+    do \
+    { \
+        printf( "Running %s\n", #testFunc ); \
+        testFunc(); \
+    } while( 0 )
+
+// Return this from main.
+static int TestResult()
+{
+    if( g_TestFailures == 0 )
+    {
+        printf( "All checks passed\n" );
+        return 0;
+    }
+
+    printf( "%d check(s) failed\n", g_TestFailures );
+    return 1;
+}
+
+#endif //__TestHelpers_H__
@@ -24,6 +24,11 @@ if PremakeConfig_UseBullet == nil then
     PremakeConfig_UseBullet = true
 end
 
+-- To allow a multithreaded bullet world, set 'PremakeConfig_UseBulletMT' to true and add 'defines { "MYFW_USE_BULLET_MT=1", "BT_THREADSAFE=1" }' to your project.
+if PremakeConfig_UseBulletMT == nil then
+    PremakeConfig_UseBulletMT = false
+end
+
 if PremakeConfig_UseMemoryTracker == nil then
     PremakeConfig_UseMemoryTracker = true
 end
@@ -182,6 +187,11 @@ else
         flags           "ExcludeFromBuild"
 end
 
+if PremakeConfig_UseBullet == true and PremakeConfig_UseBulletMT == true then
+    filter {}
+        defines         { "MYFW_USE_BULLET_MT=1", "BT_THREADSAFE=1" }
+end
+
 if PremakeConfig_UseMemoryTracker == true then
     filter "configurations:Debug or EditorDebug or EditorRelease"
         defines         "MYFW_USE_MEMORY_TRACKER"